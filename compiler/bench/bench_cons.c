@@ -0,0 +1,90 @@
+/* LAMC Compiler - Hash-Consing Benchmark
+ * Reports expression deduplication on source files and generated code
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "progen.h"
+#include "../parser/parser.h"
+
+/* Parse source twice (plain and hash-consed) and report the savings */
+static int report(const char* name, const char* source) {
+    Lexer lexer;
+    Parser parser;
+
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    double start = progen_now_ns();
+    AstNode* plain = parser_parse(&parser);
+    double plain_ns = progen_now_ns() - start;
+    if (!plain) {
+        printf("%-28s does not parse, skipped\n", name);
+        return 0;
+    }
+
+    AstConsTable* table = ast_cons_table_create();
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    parser_enable_hash_consing(&parser, table);
+    start = progen_now_ns();
+    AstNode* consed = parser_parse(&parser);
+    double consed_ns = progen_now_ns() - start;
+
+    AstConsStats stats;
+    ast_cons_get_stats(table, &stats);
+    bool same = consed && ast_equal(plain, consed);
+
+    printf("%-28s %9zu %9zu %6.1f%% %11zu %9.2f %9.2f %s\n",
+           name, stats.lookups, stats.unique,
+           stats.lookups ? 100.0 * (double)stats.hits / (double)stats.lookups : 0.0,
+           stats.bytes_saved, plain_ns / 1e6, consed_ns / 1e6,
+           same ? "ok" : "MISMATCH");
+
+    ast_free_node(consed);
+    ast_cons_table_free(table);
+    ast_free_node(plain);
+    return same ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    static const char* const DEFAULT_FILES[] = {
+        "../examples/hello.lamc",
+        "../examples/fibonacci.lamc",
+        "../test.lamc",
+        "../parser_test.lamc",
+        "../simple_control_test.lamc",
+    };
+    const char* const* files = DEFAULT_FILES;
+    int file_count = (int)(sizeof(DEFAULT_FILES) / sizeof(DEFAULT_FILES[0]));
+    int failures = 0;
+
+    if (argc > 1) {
+        files = (const char* const*)(argv + 1);
+        file_count = argc - 1;
+    }
+
+    printf("%-28s %9s %9s %7s %11s %9s %9s\n",
+           "input", "pure", "unique", "dedup", "bytes saved", "plain ms", "consed ms");
+
+    for (int i = 0; i < file_count; i++) {
+        char* source = progen_read_file(files[i], NULL);
+        if (!source) {
+            printf("%-28s cannot be read, skipped\n", files[i]);
+            continue;
+        }
+        failures += report(files[i], source);
+        free(source);
+    }
+
+    static const size_t SIZES[] = { 10000, 100000 };
+    for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); i++) {
+        char name[64];
+        char* source = progen_generate(SIZES[i], 7, NULL);
+        snprintf(name, sizeof(name), "generated (%zu lines)", SIZES[i]);
+        failures += report(name, source);
+        free(source);
+    }
+
+    return failures ? 1 : 0;
+}
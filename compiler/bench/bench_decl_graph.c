@@ -0,0 +1,243 @@
+/* LAMC Compiler - Declaration Graph Benchmark
+ * Latency of type-checking one-line edits of a large file incrementally,
+ * against resolving and inferring the whole program again
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "progen.h"
+#include "../parser/incremental.h"
+#include "../semantic/decl_graph.h"
+#include "../semantic/infer.h"
+#include "../semantic/resolve.h"
+
+#define EDITS 100
+#define FLOAT_EDITS 20
+#define LOCAL_EDITS 20
+#define CHECKED_EDITS 5
+
+enum { EDIT_SAME_KIND, EDIT_TO_FLOAT, EDIT_LOCAL, EDIT_KINDS };
+
+/* Edit of an integer literal at or after a random offset, past the
+ * first line's comment: one of its digits changed, or with to_float set,
+ * ".5" appended to make it a float */
+static char* random_edit(const char* source, size_t length, unsigned* seed, bool to_float, SourceEdit* edit) {
+    const char* first_line = strchr(source, '\n');
+    size_t skip = first_line ? (size_t)(first_line - source) : 0;
+    *seed = *seed * 1103515245u + 12345u;
+    size_t at = skip + (size_t)(*seed >> 1) % (length - skip);
+    size_t end = at;
+    for (size_t tried = 0; tried < length; tried++, at = at + 1 < length ? at + 1 : skip) {
+        char before = at > 0 ? source[at - 1] : ' ';
+        if (!isdigit((unsigned char)source[at]) || isalnum((unsigned char)before) || before == '_' || before == '.') {
+            continue;
+        }
+        end = at;
+        while (isdigit((unsigned char)source[end])) end++;
+        if (source[end] != '.') break;
+    }
+
+    char* result = (char*)malloc(length + 3);
+    if (!result) return NULL;
+    memcpy(result, source, length + 1);
+    if (to_float) {
+        memmove(result + end + 2, result + end, length - end + 1);
+        memcpy(result + end, ".5", 2);
+        edit->start = end;
+        edit->removed = 0;
+        edit->inserted = 2;
+    } else {
+        result[at] = result[at] == '9' ? '1' : (char)(result[at] + 1);
+        edit->start = at;
+        edit->removed = 1;
+        edit->inserted = 1;
+    }
+    return result;
+}
+
+/* A new local statement at the top of the first function declared at
+ * or after a random offset */
+static char* insert_local(const char* source, size_t length, unsigned* seed, SourceEdit* edit) {
+    static const char LOCAL[] = "    spare = 1\n";
+    *seed = *seed * 1103515245u + 12345u;
+    const char* header = strstr(source + (size_t)(*seed >> 1) % length, "\nfunc ");
+    if (!header) header = strstr(source, "\nfunc ");
+    const char* body = header ? strstr(header, "{\n") : NULL;
+    if (!body) return NULL;
+
+    size_t at = (size_t)(body - source) + 2;
+    size_t inserted = sizeof(LOCAL) - 1;
+    char* result = (char*)malloc(length + inserted + 1);
+    if (!result) return NULL;
+    memcpy(result, source, at);
+    memcpy(result + at, LOCAL, inserted);
+    memcpy(result + at + inserted, source + at, length - at + 1);
+    edit->start = at;
+    edit->removed = 0;
+    edit->inserted = inserted;
+    return result;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_diags(const void* a, const void* b) {
+    const Diagnostic* x = (const Diagnostic*)a;
+    const Diagnostic* y = (const Diagnostic*)b;
+    if (x->offset != y->offset) return x->offset < y->offset ? -1 : 1;
+    if (x->line != y->line) return x->line < y->line ? -1 : 1;
+    if (x->column != y->column) return x->column < y->column ? -1 : 1;
+    return (int)x->code - (int)y->code;
+}
+
+/* The graph reports what resolving and inferring the whole program does:
+ * the same diagnostics, and the same type for every top-level function */
+static bool matches_whole(const DeclGraph* graph, AstNode* program) {
+    DiagBuffer a, b;
+    Resolution res;
+    TypeInference types;
+    diag_buffer_init(&a);
+    diag_buffer_init(&b);
+    bool resolved = resolve_program(&res, program, &b);
+    bool inferred = resolved && infer_program(&types, &res, &b);
+    bool ok = inferred && decl_graph_diagnostics(graph, &a) && a.count == b.count;
+    if (ok) {
+        qsort(a.items, a.count, sizeof(Diagnostic), compare_diags);
+        qsort(b.items, b.count, sizeof(Diagnostic), compare_diags);
+    }
+    for (size_t i = 0; ok && i < a.count; i++) {
+        ok = a.items[i].code == b.items[i].code && a.items[i].offset == b.items[i].offset &&
+             a.items[i].length == b.items[i].length && a.items[i].line == b.items[i].line &&
+             a.items[i].column == b.items[i].column;
+    }
+    for (uint32_t id = 1; ok && id < res.index.count; id += res.index.size[id]) {
+        const AstNode* node = res.index.nodes[id];
+        if (node->type != AST_FUNCTION_DECL) continue;
+        char x[256], y[256];
+        type_format(decl_graph_types(graph), decl_graph_signature(graph, node->as.function.name), x, sizeof(x));
+        type_format(types.types, inference_type(&types, id), y, sizeof(y));
+        ok = strcmp(x, y) == 0;
+    }
+    if (inferred) type_inference_free(&types);
+    if (resolved) resolution_free(&res);
+    diag_buffer_free(&a);
+    diag_buffer_free(&b);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    size_t target_lines = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    size_t lines = 0;
+    char* source = progen_generate(target_lines, 23, &lines);
+    TokenBuffer tokens;
+    Parser parser;
+    AstNode* program = NULL;
+    if (source && token_buffer_lex(&tokens, source)) {
+        parser_init_tokens(&parser, &tokens, 0);
+        program = parser_parse(&parser);
+    }
+    if (!program) {
+        fprintf(stderr, "error: could not parse the generated program\n");
+        return 1;
+    }
+
+    /* Whole-program resolution and inference as the baseline */
+    double full_best = 1e30;
+    bool ok = true;
+    for (int rep = 0; rep < 3 && ok; rep++) {
+        Resolution res;
+        TypeInference types;
+        DiagBuffer diags;
+        diag_buffer_init(&diags);
+        double start = progen_now_ns();
+        ok = resolve_program(&res, program, &diags);
+        ok = ok && infer_program(&types, &res, &diags);
+        double elapsed = progen_now_ns() - start;
+        if (ok) {
+            type_inference_free(&types);
+            resolution_free(&res);
+        }
+        diag_buffer_free(&diags);
+        if (elapsed < full_best) full_best = elapsed;
+    }
+
+    DeclGraph* graph = decl_graph_create();
+    DeclCheckStats stats;
+    double start = progen_now_ns();
+    ok = ok && graph && decl_graph_check(graph, program, &stats);
+    double cold = progen_now_ns() - start;
+    size_t declarations = stats.declarations;
+    size_t components = stats.components;
+
+    /* Digit edits first, then edits that turn an integer into a float,
+     * then new statements in function bodies */
+    static const char* const KIND_NAMES[EDIT_KINDS] = { "digit edits", "int -> float edits", "new local edits" };
+    static const int KIND_EDITS[EDIT_KINDS] = { EDITS, FLOAT_EDITS, LOCAL_EDITS };
+    double reparse[EDIT_KINDS][EDITS], check[EDIT_KINDS][EDITS], total[EDIT_KINDS][EDITS];
+    size_t rechecked[EDIT_KINDS] = { 0, 0, 0 }, cutoffs[EDIT_KINDS] = { 0, 0, 0 };
+    size_t mismatches = 0;
+    unsigned seed = 11;
+    for (int kind = 0; ok && kind < EDIT_KINDS; kind++) {
+        for (int i = 0; ok && i < KIND_EDITS[kind]; i++) {
+            SourceEdit edit;
+            char* edited = kind == EDIT_LOCAL ? insert_local(source, strlen(source), &seed, &edit)
+                                              : random_edit(source, strlen(source), &seed, kind == EDIT_TO_FLOAT, &edit);
+            if (!edited) {
+                ok = false;
+                break;
+            }
+            start = progen_now_ns();
+            program = parser_reparse(program, &tokens, edited, edit, NULL);
+            double parsed = progen_now_ns();
+            ok = program && decl_graph_check(graph, program, &stats);
+            double checked = progen_now_ns();
+            free(source);
+            source = edited;
+
+            reparse[kind][i] = parsed - start;
+            check[kind][i] = checked - parsed;
+            total[kind][i] = checked - start;
+            rechecked[kind] += stats.rechecked;
+            cutoffs[kind] += stats.cutoffs;
+            if (ok && i < CHECKED_EDITS && !matches_whole(graph, program)) mismatches++;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "error: out of memory checking the program\n");
+        decl_graph_free(graph);
+        ast_free_node(program);
+        token_buffer_free(&tokens);
+        free(source);
+        return 1;
+    }
+
+    printf("program: %zu lines, %zu top-level declarations in %zu components\n", lines, declarations, components);
+    printf("whole-program resolve + infer: %9.3f ms\n", full_best / 1e6);
+    printf("cold graph check:              %9.3f ms\n", cold / 1e6);
+    for (int kind = 0; kind < EDIT_KINDS; kind++) {
+        int n = KIND_EDITS[kind];
+        qsort(reparse[kind], (size_t)n, sizeof(double), compare_doubles);
+        qsort(check[kind], (size_t)n, sizeof(double), compare_doubles);
+        qsort(total[kind], (size_t)n, sizeof(double), compare_doubles);
+        printf("%d %s:%*smedian    p95 (ms)\n", n, KIND_NAMES[kind], (int)(27 - strlen(KIND_NAMES[kind])), "");
+        printf("  reparse                      %8.3f %8.3f\n", reparse[kind][n / 2] / 1e6, reparse[kind][n * 95 / 100] / 1e6);
+        printf("  check                        %8.3f %8.3f\n", check[kind][n / 2] / 1e6, check[kind][n * 95 / 100] / 1e6);
+        printf("  reparse + check              %8.3f %8.3f\n", total[kind][n / 2] / 1e6, total[kind][n * 95 / 100] / 1e6);
+        printf("  median speedup over whole-program: %.1fx\n", full_best / total[kind][n / 2]);
+        printf("  per edit: %.1f declarations rechecked, %.2f cut off\n", (double)rechecked[kind] / n,
+               (double)cutoffs[kind] / n);
+    }
+    printf("oracle (first %d edits of each kind): %s\n", CHECKED_EDITS,
+           mismatches ? "MISMATCH" : "identical to whole-program resolve + infer");
+
+    decl_graph_free(graph);
+    ast_free_node(program);
+    token_buffer_free(&tokens);
+    free(source);
+    return mismatches ? 1 : 0;
+}
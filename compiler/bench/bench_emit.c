@@ -0,0 +1,79 @@
+/* LAMC Compiler - AST Emitter Benchmark
+ * Times pretty, JSON and S-expression output of a large tree against parsing it
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "progen.h"
+#include "../parser/parser.h"
+#include "../parser/ast_emit.h"
+
+#define REPS 5
+
+static const char* const FORMAT_NAMES[] = { "pretty", "json", "sexpr" };
+
+int main(int argc, char* argv[]) {
+    size_t target = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    size_t lines = 0;
+    char* source = progen_generate(target, 37, &lines);
+
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    double start = progen_now_ns();
+    AstNode* program = parser_parse(&parser);
+    double parse_ns = progen_now_ns() - start;
+    parser_free(&parser);
+    if (!program) {
+        fprintf(stderr, "error: generated program failed to parse\n");
+        return 1;
+    }
+
+    int fd = open("/dev/null", O_WRONLY);
+    if (fd < 0) {
+        fprintf(stderr, "error: cannot open /dev/null\n");
+        return 1;
+    }
+
+    printf("LAMC emitter benchmark: %zu lines, best of %d, written to /dev/null\n\n", lines, REPS);
+    printf("%-8s %10s %10s %10s %12s\n", "format", "ms", "MB", "MB/s", "vs parse");
+    printf("%-8s %10.3f\n", "parse", parse_ns / 1e6);
+
+    for (int format = AST_EMIT_PRETTY; format <= AST_EMIT_SEXPR; format++) {
+        double best = 0;
+        size_t bytes = 0;
+        for (int rep = 0; rep < REPS; rep++) {
+            /* Count bytes once, in memory */
+            if (rep == 0) {
+                AstEmitter memory;
+                ast_emitter_init(&memory, -1);
+                ast_emit_program(&memory, program, (AstEmitFormat)format);
+                bytes = memory.length;
+                ast_emitter_free(&memory);
+            }
+
+            AstEmitter out;
+            ast_emitter_init(&out, fd);
+            start = progen_now_ns();
+            ast_emit_program(&out, program, (AstEmitFormat)format);
+            ast_emitter_flush(&out);
+            double ns = progen_now_ns() - start;
+            ast_emitter_free(&out);
+            if (rep == 0 || ns < best) best = ns;
+        }
+
+        double mb = (double)bytes / (1024.0 * 1024.0);
+        printf("%-8s %10.3f %10.1f %10.0f %11.2fx\n", FORMAT_NAMES[format], best / 1e6, mb,
+               mb / (best / 1e9), best / parse_ns);
+    }
+
+    close(fd);
+    ast_free_node(program);
+    free(source);
+    return 0;
+}
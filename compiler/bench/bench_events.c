@@ -0,0 +1,151 @@
+/* LAMC Compiler - Event-Stream Parser Benchmark
+ * Counts calls per function from parse events and from a built tree
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "progen.h"
+#include "../parser/parser_events.h"
+#include "../parser/stats.h"
+
+#define REPS 3
+
+/* Calls per top-level function, in declaration order */
+typedef struct {
+    size_t* counts;
+    size_t functions;
+    size_t capacity;
+    bool in_function;
+    size_t events;
+} CallCounts;
+
+static void counts_add_function(CallCounts* counts) {
+    if (counts->functions == counts->capacity) {
+        counts->capacity = counts->capacity ? counts->capacity * 2 : 1024;
+        counts->counts = (size_t*)realloc(counts->counts, counts->capacity * sizeof(size_t));
+    }
+    counts->counts[counts->functions++] = 0;
+}
+
+/* ===== Event Stream ===== */
+
+static void on_event(const ParseEvent* event, void* context) {
+    CallCounts* counts = (CallCounts*)context;
+    counts->events++;
+
+    if (event->node == AST_FUNCTION_DECL) {
+        counts->in_function = event->kind == PARSE_EVENT_ENTER;
+        if (counts->in_function) counts_add_function(counts);
+    } else if (event->node == AST_CALL_EXPR && counts->in_function) {
+        counts->counts[counts->functions - 1]++;
+    }
+}
+
+static bool count_with_events(const char* source, StringInterner* interner, CallCounts* counts) {
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    bool ok = parser_parse_events(&parser, interner, on_event, counts);
+    parser_free(&parser);
+    return ok;
+}
+
+/* ===== Tree Walk ===== */
+
+static void count_calls(AstNode* node, void* context) {
+    if (!node) return;
+    if (node->type == AST_CALL_EXPR) (*(size_t*)context)++;
+    ast_visit_children(node, count_calls, context);
+}
+
+static bool count_with_tree(const char* source, CallCounts* counts) {
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+    if (!program) return false;
+
+    AstList* decls = program->as.program.declarations;
+    for (size_t i = 0; i < decls->count; i++) {
+        AstNode* decl = (AstNode*)decls->items[i];
+        if (decl->type != AST_FUNCTION_DECL) continue;
+        counts_add_function(counts);
+        count_calls(decl, &counts->counts[counts->functions - 1]);
+    }
+
+    ast_free_node(program);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    size_t target_lines = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    size_t lines = 0;
+    char* source = progen_generate(target_lines, 11, &lines);
+
+    CallCounts tree = { NULL, 0, 0, false, 0 };
+    CallCounts events = { NULL, 0, 0, false, 0 };
+    double tree_best = 1e30, events_best = 1e30;
+    size_t names = 0;
+    bool ok = true;
+
+    for (int rep = 0; rep < REPS; rep++) {
+        tree.functions = 0;
+        double start = progen_now_ns();
+        ok = count_with_tree(source, &tree) && ok;
+        double elapsed = progen_now_ns() - start;
+        if (elapsed < tree_best) tree_best = elapsed;
+
+        events.functions = 0;
+        StringInterner* interner = string_interner_create();
+        start = progen_now_ns();
+        ok = count_with_events(source, interner, &events) && ok;
+        elapsed = progen_now_ns() - start;
+        if (elapsed < events_best) events_best = elapsed;
+        names = string_interner_count(interner);
+        string_interner_free(interner);
+    }
+
+    size_t total_calls = 0;
+    bool same = ok && tree.functions == events.functions;
+    for (size_t i = 0; same && i < tree.functions; i++) {
+        same = tree.counts[i] == events.counts[i];
+        total_calls += tree.counts[i];
+    }
+
+    printf("program: %zu lines, %zu functions, %zu calls, %zu distinct names\n",
+           lines, tree.functions, total_calls, names);
+    printf("parse + walk + free:  %9.3f ms\n", tree_best / 1e6);
+    printf("event stream:         %9.3f ms\n", events_best / 1e6);
+    printf("speedup:              %9.2fx\n", tree_best / events_best);
+    printf("calls per function:   %s\n", same ? "identical" : "MISMATCH");
+
+    /* What each event costs in allocations: the nodes behind it still
+     * come from the scratch arena, token text only reaches the heap
+     * when it is too long for the parser's stack buffers */
+    ParseStats stats;
+    events.functions = 0;
+    events.events = 0;
+    parse_stats_reset();
+    count_with_events(source, NULL, &events);
+    parse_stats_snapshot(&stats);
+    if (stats.enabled && events.events > 0) {
+        uint64_t nodes = 0, bytes = 0;
+        for (int i = 0; i < AST_NODE_TYPE_COUNT; i++) nodes += stats.nodes[i];
+        for (int i = 0; i < STATS_BYTES_CATEGORY_COUNT; i++) bytes += stats.bytes[i];
+        printf("per event:            %9.2f nodes, %.1f arena bytes, %.2f heap bytes of token text\n",
+               (double)nodes / events.events, (double)(bytes - stats.bytes[STATS_BYTES_SCRATCH]) / events.events,
+               (double)stats.bytes[STATS_BYTES_SCRATCH] / events.events);
+    } else {
+        printf("per event:            %zu events (make STATS=1 for allocations)\n", events.events);
+    }
+
+    free(tree.counts);
+    free(events.counts);
+    free(source);
+    return same ? 0 : 1;
+}
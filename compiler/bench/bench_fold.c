@@ -0,0 +1,99 @@
+/* LAMC Compiler - Constant Folding Benchmark
+ * Reports the node-count reduction of parse-time folding on a corpus
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "progen.h"
+#include "../parser/parser.h"
+
+static void count_node(AstNode* node, void* context) {
+    if (!node) return;
+    (*(size_t*)context)++;
+    ast_visit_children(node, count_node, context);
+}
+
+static AstNode* parse_source(const char* source, bool fold, double* elapsed_ns) {
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    parser.silent = true;
+    parser_enable_constant_folding(&parser, fold);
+
+    double start = progen_now_ns();
+    AstNode* program = parser_parse(&parser);
+    *elapsed_ns = progen_now_ns() - start;
+    return program;
+}
+
+/* Parse source with and without folding; adds to the corpus totals */
+static void report(const char* name, const char* source, size_t* total_plain, size_t* total_folded) {
+    double plain_ns, folded_ns;
+    AstNode* plain = parse_source(source, false, &plain_ns);
+    if (!plain) {
+        printf("%-28s does not parse, skipped\n", name);
+        return;
+    }
+    AstNode* folded = parse_source(source, true, &folded_ns);
+
+    size_t plain_nodes = 0, folded_nodes = 0;
+    count_node(plain, &plain_nodes);
+    count_node(folded, &folded_nodes);
+    *total_plain += plain_nodes;
+    *total_folded += folded_nodes;
+
+    printf("%-28s %10zu %10zu %7.2f%% %9.2f %9.2f\n", name, plain_nodes, folded_nodes,
+           100.0 * (double)(plain_nodes - folded_nodes) / (double)plain_nodes,
+           plain_ns / 1e6, folded_ns / 1e6);
+
+    ast_free_node(folded);
+    ast_free_node(plain);
+}
+
+int main(int argc, char* argv[]) {
+    static const char* const DEFAULT_FILES[] = {
+        "../examples/hello.lamc",
+        "../examples/fibonacci.lamc",
+        "../test.lamc",
+        "../parser_test.lamc",
+        "../simple_control_test.lamc",
+    };
+    const char* const* files = DEFAULT_FILES;
+    int file_count = (int)(sizeof(DEFAULT_FILES) / sizeof(DEFAULT_FILES[0]));
+    size_t total_plain = 0, total_folded = 0;
+
+    if (argc > 1) {
+        files = (const char* const*)(argv + 1);
+        file_count = argc - 1;
+    }
+
+    printf("%-28s %10s %10s %8s %9s %9s\n",
+           "input", "nodes", "folded", "saved", "plain ms", "fold ms");
+
+    for (int i = 0; i < file_count; i++) {
+        char* source = progen_read_file(files[i], NULL);
+        if (!source) {
+            printf("%-28s cannot be read, skipped\n", files[i]);
+            continue;
+        }
+        report(files[i], source, &total_plain, &total_folded);
+        free(source);
+    }
+
+    static const size_t SIZES[] = { 10000, 100000 };
+    for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); i++) {
+        char name[64];
+        char* source = progen_generate(SIZES[i], 7, NULL);
+        snprintf(name, sizeof(name), "generated (%zu lines)", SIZES[i]);
+        report(name, source, &total_plain, &total_folded);
+        free(source);
+    }
+
+    if (total_plain > 0) {
+        printf("%-28s %10zu %10zu %7.2f%%\n", "total", total_plain, total_folded,
+               100.0 * (double)(total_plain - total_folded) / (double)total_plain);
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+/* LAMC Compiler - Frontend Benchmark Harness
+ * Times lexing, parsing and freeing at 10k/100k/1M lines against thresholds
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "progen.h"
+#include "../parser/parser.h"
+
+#define WARMUP 1
+#define MAX_REPS 32
+#define MAX_SIZES 8
+
+static const size_t DEFAULT_SIZES[] = { 10000, 100000, 1000000 };
+
+typedef enum {
+    PHASE_LEX,
+    PHASE_PARSE,
+    PHASE_FREE,
+    PHASE_TOTAL,
+    PHASE_COUNT
+} Phase;
+
+static const char* const PHASE_NAMES[PHASE_COUNT] = { "lex", "parse", "free", "total" };
+
+/* Median over repetitions of one program size */
+typedef struct {
+    size_t lines;
+    size_t bytes;
+    size_t tokens;
+    double ns[PHASE_COUNT];
+} Result;
+
+/* ===== Measurement ===== */
+
+/* One lex, parse and free of the whole source; false on a parse error */
+static bool run_once(const char* source, double ns[PHASE_COUNT], size_t* tokens) {
+    TokenBuffer buffer;
+    double start = progen_now_ns();
+    if (!token_buffer_lex(&buffer, source)) return false;
+    double lexed = progen_now_ns();
+
+    Parser parser;
+    parser_init_tokens(&parser, &buffer, 0);
+    AstNode* program = parser_parse(&parser);
+    bool ok = program && !parser.had_error;
+    parser_free(&parser);
+    double parsed = progen_now_ns();
+
+    ast_free_node(program);
+    double freed = progen_now_ns();
+
+    *tokens = buffer.count;
+    token_buffer_free(&buffer);
+
+    ns[PHASE_LEX] = lexed - start;
+    ns[PHASE_PARSE] = parsed - lexed;
+    ns[PHASE_FREE] = freed - parsed;
+    ns[PHASE_TOTAL] = freed - start;
+    return ok;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static bool measure(size_t target_lines, int reps, Result* result) {
+    size_t lines = 0;
+    char* source = progen_generate(target_lines, 37, &lines);
+    double samples[PHASE_COUNT][MAX_REPS];
+    double ns[PHASE_COUNT];
+    bool ok = true;
+
+    result->lines = lines;
+    result->bytes = strlen(source);
+
+    for (int rep = 0; rep < WARMUP + reps && ok; rep++) {
+        ok = run_once(source, ns, &result->tokens);
+        if (rep < WARMUP) continue;
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            samples[phase][rep - WARMUP] = ns[phase];
+        }
+    }
+
+    for (int phase = 0; ok && phase < PHASE_COUNT; phase++) {
+        qsort(samples[phase], (size_t)reps, sizeof(double), compare_doubles);
+        result->ns[phase] = samples[phase][reps / 2];
+    }
+
+    free(source);
+    return ok;
+}
+
+static void print_result(const Result* result) {
+    printf("%zu lines, %zu tokens, %.1f KB\n",
+           result->lines, result->tokens, (double)result->bytes / 1024.0);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        double ns = result->ns[phase];
+        printf("  %-6s %10.3f ms  %12.0f lines/s  %8.1f ns/token\n", PHASE_NAMES[phase],
+               ns / 1e6, (double)result->lines / (ns / 1e9), ns / (double)result->tokens);
+    }
+}
+
+/* ===== Thresholds ===== */
+
+/* Each non-comment line of the file is "<lines> <phase> <metric> <limit>",
+ * metric being ms or ns_per_token; it applies to the size measured with
+ * exactly that many requested lines. Returns the number of violations,
+ * or -1 if the file cannot be read. */
+static int check_thresholds(const char* path, const size_t* sizes, const Result* results,
+                            int size_count) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+
+    char line[256];
+    int line_number = 0;
+    int violations = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* text = line + strspn(line, " \t");
+        if (*text == '#' || *text == '\n' || *text == '\0') continue;
+
+        unsigned long lines;
+        char phase_name[16], metric[16];
+        double limit;
+        if (sscanf(text, "%lu %15s %15s %lf", &lines, phase_name, metric, &limit) != 4) {
+            fprintf(stderr, "%s:%d: malformed threshold\n", path, line_number);
+            violations++;
+            continue;
+        }
+
+        int phase = 0;
+        while (phase < PHASE_COUNT && strcmp(PHASE_NAMES[phase], phase_name) != 0) phase++;
+        bool per_token = strcmp(metric, "ns_per_token") == 0;
+        if (phase == PHASE_COUNT || (!per_token && strcmp(metric, "ms") != 0)) {
+            fprintf(stderr, "%s:%d: unknown phase or metric\n", path, line_number);
+            violations++;
+            continue;
+        }
+
+        for (int i = 0; i < size_count; i++) {
+            if (sizes[i] != lines) continue;
+            const Result* result = &results[i];
+            double value = per_token ? result->ns[phase] / (double)result->tokens
+                                     : result->ns[phase] / 1e6;
+            bool pass = value <= limit;
+            printf("  %-4s %7lu lines %-6s %-12s %10.1f <= %10.1f\n", pass ? "ok" : "FAIL",
+                   lines, phase_name, metric, value, limit);
+            if (!pass) violations++;
+        }
+    }
+
+    fclose(file);
+    return violations;
+}
+
+/* ===== Driver ===== */
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--sizes N,N,...] [--reps N] [--thresholds FILE]\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    size_t sizes[MAX_SIZES];
+    int size_count = 0;
+    int reps = 5;
+    const char* thresholds = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            char* cursor = argv[++i];
+            while (*cursor && size_count < MAX_SIZES) {
+                sizes[size_count++] = (size_t)strtoul(cursor, &cursor, 10);
+                if (*cursor == ',') cursor++;
+            }
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--thresholds") == 0 && i + 1 < argc) {
+            thresholds = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (size_count == 0) {
+        size_count = (int)(sizeof(DEFAULT_SIZES) / sizeof(DEFAULT_SIZES[0]));
+        memcpy(sizes, DEFAULT_SIZES, sizeof(DEFAULT_SIZES));
+    }
+    if (reps < 1) reps = 1;
+    if (reps > MAX_REPS) reps = MAX_REPS;
+
+    printf("LAMC frontend benchmark (median of %d after %d warmup)\n\n", reps, WARMUP);
+
+    Result results[MAX_SIZES];
+    for (int i = 0; i < size_count; i++) {
+        if (!measure(sizes[i], reps, &results[i])) {
+            fprintf(stderr, "error: generated %zu-line program failed to parse\n", sizes[i]);
+            return 1;
+        }
+        print_result(&results[i]);
+    }
+
+    if (!thresholds) return 0;
+
+    printf("\nthresholds (%s):\n", thresholds);
+    int violations = check_thresholds(thresholds, sizes, results, size_count);
+    if (violations < 0) {
+        fprintf(stderr, "error: cannot read %s\n", thresholds);
+        return 1;
+    }
+    if (violations > 0) {
+        printf("%d threshold%s exceeded\n", violations, violations == 1 ? "" : "s");
+        return 1;
+    }
+    printf("all thresholds met\n");
+    return 0;
+}
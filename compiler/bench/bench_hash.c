@@ -0,0 +1,73 @@
+/* LAMC Compiler - AST Hashing Benchmark
+ * Hashes every function of a large generated program
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "progen.h"
+#include "../parser/parser.h"
+
+int main(int argc, char* argv[]) {
+    size_t target_lines = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    size_t lines = 0;
+    char* source = progen_generate(target_lines, 42, &lines);
+
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    if (!program) {
+        fprintf(stderr, "bench_hash: generated program failed to parse\n");
+        free(source);
+        return 1;
+    }
+
+    AstList* decls = program->as.program.declarations;
+
+    /* Cold: every subtree hash is computed and cached */
+    double start = progen_now_ns();
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < decls->count; i++) {
+        checksum ^= ast_hash((AstNode*)decls->items[i]);
+    }
+    double cold_ns = progen_now_ns() - start;
+
+    /* Warm: every query is answered from the cached hash */
+    start = progen_now_ns();
+    uint64_t cached_checksum = 0;
+    for (size_t i = 0; i < decls->count; i++) {
+        cached_checksum ^= ast_hash((AstNode*)decls->items[i]);
+    }
+    double warm_ns = progen_now_ns() - start;
+
+    /* Find functions whose bodies match an earlier one */
+    start = progen_now_ns();
+    size_t duplicates = 0;
+    for (size_t i = 0; i < decls->count; i++) {
+        AstNode* fi = (AstNode*)decls->items[i];
+        for (size_t j = 0; j < i; j++) {
+            AstNode* fj = (AstNode*)decls->items[j];
+            if (ast_equal(fi->as.function.body, fj->as.function.body)) {
+                duplicates++;
+                break;
+            }
+        }
+    }
+    double dedup_ns = progen_now_ns() - start;
+
+    printf("program:        %zu lines, %zu functions\n", lines, decls->count);
+    printf("hash (cold):    %.3f ms (%.1f ns/function)\n",
+           cold_ns / 1e6, cold_ns / (double)decls->count);
+    printf("hash (cached):  %.3f ms (%.1f ns/function)\n",
+           warm_ns / 1e6, warm_ns / (double)decls->count);
+    printf("duplicate bodies: %zu (all-pairs ast_equal in %.3f ms)\n",
+           duplicates, dedup_ns / 1e6);
+    printf("checksum:       %016llx%s\n", (unsigned long long)checksum,
+           checksum == cached_checksum ? "" : " (MISMATCH)");
+
+    ast_free_node(program);
+    free(source);
+    return checksum == cached_checksum ? 0 : 1;
+}
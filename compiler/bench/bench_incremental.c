@@ -0,0 +1,133 @@
+/* LAMC Compiler - Incremental Reparse Benchmark
+ * Latency of single-line edits in a large file against a full reparse
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "progen.h"
+#include "../parser/incremental.h"
+
+#define EDITS 200
+#define CHECKED_EDITS 20
+
+static const char INSERTED_LINE[] = "    let edit_marker = 1\n";
+
+/* Apply a random single-line edit: change a digit of a number literal,
+ * or insert a statement line after a newline */
+static char* random_edit(const char* source, size_t length, unsigned* seed, SourceEdit* edit) {
+    *seed = *seed * 1103515245u + 12345u;
+    size_t offset = (size_t)(*seed >> 1) % length;
+    bool insert_line = (*seed >> 20) & 1;
+    char* result;
+
+    if (insert_line) {
+        const char* newline = strchr(source + offset, '\n');
+        size_t at = newline ? (size_t)(newline - source) + 1 : length;
+        size_t inserted = sizeof(INSERTED_LINE) - 1;
+
+        result = (char*)malloc(length + inserted + 1);
+        memcpy(result, source, at);
+        memcpy(result + at, INSERTED_LINE, inserted);
+        memcpy(result + at + inserted, source + at, length - at + 1);
+
+        edit->start = at;
+        edit->removed = 0;
+        edit->inserted = inserted;
+        return result;
+    }
+
+    /* First digit at or after offset that starts a number */
+    size_t at = offset;
+    while (at < length && !(isdigit((unsigned char)source[at]) &&
+                            (at == 0 || !(isalnum((unsigned char)source[at - 1]) || source[at - 1] == '_')))) {
+        at++;
+    }
+    if (at == length) at = 0;
+
+    result = (char*)malloc(length + 1);
+    memcpy(result, source, length + 1);
+    if (isdigit((unsigned char)result[at])) {
+        result[at] = result[at] == '9' ? '1' : (char)(result[at] + 1);
+    }
+
+    edit->start = at;
+    edit->removed = 1;
+    edit->inserted = 1;
+    return result;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char* argv[]) {
+    size_t target_lines = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    size_t lines = 0;
+    char* source = progen_generate(target_lines, 17, &lines);
+
+    /* Full lex + parse as the baseline */
+    double full_best = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+        TokenBuffer tokens;
+        double start = progen_now_ns();
+        token_buffer_lex(&tokens, source);
+        Parser parser;
+        parser_init_tokens(&parser, &tokens, 0);
+        AstNode* program = parser_parse(&parser);
+        double elapsed = progen_now_ns() - start;
+        if (elapsed < full_best) full_best = elapsed;
+        ast_free_node(program);
+        token_buffer_free(&tokens);
+    }
+
+    TokenBuffer tokens;
+    token_buffer_lex(&tokens, source);
+    Parser parser;
+    parser_init_tokens(&parser, &tokens, 0);
+    AstNode* program = parser_parse(&parser);
+
+    double latencies[EDITS];
+    size_t fallbacks = 0, reparsed = 0, relexed = 0, mismatches = 0;
+    unsigned seed = 5;
+
+    for (int i = 0; i < EDITS; i++) {
+        SourceEdit edit;
+        char* edited = random_edit(source, strlen(source), &seed, &edit);
+
+        ReparseStats stats;
+        double start = progen_now_ns();
+        program = parser_reparse(program, &tokens, edited, edit, &stats);
+        latencies[i] = progen_now_ns() - start;
+
+        free(source);
+        source = edited;
+
+        if (stats.full_reparse) fallbacks++;
+        reparsed += stats.reparsed;
+        relexed += stats.relexed_tokens;
+        if (i < CHECKED_EDITS && !parser_reparse_matches_full(program, &tokens)) mismatches++;
+    }
+
+    qsort(latencies, EDITS, sizeof(double), compare_doubles);
+
+    printf("program: %zu lines, %zu tokens\n", lines, tokens.count);
+    printf("full lex + parse:        %9.3f ms\n", full_best / 1e6);
+    printf("incremental, %d edits:  median %.3f ms, p95 %.3f ms, max %.3f ms\n",
+           EDITS, latencies[EDITS / 2] / 1e6, latencies[EDITS * 95 / 100] / 1e6,
+           latencies[EDITS - 1] / 1e6);
+    printf("median speedup:          %9.1fx\n", full_best / latencies[EDITS / 2]);
+    printf("per edit:                %.1f declarations reparsed, %.1f tokens relexed\n",
+           (double)reparsed / EDITS, (double)relexed / EDITS);
+    printf("full reparse fallbacks:  %zu\n", fallbacks);
+    printf("oracle (first %d edits): %s\n", CHECKED_EDITS,
+           mismatches ? "MISMATCH" : "identical to full reparse");
+
+    ast_free_node(program);
+    token_buffer_free(&tokens);
+    free(source);
+    return mismatches ? 1 : 0;
+}
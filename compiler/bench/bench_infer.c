@@ -0,0 +1,103 @@
+/* LAMC Compiler - Type Inference Benchmark
+ * Infers types for generated programs of growing size and reports the
+ * cost per node, which stays flat while inference is near-linear
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "progen.h"
+#include "../parser/parser.h"
+#include "../semantic/infer.h"
+#include "../semantic/resolve.h"
+
+#define REPS 3
+
+typedef struct {
+    size_t lines;
+    uint32_t nodes;
+    double resolve_ns;
+    double infer_ns;
+    size_t variables;
+    size_t types;
+    size_t conflicts;
+    size_t defaulted;
+    size_t dynamic;
+} Sample;
+
+static bool measure(size_t target, Sample* sample) {
+    char* source = progen_generate(target, 46, &sample->lines);
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+    if (!program) {
+        free(source);
+        return false;
+    }
+
+    bool ok = true;
+    for (int rep = 0; rep < REPS && ok; rep++) {
+        DiagBuffer diags;
+        Resolution res;
+        TypeInference types;
+        diag_buffer_init(&diags);
+
+        double start = progen_now_ns();
+        ok = resolve_program(&res, program, &diags);
+        double resolved = progen_now_ns();
+        ok = ok && infer_program(&types, &res, &diags);
+        double inferred = progen_now_ns();
+        if (!ok) break;
+
+        if (rep == 0 || resolved - start < sample->resolve_ns) sample->resolve_ns = resolved - start;
+        if (rep == 0 || inferred - resolved < sample->infer_ns) sample->infer_ns = inferred - resolved;
+        sample->nodes = res.index.count;
+        sample->variables = types.variables;
+        sample->types = type_table_count(types.types);
+        sample->conflicts = types.conflicts;
+        sample->defaulted = types.defaulted;
+        sample->dynamic = types.dynamic;
+
+        type_inference_free(&types);
+        resolution_free(&res);
+        diag_buffer_free(&diags);
+    }
+
+    ast_free_node(program);
+    free(source);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    size_t largest = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 1000000;
+    Sample samples[8];
+    int count = 0;
+
+    printf("LAMC type inference benchmark: best of %d\n\n", REPS);
+    printf("%9s %9s %11s %11s %9s %9s %7s %9s %9s %8s\n", "lines", "nodes", "resolve ms",
+           "infer ms", "ns/node", "vars", "types", "conflicts", "defaulted", "dynamic");
+
+    for (size_t target = 10000; target <= largest && count < 8; target *= 10) {
+        Sample* s = &samples[count];
+        if (!measure(target, s)) {
+            fprintf(stderr, "error: %zu-line program failed to parse or ran out of memory\n", target);
+            return 1;
+        }
+        printf("%9zu %9u %11.3f %11.3f %9.1f %9zu %7zu %9zu %9zu %7.1f%%\n", s->lines, s->nodes,
+               s->resolve_ns / 1e6, s->infer_ns / 1e6, s->infer_ns / s->nodes, s->variables, s->types,
+               s->conflicts, s->defaulted, 100.0 * s->dynamic / s->nodes);
+        count++;
+    }
+
+    /* Linear inference costs the same per node at every size */
+    if (count > 1) {
+        double first = samples[0].infer_ns / samples[0].nodes;
+        double last = samples[count - 1].infer_ns / samples[count - 1].nodes;
+        printf("\nns/node grew %.2fx over a %.0fx larger program\n", last / first,
+               (double)samples[count - 1].nodes / samples[0].nodes);
+    }
+    return 0;
+}
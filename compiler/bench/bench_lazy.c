@@ -0,0 +1,92 @@
+/* LAMC Compiler - Lazy Body Parsing Benchmark
+ * Compares outline-only parsing against raw lexing and full parsing
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "progen.h"
+#include "../parser/parser.h"
+
+#define REPETITIONS 5
+
+static AstNode* parse_buffer(TokenBuffer* tokens, bool lazy) {
+    Parser parser;
+    parser_init_tokens(&parser, tokens, 0);
+    parser_enable_lazy_bodies(&parser, lazy);
+    return parser_parse(&parser);
+}
+
+int main(int argc, char* argv[]) {
+    size_t target_lines = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    size_t lines = 0;
+    char* source = progen_generate(target_lines, 11, &lines);
+
+    double lex_best = 1e30, eager_best = 1e30, outline_best = 1e30;
+    size_t token_count = 0;
+
+    for (int rep = 0; rep < REPETITIONS; rep++) {
+        TokenBuffer tokens;
+
+        /* Raw lexing into a token buffer */
+        double start = progen_now_ns();
+        token_buffer_lex(&tokens, source);
+        double lex_ns = progen_now_ns() - start;
+        token_count = tokens.count;
+        token_buffer_free(&tokens);
+
+        /* Lex + full parse */
+        start = progen_now_ns();
+        token_buffer_lex(&tokens, source);
+        AstNode* eager = parse_buffer(&tokens, false);
+        double eager_ns = progen_now_ns() - start;
+        ast_free_node(eager);
+        token_buffer_free(&tokens);
+
+        /* Lex + outline (bodies skipped) */
+        start = progen_now_ns();
+        token_buffer_lex(&tokens, source);
+        AstNode* outline = parse_buffer(&tokens, true);
+        double outline_ns = progen_now_ns() - start;
+        ast_free_node(outline);
+        token_buffer_free(&tokens);
+
+        if (lex_ns < lex_best) lex_best = lex_ns;
+        if (eager_ns < eager_best) eager_best = eager_ns;
+        if (outline_ns < outline_best) outline_best = outline_ns;
+    }
+
+    /* Materialize every body and compare against the eager tree */
+    TokenBuffer tokens;
+    token_buffer_lex(&tokens, source);
+    AstNode* eager = parse_buffer(&tokens, false);
+
+    Parser parser;
+    parser_init_tokens(&parser, &tokens, 0);
+    parser_enable_lazy_bodies(&parser, true);
+    AstNode* lazy = parser_parse(&parser);
+
+    double start = progen_now_ns();
+    AstList* decls = lazy->as.program.declarations;
+    for (size_t i = 0; i < decls->count; i++) {
+        parser_materialize_body(&parser, (AstNode*)decls->items[i]);
+    }
+    double materialize_ns = progen_now_ns() - start;
+    lazy->hash = 0;
+    bool same = ast_equal(eager, lazy);
+
+    printf("program:            %zu lines, %zu tokens, %zu functions\n",
+           lines, token_count, decls->count);
+    printf("lex only:           %8.3f ms\n", lex_best / 1e6);
+    printf("lex + full parse:   %8.3f ms\n", eager_best / 1e6);
+    printf("lex + outline:      %8.3f ms (%.2fx lexing time)\n",
+           outline_best / 1e6, outline_best / lex_best);
+    printf("materialize bodies: %8.3f ms, trees %s\n",
+           materialize_ns / 1e6, same ? "identical" : "DIFFER");
+
+    ast_free_node(lazy);
+    ast_free_node(eager);
+    token_buffer_free(&tokens);
+    free(source);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/* LAMC Compiler - Module Build Benchmark
+ * Compiles a generated project of layered modules from scratch with growing
+ * thread counts, then rebuilds it unchanged and after a one-module edit
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "progen.h"
+#include "../semantic/modules.h"
+
+#define REPS 3
+#define LAYER_WIDTH 16
+
+/* Module i is called "m<i>"; the root, "main", imports the last layer */
+typedef struct {
+    char** sources;
+    size_t* lengths;
+    size_t count;
+    size_t lines;
+} Project;
+
+static char* read_module(void* context, const char* name, size_t* length) {
+    Project* project = (Project*)context;
+    size_t index = strcmp(name, "main") == 0 ? project->count : (size_t)strtoul(name + 1, NULL, 10);
+    if (name[0] != 'm' || (index >= project->count && strcmp(name, "main") != 0)) return NULL;
+    char* copy = (char*)malloc(project->lengths[index] + 1);
+    if (copy) memcpy(copy, project->sources[index], project->lengths[index] + 1);
+    *length = project->lengths[index];
+    return copy;
+}
+
+static bool set_source(Project* project, size_t index, char* source) {
+    if (!source) return false;
+    free(project->sources[index]);
+    project->sources[index] = source;
+    project->lengths[index] = strlen(source);
+    return true;
+}
+
+/* Each module past the first layer imports two of the layer below it */
+static bool generate(Project* project, size_t modules, size_t lines_per_module) {
+    project->count = modules;
+    project->lines = 0;
+    project->sources = (char**)calloc(modules + 1, sizeof(char*));
+    project->lengths = (size_t*)calloc(modules + 1, sizeof(size_t));
+    if (!project->sources || !project->lengths) return false;
+
+    for (size_t i = 0; i < modules; i++) {
+        size_t lines;
+        char* body = progen_generate(lines_per_module, 49 + (unsigned)i, &lines);
+        char* source = body ? (char*)malloc(strlen(body) + 64) : NULL;
+        if (source) {
+            source[0] = '\0';
+            if (i >= LAYER_WIDTH) {
+                size_t below = i - i % LAYER_WIDTH - LAYER_WIDTH;
+                sprintf(source, "import m%zu\nimport m%zu\n", below + i % LAYER_WIDTH,
+                        below + (i + 1) % LAYER_WIDTH);
+            }
+            strcat(source, body);
+        }
+        free(body);
+        if (!set_source(project, i, source)) return false;
+        project->lines += lines;
+    }
+
+    size_t first = modules > LAYER_WIDTH ? modules - modules % LAYER_WIDTH : 0;
+    if (first == modules) first -= LAYER_WIDTH;
+    char* root = (char*)malloc(32 * (modules - first) + 1);
+    if (!root) return false;
+    root[0] = '\0';
+    for (size_t i = first; i < modules; i++) sprintf(root + strlen(root), "import m%zu\n", i);
+    return set_source(project, modules, root);
+}
+
+static void project_free(Project* project) {
+    for (size_t i = 0; project->sources && i <= project->count; i++) free(project->sources[i]);
+    free(project->sources);
+    free(project->lengths);
+}
+
+/* Best of REPS builds; a cold build starts from an empty graph each time,
+ * a warm one rebuilds the graph of the one before it */
+static bool measure(Project* project, ModuleGraph* graph, int threads, bool cold, double* best_ns,
+                    ModuleBuildStats* stats) {
+    for (int rep = 0; rep < REPS; rep++) {
+        if (cold) {
+            module_graph_free(graph);
+            module_graph_init(graph, read_module, project);
+        }
+        double start = progen_now_ns();
+        bool ok = module_graph_build(graph, "main", threads, stats);
+        double elapsed = progen_now_ns() - start;
+        if (!ok) return false;
+        if (rep == 0 || elapsed < *best_ns) *best_ns = elapsed;
+        if (!cold) break;
+    }
+    return true;
+}
+
+static void print_row(const char* label, int threads, double ns, const ModuleBuildStats* stats) {
+    printf("%-14s %7d %11.3f %7zu %7zu %8zu %8zu %7zu\n", label, threads, ns / 1e6, stats->modules,
+           stats->waves, stats->parsed, stats->analyzed, stats->reused);
+}
+
+int main(int argc, char* argv[]) {
+    size_t modules = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 256;
+    size_t lines_per_module = argc > 2 ? (size_t)strtoul(argv[2], NULL, 10) : 2000;
+    if (modules < 1) modules = 1;
+
+    Project project;
+    if (!generate(&project, modules, lines_per_module)) {
+        fprintf(stderr, "error: out of memory generating the project\n");
+        project_free(&project);
+        return 1;
+    }
+    printf("LAMC module build benchmark: %zu modules, %zu lines, best of %d\n\n", modules + 1,
+           project.lines, REPS);
+    printf("%-14s %7s %11s %7s %7s %8s %8s %7s\n", "build", "threads", "ms", "modules", "waves",
+           "parsed", "analyzed", "reused");
+
+    ModuleGraph graph;
+    ModuleBuildStats stats;
+    double ns = 0;
+    double serial_ns = 0;
+    bool ok = true;
+    module_graph_init(&graph, read_module, &project);
+
+    for (int threads = 1; ok && threads <= 8; threads *= 2) {
+        ok = measure(&project, &graph, threads, true, &ns, &stats);
+        if (threads == 1) serial_ns = ns;
+        if (ok) print_row("cold", stats.threads, ns, &stats);
+    }
+    if (ok) printf("%-14s %7s %10.2fx\n", "", "speedup", serial_ns / ns);
+
+    /* Rebuilds keep the graph: nothing is reparsed unless its source changed */
+    ok = ok && measure(&project, &graph, 8, false, &ns, &stats);
+    if (ok) print_row("unchanged", stats.threads, ns, &stats);
+
+    /* A comment in a first-layer module leaves its interface as it was */
+    size_t length = project.lengths[0];
+    char* edited = (char*)malloc(length + 32);
+    if (edited) {
+        memcpy(edited, project.sources[0], length);
+        strcpy(edited + length, "\n// edited\n");
+    }
+    ok = ok && set_source(&project, 0, edited);
+    ok = ok && measure(&project, &graph, 8, false, &ns, &stats);
+    if (ok) print_row("body edit", stats.threads, ns, &stats);
+
+    if (ok && module_graph_error_count(&graph) > 0) {
+        printf("\n%zu errors reported in the generated project\n", module_graph_error_count(&graph));
+    }
+    module_graph_free(&graph);
+    project_free(&project);
+    if (!ok) {
+        fprintf(stderr, "error: out of memory building the project\n");
+        return 1;
+    }
+    return 0;
+}
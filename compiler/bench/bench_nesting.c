@@ -0,0 +1,142 @@
+/* LAMC Compiler - Deep Nesting Benchmark
+ * Times long else-if chains, operator and postfix chains and nesting at the limit on
+ * a small thread stack
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "progen.h"
+#include "../parser/parser.h"
+#include "../parser/parser_events.h"
+
+/* Far below the usual 8 MB: recursion per arm or operand would overflow it */
+#define STACK_BYTES (1024 * 1024)
+
+typedef struct {
+    const char* name;
+    char* source;
+    bool expect_error;
+    /* Results */
+    bool ok;
+    double parse_ns;
+    double free_ns;
+    double events_ns;
+} Case;
+
+static char* else_if_chain(size_t arms) {
+    char* source = malloc(arms * 40 + 32);
+    char* out = source;
+    for (size_t i = 0; i < arms; i++) {
+        out += sprintf(out, "%sif x == %zu { y = %zu }\n", i > 0 ? "else " : "", i, i);
+    }
+    sprintf(out, "else { y = 0 }\n");
+    return source;
+}
+
+static char* operator_chain(size_t terms) {
+    char* source = malloc(terms * 4 + 32);
+    char* out = source + sprintf(source, "z = 1");
+    for (size_t i = 1; i < terms; i++) out += sprintf(out, " + 1");
+    sprintf(out, "\n");
+    return source;
+}
+
+/* Member accesses, subscripts and calls in turn, each applied to the last */
+static char* postfix_chain(size_t links) {
+    static const char* const LINKS[] = { ".b", "[0]", "()" };
+    char* source = malloc(links * 3 + 32);
+    char* out = source + sprintf(source, "z = a");
+    for (size_t i = 0; i < links; i++) out += sprintf(out, "%s", LINKS[i % 3]);
+    sprintf(out, "\n");
+    return source;
+}
+
+static char* nested_parens(size_t depth) {
+    char* source = malloc(depth * 2 + 32);
+    char* out = source + sprintf(source, "z = ");
+    memset(out, '(', depth);
+    out += depth;
+    *out++ = '1';
+    memset(out, ')', depth);
+    out += depth;
+    sprintf(out, "\n");
+    return source;
+}
+
+static void ignore_event(const ParseEvent* event, void* context) {
+    (void)event;
+    (void)context;
+}
+
+static void* run_case(void* arg) {
+    Case* c = arg;
+    Lexer lexer;
+    Parser parser;
+
+    lexer_init(&lexer, c->source);
+    parser_init(&parser, &lexer);
+    parser.silent = true;
+    double start = progen_now_ns();
+    AstNode* program = parser_parse(&parser);
+    double parsed = progen_now_ns();
+    bool had_error = parser.had_error;
+    parser_free(&parser);
+    ast_free_node(program);
+    double freed = progen_now_ns();
+
+    lexer_init(&lexer, c->source);
+    parser_init(&parser, &lexer);
+    parser.silent = true;
+    double events_start = progen_now_ns();
+    bool events_ok = parser_parse_events(&parser, NULL, ignore_event, NULL);
+    c->events_ns = progen_now_ns() - events_start;
+    parser_free(&parser);
+
+    c->parse_ns = parsed - start;
+    c->free_ns = freed - parsed;
+    c->ok = had_error == c->expect_error && events_ok != c->expect_error;
+    return NULL;
+}
+
+int main(void) {
+    /* Smallest first: freeing the big trees leaves work for the allocator */
+    Case cases[] = {
+        { "parens just within limit", nested_parens(PARSER_DEFAULT_NESTING_LIMIT - 2), false, false, 0, 0, 0 },
+        { "parens, 100k deep", nested_parens(100000), true, false, 0, 0, 0 },
+        { "else-if chain, 1k arms", else_if_chain(1000), false, false, 0, 0, 0 },
+        { "else-if chain, 10k arms", else_if_chain(10000), false, false, 0, 0, 0 },
+        { "else-if chain, 100k arms", else_if_chain(100000), false, false, 0, 0, 0 },
+        { "'+' chain, 1M terms", operator_chain(1000000), false, false, 0, 0, 0 },
+        { "postfix chain, 300k links", postfix_chain(300000), false, false, 0, 0, 0 },
+    };
+    size_t count = sizeof(cases) / sizeof(cases[0]);
+    int failures = 0;
+
+    printf("LAMC deep nesting benchmark (%d KB thread stack, limit %d)\n\n",
+           STACK_BYTES / 1024, PARSER_DEFAULT_NESTING_LIMIT);
+    printf("%-26s %10s %10s %10s  %s\n", "case", "parse ms", "free ms", "events ms", "result");
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, STACK_BYTES);
+    for (size_t i = 0; i < count; i++) {
+        Case* c = &cases[i];
+        pthread_t thread;
+        if (pthread_create(&thread, &attr, run_case, c) != 0) {
+            fprintf(stderr, "error: cannot start thread\n");
+            return 1;
+        }
+        pthread_join(thread, NULL);
+
+        printf("%-26s %10.3f %10.3f %10.3f  %s\n", c->name, c->parse_ns / 1e6, c->free_ns / 1e6,
+               c->events_ns / 1e6, c->ok ? (c->expect_error ? "ok (E0104)" : "ok") : "FAIL");
+        if (!c->ok) failures++;
+        free(c->source);
+    }
+    pthread_attr_destroy(&attr);
+
+    return failures > 0 ? 1 : 0;
+}
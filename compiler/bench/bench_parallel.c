@@ -0,0 +1,71 @@
+/* LAMC Compiler - Parallel Parsing Benchmark
+ * Scaling curve of parser_parse_parallel() against the sequential parser
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "progen.h"
+#include "../parser/parallel.h"
+
+#define REPETITIONS 5
+
+static const int THREAD_COUNTS[] = { 1, 2, 4, 8, 16 };
+
+static AstNode* parse_sequential(TokenBuffer* tokens) {
+    Parser parser;
+    parser_init_tokens(&parser, tokens, 0);
+    return parser_parse(&parser);
+}
+
+int main(int argc, char* argv[]) {
+    size_t target_lines = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    size_t lines = 0;
+    char* source = progen_generate(target_lines, 13, &lines);
+
+    TokenBuffer tokens;
+    token_buffer_lex(&tokens, source);
+
+    double sequential_best = 1e30;
+    for (int rep = 0; rep < REPETITIONS; rep++) {
+        double start = progen_now_ns();
+        AstNode* program = parse_sequential(&tokens);
+        double elapsed = progen_now_ns() - start;
+        ast_free_node(program);
+        if (elapsed < sequential_best) sequential_best = elapsed;
+    }
+
+    AstNode* reference = parse_sequential(&tokens);
+    int failures = 0;
+
+    printf("program: %zu lines, %zu tokens, %ld online CPUs\n",
+           lines, tokens.count, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("sequential parse: %8.3f ms\n\n", sequential_best / 1e6);
+    printf("%7s %7s %10s %8s %s\n", "threads", "chunks", "parse ms", "speedup", "tree");
+
+    for (size_t t = 0; t < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); t++) {
+        double best = 1e30;
+        ParallelParseStats stats = {0};
+        bool same = true;
+
+        for (int rep = 0; rep < REPETITIONS; rep++) {
+            double start = progen_now_ns();
+            AstNode* program = parser_parse_parallel(&tokens, THREAD_COUNTS[t], NULL, &stats);
+            double elapsed = progen_now_ns() - start;
+            if (elapsed < best) best = elapsed;
+
+            if (rep == 0) same = program && ast_equal(reference, program);
+            ast_free_node(program);
+        }
+
+        printf("%7d %7zu %10.3f %7.2fx %s\n", stats.threads, stats.chunks,
+               best / 1e6, sequential_best / best, same ? "identical" : "DIFFERS");
+        if (!same) failures++;
+    }
+
+    ast_free_node(reference);
+    token_buffer_free(&tokens);
+    free(source);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+/* LAMC Compiler - Persistent AST Benchmark
+ * Times snapshots and path-copying edits on trees of growing size
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "progen.h"
+#include "../parser/parser.h"
+#include "../parser/ast_index.h"
+#include "../parser/ast_persist.h"
+
+#define SNAPSHOTS 1000000
+#define EDITS 10000
+#define MAX_DEPTH 256
+
+/* Path from the middle declaration down its first non-empty children */
+static size_t deep_path(AstNode* program, size_t* path) {
+    size_t depth = 0;
+    AstNode* node = program;
+    path[depth++] = program->as.program.declarations->count / 2;
+    node = ast_child_at(node, path[0]);
+    while (depth < MAX_DEPTH) {
+        size_t count = ast_child_count(node);
+        size_t slot = 0;
+        while (slot < count && !ast_child_at(node, slot)) slot++;
+        if (slot == count) break;
+        path[depth++] = slot;
+        node = ast_child_at(node, slot);
+    }
+    return depth;
+}
+
+static void run(size_t target) {
+    size_t lines = 0;
+    char* source = progen_generate(target, 43, &lines);
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    double start = progen_now_ns();
+    AstNode* program = parser_parse(&parser);
+    double parse_ns = progen_now_ns() - start;
+    parser_free(&parser);
+    if (!program || !program->as.program.declarations->count) {
+        fprintf(stderr, "error: generated program failed to parse\n");
+        exit(1);
+    }
+
+    AstIndex index;
+    uint32_t nodes = ast_index_build(&index, program) ? index.count : 0;
+    ast_index_free(&index);
+
+    start = progen_now_ns();
+    for (int i = 0; i < SNAPSHOTS; i++) {
+        AstSnapshot snapshot = ast_snapshot(program);
+        ast_snapshot_release(&snapshot);
+    }
+    double snapshot_ns = (progen_now_ns() - start) / SNAPSHOTS;
+
+    /* Each edit replaces the deepest node on the path with a literal and
+     * keeps both versions alive until the new one is released */
+    size_t path[MAX_DEPTH];
+    size_t depth = deep_path(program, path);
+    start = progen_now_ns();
+    for (int i = 0; i < EDITS; i++) {
+        AstNode* edited = ast_persist_replace(program, path, depth, ast_create_literal_int(i, 1, 1));
+        if (!edited) {
+            fprintf(stderr, "error: edit failed\n");
+            exit(1);
+        }
+        ast_free_node(edited);
+    }
+    double edit_ns = (progen_now_ns() - start) / EDITS;
+
+    printf("%9zu %10u %12.3f %12.1f %7zu %12.0f\n", lines, nodes, parse_ns / 1e6,
+           snapshot_ns, depth, edit_ns);
+    ast_free_node(program);
+    free(source);
+}
+
+int main(int argc, char* argv[]) {
+    size_t largest = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+
+    printf("LAMC persistent AST benchmark: per-operation cost against tree size\n\n");
+    printf("%9s %10s %12s %12s %7s %12s\n", "lines", "nodes", "parse ms", "snapshot ns",
+           "depth", "edit ns");
+    for (size_t target = 1000; target <= largest; target *= 10) {
+        run(target);
+    }
+    return 0;
+}
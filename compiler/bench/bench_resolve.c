@@ -0,0 +1,97 @@
+/* LAMC Compiler - Parallel Resolution Benchmark
+ * Resolves one generated program sequentially and with growing thread
+ * counts, checking that every run binds names the same way
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "progen.h"
+#include "../parser/parser.h"
+#include "../semantic/resolve.h"
+
+#define REPS 3
+
+/* Best time of REPS runs; threads 0 is resolve_program() */
+static bool measure(AstNode* program, int threads, double* best_ns, ParallelResolveStats* stats,
+                    NameRef** names, uint32_t* node_count, size_t* diag_count) {
+    for (int rep = 0; rep < REPS; rep++) {
+        DiagBuffer diags;
+        Resolution res;
+        diag_buffer_init(&diags);
+
+        double start = progen_now_ns();
+        bool ok = threads == 0 ? resolve_program(&res, program, &diags)
+                               : resolve_program_parallel(&res, program, &diags, threads, stats);
+        double elapsed = progen_now_ns() - start;
+        if (!ok) {
+            diag_buffer_free(&diags);
+            return false;
+        }
+        if (rep == 0 || elapsed < *best_ns) *best_ns = elapsed;
+
+        if (rep == 0) {
+            *names = (NameRef*)malloc((res.index.count + 1) * sizeof(NameRef));
+            if (*names) memcpy(*names, res.names, res.index.count * sizeof(NameRef));
+            *node_count = res.index.count;
+            *diag_count = diags.count;
+        }
+        resolution_free(&res);
+        diag_buffer_free(&diags);
+    }
+    return *names != NULL;
+}
+
+int main(int argc, char* argv[]) {
+    size_t target = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 1000000;
+    int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+
+    size_t lines = 0;
+    char* source = progen_generate(target, 48, &lines);
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+    if (!program) {
+        fprintf(stderr, "error: generated program failed to parse\n");
+        free(source);
+        return 1;
+    }
+
+    printf("LAMC parallel resolution benchmark: %zu lines, best of %d\n\n", lines, REPS);
+    printf("%10s %11s %9s %8s %8s %10s\n", "threads", "resolve ms", "speedup", "bodies", "steals", "identical");
+
+    double sequential_ns = 0;
+    NameRef* reference = NULL;
+    size_t reference_diags = 0;
+    uint32_t count = 0;
+    if (!measure(program, 0, &sequential_ns, NULL, &reference, &count, &reference_diags)) {
+        fprintf(stderr, "error: out of memory\n");
+        return 1;
+    }
+    printf("%10s %11.3f %8.2fx %8s %8s %10s\n", "sequential", sequential_ns / 1e6, 1.0, "-", "-", "-");
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double ns = 0;
+        NameRef* names = NULL;
+        uint32_t node_count = 0;
+        size_t diag_count = 0;
+        ParallelResolveStats stats;
+        if (!measure(program, threads, &ns, &stats, &names, &node_count, &diag_count)) {
+            fprintf(stderr, "error: out of memory\n");
+            return 1;
+        }
+        bool identical = node_count == count && diag_count == reference_diags && memcmp(names, reference, count * sizeof(NameRef)) == 0;
+        printf("%10d %11.3f %8.2fx %8zu %8zu %10s\n", threads, ns / 1e6, sequential_ns / ns, stats.bodies,
+               stats.steals, identical ? "yes" : "NO");
+        free(names);
+    }
+
+    free(reference);
+    ast_free_node(program);
+    free(source);
+    return 0;
+}
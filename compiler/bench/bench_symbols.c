@@ -0,0 +1,374 @@
+/* LAMC Compiler - Symbol Table Benchmark
+ * Resolves every identifier of a large program with the flat symbol table
+ * and with a hash map per scope keyed by strings, then times the resolve pass
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "progen.h"
+#include "../parser/parser.h"
+#include "../parser/intern.h"
+#include "../semantic/resolve.h"
+#include "../semantic/symbol_table.h"
+
+#define REPS 5
+
+/* ===== Recorded Resolution Steps ===== */
+
+/* The table operations of a resolve walk, recorded once so that both
+ * tables replay exactly the same work */
+typedef enum {
+    STEP_PUSH,
+    STEP_POP,
+    STEP_DECLARE,   /* New binding in the current scope */
+    STEP_BIND,      /* 'x = ...': declares x unless a binding is visible */
+    STEP_LOOKUP
+} StepKind;
+
+typedef struct {
+    StepKind kind;
+    uint32_t name;
+    const char* spelling;
+    AstNode* decl;
+} Step;
+
+typedef struct {
+    Step* steps;
+    size_t count;
+    size_t capacity;
+    StringInterner* interner;
+} Recording;
+
+static void record(Recording* rec, StepKind kind, const char* spelling, AstNode* decl) {
+    if (rec->count == rec->capacity) {
+        rec->capacity = rec->capacity ? rec->capacity * 2 : 1024;
+        rec->steps = (Step*)realloc(rec->steps, rec->capacity * sizeof(Step));
+        if (!rec->steps) {
+            fprintf(stderr, "error: out of memory\n");
+            exit(1);
+        }
+    }
+    Step* step = &rec->steps[rec->count++];
+    step->kind = kind;
+    step->spelling = spelling;
+    step->name = spelling ? string_intern(rec->interner, spelling, strlen(spelling)) : 0;
+    step->decl = decl;
+}
+
+static void walk(Recording* rec, AstNode* node);
+
+static void walk_child(AstNode* child, void* context) {
+    walk((Recording*)context, child);
+}
+
+static void walk_list(Recording* rec, AstList* list) {
+    for (size_t i = 0; list && i < list->count; i++) walk(rec, (AstNode*)list->items[i]);
+}
+
+static void walk_function(Recording* rec, AstNode* node) {
+    record(rec, STEP_PUSH, NULL, NULL);
+    AstList* params = node->as.function.parameters;
+    for (size_t i = 0; params && i < params->count; i++) {
+        Parameter* param = (Parameter*)params->items[i];
+        walk(rec, param->default_value);
+        record(rec, STEP_DECLARE, param->name, node);
+    }
+    if (node->as.function.body) walk_list(rec, node->as.function.body->as.block.statements);
+    record(rec, STEP_POP, NULL, NULL);
+}
+
+static void walk(Recording* rec, AstNode* node) {
+    if (!node) return;
+    switch (node->type) {
+        case AST_IDENTIFIER_EXPR:
+            record(rec, STEP_LOOKUP, node->as.identifier, NULL);
+            break;
+        case AST_MEMBER_EXPR:
+            walk(rec, node->as.member.object);
+            break;
+        case AST_VAR_DECL:
+            walk(rec, node->as.var_decl.initializer);
+            record(rec, STEP_BIND, node->as.var_decl.name, node);
+            break;
+        case AST_BLOCK_STMT:
+            record(rec, STEP_PUSH, NULL, NULL);
+            walk_list(rec, node->as.block.statements);
+            record(rec, STEP_POP, NULL, NULL);
+            break;
+        case AST_FOR_STMT:
+            walk(rec, node->as.for_stmt.iterable);
+            record(rec, STEP_PUSH, NULL, NULL);
+            record(rec, STEP_DECLARE, node->as.for_stmt.variable, node);
+            if (node->as.for_stmt.index_var) record(rec, STEP_DECLARE, node->as.for_stmt.index_var, node);
+            walk_list(rec, node->as.for_stmt.body->as.block.statements);
+            record(rec, STEP_POP, NULL, NULL);
+            break;
+        case AST_FUNCTION_DECL:
+            walk_function(rec, node);
+            break;
+        case AST_PROGRAM: {
+            /* Top-level names are visible throughout, before their declaration */
+            AstList* decls = node->as.program.declarations;
+            for (size_t i = 0; decls && i < decls->count; i++) {
+                AstNode* decl = (AstNode*)decls->items[i];
+                if (decl->type == AST_FUNCTION_DECL) record(rec, STEP_DECLARE, decl->as.function.name, decl);
+            }
+            walk_list(rec, decls);
+            break;
+        }
+        default:
+            ast_visit_children(node, walk_child, rec);
+            break;
+    }
+}
+
+/* ===== Flat Table ===== */
+
+static uint64_t replay_flat(const Step* steps, size_t count, size_t* resolved) {
+    SymbolTable* table = symbol_table_create();
+    uint64_t checksum = 0;
+    *resolved = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Step* step = &steps[i];
+        switch (step->kind) {
+            case STEP_PUSH:
+                symbol_table_push_scope(table);
+                break;
+            case STEP_POP:
+                symbol_table_pop_scope(table);
+                break;
+            case STEP_DECLARE:
+                symbol_table_declare(table, step->name, SYMBOL_VARIABLE, step->decl);
+                break;
+            case STEP_BIND:
+                if (symbol_table_lookup(table, step->name) == SYMBOL_NONE) {
+                    symbol_table_declare(table, step->name, SYMBOL_VARIABLE, step->decl);
+                }
+                break;
+            case STEP_LOOKUP: {
+                SymbolId id = symbol_table_lookup(table, step->name);
+                if (id != SYMBOL_NONE) {
+                    (*resolved)++;
+                    checksum = checksum * 31 + (uintptr_t)symbol_table_get(table, id)->decl;
+                }
+                break;
+            }
+        }
+    }
+    symbol_table_free(table);
+    return checksum;
+}
+
+/* ===== Hash Map per Scope ===== */
+
+/* What the architecture notes sketch: a stack of string-keyed maps, one
+ * allocated per scope, each owning copies of its keys */
+typedef struct {
+    char* key;
+    AstNode* decl;
+} MapEntry;
+
+typedef struct {
+    MapEntry* entries;
+    size_t capacity;
+    size_t count;
+} ScopeMap;
+
+typedef struct {
+    ScopeMap* scopes;
+    size_t depth;
+    size_t capacity;
+} ScopeStack;
+
+static uint64_t hash_string(const char* text) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (; *text; text++) {
+        h ^= (unsigned char)*text;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static char* copy_key(const char* key) {
+    size_t length = strlen(key) + 1;
+    char* copy = (char*)malloc(length);
+    memcpy(copy, key, length);
+    return copy;
+}
+
+static MapEntry* map_find(ScopeMap* map, const char* key) {
+    size_t mask = map->capacity - 1;
+    size_t slot = hash_string(key) & mask;
+    while (map->entries[slot].key && strcmp(map->entries[slot].key, key) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return &map->entries[slot];
+}
+
+static void map_insert(ScopeMap* map, const char* key, AstNode* decl) {
+    if ((map->count + 1) * 2 > map->capacity) {
+        ScopeMap grown = { (MapEntry*)calloc(map->capacity * 2, sizeof(MapEntry)), map->capacity * 2, 0 };
+        for (size_t i = 0; i < map->capacity; i++) {
+            if (map->entries[i].key) *map_find(&grown, map->entries[i].key) = map->entries[i];
+        }
+        grown.count = map->count;
+        free(map->entries);
+        *map = grown;
+    }
+    MapEntry* entry = map_find(map, key);
+    if (!entry->key) {
+        entry->key = copy_key(key);
+        map->count++;
+    }
+    entry->decl = decl;
+}
+
+static void stack_push(ScopeStack* stack) {
+    if (stack->depth == stack->capacity) {
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 16;
+        stack->scopes = (ScopeMap*)realloc(stack->scopes, stack->capacity * sizeof(ScopeMap));
+    }
+    ScopeMap map = { (MapEntry*)calloc(8, sizeof(MapEntry)), 8, 0 };
+    stack->scopes[stack->depth++] = map;
+}
+
+static void stack_pop(ScopeStack* stack) {
+    ScopeMap* map = &stack->scopes[--stack->depth];
+    for (size_t i = 0; i < map->capacity; i++) free(map->entries[i].key);
+    free(map->entries);
+}
+
+static MapEntry* stack_lookup(ScopeStack* stack, const char* key) {
+    for (size_t depth = stack->depth; depth > 0; depth--) {
+        MapEntry* entry = map_find(&stack->scopes[depth - 1], key);
+        if (entry->key) return entry;
+    }
+    return NULL;
+}
+
+static uint64_t replay_maps(const Step* steps, size_t count, size_t* resolved) {
+    ScopeStack stack = { NULL, 0, 0 };
+    uint64_t checksum = 0;
+    *resolved = 0;
+    stack_push(&stack);
+    for (size_t i = 0; i < count; i++) {
+        const Step* step = &steps[i];
+        switch (step->kind) {
+            case STEP_PUSH:
+                stack_push(&stack);
+                break;
+            case STEP_POP:
+                stack_pop(&stack);
+                break;
+            case STEP_DECLARE:
+                map_insert(&stack.scopes[stack.depth - 1], step->spelling, step->decl);
+                break;
+            case STEP_BIND:
+                if (!stack_lookup(&stack, step->spelling)) {
+                    map_insert(&stack.scopes[stack.depth - 1], step->spelling, step->decl);
+                }
+                break;
+            case STEP_LOOKUP: {
+                MapEntry* entry = stack_lookup(&stack, step->spelling);
+                if (entry) {
+                    (*resolved)++;
+                    checksum = checksum * 31 + (uintptr_t)entry->decl;
+                }
+                break;
+            }
+        }
+    }
+    while (stack.depth > 0) stack_pop(&stack);
+    free(stack.scopes);
+    return checksum;
+}
+
+/* ===== Driver ===== */
+
+typedef uint64_t (*Replay)(const Step* steps, size_t count, size_t* resolved);
+
+static double best_of(Replay replay, const Recording* rec, uint64_t* checksum, size_t* resolved) {
+    double best = 0;
+    for (int rep = 0; rep < REPS; rep++) {
+        double start = progen_now_ns();
+        *checksum = replay(rec->steps, rec->count, resolved);
+        double ns = progen_now_ns() - start;
+        if (rep == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t target = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 100000;
+    size_t lines = 0;
+    char* source = progen_generate(target, 44, &lines);
+
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, source);
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+    if (!program) {
+        fprintf(stderr, "error: generated program failed to parse\n");
+        return 1;
+    }
+
+    /* Interning happens once per spelling occurrence, while recording */
+    Recording rec = { NULL, 0, 0, string_interner_create() };
+    double start = progen_now_ns();
+    walk(&rec, program);
+    double record_ns = progen_now_ns() - start;
+
+    size_t lookups = 0;
+    size_t scopes = 0;
+    for (size_t i = 0; i < rec.count; i++) {
+        if (rec.steps[i].kind == STEP_LOOKUP) lookups++;
+        if (rec.steps[i].kind == STEP_PUSH) scopes++;
+    }
+
+    uint64_t flat_sum, map_sum;
+    size_t flat_resolved, map_resolved;
+    double flat_ns = best_of(replay_flat, &rec, &flat_sum, &flat_resolved);
+    double map_ns = best_of(replay_maps, &rec, &map_sum, &map_resolved);
+
+    printf("LAMC symbol table benchmark: %zu lines, best of %d\n", lines, REPS);
+    printf("%zu table operations: %zu scopes, %zu lookups, %zu distinct names\n\n",
+           rec.count, scopes, lookups, string_interner_count(rec.interner));
+    printf("%-22s %10.3f ms\n", "walk and intern", record_ns / 1e6);
+    printf("%-22s %10.3f ms %8.1f ns/op  %zu resolved\n", "flat table",
+           flat_ns / 1e6, flat_ns / rec.count, flat_resolved);
+    printf("%-22s %10.3f ms %8.1f ns/op  %zu resolved\n", "map per scope",
+           map_ns / 1e6, map_ns / rec.count, map_resolved);
+
+    /* The real pass: index, intern, resolve, slots and flags */
+    double resolve_ns = 0;
+    size_t unresolved = 0;
+    for (int rep = 0; rep < REPS; rep++) {
+        DiagBuffer diags;
+        Resolution res;
+        diag_buffer_init(&diags);
+        start = progen_now_ns();
+        if (!resolve_program(&res, program, &diags)) {
+            fprintf(stderr, "error: resolution ran out of memory\n");
+            return 1;
+        }
+        double ns = progen_now_ns() - start;
+        if (rep == 0 || ns < resolve_ns) resolve_ns = ns;
+        unresolved = res.unresolved;
+        resolution_free(&res);
+        diag_buffer_free(&diags);
+    }
+    printf("%-22s %10.3f ms                  %zu undefined uses\n", "resolve_program",
+           resolve_ns / 1e6, unresolved);
+    printf("\nspeedup %.2fx, resolutions %s\n", map_ns / flat_ns,
+           flat_sum == map_sum && flat_resolved == map_resolved ? "identical" : "DIFFER");
+
+    free(rec.steps);
+    string_interner_free(rec.interner);
+    ast_free_node(program);
+    free(source);
+    return flat_sum == map_sum && flat_resolved == map_resolved ? 0 : 1;
+}
@@ -0,0 +1,262 @@
+/* LAMC Compiler - Synthetic Program Generator
+ * Generates large, realistic LAMC programs for benchmarks
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "progen.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ===== Output Buffer ===== */
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    size_t lines;
+} Builder;
+
+static void builder_reserve(Builder* b, size_t extra) {
+    if (b->length + extra + 1 <= b->capacity) return;
+
+    size_t new_capacity = b->capacity == 0 ? 4096 : b->capacity;
+    while (b->length + extra + 1 > new_capacity) new_capacity *= 2;
+
+    char* new_data = (char*)realloc(b->data, new_capacity);
+    if (!new_data) {
+        fprintf(stderr, "progen: out of memory\n");
+        exit(1);
+    }
+    b->data = new_data;
+    b->capacity = new_capacity;
+}
+
+static void emit_line(Builder* b, int indent, const char* fmt, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n < 0) return;
+    if ((size_t)n >= sizeof(line)) n = (int)sizeof(line) - 1;
+
+    builder_reserve(b, (size_t)indent * 4 + (size_t)n + 1);
+    memset(b->data + b->length, ' ', (size_t)indent * 4);
+    b->length += (size_t)indent * 4;
+    memcpy(b->data + b->length, line, (size_t)n);
+    b->length += (size_t)n;
+    b->data[b->length++] = '\n';
+    b->data[b->length] = '\0';
+    b->lines++;
+}
+
+/* ===== Deterministic Random Numbers ===== */
+
+static unsigned next_random(unsigned* state) {
+    /* xorshift32 */
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static unsigned pick(unsigned* state, unsigned n) {
+    return next_random(state) % n;
+}
+
+/* ===== Expressions ===== */
+
+static const char* const LOCALS[] = { "a", "b", "total", "count", "value", "idx" };
+#define LOCAL_COUNT (sizeof(LOCALS) / sizeof(LOCALS[0]))
+
+static const char* const SHARED_EXPRS[] = {
+    "data[idx]",
+    "data[idx + 1]",
+    "cfg.size.width",
+    "cfg.size.height",
+    "grid[row][col]",
+    "a * 2 + b",
+    "count + 1",
+    "(a + b) * (a - b)",
+};
+#define SHARED_COUNT (sizeof(SHARED_EXPRS) / sizeof(SHARED_EXPRS[0]))
+
+static void gen_expression(unsigned* rng, char* out, size_t size, int func_count) {
+    const char* x = LOCALS[pick(rng, LOCAL_COUNT)];
+    const char* y = LOCALS[pick(rng, LOCAL_COUNT)];
+
+    switch (pick(rng, 9)) {
+        case 0: snprintf(out, size, "%s + %u", x, pick(rng, 100)); break;
+        case 1: snprintf(out, size, "%s * %s - %u", x, y, pick(rng, 10)); break;
+        case 2: snprintf(out, size, "(%s + %s) / 2", x, y); break;
+        case 3: snprintf(out, size, "%s", SHARED_EXPRS[pick(rng, SHARED_COUNT)]); break;
+        case 4: snprintf(out, size, "%s + %s", SHARED_EXPRS[pick(rng, SHARED_COUNT)], x); break;
+        case 5: snprintf(out, size, "f%u(%s, %u)", pick(rng, (unsigned)func_count), x, pick(rng, 50)); break;
+        case 6: snprintf(out, size, "%s %% %u + %s", x, pick(rng, 9) + 1, y); break;
+        case 7: snprintf(out, size, "[%s, %s, %u]", x, y, pick(rng, 1000)); break;
+        default: snprintf(out, size, "%u.%u * %s", pick(rng, 10), pick(rng, 100), x); break;
+    }
+}
+
+static void gen_condition(unsigned* rng, char* out, size_t size) {
+    static const char* const OPS[] = { "<", ">", "<=", ">=", "==", "!=" };
+    const char* x = LOCALS[pick(rng, LOCAL_COUNT)];
+
+    if (pick(rng, 4) == 0) {
+        snprintf(out, size, "%s > 0 && %s < %u", x, LOCALS[pick(rng, LOCAL_COUNT)], pick(rng, 500));
+    } else {
+        snprintf(out, size, "%s %s %u", x, OPS[pick(rng, 6)], pick(rng, 100));
+    }
+}
+
+/* ===== Statements ===== */
+
+static void gen_block(Builder* b, unsigned* rng, int indent, int depth, int statements, int func_count);
+
+static void gen_statement(Builder* b, unsigned* rng, int indent, int depth, int func_count) {
+    char expr[256];
+    char cond[128];
+    unsigned kind = pick(rng, depth >= 2 ? 4 : 9);
+
+    switch (kind) {
+        case 0:
+        case 1:
+            gen_expression(rng, expr, sizeof(expr), func_count);
+            emit_line(b, indent, "%s = %s", LOCALS[pick(rng, LOCAL_COUNT)], expr);
+            break;
+        case 2:
+            gen_expression(rng, expr, sizeof(expr), func_count);
+            emit_line(b, indent, "print(%s)", expr);
+            break;
+        case 3:
+            emit_line(b, indent, "total = total + data[idx] * %u", pick(rng, 16));
+            break;
+        case 4:
+            gen_condition(rng, cond, sizeof(cond));
+            emit_line(b, indent, "if %s {", cond);
+            gen_block(b, rng, indent + 1, depth + 1, 2, func_count);
+            gen_condition(rng, cond, sizeof(cond));
+            emit_line(b, indent, "} else if %s {", cond);
+            gen_block(b, rng, indent + 1, depth + 1, 1, func_count);
+            emit_line(b, indent, "} else {");
+            gen_block(b, rng, indent + 1, depth + 1, 2, func_count);
+            emit_line(b, indent, "}");
+            break;
+        case 5:
+            gen_condition(rng, cond, sizeof(cond));
+            emit_line(b, indent, "while %s {", cond);
+            gen_block(b, rng, indent + 1, depth + 1, 2, func_count);
+            emit_line(b, indent, "count = count - 1");
+            emit_line(b, indent, "}");
+            break;
+        case 6:
+            emit_line(b, indent, "for i in range(0, %u) {", pick(rng, 64) + 1);
+            gen_block(b, rng, indent + 1, depth + 1, 2, func_count);
+            emit_line(b, indent, "}");
+            break;
+        case 7:
+            emit_line(b, indent, "for i, item in data {");
+            emit_line(b, indent + 1, "value = value + item * i");
+            gen_block(b, rng, indent + 1, depth + 1, 1, func_count);
+            emit_line(b, indent, "}");
+            break;
+        default:
+            emit_line(b, indent, "loop {");
+            gen_block(b, rng, indent + 1, depth + 1, 1, func_count);
+            emit_line(b, indent + 1, "if count > %u {", pick(rng, 100));
+            emit_line(b, indent + 2, "break");
+            emit_line(b, indent + 1, "}");
+            emit_line(b, indent, "}");
+            break;
+    }
+}
+
+static void gen_block(Builder* b, unsigned* rng, int indent, int depth, int statements, int func_count) {
+    for (int i = 0; i < statements; i++) {
+        gen_statement(b, rng, indent, depth, func_count);
+    }
+}
+
+/* Functions in a program of this many lines, assuming ~30 lines each */
+static int estimate_function_count(size_t target_lines) {
+    size_t count = target_lines / 30;
+    if (count < 1) count = 1;
+    if (count > 1000000) count = 1000000;
+    return (int)count;
+}
+
+char* progen_generate(size_t target_lines, unsigned seed, size_t* out_lines) {
+    Builder b = { NULL, 0, 0, 0 };
+    unsigned rng = seed ? seed : 0x2545f491u;
+    int func_count = estimate_function_count(target_lines);
+
+    builder_reserve(&b, target_lines * 32);
+    emit_line(&b, 0, "// Generated LAMC program (%zu lines requested, seed %u)", target_lines, seed);
+
+    for (int f = 0; b.lines < target_lines; f++) {
+        /* Every eighth function reuses one of four shared bodies, the way
+         * generated code repeats itself */
+        unsigned body_seed = (f % 8 == 7) ? (seed + (unsigned)(f / 8) % 4) : next_random(&rng);
+        unsigned body_rng = body_seed ? body_seed : 1;
+
+        emit_line(&b, 0, "");
+        emit_line(&b, 0, "func f%d(a, b, data) {", f);
+        emit_line(&b, 1, "total = 0");
+        emit_line(&b, 1, "count = a + b");
+        emit_line(&b, 1, "idx = 0");
+        emit_line(&b, 1, "value = data[0]");
+        gen_block(&b, &body_rng, 1, 0, 6, func_count);
+        emit_line(&b, 1, "return total + count");
+        emit_line(&b, 0, "}");
+    }
+
+    emit_line(&b, 0, "");
+    emit_line(&b, 0, "func main() {");
+    emit_line(&b, 1, "result = f0(1, 2, [1, 2, 3])");
+    emit_line(&b, 1, "print(result)");
+    emit_line(&b, 0, "}");
+
+    if (out_lines) *out_lines = b.lines;
+    return b.data;
+}
+
+/* ===== Utilities ===== */
+
+char* progen_read_file(const char* path, size_t* out_size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    if (size < 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    char* data = (char*)malloc((size_t)size + 1);
+    if (!data) {
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read = fread(data, 1, (size_t)size, file);
+    data[read] = '\0';
+    fclose(file);
+
+    if (out_size) *out_size = read;
+    return data;
+}
+
+double progen_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
@@ -0,0 +1,23 @@
+/* LAMC Compiler - Synthetic Program Generator
+ * Generates large, realistic LAMC programs for benchmarks
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef PROGEN_H
+#define PROGEN_H
+
+#include <stddef.h>
+
+/* Generate a brace-delimited LAMC program of roughly target_lines lines.
+ * The output is deterministic for a given seed. Returns a malloc'd,
+ * NUL-terminated buffer; the exact line count is stored in *out_lines
+ * when out_lines is not NULL. */
+char* progen_generate(size_t target_lines, unsigned seed, size_t* out_lines);
+
+/* Read a whole file into a malloc'd, NUL-terminated buffer (NULL on error) */
+char* progen_read_file(const char* path, size_t* out_size);
+
+/* Monotonic wall clock in nanoseconds */
+double progen_now_ns(void);
+
+#endif /* PROGEN_H */
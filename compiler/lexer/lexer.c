@@ -5,6 +5,7 @@
 #include <ctype.h>
 
 void lexer_init(Lexer* lexer, const char* source) {
+    lexer->source = source;
     lexer->start = source;
     lexer->current = source;
     lexer->line = 1;
@@ -10,6 +10,7 @@
 
 // Lexer state
 typedef struct {
+    const char* source;     // Beginning of the source text
     const char* start;      // Start of current token
     const char* current;    // Current character
     int line;               // Current line number
@@ -0,0 +1,60 @@
+/* LAMC Compiler - Line Table Implementation */
+
+#include "line_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool line_table_build(LineTable* table, const char* source) {
+    memset(table, 0, sizeof(*table));
+    table->length = strlen(source);
+    
+    size_t capacity = 64;
+    table->starts = (size_t*)malloc(capacity * sizeof(size_t));
+    if (!table->starts) return false;
+    table->starts[table->count++] = 0;
+    
+    const char* end = source + table->length;
+    for (const char* p = source; (p = memchr(p, '\n', (size_t)(end - p))) != NULL; p++) {
+        if (table->count == capacity) {
+            capacity *= 2;
+            size_t* grown = (size_t*)realloc(table->starts, capacity * sizeof(size_t));
+            if (!grown) {
+                line_table_free(table);
+                return false;
+            }
+            table->starts = grown;
+        }
+        table->starts[table->count++] = (size_t)(p - source) + 1;
+    }
+    return true;
+}
+
+void line_table_free(LineTable* table) {
+    free(table->starts);
+    table->starts = NULL;
+    table->count = 0;
+}
+
+void line_table_locate(const LineTable* table, size_t offset, int* line, int* column) {
+    if (offset > table->length) offset = table->length;
+    
+    // Last line starting at or before offset
+    size_t lo = 0, hi = table->count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (table->starts[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    *line = (int)lo + 1;
+    *column = (int)(offset - table->starts[lo]) + 1;
+}
+
+size_t line_table_line_start(const LineTable* table, int line) {
+    if (line < 1) return 0;
+    if ((size_t)line > table->count) line = (int)table->count;
+    return table->starts[line - 1];
+}
@@ -0,0 +1,33 @@
+/* LAMC Compiler - Line Table
+ * Byte offset to line and column conversion for one source text
+ */
+
+#ifndef LINE_TABLE_H
+#define LINE_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Start offsets of every line, built once so that byte spans (such as AST
+// node offsets) can be turned into line and column in any order. The
+// diagnostic renderer does not use it: it walks its sorted spans forward
+// with a cursor of its own (parser/diagnostics.c).
+typedef struct {
+    size_t* starts;         // starts[i] is the offset of line i + 1
+    size_t count;           // Number of lines, at least 1
+    size_t length;          // Source length in bytes
+} LineTable;
+
+// Scan the source for line breaks (returns false when out of memory)
+bool line_table_build(LineTable* table, const char* source);
+
+void line_table_free(LineTable* table);
+
+// 1-based line and byte column of an offset; offsets past the end
+// resolve to the end of the last line. O(log lines).
+void line_table_locate(const LineTable* table, size_t offset, int* line, int* column);
+
+// Offset where a 1-based line begins (clamped to the last line)
+size_t line_table_line_start(const LineTable* table, int line);
+
+#endif // LINE_TABLE_H
@@ -0,0 +1,47 @@
+/* LAMC Compiler - Token Buffer Implementation */
+
+#include "token_buffer.h"
+#include "lexer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool buffer_push(TokenBuffer* buffer, Token token) {
+    if (buffer->count >= buffer->capacity) {
+        size_t new_capacity = buffer->capacity == 0 ? 1024 : buffer->capacity * 2;
+        Token* new_tokens = (Token*)realloc(buffer->tokens, new_capacity * sizeof(Token));
+        if (!new_tokens) return false;
+        
+        buffer->tokens = new_tokens;
+        buffer->capacity = new_capacity;
+    }
+    
+    buffer->tokens[buffer->count++] = token;
+    return true;
+}
+
+bool token_buffer_lex(TokenBuffer* buffer, const char* source) {
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->source = source;
+    
+    // Roughly one token per four bytes of source
+    size_t estimate = strlen(source) / 4 + 16;
+    buffer->tokens = (Token*)malloc(estimate * sizeof(Token));
+    if (!buffer->tokens) return false;
+    buffer->capacity = estimate;
+    
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    
+    for (;;) {
+        Token token = lexer_next_token(&lexer);
+        if (!buffer_push(buffer, token)) return false;
+        if (token.type == TOKEN_EOF) return true;
+    }
+}
+
+void token_buffer_free(TokenBuffer* buffer) {
+    free(buffer->tokens);
+    buffer->tokens = NULL;
+    buffer->count = 0;
+    buffer->capacity = 0;
+}
@@ -0,0 +1,25 @@
+/* LAMC Compiler - Token Buffer
+ * Pre-lexed token stream for random access by the parser
+ */
+
+#ifndef TOKEN_BUFFER_H
+#define TOKEN_BUFFER_H
+
+#include "token.h"
+#include <stdbool.h>
+
+// All tokens of one source text; the last token is always TOKEN_EOF
+typedef struct {
+    Token* tokens;
+    size_t count;
+    size_t capacity;
+    const char* source;     // Source the tokens point into
+} TokenBuffer;
+
+// Lex the whole source into the buffer (returns false when out of memory)
+bool token_buffer_lex(TokenBuffer* buffer, const char* source);
+
+// Release the token array (the source is not owned by the buffer)
+void token_buffer_free(TokenBuffer* buffer);
+
+#endif // TOKEN_BUFFER_H
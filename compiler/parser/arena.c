@@ -0,0 +1,95 @@
+/* LAMC Compiler - AST Arena Allocator Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_ALIGN sizeof(void*)
+
+struct AstArenaChunk {
+    AstArenaChunk* prev;
+    size_t used;
+    size_t capacity;
+    unsigned char data[];
+};
+
+static AstArenaChunk* chunk_create(size_t min_capacity, AstArenaChunk* prev) {
+    size_t capacity = min_capacity > ARENA_CHUNK_SIZE ? min_capacity : ARENA_CHUNK_SIZE;
+    AstArenaChunk* chunk = (AstArenaChunk*)malloc(sizeof(AstArenaChunk) + capacity);
+    if (!chunk) return NULL;
+    
+    chunk->prev = prev;
+    chunk->used = 0;
+    chunk->capacity = capacity;
+    return chunk;
+}
+
+AstArena* ast_arena_create(void) {
+    AstArena* arena = (AstArena*)calloc(1, sizeof(AstArena));
+    if (!arena) return NULL;
+    
+    arena->chunk = chunk_create(ARENA_CHUNK_SIZE, NULL);
+    if (!arena->chunk) {
+        free(arena);
+        return NULL;
+    }
+    return arena;
+}
+
+void* ast_arena_alloc(AstArena* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    
+    AstArenaChunk* chunk = arena->chunk;
+    if (chunk->used + size > chunk->capacity) {
+        chunk = chunk_create(size, chunk);
+        if (!chunk) return NULL;
+        arena->chunk = chunk;
+    }
+    
+    void* result = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->total_bytes += size;
+    memset(result, 0, size);
+    return result;
+}
+
+void ast_arena_free(AstArena* arena) {
+    while (arena) {
+        AstArena* next = arena->next;
+        
+        AstArenaChunk* chunk = arena->chunk;
+        while (chunk) {
+            AstArenaChunk* prev = chunk->prev;
+            free(chunk);
+            chunk = prev;
+        }
+        free(arena);
+        
+        arena = next;
+    }
+}
+
+AstArenaMark ast_arena_mark(const AstArena* arena) {
+    AstArenaMark mark = { arena->chunk, arena->chunk->used, arena->total_bytes };
+    return mark;
+}
+
+void ast_arena_rewind(AstArena* arena, AstArenaMark mark) {
+    while (arena->chunk != mark.chunk) {
+        AstArenaChunk* prev = arena->chunk->prev;
+        free(arena->chunk);
+        arena->chunk = prev;
+    }
+    arena->chunk->used = mark.used;
+    arena->total_bytes = mark.total_bytes;
+}
+
+void ast_arena_chain(AstArena* arena, AstArena* other) {
+    if (!arena || arena == other) return;
+    
+    while (arena->next) arena = arena->next;
+    arena->next = other;
+}
@@ -0,0 +1,45 @@
+/* LAMC Compiler - AST Arena Allocator
+ * Chunked bump allocation for AST nodes, released all at once
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+typedef struct AstArenaChunk AstArenaChunk;
+
+/* Bump allocator. Arenas can be chained through next so that one
+ * owner (e.g. a Program node) releases several of them together. */
+typedef struct AstArena {
+    AstArenaChunk* chunk;    /* Chunk currently being filled */
+    size_t total_bytes;      /* Bytes handed out so far */
+    struct AstArena* next;   /* Next arena in an ownership chain */
+} AstArena;
+
+AstArena* ast_arena_create(void);
+
+/* Zero-filled, pointer-aligned allocation (NULL when out of memory) */
+void* ast_arena_alloc(AstArena* arena, size_t size);
+
+/* Free an arena and every arena chained after it */
+void ast_arena_free(AstArena* arena);
+
+/* Append the chain starting at other to the chain starting at arena */
+void ast_arena_chain(AstArena* arena, AstArena* other);
+
+/* High-water mark of an arena, for undoing speculative allocations */
+typedef struct {
+    AstArenaChunk* chunk;
+    size_t used;
+    size_t total_bytes;
+} AstArenaMark;
+
+AstArenaMark ast_arena_mark(const AstArena* arena);
+
+/* Release everything allocated since mark was taken: chunks added since
+ * are freed and the marked chunk is cut back to its old fill */
+void ast_arena_rewind(AstArena* arena, AstArenaMark mark);
+
+#endif /* ARENA_H */
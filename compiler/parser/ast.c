@@ -4,19 +4,43 @@
  */
 
 #include "ast.h"
+#include "stats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+/* ===== Arena Selection ===== */
+
+/* Arena used by constructors on this thread, NULL for the heap */
+static _Thread_local AstArena* current_arena = NULL;
+
+AstArena* ast_use_arena(AstArena* arena) {
+    AstArena* previous = current_arena;
+    current_arena = arena;
+    return previous;
+}
+
+AstArena* ast_current_arena(void) {
+    return current_arena;
+}
+
+/* Zero-filled allocation from the current arena or the heap */
+static void* ast_alloc(size_t size) {
+    if (current_arena) return ast_arena_alloc(current_arena, size);
+    return calloc(1, size);
+}
+
 /* ===== AST List Implementation ===== */
 
 AstList* ast_list_create(void) {
-    AstList* list = (AstList*)malloc(sizeof(AstList));
+    AstList* list = (AstList*)ast_alloc(sizeof(AstList));
     if (!list) return NULL;
+    STATS_BYTES(STATS_BYTES_LISTS, sizeof(AstList));
     
     list->items = NULL;
     list->count = 0;
     list->capacity = 0;
+    list->arena = current_arena;
     return list;
 }
 
@@ -25,8 +49,19 @@ void ast_list_append(AstList* list, void* item) {
     
     if (list->count >= list->capacity) {
         size_t new_capacity = list->capacity == 0 ? 8 : list->capacity * 2;
-        void** new_items = (void**)realloc(list->items, new_capacity * sizeof(void*));
+        void** new_items;
+        
+        if (list->arena) {
+            /* Arena memory cannot grow in place; the old array is abandoned */
+            new_items = (void**)ast_arena_alloc(list->arena, new_capacity * sizeof(void*));
+            if (new_items && list->count > 0) {
+                memcpy(new_items, list->items, list->count * sizeof(void*));
+            }
+        } else {
+            new_items = (void**)realloc(list->items, new_capacity * sizeof(void*));
+        }
         if (!new_items) return;
+        STATS_BYTES(STATS_BYTES_LIST_GROWTH, new_capacity * sizeof(void*));
         
         list->items = new_items;
         list->capacity = new_capacity;
@@ -36,7 +71,7 @@ void ast_list_append(AstList* list, void* item) {
 }
 
 void ast_list_free(AstList* list) {
-    if (!list) return;
+    if (!list || list->arena) return;
     free(list->items);
     free(list);
 }
@@ -46,19 +81,25 @@ void ast_list_free(AstList* list) {
 static char* string_duplicate(const char* str) {
     if (!str) return NULL;
     size_t len = strlen(str);
-    char* dup = (char*)malloc(len + 1);
+    char* dup = current_arena ? (char*)ast_arena_alloc(current_arena, len + 1)
+                              : (char*)malloc(len + 1);
     if (!dup) return NULL;
+    STATS_BYTES(STATS_BYTES_STRINGS, len + 1);
     memcpy(dup, str, len + 1);
     return dup;
 }
 
 static AstNode* ast_node_alloc(AstNodeType type, int line, int col) {
-    AstNode* node = (AstNode*)calloc(1, sizeof(AstNode));
+    AstNode* node = (AstNode*)ast_alloc(sizeof(AstNode));
     if (!node) return NULL;
+    STATS_NODE(type);
+    STATS_BYTES(STATS_BYTES_NODES, sizeof(AstNode));
     
     node->type = type;
     node->line = line;
     node->column = col;
+    node->refcount = 1;
+    if (current_arena) node->flags |= AST_FLAG_ARENA;
     return node;
 }
 
@@ -175,6 +216,17 @@ AstNode* ast_create_dict(AstList* entries, int line, int col) {
     if (!node) return NULL;
     
     node->as.dict.entries = entries;
+    
+    /* Constant keys get their slots assigned now, not at run time */
+    bool constant_keys = entries != NULL;
+    for (size_t i = 0; constant_keys && i < entries->count; i++) {
+        uint64_t hash;
+        constant_keys = ast_dict_key_hash(((DictEntry*)entries->items[i])->key, &hash);
+    }
+    node->as.dict.constant_keys = constant_keys;
+    if (constant_keys) {
+        node->as.dict.layout = ast_dict_layout_build(entries, ast_alloc);
+    }
     return node;
 }
 
@@ -289,6 +341,7 @@ AstNode* ast_create_class(const char* name, AstList* methods, AstList* fields, i
     node->as.class_decl.name = string_duplicate(name);
     node->as.class_decl.methods = methods;
     node->as.class_decl.fields = fields;
+    node->as.class_decl.layout = fields ? ast_class_layout_build(fields, ast_alloc) : NULL;
     return node;
 }
 
@@ -311,8 +364,9 @@ AstNode* ast_create_program(AstList* decls) {
 /* ===== Helper Structure Constructors ===== */
 
 Parameter* ast_create_parameter(const char* name, const char* type, AstNode* default_val) {
-    Parameter* param = (Parameter*)malloc(sizeof(Parameter));
+    Parameter* param = (Parameter*)ast_alloc(sizeof(Parameter));
     if (!param) return NULL;
+    STATS_BYTES(STATS_BYTES_AUX, sizeof(Parameter));
     
     param->name = string_duplicate(name);
     param->type_name = type ? string_duplicate(type) : NULL;
@@ -321,14 +375,22 @@ Parameter* ast_create_parameter(const char* name, const char* type, AstNode* def
 }
 
 DictEntry* ast_create_dict_entry(AstNode* key, AstNode* value) {
-    DictEntry* entry = (DictEntry*)malloc(sizeof(DictEntry));
+    DictEntry* entry = (DictEntry*)ast_alloc(sizeof(DictEntry));
     if (!entry) return NULL;
+    STATS_BYTES(STATS_BYTES_AUX, sizeof(DictEntry));
     
     entry->key = key;
     entry->value = value;
     return entry;
 }
 
+/* ===== Reference Counting ===== */
+
+AstNode* ast_retain(AstNode* node) {
+    if (node) node->refcount++;
+    return node;
+}
+
 /* ===== Destructors ===== */
 
 void ast_free_parameter(Parameter* param) {
@@ -346,165 +408,282 @@ void ast_free_dict_entry(DictEntry* entry) {
     free(entry);
 }
 
+/* The left operand of a binary expression, the operand of a unary one,
+ * the object or callee of a postfix expression and the else branch of an
+ * if are freed by the loop rather than a recursive call: those are the
+ * spines that long operator, postfix and else-if chains grow along. */
 void ast_free_node(AstNode* node) {
-    if (!node) return;
-    
+    while (node) {
+        /* Arena nodes are released together with their arena */
+        if (node->flags & AST_FLAG_ARENA) return;
+        
+        /* Shared node: only drop this owner's reference */
+        if (node->refcount > 1) {
+            node->refcount--;
+            return;
+        }
+        
+        AstNode* next = NULL;
+        switch (node->type) {
+            case AST_BINARY_EXPR:
+                next = node->as.binary.left;
+                ast_free_node(node->as.binary.right);
+                break;
+                
+            case AST_UNARY_EXPR:
+                next = node->as.unary.operand;
+                break;
+                
+            case AST_LITERAL_EXPR:
+                if (node->as.literal.type == LIT_STRING) {
+                    free(node->as.literal.as.string_value);
+                }
+                break;
+                
+            case AST_IDENTIFIER_EXPR:
+                free(node->as.identifier);
+                break;
+                
+            case AST_CALL_EXPR:
+                next = node->as.call.callee;
+                if (node->as.call.arguments) {
+                    for (size_t i = 0; i < node->as.call.arguments->count; i++) {
+                        ast_free_node((AstNode*)node->as.call.arguments->items[i]);
+                    }
+                    ast_list_free(node->as.call.arguments);
+                }
+                break;
+                
+            case AST_INDEX_EXPR:
+                next = node->as.index.object;
+                ast_free_node(node->as.index.index);
+                break;
+                
+            case AST_MEMBER_EXPR:
+                next = node->as.member.object;
+                free(node->as.member.member);
+                break;
+                
+            case AST_ARRAY_EXPR:
+                if (node->as.array.elements) {
+                    for (size_t i = 0; i < node->as.array.elements->count; i++) {
+                        ast_free_node((AstNode*)node->as.array.elements->items[i]);
+                    }
+                    ast_list_free(node->as.array.elements);
+                }
+                break;
+                
+            case AST_DICT_EXPR:
+                if (node->as.dict.entries) {
+                    for (size_t i = 0; i < node->as.dict.entries->count; i++) {
+                        ast_free_dict_entry((DictEntry*)node->as.dict.entries->items[i]);
+                    }
+                    ast_list_free(node->as.dict.entries);
+                }
+                free(node->as.dict.layout);
+                break;
+                
+            case AST_VAR_DECL:
+                free(node->as.var_decl.name);
+                free(node->as.var_decl.type_name);
+                ast_free_node(node->as.var_decl.initializer);
+                break;
+                
+            case AST_ASSIGN_STMT:
+                ast_free_node(node->as.assign.target);
+                ast_free_node(node->as.assign.value);
+                break;
+                
+            case AST_EXPR_STMT:
+                ast_free_node(node->as.expr_stmt);
+                break;
+                
+            case AST_IF_STMT:
+                ast_free_node(node->as.if_stmt.condition);
+                ast_free_node(node->as.if_stmt.then_branch);
+                next = node->as.if_stmt.else_branch;
+                break;
+                
+            case AST_WHILE_STMT:
+                ast_free_node(node->as.while_stmt.condition);
+                ast_free_node(node->as.while_stmt.body);
+                break;
+                
+            case AST_FOR_STMT:
+                free(node->as.for_stmt.variable);
+                free(node->as.for_stmt.index_var);
+                ast_free_node(node->as.for_stmt.iterable);
+                ast_free_node(node->as.for_stmt.body);
+                break;
+                
+            case AST_LOOP_STMT:
+                ast_free_node(node->as.loop_stmt.body);
+                break;
+                
+            case AST_RETURN_STMT:
+                ast_free_node(node->as.return_stmt.value);
+                break;
+                
+            case AST_BLOCK_STMT:
+                if (node->as.block.statements) {
+                    for (size_t i = 0; i < node->as.block.statements->count; i++) {
+                        ast_free_node((AstNode*)node->as.block.statements->items[i]);
+                    }
+                    ast_list_free(node->as.block.statements);
+                }
+                break;
+                
+            case AST_FUNCTION_DECL:
+                free(node->as.function.name);
+                free(node->as.function.return_type);
+                if (node->as.function.parameters) {
+                    for (size_t i = 0; i < node->as.function.parameters->count; i++) {
+                        ast_free_parameter((Parameter*)node->as.function.parameters->items[i]);
+                    }
+                    ast_list_free(node->as.function.parameters);
+                }
+                ast_free_node(node->as.function.body);
+                break;
+                
+            case AST_CLASS_DECL:
+                free(node->as.class_decl.name);
+                if (node->as.class_decl.methods) {
+                    for (size_t i = 0; i < node->as.class_decl.methods->count; i++) {
+                        ast_free_node((AstNode*)node->as.class_decl.methods->items[i]);
+                    }
+                    ast_list_free(node->as.class_decl.methods);
+                }
+                if (node->as.class_decl.fields) {
+                    for (size_t i = 0; i < node->as.class_decl.fields->count; i++) {
+                        ast_free_node((AstNode*)node->as.class_decl.fields->items[i]);
+                    }
+                    ast_list_free(node->as.class_decl.fields);
+                }
+                free(node->as.class_decl.layout);
+                break;
+                
+            case AST_IMPORT_STMT:
+                free(node->as.import.module_name);
+                break;
+                
+            case AST_PROGRAM:
+                if (node->as.program.declarations) {
+                    for (size_t i = 0; i < node->as.program.declarations->count; i++) {
+                        ast_free_node((AstNode*)node->as.program.declarations->items[i]);
+                    }
+                    ast_list_free(node->as.program.declarations);
+                }
+                ast_arena_free(node->as.program.arenas);
+                free(node->as.program.decl_tokens);
+                break;
+                
+            case AST_BREAK_STMT:
+            case AST_CONTINUE_STMT:
+                /* No additional cleanup needed */
+                break;
+        }
+        
+        free(node);
+        node = next;
+    }
+}
+
+/* ===== Tree Walking ===== */
+
+static void visit_list(AstList* list, AstChildVisitor visit, void* context) {
+    if (!list) return;
+    for (size_t i = 0; i < list->count; i++) {
+        visit((AstNode*)list->items[i], context);
+    }
+}
+
+void ast_visit_children(AstNode* node, AstChildVisitor visit, void* context) {
     switch (node->type) {
         case AST_BINARY_EXPR:
-            ast_free_node(node->as.binary.left);
-            ast_free_node(node->as.binary.right);
+            visit(node->as.binary.left, context);
+            visit(node->as.binary.right, context);
             break;
-            
         case AST_UNARY_EXPR:
-            ast_free_node(node->as.unary.operand);
+            visit(node->as.unary.operand, context);
             break;
-            
-        case AST_LITERAL_EXPR:
-            if (node->as.literal.type == LIT_STRING) {
-                free(node->as.literal.as.string_value);
-            }
-            break;
-            
-        case AST_IDENTIFIER_EXPR:
-            free(node->as.identifier);
-            break;
-            
         case AST_CALL_EXPR:
-            ast_free_node(node->as.call.callee);
-            if (node->as.call.arguments) {
-                for (size_t i = 0; i < node->as.call.arguments->count; i++) {
-                    ast_free_node((AstNode*)node->as.call.arguments->items[i]);
-                }
-                ast_list_free(node->as.call.arguments);
-            }
+            visit(node->as.call.callee, context);
+            visit_list(node->as.call.arguments, visit, context);
             break;
-            
         case AST_INDEX_EXPR:
-            ast_free_node(node->as.index.object);
-            ast_free_node(node->as.index.index);
+            visit(node->as.index.object, context);
+            visit(node->as.index.index, context);
             break;
-            
         case AST_MEMBER_EXPR:
-            ast_free_node(node->as.member.object);
-            free(node->as.member.member);
+            visit(node->as.member.object, context);
             break;
-            
         case AST_ARRAY_EXPR:
-            if (node->as.array.elements) {
-                for (size_t i = 0; i < node->as.array.elements->count; i++) {
-                    ast_free_node((AstNode*)node->as.array.elements->items[i]);
-                }
-                ast_list_free(node->as.array.elements);
-            }
+            visit_list(node->as.array.elements, visit, context);
             break;
-            
         case AST_DICT_EXPR:
             if (node->as.dict.entries) {
                 for (size_t i = 0; i < node->as.dict.entries->count; i++) {
-                    ast_free_dict_entry((DictEntry*)node->as.dict.entries->items[i]);
+                    DictEntry* entry = (DictEntry*)node->as.dict.entries->items[i];
+                    visit(entry->key, context);
+                    visit(entry->value, context);
                 }
-                ast_list_free(node->as.dict.entries);
             }
             break;
-            
         case AST_VAR_DECL:
-            free(node->as.var_decl.name);
-            free(node->as.var_decl.type_name);
-            ast_free_node(node->as.var_decl.initializer);
+            visit(node->as.var_decl.initializer, context);
             break;
-            
         case AST_ASSIGN_STMT:
-            ast_free_node(node->as.assign.target);
-            ast_free_node(node->as.assign.value);
+            visit(node->as.assign.target, context);
+            visit(node->as.assign.value, context);
             break;
-            
         case AST_EXPR_STMT:
-            ast_free_node(node->as.expr_stmt);
+            visit(node->as.expr_stmt, context);
             break;
-            
         case AST_IF_STMT:
-            ast_free_node(node->as.if_stmt.condition);
-            ast_free_node(node->as.if_stmt.then_branch);
-            ast_free_node(node->as.if_stmt.else_branch);
+            visit(node->as.if_stmt.condition, context);
+            visit(node->as.if_stmt.then_branch, context);
+            visit(node->as.if_stmt.else_branch, context);
             break;
-            
         case AST_WHILE_STMT:
-            ast_free_node(node->as.while_stmt.condition);
-            ast_free_node(node->as.while_stmt.body);
+            visit(node->as.while_stmt.condition, context);
+            visit(node->as.while_stmt.body, context);
             break;
-            
         case AST_FOR_STMT:
-            free(node->as.for_stmt.variable);
-            free(node->as.for_stmt.index_var);
-            ast_free_node(node->as.for_stmt.iterable);
-            ast_free_node(node->as.for_stmt.body);
+            visit(node->as.for_stmt.iterable, context);
+            visit(node->as.for_stmt.body, context);
             break;
-            
         case AST_LOOP_STMT:
-            ast_free_node(node->as.loop_stmt.body);
+            visit(node->as.loop_stmt.body, context);
             break;
-            
         case AST_RETURN_STMT:
-            ast_free_node(node->as.return_stmt.value);
+            visit(node->as.return_stmt.value, context);
             break;
-            
         case AST_BLOCK_STMT:
-            if (node->as.block.statements) {
-                for (size_t i = 0; i < node->as.block.statements->count; i++) {
-                    ast_free_node((AstNode*)node->as.block.statements->items[i]);
-                }
-                ast_list_free(node->as.block.statements);
-            }
+            visit_list(node->as.block.statements, visit, context);
             break;
-            
         case AST_FUNCTION_DECL:
-            free(node->as.function.name);
-            free(node->as.function.return_type);
             if (node->as.function.parameters) {
                 for (size_t i = 0; i < node->as.function.parameters->count; i++) {
-                    ast_free_parameter((Parameter*)node->as.function.parameters->items[i]);
+                    Parameter* param = (Parameter*)node->as.function.parameters->items[i];
+                    visit(param->default_value, context);
                 }
-                ast_list_free(node->as.function.parameters);
             }
-            ast_free_node(node->as.function.body);
+            visit(node->as.function.body, context);
             break;
-            
         case AST_CLASS_DECL:
-            free(node->as.class_decl.name);
-            if (node->as.class_decl.methods) {
-                for (size_t i = 0; i < node->as.class_decl.methods->count; i++) {
-                    ast_free_node((AstNode*)node->as.class_decl.methods->items[i]);
-                }
-                ast_list_free(node->as.class_decl.methods);
-            }
-            if (node->as.class_decl.fields) {
-                for (size_t i = 0; i < node->as.class_decl.fields->count; i++) {
-                    ast_free_node((AstNode*)node->as.class_decl.fields->items[i]);
-                }
-                ast_list_free(node->as.class_decl.fields);
-            }
+            visit_list(node->as.class_decl.fields, visit, context);
+            visit_list(node->as.class_decl.methods, visit, context);
             break;
-            
-        case AST_IMPORT_STMT:
-            free(node->as.import.module_name);
-            break;
-            
         case AST_PROGRAM:
-            if (node->as.program.declarations) {
-                for (size_t i = 0; i < node->as.program.declarations->count; i++) {
-                    ast_free_node((AstNode*)node->as.program.declarations->items[i]);
-                }
-                ast_list_free(node->as.program.declarations);
-            }
+            visit_list(node->as.program.declarations, visit, context);
             break;
-            
+        case AST_LITERAL_EXPR:
+        case AST_IDENTIFIER_EXPR:
+        case AST_IMPORT_STMT:
         case AST_BREAK_STMT:
         case AST_CONTINUE_STMT:
-            /* No additional cleanup needed */
             break;
     }
-    
-    free(node);
 }
 
 /* ===== Utility Functions ===== */
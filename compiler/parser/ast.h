@@ -8,7 +8,9 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "../lexer/token.h"
+#include "arena.h"
 
 /* AST Node Types */
 typedef enum {
@@ -45,6 +47,10 @@ typedef enum {
     AST_PROGRAM
 } AstNodeType;
 
+/* Node flags */
+#define AST_FLAG_INTERNED  0x1u  /* Canonical node owned by an AstConsTable */
+#define AST_FLAG_ARENA     0x2u  /* Allocated in an AstArena, freed with it */
+
 /* Forward declarations */
 typedef struct AstNode AstNode;
 typedef struct AstList AstList;
@@ -125,9 +131,23 @@ typedef struct {
     AstNode* value;
 } DictEntry;
 
+/* Collision-free slot assignment for a dictionary whose keys are all
+ * constant strings or ints (hash and displace). A key with hash h (see
+ * ast_dict_key_hash) lives in slot ast_dict_slot(layout, h); the slot
+ * holds its entry index + 1, and 0 marks an empty slot. */
+typedef struct {
+    uint32_t count;         /* Entries placed */
+    uint32_t capacity;      /* Slots, a power of two */
+    uint32_t bucket_count;  /* Displacement seeds */
+    uint32_t* seeds;        /* Per-bucket seed, bucket_count of them */
+    uint32_t* slots;        /* capacity of them */
+} DictLayout;
+
 /* Dictionary expression */
 typedef struct {
-    AstList* entries;  /* List of DictEntry* */
+    AstList* entries;       /* List of DictEntry* */
+    bool constant_keys;     /* Every key is a string or int literal */
+    DictLayout* layout;     /* Set when constant_keys and the keys are distinct */
 } DictExpr;
 
 /* Variable declaration */
@@ -135,6 +155,7 @@ typedef struct {
     char* name;
     char* type_name;  /* Optional type annotation */
     AstNode* initializer;
+    bool hot;         /* Class field placed in the first cache line */
 } VarDecl;
 
 /* Assignment statement */
@@ -186,19 +207,52 @@ typedef struct {
     AstNode* default_value;  /* Optional */
 } Parameter;
 
+/* Half-open range [start, end) of indices into a TokenBuffer */
+typedef struct {
+    size_t start;
+    size_t end;
+} TokenRange;
+
 /* Function declaration */
 typedef struct {
     char* name;
     AstList* parameters;  /* List of Parameter* */
-    AstNode* body;
+    AstNode* body;        /* NULL while body_pending */
     char* return_type;  /* Optional */
+    TokenRange body_tokens;  /* '{' .. '}' of a lazily parsed body */
+    bool body_pending;       /* Body skipped, see parser_materialize_body() */
 } FunctionDecl;
 
+/* Bytes the layout tries to keep hot fields within */
+#define AST_CACHE_LINE 64
+
+/* Where one field lives in an object */
+typedef struct {
+    uint32_t field;     /* Index into ClassDecl.fields */
+    uint32_t offset;
+    uint32_t size;
+    uint32_t align;
+} FieldSlot;
+
+/* Object layout of a class: hot fields first, then the rest, each group
+ * ordered by alignment so that padding is only needed where the groups
+ * meet; later fields fill any gap that fits them. */
+typedef struct {
+    uint32_t size;           /* Multiple of align */
+    uint32_t align;
+    uint32_t padding;        /* Bytes of size not covered by a field */
+    uint32_t declared_size;  /* Size with the fields in declaration order */
+    uint32_t hot_end;        /* End of the last hot field, 0 without any */
+    uint32_t count;
+    FieldSlot* slots;        /* In offset order */
+} ClassLayout;
+
 /* Class declaration */
 typedef struct {
     char* name;
-    AstList* methods;
-    AstList* fields;
+    AstList* methods;   /* FunctionDecl nodes */
+    AstList* fields;    /* VarDecl nodes */
+    ClassLayout* layout;
 } ClassDecl;
 
 /* Import statement */
@@ -209,6 +263,8 @@ typedef struct {
 /* Program (root node) */
 typedef struct {
     AstList* declarations;
+    AstArena* arenas;  /* Arenas holding declarations, freed with the program */
+    TokenRange* decl_tokens;  /* Token range of each declaration, NULL when parsed from a lexer */
 } Program;
 
 /* Main AST Node structure */
@@ -216,6 +272,11 @@ struct AstNode {
     AstNodeType type;
     int line;
     int column;
+    uint32_t offset;    /* Byte span [offset, offset + length) in the source; */
+    uint32_t length;    /*   hash-consed nodes keep their first occurrence's */
+    uint64_t hash;      /* Cached structural hash, 0 until ast_hash() runs */
+    uint32_t refcount;  /* Owners of this node; shared nodes outlive one free */
+    uint32_t flags;     /* AST_FLAG_* bits */
     
     union {
         BinaryExpr binary;
@@ -248,8 +309,17 @@ struct AstList {
     void** items;
     size_t count;
     size_t capacity;
+    AstArena* arena;  /* Arena backing items, NULL for heap lists */
 };
 
+/* Arena allocation: while an arena is installed on the calling thread,
+ * constructors allocate nodes, strings, lists and helper structures from
+ * it. Such nodes are released with the arena; ast_free_node() leaves
+ * them alone, so heap children must not be attached to arena nodes.
+ * Returns the previously installed arena. */
+AstArena* ast_use_arena(AstArena* arena);
+AstArena* ast_current_arena(void);
+
 /* AST List functions */
 AstList* ast_list_create(void);
 void ast_list_append(AstList* list, void* item);
@@ -290,16 +360,54 @@ AstNode* ast_create_program(AstList* decls);
 Parameter* ast_create_parameter(const char* name, const char* type, AstNode* default_val);
 DictEntry* ast_create_dict_entry(AstNode* key, AstNode* value);
 
+/* AST Node reference counting: ast_retain() adds an owner and
+ * ast_free_node() drops one, freeing the node with its last owner */
+AstNode* ast_retain(AstNode* node);
+
 /* AST Node destructor */
 void ast_free_node(AstNode* node);
 void ast_free_parameter(Parameter* param);
 void ast_free_dict_entry(DictEntry* entry);
 
+/* Tree walking: calls visit on every direct child slot of node in
+ * source order, including empty (NULL) slots */
+typedef void (*AstChildVisitor)(AstNode* child, void* context);
+void ast_visit_children(AstNode* node, AstChildVisitor visit, void* context);
+
 /* AST utilities */
 const char* ast_node_type_name(AstNodeType type);
 const char* binary_op_name(BinaryOp op);
 const char* unary_op_name(UnaryOp op);
 
+/* Structural hashing and equality (positions are ignored).
+ * The hash of every visited subtree is cached in the node, so a node
+ * must not be mutated after it has been hashed. */
+uint64_t ast_hash(AstNode* node);
+bool ast_equal(AstNode* a, AstNode* b);
+
+/* Constant dictionary keys (see DictLayout). ast_dict_key_hash() is the
+ * hash later stages reproduce: FNV-1a over a string's bytes, or an int's
+ * value, finished with a splitmix64 round seeded by the key type.
+ * It returns false for a key that is not a string or int literal. */
+bool ast_dict_key_hash(const AstNode* key, uint64_t* hash);
+uint32_t ast_dict_slot(const DictLayout* layout, uint64_t key_hash);
+
+/* Layout of entries, allocated as one zero-filled block from alloc; NULL
+ * when a key is not constant, two keys hash alike, or memory runs out.
+ * ast_create_dict() computes it, and it is freed with the node. */
+DictLayout* ast_dict_layout_build(AstList* entries, void* (*alloc)(size_t size));
+
+/* First entry whose constant key repeats an earlier entry's key */
+bool ast_dict_find_duplicate(AstList* entries, size_t* index);
+
+/* Layout of class fields, allocated as one block from alloc (NULL when
+ * out of memory). Field sizes follow the type annotation: bool, i8, u8
+ * and byte take 1 byte; i16 and u16 2; i32, u32, f32 and char 4; int,
+ * float and 64-bit types 8; other named types are references (8). An
+ * untyped field holds a tagged dynamic value (16 bytes, aligned to 8).
+ * ast_create_class() computes it, and it is freed with the node. */
+ClassLayout* ast_class_layout_build(AstList* fields, void* (*alloc)(size_t size));
+
 /* AST pretty printer */
 void ast_print(AstNode* node, int indent);
 void ast_print_program(AstNode* program);
@@ -0,0 +1,150 @@
+/* LAMC Compiler - Hash-Consed Expression Nodes
+ * Open-addressing intern table keyed by structural hash
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "ast_cons.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CONS_INITIAL_CAPACITY 256
+
+struct AstConsTable {
+    AstNode** slots;     /* Canonical nodes, NULL for empty slots */
+    size_t capacity;     /* Always a power of two */
+    AstConsStats stats;
+};
+
+/* ===== Table Management ===== */
+
+AstConsTable* ast_cons_table_create(void) {
+    AstConsTable* table = (AstConsTable*)calloc(1, sizeof(AstConsTable));
+    if (!table) return NULL;
+
+    table->slots = (AstNode**)calloc(CONS_INITIAL_CAPACITY, sizeof(AstNode*));
+    if (!table->slots) {
+        free(table);
+        return NULL;
+    }
+    table->capacity = CONS_INITIAL_CAPACITY;
+    return table;
+}
+
+void ast_cons_table_free(AstConsTable* table) {
+    if (!table) return;
+
+    /* Drop the table's reference; nodes still used by a tree survive */
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i]) ast_free_node(table->slots[i]);
+    }
+    free(table->slots);
+    free(table);
+}
+
+static bool table_grow(AstConsTable* table) {
+    size_t new_capacity = table->capacity * 2;
+    AstNode** new_slots = (AstNode**)calloc(new_capacity, sizeof(AstNode*));
+    if (!new_slots) return false;
+
+    size_t mask = new_capacity - 1;
+    for (size_t i = 0; i < table->capacity; i++) {
+        AstNode* node = table->slots[i];
+        if (!node) continue;
+
+        size_t slot = (size_t)node->hash & mask;
+        while (new_slots[slot]) slot = (slot + 1) & mask;
+        new_slots[slot] = node;
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+    return true;
+}
+
+/* ===== Purity ===== */
+
+static bool is_interned(AstNode* node) {
+    return node && (node->flags & AST_FLAG_INTERNED);
+}
+
+/* A node may be shared when it has no identity of its own: a leaf, or
+ * an operator whose children are already canonical. */
+static bool is_pure(AstNode* node) {
+    switch (node->type) {
+        case AST_LITERAL_EXPR:
+        case AST_IDENTIFIER_EXPR:
+            return true;
+        case AST_BINARY_EXPR:
+            return is_interned(node->as.binary.left) && is_interned(node->as.binary.right);
+        case AST_UNARY_EXPR:
+            return is_interned(node->as.unary.operand);
+        case AST_MEMBER_EXPR:
+            return is_interned(node->as.member.object);
+        case AST_INDEX_EXPR:
+            return is_interned(node->as.index.object) && is_interned(node->as.index.index);
+        default:
+            return false;
+    }
+}
+
+/* Bytes a duplicate would have kept alive on its own */
+static size_t node_own_bytes(AstNode* node) {
+    size_t bytes = sizeof(AstNode);
+
+    if (node->type == AST_IDENTIFIER_EXPR && node->as.identifier) {
+        bytes += strlen(node->as.identifier) + 1;
+    } else if (node->type == AST_MEMBER_EXPR && node->as.member.member) {
+        bytes += strlen(node->as.member.member) + 1;
+    } else if (node->type == AST_LITERAL_EXPR && node->as.literal.type == LIT_STRING &&
+               node->as.literal.as.string_value) {
+        bytes += strlen(node->as.literal.as.string_value) + 1;
+    }
+    return bytes;
+}
+
+/* ===== Interning ===== */
+
+AstNode* ast_cons_intern(AstConsTable* table, AstNode* node) {
+    if (!table || !node || !is_pure(node)) return node;
+
+    table->stats.lookups++;
+
+    uint64_t hash = ast_hash(node);
+    size_t mask = table->capacity - 1;
+    size_t slot = (size_t)hash & mask;
+
+    while (table->slots[slot]) {
+        AstNode* candidate = table->slots[slot];
+        if (candidate->hash == hash && ast_equal(candidate, node)) {
+            table->stats.hits++;
+            table->stats.bytes_saved += node_own_bytes(node);
+            ast_free_node(node);
+            return ast_retain(candidate);
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    /* Keep the load under 70% so probes always end at an empty slot; a
+     * table that cannot grow stops interning */
+    if ((table->stats.unique + 1) * 10 > table->capacity * 7) {
+        if (!table_grow(table)) return node;
+        mask = table->capacity - 1;
+        slot = (size_t)hash & mask;
+        while (table->slots[slot]) slot = (slot + 1) & mask;
+    }
+
+    /* First occurrence: the table keeps a reference of its own */
+    node->flags |= AST_FLAG_INTERNED;
+    table->slots[slot] = ast_retain(node);
+    table->stats.unique++;
+    return node;
+}
+
+void ast_cons_get_stats(const AstConsTable* table, AstConsStats* stats) {
+    if (!table) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    *stats = table->stats;
+}
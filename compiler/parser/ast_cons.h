@@ -0,0 +1,36 @@
+/* LAMC Compiler - Hash-Consed Expression Nodes
+ * Interns pure expression subtrees so identical ones share a node
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef AST_CONS_H
+#define AST_CONS_H
+
+#include "ast.h"
+
+/* Intern table for pure expressions: literals, identifiers, and
+ * binary/unary/member/index expressions whose children are interned.
+ * The table holds one reference to every canonical node, so shared
+ * nodes stay alive until both the trees using them and the table are
+ * freed. A shared node keeps the position of its first occurrence. */
+typedef struct AstConsTable AstConsTable;
+
+/* Deduplication counters */
+typedef struct {
+    size_t lookups;      /* Pure nodes offered to the table */
+    size_t hits;         /* Lookups answered by an existing node */
+    size_t unique;       /* Canonical nodes held by the table */
+    size_t bytes_saved;  /* Node and string bytes not kept alive thanks to sharing */
+} AstConsStats;
+
+AstConsTable* ast_cons_table_create(void);
+void ast_cons_table_free(AstConsTable* table);
+
+/* Takes ownership of node and returns the canonical node to use in its
+ * place (node itself if it is impure or seen for the first time, or,
+ * uninterned, when the table is full and cannot grow). */
+AstNode* ast_cons_intern(AstConsTable* table, AstNode* node);
+
+void ast_cons_get_stats(const AstConsTable* table, AstConsStats* stats);
+
+#endif /* AST_CONS_H */
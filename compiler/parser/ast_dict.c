@@ -0,0 +1,276 @@
+/* LAMC Compiler - Dictionary Literal Layout
+ * Perfect hashing of constant dictionary keys (hash and displace)
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "ast.h"
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define KEY_SEED_STRING 0x73747269ULL
+#define KEY_SEED_INT    0x696e7400ULL
+
+/* Average keys per displacement bucket */
+#define KEYS_PER_BUCKET 4
+
+/* Seeds tried for one bucket before the table is doubled */
+#define MAX_SEED (1u << 16)
+
+/* ===== Key Hashing ===== */
+
+static uint64_t mix64(uint64_t x) {
+    /* splitmix64 */
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+bool ast_dict_key_hash(const AstNode* key, uint64_t* hash) {
+    if (!key || key->type != AST_LITERAL_EXPR) return false;
+
+    const Literal* lit = &key->as.literal;
+    if (lit->type == LIT_STRING) {
+        /* FNV-1a */
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (const unsigned char* p = (const unsigned char*)lit->as.string_value; *p; p++) {
+            h ^= *p;
+            h *= 0x100000001b3ULL;
+        }
+        *hash = mix64(h ^ KEY_SEED_STRING);
+        return true;
+    }
+    if (lit->type == LIT_INT) {
+        *hash = mix64((uint64_t)lit->as.int_value ^ KEY_SEED_INT);
+        return true;
+    }
+    return false;
+}
+
+static uint32_t bucket_of(uint64_t key_hash, uint32_t bucket_count) {
+    return (uint32_t)(key_hash >> 32) % bucket_count;
+}
+
+static uint32_t slot_of(uint64_t key_hash, uint32_t seed, uint32_t capacity) {
+    return (uint32_t)mix64(key_hash + seed * 0x9e3779b97f4a7c15ULL) & (capacity - 1);
+}
+
+uint32_t ast_dict_slot(const DictLayout* layout, uint64_t key_hash) {
+    uint32_t bucket = bucket_of(key_hash, layout->bucket_count);
+    return slot_of(key_hash, layout->seeds[bucket], layout->capacity);
+}
+
+/* ===== Sorted Keys ===== */
+
+typedef struct {
+    uint64_t hash;
+    uint32_t index;     /* Entry index */
+} KeyHash;
+
+static int compare_key_hashes(const void* a, const void* b) {
+    const KeyHash* x = (const KeyHash*)a;
+    const KeyHash* y = (const KeyHash*)b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/* Hashes of the constant keys sorted by hash, then by entry index.
+ * With require_all, a non-constant key yields NULL. */
+static KeyHash* sorted_key_hashes(AstList* entries, bool require_all, size_t* count) {
+    KeyHash* keys = (KeyHash*)malloc((entries->count ? entries->count : 1) * sizeof(KeyHash));
+    if (!keys) return NULL;
+
+    size_t n = 0;
+    for (size_t i = 0; i < entries->count; i++) {
+        DictEntry* entry = (DictEntry*)entries->items[i];
+        if (ast_dict_key_hash(entry->key, &keys[n].hash)) {
+            keys[n++].index = (uint32_t)i;
+        } else if (require_all) {
+            free(keys);
+            return NULL;
+        }
+    }
+
+    qsort(keys, n, sizeof(KeyHash), compare_key_hashes);
+    *count = n;
+    return keys;
+}
+
+bool ast_dict_find_duplicate(AstList* entries, size_t* index) {
+    size_t n;
+    KeyHash* keys = sorted_key_hashes(entries, false, &n);
+    if (!keys) return false;
+
+    bool found = false;
+    for (size_t i = 0; i < n; i++) {
+        /* Keys of a run share a hash; compare the later ones to earlier ones */
+        for (size_t j = i + 1; j < n && keys[j].hash == keys[i].hash; j++) {
+            AstNode* a = ((DictEntry*)entries->items[keys[i].index])->key;
+            AstNode* b = ((DictEntry*)entries->items[keys[j].index])->key;
+            if (ast_equal(a, b) && (!found || keys[j].index < *index)) {
+                *index = keys[j].index;
+                found = true;
+            }
+        }
+    }
+
+    free(keys);
+    return found;
+}
+
+/* ===== Layout Construction ===== */
+
+typedef struct {
+    uint32_t bucket;
+    uint32_t size;
+    uint32_t first;     /* Start of its keys in the bucket-ordered array */
+} Bucket;
+
+static int compare_buckets(const void* a, const void* b) {
+    const Bucket* x = (const Bucket*)a;
+    const Bucket* y = (const Bucket*)b;
+    if (x->size != y->size) return x->size > y->size ? -1 : 1;
+    return (x->bucket > y->bucket) - (x->bucket < y->bucket);
+}
+
+/* Find a seed for every bucket, largest bucket first, so that all keys
+ * land in distinct slots. False when some bucket exhausts its seeds. */
+static bool place_buckets(const KeyHash* keys, const Bucket* buckets, uint32_t bucket_count,
+                          uint32_t capacity, uint32_t* seeds, uint32_t* slots, uint32_t* trial) {
+    memset(slots, 0, capacity * sizeof(uint32_t));
+
+    for (uint32_t b = 0; b < bucket_count && buckets[b].size > 0; b++) {
+        const Bucket* bucket = &buckets[b];
+        const KeyHash* members = &keys[bucket->first];
+        bool placed = false;
+
+        for (uint32_t seed = 0; seed < MAX_SEED && !placed; seed++) {
+            placed = true;
+            for (uint32_t k = 0; k < bucket->size && placed; k++) {
+                trial[k] = slot_of(members[k].hash, seed, capacity);
+                if (slots[trial[k]]) placed = false;
+                for (uint32_t m = 0; m < k && placed; m++) {
+                    if (trial[m] == trial[k]) placed = false;
+                }
+            }
+            if (placed) seeds[bucket->bucket] = seed;
+        }
+        if (!placed) return false;
+
+        for (uint32_t k = 0; k < bucket->size; k++) {
+            slots[trial[k]] = members[k].index + 1;
+        }
+    }
+    return true;
+}
+
+/* Scratch arrays of one layout construction */
+typedef struct {
+    Bucket* buckets;        /* Sorted largest first */
+    uint32_t bucket_count;
+    KeyHash* grouped;       /* Keys ordered by bucket */
+    uint32_t* trial;
+    uint32_t* seeds;
+    uint32_t* slots;
+} LayoutWork;
+
+static void work_free(LayoutWork* work) {
+    free(work->buckets);
+    free(work->grouped);
+    free(work->trial);
+    free(work->seeds);
+    free(work->slots);
+}
+
+/* Group the keys by bucket; a counting sort keeps the hash order */
+static bool work_init(LayoutWork* work, const KeyHash* keys, size_t n) {
+    uint32_t bucket_count = (uint32_t)((n + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET);
+    if (bucket_count == 0) bucket_count = 1;
+
+    work->bucket_count = bucket_count;
+    work->buckets = (Bucket*)calloc(bucket_count, sizeof(Bucket));
+    work->grouped = (KeyHash*)malloc((n ? n : 1) * sizeof(KeyHash));
+    work->trial = (uint32_t*)malloc((n ? n : 1) * sizeof(uint32_t));
+    work->seeds = (uint32_t*)calloc(bucket_count, sizeof(uint32_t));
+    work->slots = NULL;
+    if (!work->buckets || !work->grouped || !work->trial || !work->seeds) return false;
+
+    for (size_t i = 0; i < n; i++) {
+        work->buckets[bucket_of(keys[i].hash, bucket_count)].size++;
+    }
+    uint32_t first = 0;
+    for (uint32_t b = 0; b < bucket_count; b++) {
+        work->buckets[b].bucket = b;
+        work->buckets[b].first = first;
+        first += work->buckets[b].size;
+        work->buckets[b].size = 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        Bucket* bucket = &work->buckets[bucket_of(keys[i].hash, bucket_count)];
+        work->grouped[bucket->first + bucket->size++] = keys[i];
+    }
+
+    qsort(work->buckets, bucket_count, sizeof(Bucket), compare_buckets);
+    return true;
+}
+
+/* Smallest power-of-two table the buckets fit in, copied out via alloc */
+static DictLayout* work_place(LayoutWork* work, size_t n, void* (*alloc)(size_t size)) {
+    size_t limit = 64 * (n ? n : 1);
+    uint32_t capacity = 1;
+    while (capacity < n) capacity *= 2;
+
+    /* A full table rarely fails; each doubling makes placement easier */
+    for (;; capacity *= 2) {
+        if (capacity > limit) return NULL;
+        uint32_t* grown = (uint32_t*)realloc(work->slots, capacity * sizeof(uint32_t));
+        if (!grown) return NULL;
+        work->slots = grown;
+        if (place_buckets(work->grouped, work->buckets, work->bucket_count, capacity,
+                          work->seeds, work->slots, work->trial)) {
+            break;
+        }
+    }
+
+    size_t seeds_size = work->bucket_count * sizeof(uint32_t);
+    size_t slots_size = capacity * sizeof(uint32_t);
+    DictLayout* layout = (DictLayout*)alloc(sizeof(DictLayout) + seeds_size + slots_size);
+    if (!layout) return NULL;
+    STATS_BYTES(STATS_BYTES_AUX, sizeof(DictLayout) + seeds_size + slots_size);
+
+    layout->count = (uint32_t)n;
+    layout->capacity = capacity;
+    layout->bucket_count = work->bucket_count;
+    layout->seeds = (uint32_t*)(layout + 1);
+    layout->slots = layout->seeds + work->bucket_count;
+    memcpy(layout->seeds, work->seeds, seeds_size);
+    memcpy(layout->slots, work->slots, slots_size);
+    return layout;
+}
+
+DictLayout* ast_dict_layout_build(AstList* entries, void* (*alloc)(size_t size)) {
+    if (!entries || entries->count >= UINT32_MAX / 64) return NULL;
+
+    size_t n;
+    KeyHash* keys = sorted_key_hashes(entries, true, &n);
+    if (!keys) return NULL;
+
+    /* Equal hashes can never be separated: duplicate keys or a collision */
+    for (size_t i = 1; i < n; i++) {
+        if (keys[i].hash == keys[i - 1].hash) {
+            free(keys);
+            return NULL;
+        }
+    }
+
+    LayoutWork work;
+    DictLayout* layout = NULL;
+    if (work_init(&work, keys, n)) {
+        layout = work_place(&work, n, alloc);
+    }
+
+    work_free(&work);
+    free(keys);
+    return layout;
+}
@@ -0,0 +1,638 @@
+/* LAMC Compiler - AST Emitters
+ * Output buffer, JSON and S-expression formats
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "ast_emit.h"
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define EMIT_MEMORY_INITIAL 4096
+
+/* Indentation is copied out of this, never produced a space at a time */
+static const char SPACES[] =
+    "                                                                "
+    "                                                                ";
+
+/* ===== Output Buffer ===== */
+
+void ast_emitter_init(AstEmitter* emitter, int fd) {
+    size_t capacity = fd >= 0 ? AST_EMIT_FLUSH_BYTES : EMIT_MEMORY_INITIAL;
+    emitter->data = (char*)malloc(capacity);
+    emitter->length = 0;
+    emitter->capacity = emitter->data ? capacity : 0;
+    emitter->fd = fd;
+    emitter->failed = emitter->data == NULL;
+    if (emitter->data) emitter->data[0] = '\0';
+}
+
+bool ast_emitter_flush(AstEmitter* emitter) {
+    if (emitter->fd < 0) return !emitter->failed;
+
+    size_t written = 0;
+    while (written < emitter->length) {
+        ssize_t n = write(emitter->fd, emitter->data + written, emitter->length - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            emitter->failed = true;
+            break;
+        }
+        written += (size_t)n;
+    }
+    emitter->length = 0;
+    return !emitter->failed;
+}
+
+bool ast_emitter_free(AstEmitter* emitter) {
+    bool ok = ast_emitter_flush(emitter);
+    free(emitter->data);
+    emitter->data = NULL;
+    emitter->length = 0;
+    emitter->capacity = 0;
+    return ok;
+}
+
+/* Room for length more bytes plus a terminator: an fd emitter flushes
+ * first, and either kind grows for a single oversized piece */
+static bool reserve(AstEmitter* emitter, size_t length) {
+    if (emitter->failed) return false;
+    if (emitter->length + length < emitter->capacity) return true;
+
+    if (emitter->fd >= 0) {
+        if (!ast_emitter_flush(emitter)) return false;
+        if (length < emitter->capacity) return true;
+    }
+
+    size_t capacity = emitter->capacity;
+    while (emitter->length + length >= capacity) capacity *= 2;
+    char* grown = (char*)realloc(emitter->data, capacity);
+    if (!grown) {
+        emitter->failed = true;
+        return false;
+    }
+    emitter->data = grown;
+    emitter->capacity = capacity;
+    return true;
+}
+
+void ast_emit_bytes(AstEmitter* emitter, const char* bytes, size_t length) {
+    if (!reserve(emitter, length)) return;
+    memcpy(emitter->data + emitter->length, bytes, length);
+    emitter->length += length;
+    emitter->data[emitter->length] = '\0';
+}
+
+void ast_emit_string(AstEmitter* emitter, const char* text) {
+    ast_emit_bytes(emitter, text, strlen(text));
+}
+
+void ast_emit_indent(AstEmitter* emitter, int indent) {
+    size_t remaining = indent > 0 ? (size_t)indent * 2 : 0;
+    while (remaining > 0) {
+        size_t chunk = remaining < sizeof(SPACES) - 1 ? remaining : sizeof(SPACES) - 1;
+        ast_emit_bytes(emitter, SPACES, chunk);
+        remaining -= chunk;
+    }
+}
+
+void ast_emit_format(AstEmitter* emitter, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    char small[256];
+    int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) return;
+
+    if ((size_t)length < sizeof(small)) {
+        ast_emit_bytes(emitter, small, (size_t)length);
+        return;
+    }
+
+    /* Longer than the scratch space: format straight into the buffer */
+    if (!reserve(emitter, (size_t)length)) return;
+    va_start(args, format);
+    vsnprintf(emitter->data + emitter->length, (size_t)length + 1, format, args);
+    va_end(args);
+    emitter->length += (size_t)length;
+}
+
+void ast_emit_long(AstEmitter* emitter, long value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* cursor = end;
+    /* Negate as unsigned so that LONG_MIN is printed correctly */
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        *--cursor = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) *--cursor = '-';
+    ast_emit_bytes(emitter, cursor, (size_t)(end - cursor));
+}
+
+/* Quoted, with JSON escapes (also valid in the S-expression format) */
+static void emit_quoted(AstEmitter* emitter, const char* text) {
+    ast_emit_bytes(emitter, "\"", 1);
+    const char* run = text;
+    for (const char* c = text; *c; c++) {
+        unsigned char ch = (unsigned char)*c;
+        if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+
+        ast_emit_bytes(emitter, run, (size_t)(c - run));
+        run = c + 1;
+        switch (ch) {
+            case '"': ast_emit_bytes(emitter, "\\\"", 2); break;
+            case '\\': ast_emit_bytes(emitter, "\\\\", 2); break;
+            case '\n': ast_emit_bytes(emitter, "\\n", 2); break;
+            case '\t': ast_emit_bytes(emitter, "\\t", 2); break;
+            case '\r': ast_emit_bytes(emitter, "\\r", 2); break;
+            default: ast_emit_format(emitter, "\\u%04x", ch); break;
+        }
+    }
+    ast_emit_bytes(emitter, run, strlen(run));
+    ast_emit_bytes(emitter, "\"", 1);
+}
+
+/* ===== JSON ===== */
+
+static void json_node(AstEmitter* out, AstNode* node);
+
+static void json_key(AstEmitter* out, const char* key) {
+    ast_emit_string(out, ",\"");
+    ast_emit_string(out, key);
+    ast_emit_string(out, "\":");
+}
+
+static void json_child(AstEmitter* out, const char* key, AstNode* child) {
+    json_key(out, key);
+    json_node(out, child);
+}
+
+static void json_name(AstEmitter* out, const char* key, const char* name) {
+    json_key(out, key);
+    if (name) {
+        emit_quoted(out, name);
+    } else {
+        ast_emit_string(out, "null");
+    }
+}
+
+static void json_list(AstEmitter* out, const char* key, AstList* list) {
+    json_key(out, key);
+    ast_emit_string(out, "[");
+    for (size_t i = 0; list && i < list->count; i++) {
+        if (i > 0) ast_emit_string(out, ",");
+        json_node(out, (AstNode*)list->items[i]);
+    }
+    ast_emit_string(out, "]");
+}
+
+static void json_literal(AstEmitter* out, AstNode* node) {
+    json_key(out, "value");
+    switch (node->as.literal.type) {
+        case LIT_INT:
+            ast_emit_long(out, node->as.literal.as.int_value);
+            break;
+        case LIT_FLOAT:
+            /* JSON has no infinities or NaN */
+            if (isfinite(node->as.literal.as.float_value)) {
+                ast_emit_format(out, "%.17g", node->as.literal.as.float_value);
+            } else {
+                ast_emit_string(out, "null");
+            }
+            break;
+        case LIT_STRING:
+            emit_quoted(out, node->as.literal.as.string_value);
+            break;
+        case LIT_BOOL:
+            ast_emit_string(out, node->as.literal.as.bool_value ? "true" : "false");
+            break;
+        case LIT_NULL:
+            ast_emit_string(out, "null");
+            break;
+    }
+}
+
+static const char* literal_type_name(LiteralType type) {
+    switch (type) {
+        case LIT_INT: return "int";
+        case LIT_FLOAT: return "float";
+        case LIT_STRING: return "string";
+        case LIT_BOOL: return "bool";
+        case LIT_NULL: return "null";
+    }
+    return "?";
+}
+
+static void json_node(AstEmitter* out, AstNode* node) {
+    if (!node) {
+        ast_emit_string(out, "null");
+        return;
+    }
+
+    ast_emit_string(out, "{\"type\":\"");
+    ast_emit_string(out, ast_node_type_name(node->type));
+    ast_emit_string(out, "\",\"line\":");
+    ast_emit_long(out, node->line);
+    ast_emit_string(out, ",\"column\":");
+    ast_emit_long(out, node->column);
+    ast_emit_string(out, ",\"offset\":");
+    ast_emit_long(out, (long)node->offset);
+    ast_emit_string(out, ",\"length\":");
+    ast_emit_long(out, (long)node->length);
+
+    switch (node->type) {
+        case AST_BINARY_EXPR:
+            json_name(out, "op", binary_op_name(node->as.binary.op));
+            json_child(out, "left", node->as.binary.left);
+            json_child(out, "right", node->as.binary.right);
+            break;
+
+        case AST_UNARY_EXPR:
+            json_name(out, "op", unary_op_name(node->as.unary.op));
+            json_child(out, "operand", node->as.unary.operand);
+            break;
+
+        case AST_LITERAL_EXPR:
+            json_name(out, "literal", literal_type_name(node->as.literal.type));
+            json_literal(out, node);
+            break;
+
+        case AST_IDENTIFIER_EXPR:
+            json_name(out, "name", node->as.identifier);
+            break;
+
+        case AST_CALL_EXPR:
+            json_child(out, "callee", node->as.call.callee);
+            json_list(out, "arguments", node->as.call.arguments);
+            break;
+
+        case AST_INDEX_EXPR:
+            json_child(out, "object", node->as.index.object);
+            json_child(out, "index", node->as.index.index);
+            break;
+
+        case AST_MEMBER_EXPR:
+            json_child(out, "object", node->as.member.object);
+            json_name(out, "member", node->as.member.member);
+            break;
+
+        case AST_ARRAY_EXPR:
+            json_list(out, "elements", node->as.array.elements);
+            break;
+
+        case AST_DICT_EXPR:
+            json_key(out, "entries");
+            ast_emit_string(out, "[");
+            for (size_t i = 0; node->as.dict.entries && i < node->as.dict.entries->count; i++) {
+                DictEntry* entry = (DictEntry*)node->as.dict.entries->items[i];
+                ast_emit_string(out, i > 0 ? ",{\"key\":" : "{\"key\":");
+                json_node(out, entry->key);
+                json_child(out, "value", entry->value);
+                ast_emit_string(out, "}");
+            }
+            ast_emit_string(out, "]");
+            if (node->as.dict.layout) {
+                json_key(out, "slots");
+                ast_emit_long(out, (long)node->as.dict.layout->capacity);
+            }
+            break;
+
+        case AST_VAR_DECL:
+            json_name(out, "name", node->as.var_decl.name);
+            json_name(out, "type_name", node->as.var_decl.type_name);
+            if (node->as.var_decl.hot) ast_emit_string(out, ",\"hot\":true");
+            json_child(out, "initializer", node->as.var_decl.initializer);
+            break;
+
+        case AST_ASSIGN_STMT:
+            json_child(out, "target", node->as.assign.target);
+            json_child(out, "value", node->as.assign.value);
+            break;
+
+        case AST_EXPR_STMT:
+            json_child(out, "expression", node->as.expr_stmt);
+            break;
+
+        case AST_IF_STMT:
+            json_child(out, "condition", node->as.if_stmt.condition);
+            json_child(out, "then", node->as.if_stmt.then_branch);
+            json_child(out, "else", node->as.if_stmt.else_branch);
+            break;
+
+        case AST_WHILE_STMT:
+            json_child(out, "condition", node->as.while_stmt.condition);
+            json_child(out, "body", node->as.while_stmt.body);
+            break;
+
+        case AST_FOR_STMT:
+            json_name(out, "variable", node->as.for_stmt.variable);
+            json_name(out, "index_var", node->as.for_stmt.index_var);
+            json_child(out, "iterable", node->as.for_stmt.iterable);
+            json_child(out, "body", node->as.for_stmt.body);
+            break;
+
+        case AST_LOOP_STMT:
+            json_child(out, "body", node->as.loop_stmt.body);
+            break;
+
+        case AST_RETURN_STMT:
+            json_child(out, "value", node->as.return_stmt.value);
+            break;
+
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            break;
+
+        case AST_BLOCK_STMT:
+            json_list(out, "statements", node->as.block.statements);
+            break;
+
+        case AST_FUNCTION_DECL:
+            json_name(out, "name", node->as.function.name);
+            json_name(out, "return_type", node->as.function.return_type);
+            json_key(out, "parameters");
+            ast_emit_string(out, "[");
+            for (size_t i = 0; node->as.function.parameters && i < node->as.function.parameters->count; i++) {
+                Parameter* param = (Parameter*)node->as.function.parameters->items[i];
+                ast_emit_string(out, i > 0 ? ",{\"name\":" : "{\"name\":");
+                emit_quoted(out, param->name);
+                json_name(out, "type_name", param->type_name);
+                json_child(out, "default", param->default_value);
+                ast_emit_string(out, "}");
+            }
+            ast_emit_string(out, "]");
+            if (node->as.function.body_pending) {
+                ast_emit_format(out, ",\"body\":null,\"body_tokens\":[%zu,%zu]",
+                                node->as.function.body_tokens.start,
+                                node->as.function.body_tokens.end);
+            } else {
+                json_child(out, "body", node->as.function.body);
+            }
+            break;
+
+        case AST_CLASS_DECL:
+            json_name(out, "name", node->as.class_decl.name);
+            json_list(out, "fields", node->as.class_decl.fields);
+            json_list(out, "methods", node->as.class_decl.methods);
+            if (node->as.class_decl.layout) {
+                ClassLayout* layout = node->as.class_decl.layout;
+                ast_emit_format(out, ",\"layout\":{\"size\":%u,\"align\":%u,\"padding\":%u}",
+                                layout->size, layout->align, layout->padding);
+            }
+            break;
+
+        case AST_IMPORT_STMT:
+            json_name(out, "module", node->as.import.module_name);
+            break;
+
+        case AST_PROGRAM:
+            json_list(out, "declarations", node->as.program.declarations);
+            break;
+    }
+
+    ast_emit_string(out, "}");
+}
+
+void ast_emit_json(AstEmitter* emitter, AstNode* node) {
+    json_node(emitter, node);
+    ast_emit_string(emitter, "\n");
+}
+
+/* ===== S-Expressions ===== */
+
+/* (head attributes... children...), with _ for an absent child or name */
+
+static void sexpr_node(AstEmitter* out, AstNode* node);
+
+static void sexpr_child(AstEmitter* out, AstNode* child) {
+    ast_emit_string(out, " ");
+    sexpr_node(out, child);
+}
+
+static void sexpr_name(AstEmitter* out, const char* name) {
+    ast_emit_string(out, " ");
+    ast_emit_string(out, name ? name : "_");
+}
+
+static void sexpr_list(AstEmitter* out, AstList* list) {
+    for (size_t i = 0; list && i < list->count; i++) {
+        sexpr_child(out, (AstNode*)list->items[i]);
+    }
+}
+
+static void sexpr_node(AstEmitter* out, AstNode* node) {
+    if (!node) {
+        ast_emit_string(out, "_");
+        return;
+    }
+
+    switch (node->type) {
+        case AST_BINARY_EXPR:
+            ast_emit_string(out, "(");
+            ast_emit_string(out, binary_op_name(node->as.binary.op));
+            sexpr_child(out, node->as.binary.left);
+            sexpr_child(out, node->as.binary.right);
+            break;
+
+        case AST_UNARY_EXPR:
+            ast_emit_string(out, "(");
+            ast_emit_string(out, unary_op_name(node->as.unary.op));
+            sexpr_child(out, node->as.unary.operand);
+            break;
+
+        case AST_LITERAL_EXPR:
+            /* Atoms, like identifiers */
+            switch (node->as.literal.type) {
+                case LIT_INT: ast_emit_long(out, node->as.literal.as.int_value); break;
+                case LIT_FLOAT: ast_emit_format(out, "%g", node->as.literal.as.float_value); break;
+                case LIT_STRING: emit_quoted(out, node->as.literal.as.string_value); break;
+                case LIT_BOOL: ast_emit_string(out, node->as.literal.as.bool_value ? "#t" : "#f"); break;
+                case LIT_NULL: ast_emit_string(out, "nil"); break;
+            }
+            return;
+
+        case AST_IDENTIFIER_EXPR:
+            ast_emit_string(out, node->as.identifier);
+            return;
+
+        case AST_CALL_EXPR:
+            ast_emit_string(out, "(call");
+            sexpr_child(out, node->as.call.callee);
+            sexpr_list(out, node->as.call.arguments);
+            break;
+
+        case AST_INDEX_EXPR:
+            ast_emit_string(out, "(index");
+            sexpr_child(out, node->as.index.object);
+            sexpr_child(out, node->as.index.index);
+            break;
+
+        case AST_MEMBER_EXPR:
+            ast_emit_string(out, "(.");
+            sexpr_child(out, node->as.member.object);
+            sexpr_name(out, node->as.member.member);
+            break;
+
+        case AST_ARRAY_EXPR:
+            ast_emit_string(out, "(array");
+            sexpr_list(out, node->as.array.elements);
+            break;
+
+        case AST_DICT_EXPR:
+            ast_emit_string(out, "(dict");
+            for (size_t i = 0; node->as.dict.entries && i < node->as.dict.entries->count; i++) {
+                DictEntry* entry = (DictEntry*)node->as.dict.entries->items[i];
+                ast_emit_string(out, " (");
+                sexpr_node(out, entry->key);
+                sexpr_child(out, entry->value);
+                ast_emit_string(out, ")");
+            }
+            break;
+
+        case AST_VAR_DECL:
+            ast_emit_string(out, node->as.var_decl.hot ? "(var-hot" : "(var");
+            sexpr_name(out, node->as.var_decl.name);
+            sexpr_name(out, node->as.var_decl.type_name);
+            sexpr_child(out, node->as.var_decl.initializer);
+            break;
+
+        case AST_ASSIGN_STMT:
+            ast_emit_string(out, "(set");
+            sexpr_child(out, node->as.assign.target);
+            sexpr_child(out, node->as.assign.value);
+            break;
+
+        case AST_EXPR_STMT:
+            ast_emit_string(out, "(expr");
+            sexpr_child(out, node->as.expr_stmt);
+            break;
+
+        case AST_IF_STMT:
+            ast_emit_string(out, "(if");
+            sexpr_child(out, node->as.if_stmt.condition);
+            sexpr_child(out, node->as.if_stmt.then_branch);
+            if (node->as.if_stmt.else_branch) sexpr_child(out, node->as.if_stmt.else_branch);
+            break;
+
+        case AST_WHILE_STMT:
+            ast_emit_string(out, "(while");
+            sexpr_child(out, node->as.while_stmt.condition);
+            sexpr_child(out, node->as.while_stmt.body);
+            break;
+
+        case AST_FOR_STMT:
+            ast_emit_string(out, "(for");
+            sexpr_name(out, node->as.for_stmt.variable);
+            sexpr_name(out, node->as.for_stmt.index_var);
+            sexpr_child(out, node->as.for_stmt.iterable);
+            sexpr_child(out, node->as.for_stmt.body);
+            break;
+
+        case AST_LOOP_STMT:
+            ast_emit_string(out, "(loop");
+            sexpr_child(out, node->as.loop_stmt.body);
+            break;
+
+        case AST_RETURN_STMT:
+            ast_emit_string(out, "(return");
+            if (node->as.return_stmt.value) sexpr_child(out, node->as.return_stmt.value);
+            break;
+
+        case AST_BREAK_STMT:
+            ast_emit_string(out, "(break");
+            break;
+
+        case AST_CONTINUE_STMT:
+            ast_emit_string(out, "(continue");
+            break;
+
+        case AST_BLOCK_STMT:
+            ast_emit_string(out, "(block");
+            sexpr_list(out, node->as.block.statements);
+            break;
+
+        case AST_FUNCTION_DECL:
+            ast_emit_string(out, "(func");
+            sexpr_name(out, node->as.function.name);
+            ast_emit_string(out, " (");
+            for (size_t i = 0; node->as.function.parameters && i < node->as.function.parameters->count; i++) {
+                Parameter* param = (Parameter*)node->as.function.parameters->items[i];
+                if (i > 0) ast_emit_string(out, " ");
+                if (param->type_name || param->default_value) {
+                    ast_emit_string(out, "(");
+                    ast_emit_string(out, param->name);
+                    sexpr_name(out, param->type_name);
+                    if (param->default_value) sexpr_child(out, param->default_value);
+                    ast_emit_string(out, ")");
+                } else {
+                    ast_emit_string(out, param->name);
+                }
+            }
+            ast_emit_string(out, ")");
+            sexpr_name(out, node->as.function.return_type);
+            if (node->as.function.body_pending) {
+                ast_emit_string(out, " (pending)");
+            } else {
+                sexpr_child(out, node->as.function.body);
+            }
+            break;
+
+        case AST_CLASS_DECL:
+            ast_emit_string(out, "(class");
+            sexpr_name(out, node->as.class_decl.name);
+            ast_emit_string(out, " (fields");
+            sexpr_list(out, node->as.class_decl.fields);
+            ast_emit_string(out, ") (methods");
+            sexpr_list(out, node->as.class_decl.methods);
+            ast_emit_string(out, ")");
+            break;
+
+        case AST_IMPORT_STMT:
+            ast_emit_string(out, "(import");
+            sexpr_name(out, node->as.import.module_name);
+            break;
+
+        case AST_PROGRAM:
+            ast_emit_string(out, "(program");
+            sexpr_list(out, node->as.program.declarations);
+            break;
+    }
+
+    ast_emit_string(out, ")");
+}
+
+void ast_emit_sexpr(AstEmitter* emitter, AstNode* node) {
+    sexpr_node(emitter, node);
+    ast_emit_string(emitter, "\n");
+}
+
+/* ===== Dispatch ===== */
+
+void ast_emit(AstEmitter* emitter, AstNode* node, AstEmitFormat format, int indent) {
+    switch (format) {
+        case AST_EMIT_PRETTY: ast_emit_pretty(emitter, node, indent); break;
+        case AST_EMIT_JSON: ast_emit_json(emitter, node); break;
+        case AST_EMIT_SEXPR: ast_emit_sexpr(emitter, node); break;
+    }
+}
+
+void ast_emit_program(AstEmitter* emitter, AstNode* program, AstEmitFormat format) {
+    if (!program || program->type != AST_PROGRAM) {
+        ast_emit_string(emitter, "Error: Not a program node\n");
+        return;
+    }
+
+    if (format != AST_EMIT_PRETTY) {
+        ast_emit(emitter, program, format, 0);
+        return;
+    }
+    ast_emit_string(emitter, "===== LAMC Abstract Syntax Tree =====\n\n");
+    ast_emit_pretty(emitter, program, 0);
+    ast_emit_string(emitter, "\n===== End of AST =====\n");
+}
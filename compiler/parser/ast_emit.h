@@ -0,0 +1,57 @@
+/* LAMC Compiler - AST Emitters
+ * Buffered text, JSON and S-expression output of syntax trees
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef AST_EMIT_H
+#define AST_EMIT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "ast.h"
+
+typedef enum {
+    AST_EMIT_PRETTY,    /* The indented tree of ast_print() */
+    AST_EMIT_JSON,      /* One object per node, with its span */
+    AST_EMIT_SEXPR      /* Compact S-expressions */
+} AstEmitFormat;
+
+/* Output accumulates in data. An emitter bound to a file descriptor
+ * hands it to write() whenever AST_EMIT_FLUSH_BYTES have built up; an
+ * in-memory emitter (fd < 0) keeps everything, NUL-terminated. */
+#define AST_EMIT_FLUSH_BYTES (64 * 1024)
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    int fd;
+    bool failed;        /* Out of memory or a write error; output was lost */
+} AstEmitter;
+
+void ast_emitter_init(AstEmitter* emitter, int fd);
+/* Write out what is buffered (fd emitters only); false once anything failed */
+bool ast_emitter_flush(AstEmitter* emitter);
+/* Flushes, then releases the buffer */
+bool ast_emitter_free(AstEmitter* emitter);
+
+/* Raw output, used by the formats */
+void ast_emit_bytes(AstEmitter* emitter, const char* bytes, size_t length);
+void ast_emit_string(AstEmitter* emitter, const char* text);
+void ast_emit_indent(AstEmitter* emitter, int indent);   /* Two spaces per level */
+void ast_emit_format(AstEmitter* emitter, const char* format, ...);
+void ast_emit_long(AstEmitter* emitter, long value);
+
+/* One node and its subtree. Pretty output starts at indent levels;
+ * JSON and S-expression output end with a newline. */
+void ast_emit(AstEmitter* emitter, AstNode* node, AstEmitFormat format, int indent);
+
+/* ast_emit() of a program; pretty output is framed as by ast_print_program() */
+void ast_emit_program(AstEmitter* emitter, AstNode* program, AstEmitFormat format);
+
+/* Individual formats (ast_emit() dispatches to these) */
+void ast_emit_pretty(AstEmitter* emitter, AstNode* node, int indent);
+void ast_emit_json(AstEmitter* emitter, AstNode* node);
+void ast_emit_sexpr(AstEmitter* emitter, AstNode* node);
+
+#endif /* AST_EMIT_H */
@@ -0,0 +1,277 @@
+/* LAMC Compiler - Constant Folding Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "ast_fold.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ===== Helpers ===== */
+
+static bool is_literal(AstNode* node, LiteralType type) {
+    return node && node->type == AST_LITERAL_EXPR && node->as.literal.type == type;
+}
+
+static bool is_int_literal(AstNode* node, int64_t value) {
+    return is_literal(node, LIT_INT) && (int64_t)node->as.literal.as.int_value == value;
+}
+
+/* Operand chains deeper than this are not looked into */
+#define TYPE_DEPTH_LIMIT 8
+
+/* An expression every program types as an integer: bitwise operators,
+ * and arithmetic over them and integer literals. A lone literal does not
+ * count, since it may still become a float. */
+static bool is_integral(AstNode* node, int depth) {
+    if (!node || depth > TYPE_DEPTH_LIMIT) return false;
+    if (node->type == AST_UNARY_EXPR) {
+        UnaryOp op = node->as.unary.op;
+        return op == OP_BIT_NOT || (op == OP_NEG && is_integral(node->as.unary.operand, depth + 1));
+    }
+    if (node->type != AST_BINARY_EXPR) return false;
+
+    AstNode* left = node->as.binary.left;
+    AstNode* right = node->as.binary.right;
+    switch (node->as.binary.op) {
+        case OP_BIT_AND:
+        case OP_BIT_OR:
+        case OP_BIT_XOR:
+        case OP_SHL:
+        case OP_SHR:
+            return true;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_MOD:
+            return (is_integral(left, depth + 1) && (is_literal(right, LIT_INT) || is_integral(right, depth + 1))) ||
+                   (is_literal(left, LIT_INT) && is_integral(right, depth + 1));
+        default:
+            return false;
+    }
+}
+
+/* A bool literal, a comparison or a logical operator */
+static bool is_boolean(AstNode* node) {
+    if (!node) return false;
+    if (node->type == AST_LITERAL_EXPR) return node->as.literal.type == LIT_BOOL;
+    if (node->type == AST_UNARY_EXPR) return node->as.unary.op == OP_NOT;
+    if (node->type != AST_BINARY_EXPR) return false;
+    switch (node->as.binary.op) {
+        case OP_EQ:
+        case OP_NE:
+        case OP_LT:
+        case OP_GT:
+        case OP_LE:
+        case OP_GE:
+        case OP_AND:
+        case OP_OR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Release both operands and return the folded node */
+static AstNode* replace(AstNode* folded, AstNode* left, AstNode* right) {
+    if (!folded) return NULL;
+    ast_free_node(left);
+    ast_free_node(right);
+    return folded;
+}
+
+/* Keep one operand, dropping the other */
+static AstNode* keep(AstNode* kept, AstNode* dropped) {
+    ast_free_node(dropped);
+    return kept;
+}
+
+/* ===== Integer Arithmetic ===== */
+
+/* Wraps in two's complement; false when the operation would trap */
+static bool fold_int(BinaryOp op, int64_t a, int64_t b, int64_t* result) {
+    uint64_t ua = (uint64_t)a;
+    uint64_t ub = (uint64_t)b;
+
+    switch (op) {
+        case OP_ADD: *result = (int64_t)(ua + ub); return true;
+        case OP_SUB: *result = (int64_t)(ua - ub); return true;
+        case OP_MUL: *result = (int64_t)(ua * ub); return true;
+        case OP_DIV:
+            if (b == 0 || (a == INT64_MIN && b == -1)) return false;
+            *result = a / b;
+            return true;
+        case OP_MOD:
+            if (b == 0 || (a == INT64_MIN && b == -1)) return false;
+            *result = a % b;
+            return true;
+        case OP_BIT_AND: *result = a & b; return true;
+        case OP_BIT_OR: *result = a | b; return true;
+        case OP_BIT_XOR: *result = a ^ b; return true;
+        case OP_SHL:
+            if (b < 0 || b >= 64) return false;
+            *result = (int64_t)(ua << b);
+            return true;
+        case OP_SHR:
+            if (b < 0 || b >= 64) return false;
+            *result = a >= 0 ? a >> b : ~(~a >> b);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool compare(BinaryOp op, int order, bool* result) {
+    switch (op) {
+        case OP_EQ: *result = order == 0; return true;
+        case OP_NE: *result = order != 0; return true;
+        case OP_LT: *result = order < 0; return true;
+        case OP_GT: *result = order > 0; return true;
+        case OP_LE: *result = order <= 0; return true;
+        case OP_GE: *result = order >= 0; return true;
+        default: return false;
+    }
+}
+
+/* ===== Literal Folding ===== */
+
+static AstNode* fold_literals(BinaryOp op, AstNode* left, AstNode* right) {
+    Literal* a = &left->as.literal;
+    Literal* b = &right->as.literal;
+    int line = left->line;
+    int col = left->column;
+    bool truth;
+
+    if (a->type != b->type) return NULL;
+
+    switch (a->type) {
+        case LIT_INT: {
+            int64_t x = a->as.int_value, y = b->as.int_value;
+            int64_t value;
+            if (fold_int(op, x, y, &value)) {
+                return ast_create_literal_int(value, line, col);
+            }
+            if (compare(op, (x > y) - (x < y), &truth)) {
+                return ast_create_literal_bool(truth, line, col);
+            }
+            return NULL;
+        }
+
+        case LIT_FLOAT: {
+            double x = a->as.float_value, y = b->as.float_value;
+            switch (op) {
+                case OP_ADD: return ast_create_literal_float(x + y, line, col);
+                case OP_SUB: return ast_create_literal_float(x - y, line, col);
+                case OP_MUL: return ast_create_literal_float(x * y, line, col);
+                case OP_DIV:
+                    if (y == 0.0) return NULL;
+                    return ast_create_literal_float(x / y, line, col);
+                default:
+                    break;
+            }
+            /* NaN compares unordered; leave it to run time */
+            if (x != x || y != y) return NULL;
+            if (compare(op, (x > y) - (x < y), &truth)) {
+                return ast_create_literal_bool(truth, line, col);
+            }
+            return NULL;
+        }
+
+        case LIT_BOOL: {
+            bool x = a->as.bool_value, y = b->as.bool_value;
+            switch (op) {
+                case OP_AND: return ast_create_literal_bool(x && y, line, col);
+                case OP_OR: return ast_create_literal_bool(x || y, line, col);
+                case OP_EQ: return ast_create_literal_bool(x == y, line, col);
+                case OP_NE: return ast_create_literal_bool(x != y, line, col);
+                default: return NULL;
+            }
+        }
+
+        case LIT_STRING: {
+            const char* x = a->as.string_value;
+            const char* y = b->as.string_value;
+            if (op == OP_ADD) {
+                size_t x_len = strlen(x), y_len = strlen(y);
+                char* joined = (char*)malloc(x_len + y_len + 1);
+                if (!joined) return NULL;
+                memcpy(joined, x, x_len);
+                memcpy(joined + x_len, y, y_len + 1);
+                AstNode* node = ast_create_literal_string(joined, line, col);
+                free(joined);
+                return node;
+            }
+            if (op == OP_EQ || op == OP_NE) {
+                return ast_create_literal_bool((strcmp(x, y) == 0) == (op == OP_EQ), line, col);
+            }
+            return NULL;
+        }
+
+        case LIT_NULL:
+            return NULL;
+    }
+    return NULL;
+}
+
+/* ===== Public Interface ===== */
+
+AstNode* ast_fold_binary(BinaryOp op, AstNode* left, AstNode* right) {
+    if (!left || !right) return NULL;
+
+    if (left->type == AST_LITERAL_EXPR && right->type == AST_LITERAL_EXPR) {
+        return replace(fold_literals(op, left, right), left, right);
+    }
+
+    /* Identities hold for integers only: '+' also joins strings, and the
+     * literal would make an operand of unknown type numeric */
+    switch (op) {
+        case OP_MUL:
+            if (is_int_literal(right, 1) && is_integral(left, 0)) return keep(left, right);
+            if (is_int_literal(left, 1) && is_integral(right, 0)) return keep(right, left);
+            return NULL;
+        case OP_ADD:
+            if (is_int_literal(right, 0) && is_integral(left, 0)) return keep(left, right);
+            if (is_int_literal(left, 0) && is_integral(right, 0)) return keep(right, left);
+            return NULL;
+        case OP_SUB:
+            if (is_int_literal(right, 0) && is_integral(left, 0)) return keep(left, right);
+            return NULL;
+        default:
+            return NULL;
+    }
+}
+
+AstNode* ast_fold_unary(UnaryOp op, AstNode* operand) {
+    if (!operand) return NULL;
+
+    if (operand->type == AST_LITERAL_EXPR) {
+        Literal* lit = &operand->as.literal;
+        AstNode* folded = NULL;
+
+        if (op == OP_NEG && lit->type == LIT_INT) {
+            folded = ast_create_literal_int((long)(int64_t)(0 - (uint64_t)lit->as.int_value),
+                                            operand->line, operand->column);
+        } else if (op == OP_NEG && lit->type == LIT_FLOAT) {
+            folded = ast_create_literal_float(-lit->as.float_value, operand->line, operand->column);
+        } else if (op == OP_BIT_NOT && lit->type == LIT_INT) {
+            folded = ast_create_literal_int(~lit->as.int_value, operand->line, operand->column);
+        } else if (op == OP_NOT && lit->type == LIT_BOOL) {
+            folded = ast_create_literal_bool(!lit->as.bool_value, operand->line, operand->column);
+        }
+
+        if (folded) ast_free_node(operand);
+        return folded;
+    }
+
+    /* -(-x) of an integer and !!x of a bool: the outer operator cancels
+     * the inner one */
+    AstNode* inner = operand->type == AST_UNARY_EXPR && operand->as.unary.op == op ? operand->as.unary.operand : NULL;
+    if ((op == OP_NEG && is_integral(inner, 0)) || (op == OP_NOT && is_boolean(inner))) {
+        ast_retain(inner);
+        ast_free_node(operand);
+        return inner;
+    }
+
+    return NULL;
+}
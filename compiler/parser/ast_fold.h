@@ -0,0 +1,28 @@
+/* LAMC Compiler - Constant Folding
+ * Folds operators over literal operands and simple algebraic identities
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef AST_FOLD_H
+#define AST_FOLD_H
+
+#include "ast.h"
+
+/* Folding follows LAMC's i64 semantics: + - * and << wrap around in
+ * two's complement, / and % truncate toward zero, >> is arithmetic.
+ * Anything that traps at run time (division by zero, INT64_MIN / -1,
+ * shift counts outside 0..63) is left unfolded, as is anything that
+ * mixes operand types.
+ *
+ * Identities: x * 1, 1 * x, x + 0, 0 + x, x - 0 and -(-x) become x when x
+ * is an integer whatever the program (a bitwise operator, or arithmetic
+ * over those and integer literals); !!x becomes x when x is a bool
+ * literal, a comparison or a logical operator. Other operands may be
+ * strings or of types not known yet, so they are left alone.
+ *
+ * On success the operands are consumed and the replacement node is
+ * returned; otherwise NULL is returned and the operands are untouched. */
+AstNode* ast_fold_binary(BinaryOp op, AstNode* left, AstNode* right);
+AstNode* ast_fold_unary(UnaryOp op, AstNode* operand);
+
+#endif /* AST_FOLD_H */
@@ -0,0 +1,406 @@
+/* LAMC Compiler - AST Structural Hashing
+ * 64-bit structural hash and equality for AST subtrees
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "ast.h"
+#include <string.h>
+
+/* Hash of a missing child or string, distinct from any real hash */
+#define HASH_NULL 0x9e3779b97f4a7c15ULL
+
+/* ===== Mixing Helpers ===== */
+
+static uint64_t hash_mix(uint64_t h, uint64_t value) {
+    /* splitmix64 finalizer over the combined state */
+    h ^= value + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+static uint64_t hash_string(const char* str) {
+    if (!str) return HASH_NULL;
+
+    /* FNV-1a */
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char* p = (const unsigned char*)str; *p; p++) {
+        h ^= *p;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static uint64_t hash_child(AstNode* node) {
+    return node ? ast_hash(node) : HASH_NULL;
+}
+
+static uint64_t hash_node_list(uint64_t h, AstList* list) {
+    if (!list) return hash_mix(h, HASH_NULL);
+
+    h = hash_mix(h, list->count);
+    for (size_t i = 0; i < list->count; i++) {
+        h = hash_mix(h, hash_child((AstNode*)list->items[i]));
+    }
+    return h;
+}
+
+static uint64_t hash_literal(uint64_t h, Literal* lit) {
+    h = hash_mix(h, (uint64_t)lit->type);
+
+    switch (lit->type) {
+        case LIT_INT:
+            return hash_mix(h, (uint64_t)lit->as.int_value);
+        case LIT_FLOAT: {
+            /* Hash the bit pattern so that ast_equal can compare bits */
+            uint64_t bits;
+            memcpy(&bits, &lit->as.float_value, sizeof(bits));
+            return hash_mix(h, bits);
+        }
+        case LIT_STRING:
+            return hash_mix(h, hash_string(lit->as.string_value));
+        case LIT_BOOL:
+            return hash_mix(h, lit->as.bool_value ? 1 : 0);
+        case LIT_NULL:
+            return h;
+    }
+    return h;
+}
+
+/* ===== Structural Hash ===== */
+
+static uint64_t compute_hash(AstNode* node) {
+    uint64_t h = hash_mix(0, (uint64_t)node->type);
+
+    switch (node->type) {
+        case AST_BINARY_EXPR:
+            h = hash_mix(h, (uint64_t)node->as.binary.op);
+            h = hash_mix(h, hash_child(node->as.binary.left));
+            h = hash_mix(h, hash_child(node->as.binary.right));
+            break;
+
+        case AST_UNARY_EXPR:
+            h = hash_mix(h, (uint64_t)node->as.unary.op);
+            h = hash_mix(h, hash_child(node->as.unary.operand));
+            break;
+
+        case AST_LITERAL_EXPR:
+            h = hash_literal(h, &node->as.literal);
+            break;
+
+        case AST_IDENTIFIER_EXPR:
+            h = hash_mix(h, hash_string(node->as.identifier));
+            break;
+
+        case AST_CALL_EXPR:
+            h = hash_mix(h, hash_child(node->as.call.callee));
+            h = hash_node_list(h, node->as.call.arguments);
+            break;
+
+        case AST_INDEX_EXPR:
+            h = hash_mix(h, hash_child(node->as.index.object));
+            h = hash_mix(h, hash_child(node->as.index.index));
+            break;
+
+        case AST_MEMBER_EXPR:
+            h = hash_mix(h, hash_child(node->as.member.object));
+            h = hash_mix(h, hash_string(node->as.member.member));
+            break;
+
+        case AST_ARRAY_EXPR:
+            h = hash_node_list(h, node->as.array.elements);
+            break;
+
+        case AST_DICT_EXPR:
+            if (node->as.dict.entries) {
+                h = hash_mix(h, node->as.dict.entries->count);
+                for (size_t i = 0; i < node->as.dict.entries->count; i++) {
+                    DictEntry* entry = (DictEntry*)node->as.dict.entries->items[i];
+                    h = hash_mix(h, hash_child(entry->key));
+                    h = hash_mix(h, hash_child(entry->value));
+                }
+            } else {
+                h = hash_mix(h, HASH_NULL);
+            }
+            break;
+
+        case AST_VAR_DECL:
+            h = hash_mix(h, hash_string(node->as.var_decl.name));
+            h = hash_mix(h, hash_string(node->as.var_decl.type_name));
+            h = hash_mix(h, hash_child(node->as.var_decl.initializer));
+            h = hash_mix(h, node->as.var_decl.hot);
+            break;
+
+        case AST_ASSIGN_STMT:
+            h = hash_mix(h, hash_child(node->as.assign.target));
+            h = hash_mix(h, hash_child(node->as.assign.value));
+            break;
+
+        case AST_EXPR_STMT:
+            h = hash_mix(h, hash_child(node->as.expr_stmt));
+            break;
+
+        case AST_IF_STMT:
+            h = hash_mix(h, hash_child(node->as.if_stmt.condition));
+            h = hash_mix(h, hash_child(node->as.if_stmt.then_branch));
+            h = hash_mix(h, hash_child(node->as.if_stmt.else_branch));
+            break;
+
+        case AST_WHILE_STMT:
+            h = hash_mix(h, hash_child(node->as.while_stmt.condition));
+            h = hash_mix(h, hash_child(node->as.while_stmt.body));
+            break;
+
+        case AST_FOR_STMT:
+            h = hash_mix(h, hash_string(node->as.for_stmt.variable));
+            h = hash_mix(h, hash_string(node->as.for_stmt.index_var));
+            h = hash_mix(h, hash_child(node->as.for_stmt.iterable));
+            h = hash_mix(h, hash_child(node->as.for_stmt.body));
+            break;
+
+        case AST_LOOP_STMT:
+            h = hash_mix(h, hash_child(node->as.loop_stmt.body));
+            break;
+
+        case AST_RETURN_STMT:
+            h = hash_mix(h, hash_child(node->as.return_stmt.value));
+            break;
+
+        case AST_BLOCK_STMT:
+            h = hash_node_list(h, node->as.block.statements);
+            break;
+
+        case AST_FUNCTION_DECL:
+            h = hash_mix(h, hash_string(node->as.function.name));
+            h = hash_mix(h, hash_string(node->as.function.return_type));
+            if (node->as.function.parameters) {
+                AstList* params = node->as.function.parameters;
+                h = hash_mix(h, params->count);
+                for (size_t i = 0; i < params->count; i++) {
+                    Parameter* param = (Parameter*)params->items[i];
+                    h = hash_mix(h, hash_string(param->name));
+                    h = hash_mix(h, hash_string(param->type_name));
+                    h = hash_mix(h, hash_child(param->default_value));
+                }
+            } else {
+                h = hash_mix(h, HASH_NULL);
+            }
+            h = hash_mix(h, hash_child(node->as.function.body));
+            if (node->as.function.body_pending) {
+                /* Unparsed bodies are only known by their token range */
+                h = hash_mix(h, node->as.function.body_tokens.start);
+                h = hash_mix(h, node->as.function.body_tokens.end);
+            }
+            break;
+
+        case AST_CLASS_DECL:
+            h = hash_mix(h, hash_string(node->as.class_decl.name));
+            h = hash_node_list(h, node->as.class_decl.fields);
+            h = hash_node_list(h, node->as.class_decl.methods);
+            break;
+
+        case AST_IMPORT_STMT:
+            h = hash_mix(h, hash_string(node->as.import.module_name));
+            break;
+
+        case AST_PROGRAM:
+            h = hash_node_list(h, node->as.program.declarations);
+            break;
+
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            /* Kind alone identifies these */
+            break;
+    }
+
+    /* 0 marks "not computed yet" */
+    return h ? h : 1;
+}
+
+uint64_t ast_hash(AstNode* node) {
+    if (!node) return HASH_NULL;
+
+    if (node->hash == 0) {
+        node->hash = compute_hash(node);
+    }
+    return node->hash;
+}
+
+/* ===== Structural Equality ===== */
+
+static bool string_equal(const char* a, const char* b) {
+    if (a == b) return true;
+    if (!a || !b) return false;
+    return strcmp(a, b) == 0;
+}
+
+static bool node_list_equal(AstList* a, AstList* b) {
+    if (a == b) return true;
+    if (!a || !b) return false;
+    if (a->count != b->count) return false;
+
+    for (size_t i = 0; i < a->count; i++) {
+        if (!ast_equal((AstNode*)a->items[i], (AstNode*)b->items[i])) return false;
+    }
+    return true;
+}
+
+static bool literal_equal(Literal* a, Literal* b) {
+    if (a->type != b->type) return false;
+
+    switch (a->type) {
+        case LIT_INT:
+            return a->as.int_value == b->as.int_value;
+        case LIT_FLOAT:
+            return memcmp(&a->as.float_value, &b->as.float_value, sizeof(double)) == 0;
+        case LIT_STRING:
+            return string_equal(a->as.string_value, b->as.string_value);
+        case LIT_BOOL:
+            return a->as.bool_value == b->as.bool_value;
+        case LIT_NULL:
+            return true;
+    }
+    return false;
+}
+
+bool ast_equal(AstNode* a, AstNode* b) {
+    if (a == b) return true;
+    if (!a || !b) return false;
+    if (a->type != b->type) return false;
+
+    /* Hash-first: differing hashes prove inequality */
+    if (ast_hash(a) != ast_hash(b)) return false;
+
+    switch (a->type) {
+        case AST_BINARY_EXPR:
+            return a->as.binary.op == b->as.binary.op &&
+                   ast_equal(a->as.binary.left, b->as.binary.left) &&
+                   ast_equal(a->as.binary.right, b->as.binary.right);
+
+        case AST_UNARY_EXPR:
+            return a->as.unary.op == b->as.unary.op &&
+                   ast_equal(a->as.unary.operand, b->as.unary.operand);
+
+        case AST_LITERAL_EXPR:
+            return literal_equal(&a->as.literal, &b->as.literal);
+
+        case AST_IDENTIFIER_EXPR:
+            return string_equal(a->as.identifier, b->as.identifier);
+
+        case AST_CALL_EXPR:
+            return ast_equal(a->as.call.callee, b->as.call.callee) &&
+                   node_list_equal(a->as.call.arguments, b->as.call.arguments);
+
+        case AST_INDEX_EXPR:
+            return ast_equal(a->as.index.object, b->as.index.object) &&
+                   ast_equal(a->as.index.index, b->as.index.index);
+
+        case AST_MEMBER_EXPR:
+            return string_equal(a->as.member.member, b->as.member.member) &&
+                   ast_equal(a->as.member.object, b->as.member.object);
+
+        case AST_ARRAY_EXPR:
+            return node_list_equal(a->as.array.elements, b->as.array.elements);
+
+        case AST_DICT_EXPR: {
+            AstList* ea = a->as.dict.entries;
+            AstList* eb = b->as.dict.entries;
+            if (!ea || !eb) return ea == eb;
+            if (ea->count != eb->count) return false;
+            for (size_t i = 0; i < ea->count; i++) {
+                DictEntry* da = (DictEntry*)ea->items[i];
+                DictEntry* db = (DictEntry*)eb->items[i];
+                if (!ast_equal(da->key, db->key) || !ast_equal(da->value, db->value)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        case AST_VAR_DECL:
+            return string_equal(a->as.var_decl.name, b->as.var_decl.name) &&
+                   string_equal(a->as.var_decl.type_name, b->as.var_decl.type_name) &&
+                   ast_equal(a->as.var_decl.initializer, b->as.var_decl.initializer) &&
+                   a->as.var_decl.hot == b->as.var_decl.hot;
+
+        case AST_ASSIGN_STMT:
+            return ast_equal(a->as.assign.target, b->as.assign.target) &&
+                   ast_equal(a->as.assign.value, b->as.assign.value);
+
+        case AST_EXPR_STMT:
+            return ast_equal(a->as.expr_stmt, b->as.expr_stmt);
+
+        case AST_IF_STMT:
+            return ast_equal(a->as.if_stmt.condition, b->as.if_stmt.condition) &&
+                   ast_equal(a->as.if_stmt.then_branch, b->as.if_stmt.then_branch) &&
+                   ast_equal(a->as.if_stmt.else_branch, b->as.if_stmt.else_branch);
+
+        case AST_WHILE_STMT:
+            return ast_equal(a->as.while_stmt.condition, b->as.while_stmt.condition) &&
+                   ast_equal(a->as.while_stmt.body, b->as.while_stmt.body);
+
+        case AST_FOR_STMT:
+            return string_equal(a->as.for_stmt.variable, b->as.for_stmt.variable) &&
+                   string_equal(a->as.for_stmt.index_var, b->as.for_stmt.index_var) &&
+                   ast_equal(a->as.for_stmt.iterable, b->as.for_stmt.iterable) &&
+                   ast_equal(a->as.for_stmt.body, b->as.for_stmt.body);
+
+        case AST_LOOP_STMT:
+            return ast_equal(a->as.loop_stmt.body, b->as.loop_stmt.body);
+
+        case AST_RETURN_STMT:
+            return ast_equal(a->as.return_stmt.value, b->as.return_stmt.value);
+
+        case AST_BLOCK_STMT:
+            return node_list_equal(a->as.block.statements, b->as.block.statements);
+
+        case AST_FUNCTION_DECL: {
+            if (!string_equal(a->as.function.name, b->as.function.name) ||
+                !string_equal(a->as.function.return_type, b->as.function.return_type)) {
+                return false;
+            }
+            AstList* pa = a->as.function.parameters;
+            AstList* pb = b->as.function.parameters;
+            if (!pa || !pb) {
+                if (pa != pb) return false;
+            } else {
+                if (pa->count != pb->count) return false;
+                for (size_t i = 0; i < pa->count; i++) {
+                    Parameter* xa = (Parameter*)pa->items[i];
+                    Parameter* xb = (Parameter*)pb->items[i];
+                    if (!string_equal(xa->name, xb->name) ||
+                        !string_equal(xa->type_name, xb->type_name) ||
+                        !ast_equal(xa->default_value, xb->default_value)) {
+                        return false;
+                    }
+                }
+            }
+            if (a->as.function.body_pending || b->as.function.body_pending) {
+                return a->as.function.body_pending == b->as.function.body_pending &&
+                       a->as.function.body_tokens.start == b->as.function.body_tokens.start &&
+                       a->as.function.body_tokens.end == b->as.function.body_tokens.end;
+            }
+            return ast_equal(a->as.function.body, b->as.function.body);
+        }
+
+        case AST_CLASS_DECL:
+            return string_equal(a->as.class_decl.name, b->as.class_decl.name) &&
+                   node_list_equal(a->as.class_decl.fields, b->as.class_decl.fields) &&
+                   node_list_equal(a->as.class_decl.methods, b->as.class_decl.methods);
+
+        case AST_IMPORT_STMT:
+            return string_equal(a->as.import.module_name, b->as.import.module_name);
+
+        case AST_PROGRAM:
+            return node_list_equal(a->as.program.declarations, b->as.program.declarations);
+
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,246 @@
+/* LAMC Compiler - AST Index Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "ast_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* A node waiting to be numbered, with its parent's id */
+typedef struct {
+    AstNode* node;
+    uint32_t parent;
+} PendingNode;
+
+/* Growable array of pointer-sized or smaller items */
+typedef struct {
+    void* items;
+    size_t count;
+    size_t capacity;
+} Vec;
+
+static bool vec_reserve(Vec* vec, size_t item_size) {
+    if (vec->count < vec->capacity) return true;
+    size_t capacity = vec->capacity ? vec->capacity * 2 : 64;
+    void* grown = realloc(vec->items, capacity * item_size);
+    if (!grown) return false;
+    vec->items = grown;
+    vec->capacity = capacity;
+    return true;
+}
+
+/* ===== Numbering ===== */
+
+typedef struct {
+    Vec children;       /* AstNode*, one node's children in source order */
+    bool failed;
+} ChildCollector;
+
+static void collect_child(AstNode* child, void* context) {
+    ChildCollector* collector = (ChildCollector*)context;
+    if (!child || collector->failed) return;
+    if (!vec_reserve(&collector->children, sizeof(AstNode*))) {
+        collector->failed = true;
+        return;
+    }
+    ((AstNode**)collector->children.items)[collector->children.count++] = child;
+}
+
+/* Preorder walk with an explicit stack: children are pushed in reverse
+ * so that they are numbered in source order */
+static bool number_nodes(AstIndex* index, AstNode* root) {
+    Vec stack = { NULL, 0, 0 };
+    Vec nodes = { NULL, 0, 0 };
+    Vec parents = { NULL, 0, 0 };
+    ChildCollector collector = { { NULL, 0, 0 }, false };
+    bool ok = vec_reserve(&stack, sizeof(PendingNode));
+
+    if (ok) {
+        ((PendingNode*)stack.items)[stack.count++] = (PendingNode){ root, AST_INDEX_NONE };
+    }
+    while (ok && stack.count > 0) {
+        PendingNode pending = ((PendingNode*)stack.items)[--stack.count];
+        if (nodes.count == AST_INDEX_NONE ||
+            !vec_reserve(&nodes, sizeof(AstNode*)) || !vec_reserve(&parents, sizeof(uint32_t))) {
+            ok = false;
+            break;
+        }
+        uint32_t id = (uint32_t)nodes.count;
+        ((AstNode**)nodes.items)[nodes.count++] = pending.node;
+        ((uint32_t*)parents.items)[parents.count++] = pending.parent;
+
+        collector.children.count = 0;
+        ast_visit_children(pending.node, collect_child, &collector);
+        for (size_t i = collector.children.count; ok && i > 0; i--) {
+            ok = !collector.failed && vec_reserve(&stack, sizeof(PendingNode));
+            if (ok) {
+                AstNode* child = ((AstNode**)collector.children.items)[i - 1];
+                ((PendingNode*)stack.items)[stack.count++] = (PendingNode){ child, id };
+            }
+        }
+        ok = ok && !collector.failed;
+    }
+
+    free(stack.items);
+    free(collector.children.items);
+    index->nodes = (AstNode**)nodes.items;
+    index->parent = (uint32_t*)parents.items;
+    index->count = (uint32_t)nodes.count;
+    return ok;
+}
+
+/* Children follow their parent, so one backward pass sums subtree sizes */
+static bool compute_sizes(AstIndex* index) {
+    index->size = (uint32_t*)malloc(index->count * sizeof(uint32_t));
+    if (!index->size) return false;
+
+    for (uint32_t id = 0; id < index->count; id++) index->size[id] = 1;
+    for (uint32_t id = index->count - 1; id > 0; id--) {
+        index->size[index->parent[id]] += index->size[id];
+    }
+    return true;
+}
+
+/* ===== Lookup Tables ===== */
+
+static size_t hash_pointer(const void* pointer) {
+    uint64_t bits = (uint64_t)(uintptr_t)pointer;
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+    return (size_t)bits;
+}
+
+/* Node -> first id, at most half full */
+static bool build_id_map(AstIndex* index) {
+    size_t capacity = 16;
+    while (capacity < (size_t)index->count * 2) capacity *= 2;
+
+    index->keys = (const AstNode**)calloc(capacity, sizeof(AstNode*));
+    index->ids = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    if (!index->keys || !index->ids) return false;
+    index->mask = capacity - 1;
+
+    for (uint32_t id = 0; id < index->count; id++) {
+        const AstNode* node = index->nodes[id];
+        size_t slot = hash_pointer(node) & index->mask;
+        while (index->keys[slot] && index->keys[slot] != node) {
+            slot = (slot + 1) & index->mask;
+        }
+        if (!index->keys[slot]) {
+            index->keys[slot] = node;
+            index->ids[slot] = id;
+        }
+    }
+    return true;
+}
+
+static int compare_keys(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Ids by (offset, id). Preorder already has that order unless children
+ * are stored out of source order (class fields before methods), so the
+ * sort is usually skipped. */
+static bool build_offset_order(AstIndex* index) {
+    index->by_offset = (uint32_t*)malloc(index->count * sizeof(uint32_t));
+    if (!index->by_offset) return false;
+
+    bool sorted = true;
+    for (uint32_t id = 0; id < index->count; id++) {
+        index->by_offset[id] = id;
+        if (id > 0 && index->nodes[id]->offset < index->nodes[id - 1]->offset) sorted = false;
+    }
+    if (sorted) return true;
+
+    uint64_t* keys = (uint64_t*)malloc(index->count * sizeof(uint64_t));
+    if (!keys) return false;
+    for (uint32_t id = 0; id < index->count; id++) {
+        keys[id] = ((uint64_t)index->nodes[id]->offset << 32) | id;
+    }
+    qsort(keys, index->count, sizeof(uint64_t), compare_keys);
+    for (uint32_t i = 0; i < index->count; i++) {
+        index->by_offset[i] = (uint32_t)keys[i];
+    }
+    free(keys);
+    return true;
+}
+
+bool ast_index_build(AstIndex* index, AstNode* root) {
+    memset(index, 0, sizeof(*index));
+    if (!root) return true;
+
+    if (!number_nodes(index, root) || !compute_sizes(index) ||
+        !build_id_map(index) || !build_offset_order(index)) {
+        ast_index_free(index);
+        return false;
+    }
+    return true;
+}
+
+void ast_index_free(AstIndex* index) {
+    free(index->nodes);
+    free(index->parent);
+    free(index->size);
+    free(index->by_offset);
+    free(index->keys);
+    free(index->ids);
+    memset(index, 0, sizeof(*index));
+}
+
+/* ===== Queries ===== */
+
+uint32_t ast_index_id(const AstIndex* index, const AstNode* node) {
+    if (!index->keys || !node) return AST_INDEX_NONE;
+
+    size_t slot = hash_pointer(node) & index->mask;
+    while (index->keys[slot]) {
+        if (index->keys[slot] == node) return index->ids[slot];
+        slot = (slot + 1) & index->mask;
+    }
+    return AST_INDEX_NONE;
+}
+
+AstNode* ast_index_parent(const AstIndex* index, uint32_t id) {
+    uint32_t parent = index->parent[id];
+    return parent == AST_INDEX_NONE ? NULL : index->nodes[parent];
+}
+
+bool ast_index_is_ancestor(const AstIndex* index, uint32_t ancestor, uint32_t id) {
+    return ancestor <= id && id - ancestor < index->size[ancestor];
+}
+
+uint32_t ast_index_enclosing(const AstIndex* index, uint32_t id, uint32_t types) {
+    for (uint32_t up = index->parent[id]; up != AST_INDEX_NONE; up = index->parent[up]) {
+        if (types & AST_TYPE_BIT(index->nodes[up]->type)) return up;
+    }
+    return AST_INDEX_NONE;
+}
+
+static bool span_contains(const AstNode* node, size_t offset) {
+    return offset >= node->offset && offset - node->offset < node->length;
+}
+
+/* The last node starting at or before offset is, if anything contains
+ * offset, a descendant of the innermost such node (spans of unrelated
+ * nodes do not overlap), so that node is its first containing ancestor */
+uint32_t ast_index_at_offset(const AstIndex* index, size_t offset) {
+    size_t low = 0;
+    size_t high = index->count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (index->nodes[index->by_offset[mid]]->offset <= offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) return AST_INDEX_NONE;
+
+    for (uint32_t id = index->by_offset[low - 1]; id != AST_INDEX_NONE; id = index->parent[id]) {
+        if (span_contains(index->nodes[id], offset)) return id;
+    }
+    return AST_INDEX_NONE;
+}
@@ -0,0 +1,57 @@
+/* LAMC Compiler - AST Index
+ * Preorder numbering, parent links and offset lookup for a built tree
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef AST_INDEX_H
+#define AST_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ast.h"
+
+/* Preorder id of no node (the root's parent, a failed lookup) */
+#define AST_INDEX_NONE UINT32_MAX
+
+/* Bit of a node type in an enclosing-node query */
+#define AST_TYPE_BIT(type) (1u << (type))
+
+/* Side tables over a tree, indexed by preorder id: the root is 0 and a
+ * node's subtree is the id range [id, id + size[id]). The tree is not
+ * modified; rebuild the index after editing it. */
+typedef struct {
+    AstNode** nodes;        /* Node of each id */
+    uint32_t* parent;       /* Parent's id, AST_INDEX_NONE for the root */
+    uint32_t* size;         /* Nodes in the subtree, the node included */
+    uint32_t count;
+    uint32_t* by_offset;    /* Ids ordered by span start, then id */
+    const AstNode** keys;   /* Open-addressed node -> id map */
+    uint32_t* ids;
+    size_t mask;
+} AstIndex;
+
+/* Number every node reachable from root without recursing. A node shared
+ * by hash-consing gets an id per occurrence; ast_index_id() returns the
+ * first. Returns false when out of memory. */
+bool ast_index_build(AstIndex* index, AstNode* root);
+void ast_index_free(AstIndex* index);
+
+/* Id of node, AST_INDEX_NONE if it is not in the tree */
+uint32_t ast_index_id(const AstIndex* index, const AstNode* node);
+
+/* Parent node, NULL for the root */
+AstNode* ast_index_parent(const AstIndex* index, uint32_t id);
+
+/* Interval containment: true when ancestor is id or one of its ancestors */
+bool ast_index_is_ancestor(const AstIndex* index, uint32_t ancestor, uint32_t id);
+
+/* Nearest proper ancestor whose type is in types (a mask of AST_TYPE_BIT),
+ * e.g. the loop a break belongs to; AST_INDEX_NONE if there is none */
+uint32_t ast_index_enclosing(const AstIndex* index, uint32_t id, uint32_t types);
+
+/* Innermost node whose span contains the byte offset, by binary search
+ * over span starts; AST_INDEX_NONE when no span contains it */
+uint32_t ast_index_at_offset(const AstIndex* index, size_t offset);
+
+#endif /* AST_INDEX_H */
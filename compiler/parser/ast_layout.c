@@ -0,0 +1,168 @@
+/* LAMC Compiler - Class Field Layout
+ * Field offsets ordered by hotness and alignment to minimize padding
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "ast.h"
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Tagged dynamic value: type tag + payload */
+#define DYNAMIC_SIZE 16
+#define DYNAMIC_ALIGN 8
+
+/* Built-in scalar types; anything else named is a reference */
+static const struct {
+    const char* name;
+    uint32_t size;
+} SCALAR_TYPES[] = {
+    { "bool", 1 }, { "i8", 1 }, { "u8", 1 }, { "byte", 1 },
+    { "i16", 2 }, { "u16", 2 },
+    { "i32", 4 }, { "u32", 4 }, { "f32", 4 }, { "char", 4 },
+    { "int", 8 }, { "i64", 8 }, { "u64", 8 }, { "float", 8 }, { "f64", 8 },
+};
+
+#define REFERENCE_SIZE 8
+
+static void field_size(const VarDecl* field, uint32_t* size, uint32_t* align) {
+    if (!field->type_name) {
+        *size = DYNAMIC_SIZE;
+        *align = DYNAMIC_ALIGN;
+        return;
+    }
+
+    *size = REFERENCE_SIZE;
+    for (size_t i = 0; i < sizeof(SCALAR_TYPES) / sizeof(SCALAR_TYPES[0]); i++) {
+        if (strcmp(field->type_name, SCALAR_TYPES[i].name) == 0) {
+            *size = SCALAR_TYPES[i].size;
+            break;
+        }
+    }
+    *align = *size;
+}
+
+static uint32_t align_up(uint32_t offset, uint32_t align) {
+    return (offset + align - 1) & ~(align - 1);
+}
+
+/* ===== Placement ===== */
+
+typedef struct {
+    FieldSlot slot;
+    bool hot;
+} Candidate;
+
+/* Hot first, then stricter alignment, then larger, then declaration order */
+static int compare_candidates(const void* a, const void* b) {
+    const Candidate* x = (const Candidate*)a;
+    const Candidate* y = (const Candidate*)b;
+    if (x->hot != y->hot) return x->hot ? -1 : 1;
+    if (x->slot.align != y->slot.align) return x->slot.align > y->slot.align ? -1 : 1;
+    if (x->slot.size != y->slot.size) return x->slot.size > y->slot.size ? -1 : 1;
+    return (x->slot.field > y->slot.field) - (x->slot.field < y->slot.field);
+}
+
+static int compare_offsets(const void* a, const void* b) {
+    const Candidate* x = (const Candidate*)a;
+    const Candidate* y = (const Candidate*)b;
+    return (x->slot.offset > y->slot.offset) - (x->slot.offset < y->slot.offset);
+}
+
+/* Unused byte range [start, end) left by alignment */
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} Hole;
+
+/* Place fields in the given order, reusing holes when fill is set;
+ * returns the end of the last field */
+static uint32_t place_fields(Candidate* fields, size_t count, bool fill, Hole* holes) {
+    size_t hole_count = 0;
+    uint32_t end = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        FieldSlot* slot = &fields[i].slot;
+        bool placed = false;
+
+        for (size_t h = 0; fill && h < hole_count && !placed; h++) {
+            uint32_t offset = align_up(holes[h].start, slot->align);
+            if (offset + slot->size > holes[h].end) continue;
+
+            /* Keep what is left on either side of the field */
+            Hole after = { offset + slot->size, holes[h].end };
+            holes[h].end = offset;
+            if (after.start < after.end) holes[hole_count++] = after;
+            slot->offset = offset;
+            placed = true;
+        }
+        if (placed) continue;
+
+        uint32_t offset = align_up(end, slot->align);
+        if (fill && offset > end) {
+            holes[hole_count].start = end;
+            holes[hole_count++].end = offset;
+        }
+        slot->offset = offset;
+        end = offset + slot->size;
+    }
+    return end;
+}
+
+ClassLayout* ast_class_layout_build(AstList* fields, void* (*alloc)(size_t size)) {
+    size_t count = fields->count;
+    Candidate* candidates = (Candidate*)malloc((count ? count : 1) * sizeof(Candidate));
+    /* Each placement adds at most one hole and a split at most one more */
+    Hole* holes = (Hole*)malloc((2 * count + 1) * sizeof(Hole));
+    if (!candidates || !holes) {
+        free(candidates);
+        free(holes);
+        return NULL;
+    }
+
+    uint32_t max_align = 1;
+    uint32_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        AstNode* field = (AstNode*)fields->items[i];
+        Candidate* candidate = &candidates[i];
+        candidate->slot.field = (uint32_t)i;
+        candidate->hot = field && field->type == AST_VAR_DECL && field->as.var_decl.hot;
+        if (field && field->type == AST_VAR_DECL) {
+            field_size(&field->as.var_decl, &candidate->slot.size, &candidate->slot.align);
+        } else {
+            candidate->slot.size = DYNAMIC_SIZE;
+            candidate->slot.align = DYNAMIC_ALIGN;
+        }
+        if (candidate->slot.align > max_align) max_align = candidate->slot.align;
+        used += candidate->slot.size;
+    }
+
+    /* The naive layout, for comparison */
+    uint32_t declared_end = place_fields(candidates, count, false, holes);
+
+    qsort(candidates, count, sizeof(Candidate), compare_candidates);
+    uint32_t end = place_fields(candidates, count, true, holes);
+
+    ClassLayout* layout = (ClassLayout*)alloc(sizeof(ClassLayout) + count * sizeof(FieldSlot));
+    if (layout) {
+        STATS_BYTES(STATS_BYTES_AUX, sizeof(ClassLayout) + count * sizeof(FieldSlot));
+        layout->align = max_align;
+        layout->size = align_up(end, max_align);
+        layout->padding = layout->size - used;
+        layout->declared_size = align_up(declared_end, max_align);
+        layout->hot_end = 0;
+        layout->count = (uint32_t)count;
+        layout->slots = (FieldSlot*)(layout + 1);
+
+        qsort(candidates, count, sizeof(Candidate), compare_offsets);
+        for (size_t i = 0; i < count; i++) {
+            layout->slots[i] = candidates[i].slot;
+            uint32_t field_end = candidates[i].slot.offset + candidates[i].slot.size;
+            if (candidates[i].hot && field_end > layout->hot_end) layout->hot_end = field_end;
+        }
+    }
+
+    free(candidates);
+    free(holes);
+    return layout;
+}
@@ -0,0 +1,364 @@
+/* LAMC Compiler - Persistent AST Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "ast_persist.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ===== Snapshots ===== */
+
+AstSnapshot ast_snapshot(AstNode* root) {
+    AstSnapshot snapshot = { ast_retain(root) };
+    return snapshot;
+}
+
+void ast_snapshot_release(AstSnapshot* snapshot) {
+    ast_free_node(snapshot->root);
+    snapshot->root = NULL;
+}
+
+/* ===== Child Slots ===== */
+
+static void count_child(AstNode* child, void* context) {
+    (void)child;
+    (*(size_t*)context)++;
+}
+
+size_t ast_child_count(AstNode* node) {
+    size_t count = 0;
+    if (node) ast_visit_children(node, count_child, &count);
+    return count;
+}
+
+static AstNode** list_slot(AstList* list, size_t slot) {
+    return list && slot < list->count ? (AstNode**)&list->items[slot] : NULL;
+}
+
+static size_t list_count(const AstList* list) {
+    return list ? list->count : 0;
+}
+
+/* Address of a child slot, numbered as ast_visit_children() visits them */
+static AstNode** child_slot(AstNode* node, size_t slot) {
+    switch (node->type) {
+        case AST_BINARY_EXPR:
+            return slot == 0 ? &node->as.binary.left : slot == 1 ? &node->as.binary.right : NULL;
+        case AST_UNARY_EXPR:
+            return slot == 0 ? &node->as.unary.operand : NULL;
+        case AST_CALL_EXPR:
+            if (slot == 0) return &node->as.call.callee;
+            return list_slot(node->as.call.arguments, slot - 1);
+        case AST_INDEX_EXPR:
+            return slot == 0 ? &node->as.index.object : slot == 1 ? &node->as.index.index : NULL;
+        case AST_MEMBER_EXPR:
+            return slot == 0 ? &node->as.member.object : NULL;
+        case AST_ARRAY_EXPR:
+            return list_slot(node->as.array.elements, slot);
+        case AST_DICT_EXPR: {
+            AstList* entries = node->as.dict.entries;
+            if (slot / 2 >= list_count(entries)) return NULL;
+            DictEntry* entry = (DictEntry*)entries->items[slot / 2];
+            return slot % 2 == 0 ? &entry->key : &entry->value;
+        }
+        case AST_VAR_DECL:
+            return slot == 0 ? &node->as.var_decl.initializer : NULL;
+        case AST_ASSIGN_STMT:
+            return slot == 0 ? &node->as.assign.target : slot == 1 ? &node->as.assign.value : NULL;
+        case AST_EXPR_STMT:
+            return slot == 0 ? &node->as.expr_stmt : NULL;
+        case AST_IF_STMT:
+            if (slot == 0) return &node->as.if_stmt.condition;
+            if (slot == 1) return &node->as.if_stmt.then_branch;
+            return slot == 2 ? &node->as.if_stmt.else_branch : NULL;
+        case AST_WHILE_STMT:
+            return slot == 0 ? &node->as.while_stmt.condition : slot == 1 ? &node->as.while_stmt.body : NULL;
+        case AST_FOR_STMT:
+            return slot == 0 ? &node->as.for_stmt.iterable : slot == 1 ? &node->as.for_stmt.body : NULL;
+        case AST_LOOP_STMT:
+            return slot == 0 ? &node->as.loop_stmt.body : NULL;
+        case AST_RETURN_STMT:
+            return slot == 0 ? &node->as.return_stmt.value : NULL;
+        case AST_BLOCK_STMT:
+            return list_slot(node->as.block.statements, slot);
+        case AST_FUNCTION_DECL: {
+            AstList* params = node->as.function.parameters;
+            if (slot < list_count(params)) return &((Parameter*)params->items[slot])->default_value;
+            return slot == list_count(params) ? &node->as.function.body : NULL;
+        }
+        case AST_CLASS_DECL: {
+            size_t fields = list_count(node->as.class_decl.fields);
+            if (slot < fields) return list_slot(node->as.class_decl.fields, slot);
+            return list_slot(node->as.class_decl.methods, slot - fields);
+        }
+        case AST_PROGRAM:
+            return list_slot(node->as.program.declarations, slot);
+        case AST_LITERAL_EXPR:
+        case AST_IDENTIFIER_EXPR:
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+        case AST_IMPORT_STMT:
+            break;
+    }
+    return NULL;
+}
+
+AstNode* ast_child_at(AstNode* node, size_t slot) {
+    AstNode** child = node ? child_slot(node, slot) : NULL;
+    return child ? *child : NULL;
+}
+
+/* List of a node whose children (from slot *first on) are one list */
+static AstList** child_list(AstNode* node, size_t* first) {
+    *first = 0;
+    switch (node->type) {
+        case AST_PROGRAM:    return &node->as.program.declarations;
+        case AST_BLOCK_STMT: return &node->as.block.statements;
+        case AST_ARRAY_EXPR: return &node->as.array.elements;
+        case AST_CALL_EXPR:
+            *first = 1;
+            return &node->as.call.arguments;
+        default:
+            return NULL;
+    }
+}
+
+/* ===== Copying ===== */
+
+static void* heap_alloc(size_t size) {
+    return calloc(1, size);
+}
+
+static char* copy_string(const char* text) {
+    if (!text) return NULL;
+    size_t length = strlen(text) + 1;
+    char* copy = (char*)malloc(length);
+    if (copy) memcpy(copy, text, length);
+    return copy;
+}
+
+/* New list with the same items; the items' owners are added separately */
+static AstList* copy_list(const AstList* list) {
+    if (!list) return NULL;
+    AstList* copy = ast_list_create();
+    for (size_t i = 0; copy && i < list->count; i++) {
+        ast_list_append(copy, list->items[i]);
+    }
+    return copy;
+}
+
+static void retain_child(AstNode* child, void* context) {
+    (void)context;
+    ast_retain(child);
+}
+
+/* Shallow copy: owned strings, lists and helper structures are
+ * duplicated and every child gains the copy as an owner. Derived data
+ * (dict and class layouts) is left for finish_copy(). */
+static AstNode* copy_node(const AstNode* node) {
+    AstNode* copy = (AstNode*)malloc(sizeof(AstNode));
+    if (!copy) return NULL;
+    *copy = *node;
+    copy->hash = 0;
+    copy->refcount = 1;
+    copy->flags = 0;
+
+    switch (copy->type) {
+        case AST_LITERAL_EXPR:
+            if (copy->as.literal.type == LIT_STRING) {
+                copy->as.literal.as.string_value = copy_string(node->as.literal.as.string_value);
+            }
+            break;
+        case AST_IDENTIFIER_EXPR:
+            copy->as.identifier = copy_string(node->as.identifier);
+            break;
+        case AST_CALL_EXPR:
+            copy->as.call.arguments = copy_list(node->as.call.arguments);
+            break;
+        case AST_MEMBER_EXPR:
+            copy->as.member.member = copy_string(node->as.member.member);
+            break;
+        case AST_ARRAY_EXPR:
+            copy->as.array.elements = copy_list(node->as.array.elements);
+            break;
+        case AST_DICT_EXPR: {
+            AstList* entries = node->as.dict.entries;
+            copy->as.dict.entries = entries ? ast_list_create() : NULL;
+            copy->as.dict.layout = NULL;
+            for (size_t i = 0; copy->as.dict.entries && i < entries->count; i++) {
+                DictEntry* entry = (DictEntry*)entries->items[i];
+                ast_list_append(copy->as.dict.entries, ast_create_dict_entry(entry->key, entry->value));
+            }
+            break;
+        }
+        case AST_VAR_DECL:
+            copy->as.var_decl.name = copy_string(node->as.var_decl.name);
+            copy->as.var_decl.type_name = copy_string(node->as.var_decl.type_name);
+            break;
+        case AST_FOR_STMT:
+            copy->as.for_stmt.variable = copy_string(node->as.for_stmt.variable);
+            copy->as.for_stmt.index_var = copy_string(node->as.for_stmt.index_var);
+            break;
+        case AST_BLOCK_STMT:
+            copy->as.block.statements = copy_list(node->as.block.statements);
+            break;
+        case AST_FUNCTION_DECL: {
+            AstList* params = node->as.function.parameters;
+            copy->as.function.name = copy_string(node->as.function.name);
+            copy->as.function.return_type = copy_string(node->as.function.return_type);
+            copy->as.function.parameters = params ? ast_list_create() : NULL;
+            for (size_t i = 0; copy->as.function.parameters && i < params->count; i++) {
+                Parameter* param = (Parameter*)params->items[i];
+                ast_list_append(copy->as.function.parameters,
+                                ast_create_parameter(param->name, param->type_name, param->default_value));
+            }
+            break;
+        }
+        case AST_CLASS_DECL:
+            copy->as.class_decl.name = copy_string(node->as.class_decl.name);
+            copy->as.class_decl.methods = copy_list(node->as.class_decl.methods);
+            copy->as.class_decl.fields = copy_list(node->as.class_decl.fields);
+            copy->as.class_decl.layout = NULL;
+            break;
+        case AST_IMPORT_STMT:
+            copy->as.import.module_name = copy_string(node->as.import.module_name);
+            break;
+        case AST_PROGRAM:
+            copy->as.program.declarations = copy_list(node->as.program.declarations);
+            copy->as.program.arenas = NULL;
+            copy->as.program.decl_tokens = NULL;
+            break;
+        default:
+            break;
+    }
+
+    ast_visit_children(copy, retain_child, NULL);
+    return copy;
+}
+
+/* Rebuilds what the constructors derive from a node's children */
+static void finish_copy(AstNode* copy) {
+    if (copy->type == AST_DICT_EXPR) {
+        AstList* entries = copy->as.dict.entries;
+        bool constant_keys = entries != NULL;
+        for (size_t i = 0; constant_keys && i < entries->count; i++) {
+            uint64_t hash;
+            constant_keys = ast_dict_key_hash(((DictEntry*)entries->items[i])->key, &hash);
+        }
+        copy->as.dict.constant_keys = constant_keys;
+        copy->as.dict.layout = constant_keys ? ast_dict_layout_build(entries, heap_alloc) : NULL;
+    } else if (copy->type == AST_CLASS_DECL && copy->as.class_decl.fields) {
+        copy->as.class_decl.layout = ast_class_layout_build(copy->as.class_decl.fields, heap_alloc);
+    }
+}
+
+/* ===== Path Copying ===== */
+
+typedef enum {
+    EDIT_REPLACE,
+    EDIT_INSERT,
+    EDIT_REMOVE
+} EditKind;
+
+/* Nodes from root down the path, the last one possibly NULL (an empty
+ * slot). NULL if a step leaves the tree or passes an arena node, which
+ * could be released behind the copy's back. */
+static AstNode** walk_path(AstNode* root, const size_t* path, size_t depth) {
+    if (!root || (root->type == AST_PROGRAM && root->as.program.arenas)) return NULL;
+
+    AstNode** nodes = (AstNode**)malloc((depth + 1) * sizeof(AstNode*));
+    if (!nodes) return NULL;
+    nodes[0] = root;
+    for (size_t i = 0; i < depth; i++) {
+        AstNode** child = NULL;
+        if (nodes[i] && !(nodes[i]->flags & AST_FLAG_ARENA)) child = child_slot(nodes[i], path[i]);
+        if (!child) {
+            free(nodes);
+            return NULL;
+        }
+        nodes[i + 1] = *child;
+    }
+    return nodes;
+}
+
+/* Copy of a list node with node inserted at, or the child removed from,
+ * the given slot */
+static AstNode* edit_list(AstNode* container, EditKind kind, size_t slot, AstNode* node) {
+    size_t first;
+    if (!container || (container->flags & AST_FLAG_ARENA)) return NULL;
+    if (!child_list(container, &first) || slot < first) return NULL;
+
+    AstNode* copy = copy_node(container);
+    if (!copy) return NULL;
+    AstList** list = child_list(copy, &first);
+    size_t index = slot - first;
+    if (!*list) *list = ast_list_create();
+
+    if (kind == EDIT_INSERT && *list && index <= (*list)->count) {
+        size_t count = (*list)->count;
+        ast_list_append(*list, node);
+        if ((*list)->count > count) {
+            memmove(&(*list)->items[index + 1], &(*list)->items[index],
+                    (count - index) * sizeof(void*));
+            (*list)->items[index] = node;
+            return copy;
+        }
+    } else if (kind == EDIT_REMOVE && *list && index < (*list)->count) {
+        ast_free_node((AstNode*)(*list)->items[index]);
+        (*list)->count--;
+        memmove(&(*list)->items[index], &(*list)->items[index + 1],
+                ((*list)->count - index) * sizeof(void*));
+        return copy;
+    }
+    ast_free_node(copy);
+    return NULL;
+}
+
+static AstNode* edit_path(AstNode* root, const size_t* path, size_t depth,
+                          EditKind kind, size_t slot, AstNode* node) {
+    /* The copies are heap nodes whatever arena the caller has installed */
+    AstArena* saved_arena = ast_use_arena(NULL);
+    AstNode** nodes = walk_path(root, path, depth);
+    AstNode* result = NULL;
+
+    if (nodes) {
+        result = kind == EDIT_REPLACE ? node : edit_list(nodes[depth], kind, slot, node);
+        if (kind == EDIT_REPLACE || result) node = NULL;
+
+        /* Copy each ancestor with its edited slot pointing at the new child */
+        for (size_t i = depth; result && i > 0; i--) {
+            AstNode* copy = copy_node(nodes[i - 1]);
+            if (!copy) {
+                ast_free_node(result);
+                result = NULL;
+                break;
+            }
+            AstNode** child = child_slot(copy, path[i - 1]);
+            ast_free_node(*child);
+            *child = result;
+            finish_copy(copy);
+            result = copy;
+        }
+        free(nodes);
+    }
+
+    /* A node that did not make it into a new tree is the caller's loss */
+    ast_free_node(node);
+    ast_use_arena(saved_arena);
+    return result;
+}
+
+AstNode* ast_persist_replace(AstNode* root, const size_t* path, size_t depth,
+                             AstNode* replacement) {
+    return edit_path(root, path, depth, EDIT_REPLACE, 0, replacement);
+}
+
+AstNode* ast_persist_insert(AstNode* root, const size_t* path, size_t depth,
+                            size_t slot, AstNode* node) {
+    if (!node) return NULL;
+    return edit_path(root, path, depth, EDIT_INSERT, slot, node);
+}
+
+AstNode* ast_persist_remove(AstNode* root, const size_t* path, size_t depth, size_t slot) {
+    return edit_path(root, path, depth, EDIT_REMOVE, slot, NULL);
+}
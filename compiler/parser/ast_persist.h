@@ -0,0 +1,64 @@
+/* LAMC Compiler - Persistent AST
+ * Constant-time snapshots and path-copying edits over shared trees
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef AST_PERSIST_H
+#define AST_PERSIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "ast.h"
+
+/* A persistent tree is never modified once built. An edit copies the
+ * nodes on the path from the root to the edited slot and shares every
+ * other subtree with the old version through its reference count, so
+ * each version costs O(depth) new nodes (plus one pointer per child of a
+ * copied list node, e.g. the program's declarations) and stays valid
+ * until its last owner lets go.
+ *
+ * In-place mutators (parser_reparse(), parser_materialize_body())
+ * must not be applied to a tree that has snapshots. Reference counts are
+ * not atomic: take and release snapshots on the thread that owns the
+ * tree; any thread may read a snapshot it was handed. */
+
+/* One version of a tree */
+typedef struct {
+    AstNode* root;
+} AstSnapshot;
+
+/* O(1): adds an owner to root rather than copying anything */
+AstSnapshot ast_snapshot(AstNode* root);
+/* Drops the snapshot's owner; nodes no other version uses are freed */
+void ast_snapshot_release(AstSnapshot* snapshot);
+
+/* Child slots are numbered in ast_visit_children() order, empty slots
+ * included: a dict entry is two slots (key, value), a function's
+ * parameter defaults come before its body. */
+size_t ast_child_count(AstNode* node);
+/* Child in slot, NULL when the slot is empty or out of range */
+AstNode* ast_child_at(AstNode* node, size_t slot);
+
+/* Path-copying edits. path holds depth slot numbers leading down from
+ * root; root itself is left untouched and still owned by the caller.
+ * Each returns a new root holding one reference, or NULL if the path is
+ * invalid, the tree was built in an arena, or memory ran out. Copies are
+ * heap nodes with no cached hash; a copied program loses its token
+ * ranges, so incremental reparsing starts over from a full parse. */
+
+/* Replaces the node the path leads to with replacement, whose ownership
+ * passes to the new tree (it is freed on failure). replacement may be
+ * NULL only for optional slots such as an else branch or initializer. */
+AstNode* ast_persist_replace(AstNode* root, const size_t* path, size_t depth,
+                             AstNode* replacement);
+
+/* The path leads to a list node (program, block, array or call); node
+ * is inserted so that it occupies child slot, which may be one past the
+ * last. Ownership of node passes to the new tree. */
+AstNode* ast_persist_insert(AstNode* root, const size_t* path, size_t depth,
+                            size_t slot, AstNode* node);
+
+/* The path leads to a list node; the child in slot is removed */
+AstNode* ast_persist_remove(AstNode* root, const size_t* path, size_t depth, size_t slot);
+
+#endif /* AST_PERSIST_H */
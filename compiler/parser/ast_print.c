@@ -3,278 +3,335 @@
  * Copyright (c) 2025 Naveen Singh
  */
 
-#include "ast.h"
+#include "ast_emit.h"
 #include <stdio.h>
+#include <unistd.h>
 
-static void print_indent(int indent) {
-    for (int i = 0; i < indent; i++) {
-        printf("  ");
+/* Field table of a class: offset, size and alignment in offset order */
+static void print_class_layout(AstEmitter* out, AstNode* node, int indent) {
+    ClassLayout* layout = node->as.class_decl.layout;
+    
+    ast_emit_indent(out, indent);
+    ast_emit_format(out, "layout: %u bytes, align %u, padding %u (declaration order: %u bytes)\n",
+           layout->size, layout->align, layout->padding, layout->declared_size);
+    for (uint32_t i = 0; i < layout->count; i++) {
+        FieldSlot* slot = &layout->slots[i];
+        AstNode* field = (AstNode*)node->as.class_decl.fields->items[slot->field];
+        ast_emit_indent(out, indent + 1);
+        ast_emit_format(out, "%4u  %-16s size %u, align %u%s\n", slot->offset,
+               field->type == AST_VAR_DECL ? field->as.var_decl.name : "?",
+               slot->size, slot->align,
+               field->type == AST_VAR_DECL && field->as.var_decl.hot ? ", hot" : "");
+    }
+    if (layout->hot_end > AST_CACHE_LINE) {
+        ast_emit_indent(out, indent + 1);
+        ast_emit_format(out, "hot fields end at byte %u, past the first %d-byte cache line\n",
+               layout->hot_end, AST_CACHE_LINE);
     }
 }
 
-void ast_print(AstNode* node, int indent) {
+void ast_emit_pretty(AstEmitter* out, AstNode* node, int indent) {
     if (!node) {
-        print_indent(indent);
-        printf("(null)\n");
+        ast_emit_indent(out, indent);
+        ast_emit_string(out, "(null)\n");
         return;
     }
     
-    print_indent(indent);
+    ast_emit_indent(out, indent);
     
     switch (node->type) {
         case AST_BINARY_EXPR:
-            printf("BinaryExpr (%s)\n", binary_op_name(node->as.binary.op));
-            ast_print(node->as.binary.left, indent + 1);
-            ast_print(node->as.binary.right, indent + 1);
+            ast_emit_string(out, "BinaryExpr (");
+            ast_emit_string(out, binary_op_name(node->as.binary.op));
+            ast_emit_string(out, ")\n");
+            ast_emit_pretty(out, node->as.binary.left, indent + 1);
+            ast_emit_pretty(out, node->as.binary.right, indent + 1);
             break;
             
         case AST_UNARY_EXPR:
-            printf("UnaryExpr (%s)\n", unary_op_name(node->as.unary.op));
-            ast_print(node->as.unary.operand, indent + 1);
+            ast_emit_string(out, "UnaryExpr (");
+            ast_emit_string(out, unary_op_name(node->as.unary.op));
+            ast_emit_string(out, ")\n");
+            ast_emit_pretty(out, node->as.unary.operand, indent + 1);
             break;
             
         case AST_LITERAL_EXPR:
             switch (node->as.literal.type) {
                 case LIT_INT:
-                    printf("Literal (int: %ld)\n", node->as.literal.as.int_value);
+                    ast_emit_string(out, "Literal (int: ");
+                    ast_emit_long(out, node->as.literal.as.int_value);
+                    ast_emit_string(out, ")\n");
                     break;
                 case LIT_FLOAT:
-                    printf("Literal (float: %g)\n", node->as.literal.as.float_value);
+                    ast_emit_format(out, "Literal (float: %g)\n", node->as.literal.as.float_value);
                     break;
                 case LIT_STRING:
-                    printf("Literal (string: \"%s\")\n", node->as.literal.as.string_value);
+                    ast_emit_string(out, "Literal (string: \"");
+                    ast_emit_string(out, node->as.literal.as.string_value);
+                    ast_emit_string(out, "\")\n");
                     break;
                 case LIT_BOOL:
-                    printf("Literal (bool: %s)\n", node->as.literal.as.bool_value ? "true" : "false");
+                    ast_emit_string(out, node->as.literal.as.bool_value ? "Literal (bool: true)\n" : "Literal (bool: false)\n");
                     break;
                 case LIT_NULL:
-                    printf("Literal (null)\n");
+                    ast_emit_string(out, "Literal (null)\n");
                     break;
             }
             break;
             
         case AST_IDENTIFIER_EXPR:
-            printf("Identifier (%s)\n", node->as.identifier);
+            ast_emit_string(out, "Identifier (");
+            ast_emit_string(out, node->as.identifier);
+            ast_emit_string(out, ")\n");
             break;
             
         case AST_CALL_EXPR:
-            printf("CallExpr\n");
-            print_indent(indent + 1);
-            printf("callee:\n");
-            ast_print(node->as.call.callee, indent + 2);
-            print_indent(indent + 1);
-            printf("arguments:\n");
+            ast_emit_string(out, "CallExpr\n");
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "callee:\n");
+            ast_emit_pretty(out, node->as.call.callee, indent + 2);
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "arguments:\n");
             if (node->as.call.arguments) {
                 for (size_t i = 0; i < node->as.call.arguments->count; i++) {
-                    ast_print((AstNode*)node->as.call.arguments->items[i], indent + 2);
+                    ast_emit_pretty(out, (AstNode*)node->as.call.arguments->items[i], indent + 2);
                 }
             }
             break;
             
         case AST_INDEX_EXPR:
-            printf("IndexExpr\n");
-            print_indent(indent + 1);
-            printf("object:\n");
-            ast_print(node->as.index.object, indent + 2);
-            print_indent(indent + 1);
-            printf("index:\n");
-            ast_print(node->as.index.index, indent + 2);
+            ast_emit_string(out, "IndexExpr\n");
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "object:\n");
+            ast_emit_pretty(out, node->as.index.object, indent + 2);
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "index:\n");
+            ast_emit_pretty(out, node->as.index.index, indent + 2);
             break;
             
         case AST_MEMBER_EXPR:
-            printf("MemberExpr (field: %s)\n", node->as.member.member);
-            ast_print(node->as.member.object, indent + 1);
+            ast_emit_string(out, "MemberExpr (field: ");
+            ast_emit_string(out, node->as.member.member);
+            ast_emit_string(out, ")\n");
+            ast_emit_pretty(out, node->as.member.object, indent + 1);
             break;
             
         case AST_ARRAY_EXPR:
-            printf("ArrayExpr\n");
+            ast_emit_string(out, "ArrayExpr\n");
             if (node->as.array.elements) {
                 for (size_t i = 0; i < node->as.array.elements->count; i++) {
-                    ast_print((AstNode*)node->as.array.elements->items[i], indent + 1);
+                    ast_emit_pretty(out, (AstNode*)node->as.array.elements->items[i], indent + 1);
                 }
             }
             break;
             
         case AST_DICT_EXPR:
-            printf("DictExpr\n");
+            if (node->as.dict.layout) {
+                ast_emit_format(out, "DictExpr (constant keys, slots: %u)\n", node->as.dict.layout->capacity);
+            } else {
+                ast_emit_string(out, "DictExpr\n");
+            }
             if (node->as.dict.entries) {
                 for (size_t i = 0; i < node->as.dict.entries->count; i++) {
                     DictEntry* entry = (DictEntry*)node->as.dict.entries->items[i];
-                    print_indent(indent + 1);
-                    printf("entry:\n");
-                    print_indent(indent + 2);
-                    printf("key:\n");
-                    ast_print(entry->key, indent + 3);
-                    print_indent(indent + 2);
-                    printf("value:\n");
-                    ast_print(entry->value, indent + 3);
+                    ast_emit_indent(out, indent + 1);
+                    ast_emit_string(out, "entry:\n");
+                    ast_emit_indent(out, indent + 2);
+                    ast_emit_string(out, "key:\n");
+                    ast_emit_pretty(out, entry->key, indent + 3);
+                    ast_emit_indent(out, indent + 2);
+                    ast_emit_string(out, "value:\n");
+                    ast_emit_pretty(out, entry->value, indent + 3);
                 }
             }
             break;
             
         case AST_VAR_DECL:
-            printf("VarDecl (name: %s", node->as.var_decl.name);
+            ast_emit_string(out, "VarDecl (name: ");
+            ast_emit_string(out, node->as.var_decl.name);
             if (node->as.var_decl.type_name) {
-                printf(", type: %s", node->as.var_decl.type_name);
+                ast_emit_string(out, ", type: ");
+                ast_emit_string(out, node->as.var_decl.type_name);
             }
-            printf(")\n");
+            if (node->as.var_decl.hot) {
+                ast_emit_string(out, ", hot");
+            }
+            ast_emit_string(out, ")\n");
             if (node->as.var_decl.initializer) {
-                print_indent(indent + 1);
-                printf("initializer:\n");
-                ast_print(node->as.var_decl.initializer, indent + 2);
+                ast_emit_indent(out, indent + 1);
+                ast_emit_string(out, "initializer:\n");
+                ast_emit_pretty(out, node->as.var_decl.initializer, indent + 2);
             }
             break;
             
         case AST_ASSIGN_STMT:
-            printf("AssignStmt\n");
-            print_indent(indent + 1);
-            printf("target:\n");
-            ast_print(node->as.assign.target, indent + 2);
-            print_indent(indent + 1);
-            printf("value:\n");
-            ast_print(node->as.assign.value, indent + 2);
+            ast_emit_string(out, "AssignStmt\n");
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "target:\n");
+            ast_emit_pretty(out, node->as.assign.target, indent + 2);
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "value:\n");
+            ast_emit_pretty(out, node->as.assign.value, indent + 2);
             break;
             
         case AST_EXPR_STMT:
-            printf("ExprStmt\n");
-            ast_print(node->as.expr_stmt, indent + 1);
+            ast_emit_string(out, "ExprStmt\n");
+            ast_emit_pretty(out, node->as.expr_stmt, indent + 1);
             break;
             
         case AST_IF_STMT:
-            printf("IfStmt\n");
-            print_indent(indent + 1);
-            printf("condition:\n");
-            ast_print(node->as.if_stmt.condition, indent + 2);
-            print_indent(indent + 1);
-            printf("then:\n");
-            ast_print(node->as.if_stmt.then_branch, indent + 2);
+            ast_emit_string(out, "IfStmt\n");
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "condition:\n");
+            ast_emit_pretty(out, node->as.if_stmt.condition, indent + 2);
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "then:\n");
+            ast_emit_pretty(out, node->as.if_stmt.then_branch, indent + 2);
             if (node->as.if_stmt.else_branch) {
-                print_indent(indent + 1);
-                printf("else:\n");
-                ast_print(node->as.if_stmt.else_branch, indent + 2);
+                ast_emit_indent(out, indent + 1);
+                ast_emit_string(out, "else:\n");
+                ast_emit_pretty(out, node->as.if_stmt.else_branch, indent + 2);
             }
             break;
             
         case AST_WHILE_STMT:
-            printf("WhileStmt\n");
-            print_indent(indent + 1);
-            printf("condition:\n");
-            ast_print(node->as.while_stmt.condition, indent + 2);
-            print_indent(indent + 1);
-            printf("body:\n");
-            ast_print(node->as.while_stmt.body, indent + 2);
+            ast_emit_string(out, "WhileStmt\n");
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "condition:\n");
+            ast_emit_pretty(out, node->as.while_stmt.condition, indent + 2);
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "body:\n");
+            ast_emit_pretty(out, node->as.while_stmt.body, indent + 2);
             break;
             
         case AST_FOR_STMT:
-            printf("ForStmt (var: %s", node->as.for_stmt.variable);
+            ast_emit_format(out, "ForStmt (var: %s", node->as.for_stmt.variable);
             if (node->as.for_stmt.index_var) {
-                printf(", index: %s", node->as.for_stmt.index_var);
+                ast_emit_format(out, ", index: %s", node->as.for_stmt.index_var);
             }
-            printf(")\n");
-            print_indent(indent + 1);
-            printf("iterable:\n");
-            ast_print(node->as.for_stmt.iterable, indent + 2);
-            print_indent(indent + 1);
-            printf("body:\n");
-            ast_print(node->as.for_stmt.body, indent + 2);
+            ast_emit_string(out, ")\n");
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "iterable:\n");
+            ast_emit_pretty(out, node->as.for_stmt.iterable, indent + 2);
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "body:\n");
+            ast_emit_pretty(out, node->as.for_stmt.body, indent + 2);
             break;
             
         case AST_LOOP_STMT:
-            printf("LoopStmt\n");
-            ast_print(node->as.loop_stmt.body, indent + 1);
+            ast_emit_string(out, "LoopStmt\n");
+            ast_emit_pretty(out, node->as.loop_stmt.body, indent + 1);
             break;
             
         case AST_RETURN_STMT:
-            printf("ReturnStmt\n");
+            ast_emit_string(out, "ReturnStmt\n");
             if (node->as.return_stmt.value) {
-                ast_print(node->as.return_stmt.value, indent + 1);
+                ast_emit_pretty(out, node->as.return_stmt.value, indent + 1);
             }
             break;
             
         case AST_BREAK_STMT:
-            printf("BreakStmt\n");
+            ast_emit_string(out, "BreakStmt\n");
             break;
             
         case AST_CONTINUE_STMT:
-            printf("ContinueStmt\n");
+            ast_emit_string(out, "ContinueStmt\n");
             break;
             
         case AST_BLOCK_STMT:
-            printf("BlockStmt\n");
+            ast_emit_string(out, "BlockStmt\n");
             if (node->as.block.statements) {
                 for (size_t i = 0; i < node->as.block.statements->count; i++) {
-                    ast_print((AstNode*)node->as.block.statements->items[i], indent + 1);
+                    ast_emit_pretty(out, (AstNode*)node->as.block.statements->items[i], indent + 1);
                 }
             }
             break;
             
         case AST_FUNCTION_DECL:
-            printf("FunctionDecl (name: %s", node->as.function.name);
+            ast_emit_format(out, "FunctionDecl (name: %s", node->as.function.name);
             if (node->as.function.return_type) {
-                printf(", return: %s", node->as.function.return_type);
+                ast_emit_format(out, ", return: %s", node->as.function.return_type);
             }
-            printf(")\n");
-            print_indent(indent + 1);
-            printf("parameters:\n");
+            ast_emit_string(out, ")\n");
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "parameters:\n");
             if (node->as.function.parameters) {
                 for (size_t i = 0; i < node->as.function.parameters->count; i++) {
                     Parameter* param = (Parameter*)node->as.function.parameters->items[i];
-                    print_indent(indent + 2);
-                    printf("param: %s", param->name);
+                    ast_emit_indent(out, indent + 2);
+                    ast_emit_format(out, "param: %s", param->name);
                     if (param->type_name) {
-                        printf(": %s", param->type_name);
+                        ast_emit_format(out, ": %s", param->type_name);
                     }
                     if (param->default_value) {
-                        printf(" = ...");
+                        ast_emit_string(out, " = ...");
                     }
-                    printf("\n");
+                    ast_emit_string(out, "\n");
                 }
             }
-            print_indent(indent + 1);
-            printf("body:\n");
-            ast_print(node->as.function.body, indent + 2);
+            ast_emit_indent(out, indent + 1);
+            ast_emit_string(out, "body:\n");
+            if (node->as.function.body_pending) {
+                ast_emit_indent(out, indent + 2);
+                ast_emit_format(out, "(not parsed: tokens %zu..%zu)\n",
+                       node->as.function.body_tokens.start,
+                       node->as.function.body_tokens.end);
+            } else {
+                ast_emit_pretty(out, node->as.function.body, indent + 2);
+            }
             break;
             
         case AST_CLASS_DECL:
-            printf("ClassDecl (name: %s)\n", node->as.class_decl.name);
+            ast_emit_format(out, "ClassDecl (name: %s)\n", node->as.class_decl.name);
             if (node->as.class_decl.fields && node->as.class_decl.fields->count > 0) {
-                print_indent(indent + 1);
-                printf("fields:\n");
+                ast_emit_indent(out, indent + 1);
+                ast_emit_string(out, "fields:\n");
                 for (size_t i = 0; i < node->as.class_decl.fields->count; i++) {
-                    ast_print((AstNode*)node->as.class_decl.fields->items[i], indent + 2);
+                    ast_emit_pretty(out, (AstNode*)node->as.class_decl.fields->items[i], indent + 2);
                 }
             }
+            if (node->as.class_decl.layout && node->as.class_decl.layout->count > 0) {
+                print_class_layout(out, node, indent + 1);
+            }
             if (node->as.class_decl.methods && node->as.class_decl.methods->count > 0) {
-                print_indent(indent + 1);
-                printf("methods:\n");
+                ast_emit_indent(out, indent + 1);
+                ast_emit_string(out, "methods:\n");
                 for (size_t i = 0; i < node->as.class_decl.methods->count; i++) {
-                    ast_print((AstNode*)node->as.class_decl.methods->items[i], indent + 2);
+                    ast_emit_pretty(out, (AstNode*)node->as.class_decl.methods->items[i], indent + 2);
                 }
             }
             break;
             
         case AST_IMPORT_STMT:
-            printf("ImportStmt (module: %s)\n", node->as.import.module_name);
+            ast_emit_format(out, "ImportStmt (module: %s)\n", node->as.import.module_name);
             break;
             
         case AST_PROGRAM:
-            printf("Program\n");
+            ast_emit_string(out, "Program\n");
             if (node->as.program.declarations) {
                 for (size_t i = 0; i < node->as.program.declarations->count; i++) {
-                    ast_print((AstNode*)node->as.program.declarations->items[i], indent + 1);
+                    ast_emit_pretty(out, (AstNode*)node->as.program.declarations->items[i], indent + 1);
                 }
             }
             break;
     }
 }
 
+/* ===== stdout Wrappers ===== */
+
+/* Anything already in stdio's buffer goes out first */
+void ast_print(AstNode* node, int indent) {
+    AstEmitter out;
+    fflush(stdout);
+    ast_emitter_init(&out, STDOUT_FILENO);
+    ast_emit_pretty(&out, node, indent);
+    ast_emitter_free(&out);
+}
+
 void ast_print_program(AstNode* program) {
-    if (!program || program->type != AST_PROGRAM) {
-        printf("Error: Not a program node\n");
-        return;
-    }
-    
-    printf("===== LAMC Abstract Syntax Tree =====\n\n");
-    ast_print(program, 0);
-    printf("\n===== End of AST =====\n");
+    AstEmitter out;
+    fflush(stdout);
+    ast_emitter_init(&out, STDOUT_FILENO);
+    ast_emit_program(&out, program, AST_EMIT_PRETTY);
+    ast_emitter_free(&out);
 }
@@ -0,0 +1,242 @@
+/* LAMC Compiler - Diagnostics Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "diagnostics.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ===== Buffer ===== */
+
+void diag_buffer_init(DiagBuffer* diags) {
+    diags->items = NULL;
+    diags->count = 0;
+    diags->capacity = 0;
+    diags->error_count = 0;
+}
+
+void diag_buffer_free(DiagBuffer* diags) {
+    free(diags->items);
+    diag_buffer_init(diags);
+}
+
+bool diag_report(DiagBuffer* diags, const Diagnostic* diag) {
+    if (diags->count == diags->capacity) {
+        size_t capacity = diags->capacity ? diags->capacity * 2 : 16;
+        Diagnostic* grown = (Diagnostic*)realloc(diags->items, capacity * sizeof(Diagnostic));
+        if (!grown) return false;
+        diags->items = grown;
+        diags->capacity = capacity;
+    }
+
+    diags->items[diags->count++] = *diag;
+    if (diag->severity == DIAG_ERROR) diags->error_count++;
+    return true;
+}
+
+void diag_buffer_truncate(DiagBuffer* diags, size_t count) {
+    while (diags->count > count) {
+        if (diags->items[--diags->count].severity == DIAG_ERROR) diags->error_count--;
+    }
+}
+
+const char* diag_code_name(DiagCode code) {
+    switch (code) {
+        case DIAG_LEXICAL: return "E0001";
+        case DIAG_SYNTAX: return "E0100";
+        case DIAG_EXPECTED_TOKEN: return "E0101";
+        case DIAG_EXPECTED_EXPRESSION: return "E0102";
+        case DIAG_DUPLICATE_KEY: return "E0103";
+        case DIAG_NESTING_LIMIT: return "E0104";
+        case DIAG_UNDEFINED_NAME: return "E0200";
+        case DIAG_DUPLICATE_NAME: return "E0201";
+        case DIAG_IMPORT_CYCLE: return "E0202";
+        case DIAG_TYPE_CONFLICT: return "E0300";
+        case DIAG_ARGUMENT_COUNT: return "E0301";
+        case DIAG_OUT_OF_MEMORY: return "E0900";
+    }
+    return "E0000";
+}
+
+static const char* severity_name(DiagSeverity severity) {
+    switch (severity) {
+        case DIAG_ERROR: return "error";
+        case DIAG_WARNING: return "warning";
+        case DIAG_NOTE: return "note";
+    }
+    return "error";
+}
+
+/* ===== Source Locations ===== */
+
+/* Walks the source forward; diagnostics arrive mostly in order, so a
+ * batch costs one pass over the text */
+typedef struct {
+    const char* source;
+    const char* line_start;
+    int line;
+} LineCursor;
+
+/* Where a diagnostic points, resolved against the source */
+typedef struct {
+    int line;
+    const char* line_start;
+    size_t line_length;
+    size_t column;      /* 0-based byte column of the span */
+    size_t width;       /* Caret count, at least 1 */
+} SourceLocation;
+
+static void cursor_reset(LineCursor* cursor, const char* source) {
+    cursor->source = source;
+    cursor->line_start = source;
+    cursor->line = 1;
+}
+
+/* Move to the line containing position */
+static void cursor_seek_offset(LineCursor* cursor, const char* position) {
+    if (position < cursor->line_start) cursor_reset(cursor, cursor->source);
+
+    for (const char* p = cursor->line_start; p < position; p++) {
+        if (*p == '\n') {
+            cursor->line++;
+            cursor->line_start = p + 1;
+        }
+    }
+}
+
+/* Move to the start of a line number (or the last line) */
+static void cursor_seek_line(LineCursor* cursor, int line) {
+    if (line < cursor->line) cursor_reset(cursor, cursor->source);
+
+    while (cursor->line < line) {
+        const char* newline = strchr(cursor->line_start, '\n');
+        if (!newline) break;
+        cursor->line++;
+        cursor->line_start = newline + 1;
+    }
+}
+
+static SourceLocation locate(LineCursor* cursor, const Diagnostic* diag) {
+    SourceLocation loc;
+
+    if (diag->offset != DIAG_NO_OFFSET) {
+        const char* position = cursor->source + diag->offset;
+        cursor_seek_offset(cursor, position);
+        loc.column = (size_t)(position - cursor->line_start);
+        loc.width = diag->length;
+    } else {
+        /* The lexer's column is one past the offending character */
+        cursor_seek_line(cursor, diag->line);
+        loc.column = diag->column > 1 ? (size_t)(diag->column - 2) : 0;
+        loc.width = 1;
+    }
+
+    loc.line = cursor->line;
+    loc.line_start = cursor->line_start;
+    const char* newline = strchr(loc.line_start, '\n');
+    loc.line_length = newline ? (size_t)(newline - loc.line_start) : strlen(loc.line_start);
+
+    if (loc.column > loc.line_length) loc.column = loc.line_length;
+    if (loc.column + loc.width > loc.line_length) loc.width = loc.line_length - loc.column;
+    if (loc.width == 0) loc.width = 1;
+    return loc;
+}
+
+/* ===== Text Rendering ===== */
+
+static int digit_count(int value) {
+    int digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        digits++;
+    }
+    return digits;
+}
+
+void diag_render_text(const DiagBuffer* diags, const char* source, const char* path, FILE* out) {
+    LineCursor cursor;
+    cursor_reset(&cursor, source);
+    if (!path) path = "<input>";
+
+    for (size_t i = 0; i < diags->count; i++) {
+        const Diagnostic* diag = &diags->items[i];
+        SourceLocation loc = locate(&cursor, diag);
+        int gutter = digit_count(loc.line);
+
+        if (i > 0) fputc('\n', out);
+        fprintf(out, "%s[%s]: %s\n", severity_name(diag->severity),
+                diag_code_name(diag->code), diag->message);
+        fprintf(out, "%*s--> %s:%d:%zu\n", gutter, "", path, loc.line, loc.column + 1);
+        fprintf(out, "%*s |\n", gutter, "");
+        fprintf(out, "%*d | %.*s\n", gutter, loc.line, (int)loc.line_length, loc.line_start);
+
+        /* Carets under the span; tabs are kept so that they line up */
+        fprintf(out, "%*s | ", gutter, "");
+        for (size_t c = 0; c < loc.column; c++) {
+            fputc(loc.line_start[c] == '\t' ? '\t' : ' ', out);
+        }
+        for (size_t c = 0; c < loc.width; c++) {
+            fputc('^', out);
+        }
+
+        if (diag->found == TOKEN_EOF) {
+            fprintf(out, " at end");
+        } else if (diag->found != TOKEN_ERROR && diag->offset != DIAG_NO_OFFSET) {
+            fprintf(out, " found '%.*s'", (int)diag->length, source + diag->offset);
+        }
+        fputc('\n', out);
+    }
+}
+
+/* ===== JSON Rendering ===== */
+
+static void write_json_string(FILE* out, const char* text, size_t length) {
+    fputc('"', out);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        switch (c) {
+            case '"': fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if (c < 0x20) {
+                    fprintf(out, "\\u%04x", c);
+                } else {
+                    fputc(c, out);
+                }
+        }
+    }
+    fputc('"', out);
+}
+
+void diag_render_json(const DiagBuffer* diags, const char* source, const char* path, FILE* out) {
+    LineCursor cursor;
+    cursor_reset(&cursor, source);
+
+    fputs("[", out);
+    for (size_t i = 0; i < diags->count; i++) {
+        const Diagnostic* diag = &diags->items[i];
+        SourceLocation loc = locate(&cursor, diag);
+
+        fputs(i > 0 ? ",\n  {" : "\n  {", out);
+        fprintf(out, "\"severity\": \"%s\", \"code\": \"%s\", \"message\": ",
+                severity_name(diag->severity), diag_code_name(diag->code));
+        write_json_string(out, diag->message, strlen(diag->message));
+        fputs(", \"file\": ", out);
+        if (path) {
+            write_json_string(out, path, strlen(path));
+        } else {
+            fputs("null", out);
+        }
+        fprintf(out, ", \"line\": %d, \"column\": %zu", loc.line, loc.column + 1);
+        if (diag->offset != DIAG_NO_OFFSET) {
+            fprintf(out, ", \"offset\": %zu, \"length\": %zu", diag->offset, diag->length);
+        } else {
+            fputs(", \"offset\": null, \"length\": null", out);
+        }
+        fputc('}', out);
+    }
+    fputs(diags->count ? "\n]\n" : "]\n", out);
+}
@@ -0,0 +1,77 @@
+/* LAMC Compiler - Diagnostics
+ * In-memory diagnostic buffer with batched text and JSON rendering
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "../lexer/token.h"
+
+typedef enum {
+    DIAG_ERROR,
+    DIAG_WARNING,
+    DIAG_NOTE
+} DiagSeverity;
+
+/* Stable codes, rendered as E0001 etc. */
+typedef enum {
+    DIAG_LEXICAL,              /* E0001: invalid character, unterminated string */
+    DIAG_SYNTAX,               /* E0100: malformed construct */
+    DIAG_EXPECTED_TOKEN,       /* E0101: a specific token was required */
+    DIAG_EXPECTED_EXPRESSION,  /* E0102: an expression was required */
+    DIAG_DUPLICATE_KEY,        /* E0103: a dictionary literal repeats a key */
+    DIAG_NESTING_LIMIT,        /* E0104: input nested deeper than the parser allows */
+    DIAG_UNDEFINED_NAME,       /* E0200: a name is used where nothing declares it */
+    DIAG_DUPLICATE_NAME,       /* E0201: a function, class or parameter name is reused */
+    DIAG_IMPORT_CYCLE,         /* E0202: a module imports itself through its imports */
+    DIAG_TYPE_CONFLICT,        /* E0300: a value is given incompatible types and falls back to dynamic */
+    DIAG_ARGUMENT_COUNT,       /* E0301: a call passes too few or too many arguments */
+    DIAG_OUT_OF_MEMORY         /* E0900 */
+} DiagCode;
+
+/* Offset of a diagnostic whose byte span is not known */
+#define DIAG_NO_OFFSET ((size_t)-1)
+
+/* One diagnostic, stored unformatted. message is static text; the
+ * offending token is kept as a span and quoted only when rendering. */
+typedef struct {
+    DiagSeverity severity;
+    DiagCode code;
+    const char* message;
+    TokenType found;    /* Type of the token the diagnostic points at */
+    size_t offset;      /* Byte span in the source, DIAG_NO_OFFSET if unknown */
+    size_t length;
+    int line;           /* Line and column as reported by the lexer */
+    int column;
+} Diagnostic;
+
+typedef struct {
+    Diagnostic* items;
+    size_t count;
+    size_t capacity;
+    size_t error_count;
+} DiagBuffer;
+
+void diag_buffer_init(DiagBuffer* diags);
+void diag_buffer_free(DiagBuffer* diags);
+
+/* Append a copy of diag; no formatting or I/O happens here.
+ * Returns false when out of memory (the diagnostic is dropped). */
+bool diag_report(DiagBuffer* diags, const Diagnostic* diag);
+
+/* Drop every diagnostic after the first count */
+void diag_buffer_truncate(DiagBuffer* diags, size_t count);
+
+/* "E0102" etc. */
+const char* diag_code_name(DiagCode code);
+
+/* Render every diagnostic in one batch. source is the text the spans
+ * refer to; path names it in the output (may be NULL). */
+void diag_render_text(const DiagBuffer* diags, const char* source, const char* path, FILE* out);
+void diag_render_json(const DiagBuffer* diags, const char* source, const char* path, FILE* out);
+
+#endif /* DIAGNOSTICS_H */
@@ -0,0 +1,339 @@
+/* LAMC Compiler - Incremental Reparsing Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "incremental.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ===== Shifting ===== */
+
+typedef struct {
+    int lines;        /* Added to every line number */
+    ptrdiff_t bytes;  /* Added to every span offset */
+    ptrdiff_t tokens; /* Added to every lazy body token range */
+} Shift;
+
+static void shift_node(AstNode* node, void* context) {
+    /* Shared nodes stand for several positions at once */
+    if (!node || (node->flags & AST_FLAG_INTERNED)) return;
+
+    Shift* shift = (Shift*)context;
+    node->line += shift->lines;
+    node->offset = (uint32_t)((ptrdiff_t)node->offset + shift->bytes);
+    if (node->type == AST_FUNCTION_DECL && node->as.function.body_pending) {
+        node->as.function.body_tokens.start += (size_t)shift->tokens;
+        node->as.function.body_tokens.end += (size_t)shift->tokens;
+    }
+    ast_visit_children(node, shift_node, context);
+}
+
+/* ===== Source Helpers ===== */
+
+static size_t token_offset(const TokenBuffer* tokens, size_t index) {
+    return (size_t)(tokens->tokens[index].start - tokens->source);
+}
+
+static size_t token_end_offset(const TokenBuffer* tokens, size_t index) {
+    return token_offset(tokens, index) + tokens->tokens[index].length;
+}
+
+static int count_newlines(const char* text, size_t length) {
+    int count = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '\n') count++;
+    }
+    return count;
+}
+
+/* ===== Fallback ===== */
+
+static AstNode* full_reparse(AstNode* program, TokenBuffer* tokens, const char* new_source,
+                             bool relex, ReparseStats* stats) {
+    ast_free_node(program);
+    if (relex) {
+        token_buffer_free(tokens);
+        if (!token_buffer_lex(tokens, new_source)) return NULL;
+    }
+    if (stats) {
+        stats->reused = 0;
+        stats->reparsed = 0;
+        stats->relexed_tokens = tokens->count;
+        stats->full_reparse = true;
+    }
+
+    Parser parser;
+    parser_init_tokens(&parser, tokens, 0);
+    AstNode* result = parser_parse(&parser);
+    if (stats && result) stats->reparsed = result->as.program.declarations->count;
+    return result;
+}
+
+/* ===== Incremental Reparse ===== */
+
+AstNode* parser_reparse(AstNode* program, TokenBuffer* tokens, const char* new_source,
+                        SourceEdit edit, ReparseStats* stats) {
+    if (!program || program->type != AST_PROGRAM || !program->as.program.decl_tokens) {
+        return full_reparse(program, tokens, new_source, true, stats);
+    }
+
+    AstList* old_decls = program->as.program.declarations;
+    TokenRange* old_ranges = program->as.program.decl_tokens;
+    size_t decl_count = old_decls->count;
+    size_t old_eof = tokens->count - 1;
+    const char* old_source = tokens->source;
+    size_t old_edit_end = edit.start + edit.removed;
+    ptrdiff_t byte_delta = (ptrdiff_t)edit.inserted - (ptrdiff_t)edit.removed;
+
+    /* Declarations ending before the edit are kept as they are. The parser
+     * ended each one on seeing the token after it (range.end), so that
+     * token must lie before the edit too: "x = a" followed by an inserted
+     * "(b)" becomes a call. */
+    size_t lo = 0;
+    while (lo < decl_count && token_end_offset(tokens, old_ranges[lo].end) < edit.start) lo++;
+
+    /* Relexing resumes right after the last kept token, in the state the
+     * lexer had there (a token carries the line and column after it) */
+    size_t region_start = lo > 0 ? old_ranges[lo - 1].end : 0;
+    Lexer lexer;
+    lexer_init(&lexer, new_source);
+    if (region_start > 0) {
+        Token* last = &tokens->tokens[region_start - 1];
+        lexer.start = lexer.current = new_source + token_end_offset(tokens, region_start - 1);
+        lexer.line = last->line;
+        lexer.column = last->column;
+    }
+
+    /* Declarations after the edit may be reused once the relexed stream
+     * lines up with theirs. They must start on a later line than the
+     * edit ends on, so that only their line numbers change. */
+    size_t hi = lo;
+    while (hi < decl_count &&
+           (token_offset(tokens, old_ranges[hi].start) <= old_edit_end ||
+            !memchr(old_source + old_edit_end, '\n',
+                    token_offset(tokens, old_ranges[hi].start) - old_edit_end))) {
+        hi++;
+    }
+
+    /* Relex until a token starts where a reusable declaration starts */
+    size_t new_edit_end = edit.start + edit.inserted;
+    Token* relexed = NULL;
+    size_t relexed_count = 0;
+    size_t relexed_capacity = 0;
+
+    for (;;) {
+        Token token = lexer_next_token(&lexer);
+        size_t offset = (size_t)(token.start - new_source);
+
+        if (token.type == TOKEN_EOF) {
+            hi = decl_count;
+            break;
+        }
+        if (offset >= new_edit_end) {
+            size_t old_offset = (size_t)((ptrdiff_t)offset - byte_delta);
+            while (hi < decl_count && token_offset(tokens, old_ranges[hi].start) < old_offset) hi++;
+            if (hi < decl_count && token_offset(tokens, old_ranges[hi].start) == old_offset) break;
+        }
+
+        if (relexed_count == relexed_capacity) {
+            relexed_capacity = relexed_capacity ? relexed_capacity * 2 : 64;
+            Token* grown = (Token*)realloc(relexed, relexed_capacity * sizeof(Token));
+            if (!grown) {
+                free(relexed);
+                return full_reparse(program, tokens, new_source, true, stats);
+            }
+            relexed = grown;
+        }
+        relexed[relexed_count++] = token;
+    }
+
+    /* Splice the relexed tokens into the buffer and move every kept token
+     * into the new source */
+    size_t region_end = hi < decl_count ? old_ranges[hi].start : old_eof;
+    size_t old_region_count = region_end - region_start;
+    size_t suffix_count = tokens->count - region_end;
+    size_t new_count = region_start + relexed_count + suffix_count;
+    ptrdiff_t token_delta = (ptrdiff_t)relexed_count - (ptrdiff_t)old_region_count;
+    int line_delta = count_newlines(new_source + edit.start, edit.inserted) -
+                     count_newlines(old_source + edit.start, edit.removed);
+
+    if (new_count > tokens->capacity) {
+        /* Headroom, so that typing does not copy the buffer every time */
+        size_t capacity = new_count + new_count / 8;
+        Token* grown = (Token*)realloc(tokens->tokens, capacity * sizeof(Token));
+        if (!grown) {
+            free(relexed);
+            return full_reparse(program, tokens, new_source, true, stats);
+        }
+        tokens->tokens = grown;
+        tokens->capacity = capacity;
+    }
+
+    memmove(tokens->tokens + region_start + relexed_count, tokens->tokens + region_end,
+            suffix_count * sizeof(Token));
+    if (relexed_count > 0) {
+        memcpy(tokens->tokens + region_start, relexed, relexed_count * sizeof(Token));
+    }
+    free(relexed);
+
+    for (size_t i = 0; i < region_start; i++) {
+        tokens->tokens[i].start = new_source + (tokens->tokens[i].start - old_source);
+    }
+    for (size_t i = region_start + relexed_count; i < new_count; i++) {
+        Token* token = &tokens->tokens[i];
+        token->start = new_source + (token->start - old_source) + byte_delta;
+        token->line += line_delta;
+    }
+    tokens->count = new_count;
+    tokens->source = new_source;
+
+    /* Parse the relexed region silently; any error is reported by the
+     * full reparse instead, exactly as parser_parse() reports it */
+    size_t new_region_end = region_start + relexed_count;
+    AstList* region_decls = ast_list_create();
+    TokenRange* region_ranges = NULL;
+    size_t range_capacity = 0;
+    bool ok = tokens->tokens[region_start].type != TOKEN_ERROR;
+
+    if (ok) {
+        Parser parser;
+        parser_init_tokens(&parser, tokens, region_start);
+        parser.silent = true;
+
+        while (!parser_is_at_end(&parser) && parser.position - 1 < new_region_end) {
+            size_t start = parser.position - 1;
+            AstNode* decl = parser_parse_declaration(&parser);
+            if (decl) {
+                ast_list_append(region_decls, decl);
+
+                if (region_decls->count > range_capacity) {
+                    range_capacity = range_capacity ? range_capacity * 2 : 8;
+                    TokenRange* grown = (TokenRange*)realloc(region_ranges, range_capacity * sizeof(TokenRange));
+                    if (!grown) {
+                        parser.had_error = true;
+                        break;
+                    }
+                    region_ranges = grown;
+                }
+                region_ranges[region_decls->count - 1].start = start;
+                region_ranges[region_decls->count - 1].end = parser.position - 1;
+            }
+            if (parser.panic_mode) break;
+        }
+        ok = !parser.had_error && parser.position - 1 == new_region_end;
+        parser_free(&parser);
+    }
+
+    size_t new_decl_count = lo + region_decls->count + (decl_count - hi);
+    TokenRange* new_ranges = ok ? (TokenRange*)malloc((new_decl_count ? new_decl_count : 1) * sizeof(TokenRange)) : NULL;
+
+    if (!new_ranges) {
+        for (size_t i = 0; i < region_decls->count; i++) {
+            ast_free_node((AstNode*)region_decls->items[i]);
+        }
+        ast_list_free(region_decls);
+        free(region_ranges);
+        return full_reparse(program, tokens, new_source, false, stats);
+    }
+
+    /* Assemble: kept prefix, reparsed region, shifted suffix */
+    AstList* declarations = ast_list_create();
+    Shift shift = { line_delta, byte_delta, token_delta };
+
+    for (size_t i = 0; i < lo; i++) {
+        ast_list_append(declarations, old_decls->items[i]);
+        new_ranges[i] = old_ranges[i];
+    }
+    for (size_t i = lo; i < hi; i++) {
+        ast_free_node((AstNode*)old_decls->items[i]);
+    }
+    for (size_t i = 0; i < region_decls->count; i++) {
+        ast_list_append(declarations, region_decls->items[i]);
+        new_ranges[lo + i] = region_ranges[i];
+    }
+    for (size_t i = hi; i < decl_count; i++) {
+        AstNode* decl = (AstNode*)old_decls->items[i];
+        if (line_delta != 0 || byte_delta != 0 || token_delta != 0) shift_node(decl, &shift);
+        ast_list_append(declarations, decl);
+
+        TokenRange* range = &new_ranges[declarations->count - 1];
+        range->start = (size_t)((ptrdiff_t)old_ranges[i].start + token_delta);
+        range->end = (size_t)((ptrdiff_t)old_ranges[i].end + token_delta);
+    }
+
+    if (stats) {
+        stats->reused = decl_count - (hi - lo);
+        stats->reparsed = region_decls->count;
+        stats->relexed_tokens = relexed_count;
+        stats->full_reparse = false;
+    }
+
+    ast_list_free(region_decls);
+    free(region_ranges);
+
+    /* The old root gives up its declarations and arenas */
+    AstNode* result = ast_create_program(declarations);
+    result->length = (uint32_t)token_offset(tokens, tokens->count - 1);
+    result->as.program.decl_tokens = new_ranges;
+    result->as.program.arenas = program->as.program.arenas;
+    program->as.program.arenas = NULL;
+    old_decls->count = 0;
+    ast_free_node(program);
+    return result;
+}
+
+/* ===== Oracle ===== */
+
+typedef struct {
+    long* values;   /* Line, column, offset and length of each node in preorder */
+    size_t count;
+    size_t capacity;
+    bool failed;
+} PositionLog;
+
+static void log_position(AstNode* node, void* context) {
+    if (!node) return;
+
+    PositionLog* log = (PositionLog*)context;
+    if (log->count + 4 > log->capacity) {
+        size_t capacity = log->capacity ? log->capacity * 2 : 256;
+        long* grown = (long*)realloc(log->values, capacity * sizeof(long));
+        if (!grown) {
+            log->failed = true;
+            return;
+        }
+        log->values = grown;
+        log->capacity = capacity;
+    }
+    log->values[log->count++] = node->line;
+    log->values[log->count++] = node->column;
+    log->values[log->count++] = node->offset;
+    log->values[log->count++] = node->length;
+    ast_visit_children(node, log_position, context);
+}
+
+bool parser_reparse_matches_full(AstNode* program, TokenBuffer* tokens) {
+    Parser parser;
+    parser_init_tokens(&parser, tokens, 0);
+    parser.silent = true;
+    AstNode* full = parser_parse(&parser);
+
+    if (!program || !full) {
+        ast_free_node(full);
+        return program == full;
+    }
+
+    bool same = ast_equal(program, full);
+    if (same) {
+        PositionLog a = {0}, b = {0};
+        log_position(program, &a);
+        log_position(full, &b);
+        same = !a.failed && !b.failed && a.count == b.count &&
+               memcmp(a.values, b.values, a.count * sizeof(long)) == 0;
+        free(a.values);
+        free(b.values);
+    }
+
+    ast_free_node(full);
+    return same;
+}
@@ -0,0 +1,50 @@
+/* LAMC Compiler - Incremental Reparsing
+ * Reparses the top-level declarations touched by an edit
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "parser.h"
+
+/* A text edit: bytes [start, start + removed) of the old source were
+ * replaced by inserted bytes, which begin at start in the new source */
+typedef struct {
+    size_t start;
+    size_t removed;
+    size_t inserted;
+} SourceEdit;
+
+/* What an incremental reparse did */
+typedef struct {
+    size_t reused;          /* Declarations kept from the old tree */
+    size_t reparsed;        /* Declarations parsed from relexed tokens */
+    size_t relexed_tokens;  /* Tokens produced by relexing the edited region */
+    bool full_reparse;      /* Fell back to lexing and parsing everything */
+} ReparseStats;
+
+/* Update program and tokens after an edit of their source.
+ *
+ * program must come from a token-buffer parse of tokens (see
+ * Program.decl_tokens), and the old source tokens->source must stay
+ * valid until the call returns. Only the declarations overlapping the
+ * edit (widened until the relexed tokens line up with the old ones
+ * again) are parsed; all others are moved into the new tree, the ones
+ * after the edit with their line numbers, byte spans and lazy body
+ * ranges shifted.
+ * Hash-consed (shared) nodes keep their positions.
+ *
+ * On return tokens describes new_source. The old program is consumed;
+ * the result is what parser_parse() would return for the new tokens,
+ * including NULL and printed diagnostics on errors. Reparsed bodies are
+ * always parsed eagerly. stats may be NULL. */
+AstNode* parser_reparse(AstNode* program, TokenBuffer* tokens, const char* new_source,
+                        SourceEdit edit, ReparseStats* stats);
+
+/* Correctness oracle: true when program equals a full parse of tokens,
+ * structurally and in every node position and span (NULL matches a failed
+ * parse). Meant for eagerly parsed trees without hash-consing. */
+bool parser_reparse_matches_full(AstNode* program, TokenBuffer* tokens);
+
+#endif /* INCREMENTAL_H */
@@ -0,0 +1,136 @@
+/* LAMC Compiler - String Interning
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "intern.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERN_INITIAL_CAPACITY 256
+
+typedef struct {
+    const char* start;
+    uint32_t length;
+    uint32_t hash;
+} InternEntry;
+
+struct StringInterner {
+    uint32_t* slots;         /* Entry index + 1, 0 for empty slots */
+    size_t capacity;         /* Always a power of two */
+    InternEntry* entries;    /* Indexed by id - 1 */
+    size_t count;
+    size_t entry_capacity;
+};
+
+/* FNV-1a, folded to 32 bits */
+static uint32_t hash_span(const char* start, size_t length) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)start[i];
+        h *= 0x100000001b3ULL;
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+/* ===== Table Management ===== */
+
+StringInterner* string_interner_create(void) {
+    StringInterner* interner = (StringInterner*)calloc(1, sizeof(StringInterner));
+    if (!interner) return NULL;
+
+    interner->slots = (uint32_t*)calloc(INTERN_INITIAL_CAPACITY, sizeof(uint32_t));
+    if (!interner->slots) {
+        free(interner);
+        return NULL;
+    }
+    interner->capacity = INTERN_INITIAL_CAPACITY;
+    return interner;
+}
+
+void string_interner_free(StringInterner* interner) {
+    if (!interner) return;
+    free(interner->slots);
+    free(interner->entries);
+    free(interner);
+}
+
+static bool table_grow(StringInterner* interner) {
+    size_t new_capacity = interner->capacity * 2;
+    uint32_t* new_slots = (uint32_t*)calloc(new_capacity, sizeof(uint32_t));
+    if (!new_slots) return false;
+
+    size_t mask = new_capacity - 1;
+    for (size_t i = 0; i < interner->count; i++) {
+        size_t slot = interner->entries[i].hash & mask;
+        while (new_slots[slot]) slot = (slot + 1) & mask;
+        new_slots[slot] = (uint32_t)(i + 1);
+    }
+
+    free(interner->slots);
+    interner->slots = new_slots;
+    interner->capacity = new_capacity;
+    return true;
+}
+
+/* ===== Interning ===== */
+
+/* Slot holding the spelling, or the empty slot ending its probe */
+static size_t find_slot(const StringInterner* interner, const char* start, size_t length, uint32_t hash) {
+    size_t mask = interner->capacity - 1;
+    size_t slot = hash & mask;
+
+    while (interner->slots[slot]) {
+        const InternEntry* entry = &interner->entries[interner->slots[slot] - 1];
+        if (entry->hash == hash && entry->length == length &&
+            memcmp(entry->start, start, length) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+uint32_t string_interner_find(const StringInterner* interner, const char* start, size_t length) {
+    return interner->slots[find_slot(interner, start, length, hash_span(start, length))];
+}
+
+uint32_t string_intern(StringInterner* interner, const char* start, size_t length) {
+    uint32_t hash = hash_span(start, length);
+    size_t slot = find_slot(interner, start, length, hash);
+    if (interner->slots[slot]) return interner->slots[slot];
+
+    /* Keep the load factor under 1/2 */
+    if ((interner->count + 1) * 2 > interner->capacity) {
+        if (!table_grow(interner)) return 0;
+        size_t mask = interner->capacity - 1;
+        slot = hash & mask;
+        while (interner->slots[slot]) slot = (slot + 1) & mask;
+    }
+
+    if (interner->count == interner->entry_capacity) {
+        size_t capacity = interner->entry_capacity ? interner->entry_capacity * 2 : 64;
+        InternEntry* grown = (InternEntry*)realloc(interner->entries, capacity * sizeof(InternEntry));
+        if (!grown) return 0;
+        interner->entries = grown;
+        interner->entry_capacity = capacity;
+    }
+
+    InternEntry* entry = &interner->entries[interner->count++];
+    entry->start = start;
+    entry->length = (uint32_t)length;
+    entry->hash = hash;
+    interner->slots[slot] = (uint32_t)interner->count;
+    return (uint32_t)interner->count;
+}
+
+const char* string_interner_lookup(const StringInterner* interner, uint32_t id, size_t* length) {
+    if (id == 0 || id > interner->count) return NULL;
+
+    const InternEntry* entry = &interner->entries[id - 1];
+    if (length) *length = entry->length;
+    return entry->start;
+}
+
+size_t string_interner_count(const StringInterner* interner) {
+    return interner->count;
+}
@@ -0,0 +1,33 @@
+/* LAMC Compiler - String Interning
+ * Maps identifier spellings in a source text to small integer ids
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Open-addressing table of (pointer, length) keys into a source text.
+ * Spellings are not copied, so the text must outlive the interner; the
+ * only allocations are the table itself and its growth. Ids are dense
+ * and start at 1; 0 never names a string. */
+typedef struct StringInterner StringInterner;
+
+StringInterner* string_interner_create(void);
+void string_interner_free(StringInterner* interner);
+
+/* Id of the spelling, adding it on first sight; 0 when out of memory */
+uint32_t string_intern(StringInterner* interner, const char* start, size_t length);
+
+/* Id of the spelling if it was interned, else 0; never adds it */
+uint32_t string_interner_find(const StringInterner* interner, const char* start, size_t length);
+
+/* Spelling of an id, NULL for an id that was never returned */
+const char* string_interner_lookup(const StringInterner* interner, uint32_t id, size_t* length);
+
+size_t string_interner_count(const StringInterner* interner);
+
+#endif /* INTERN_H */
@@ -0,0 +1,318 @@
+/* LAMC Compiler - Parallel Parser Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "parallel.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Chunks per worker, so that uneven declarations still balance */
+#define CHUNKS_PER_THREAD 8
+#define MIN_CHUNK_TOKENS 256
+
+/* A run of whole top-level declarations */
+typedef struct {
+    size_t start;       /* Token index of the first declaration */
+    size_t end;         /* Token index where the next chunk starts */
+    AstList* decls;     /* Parsed declarations (worker arena) */
+    TokenRange* ranges; /* Token range of each declaration */
+    bool ok;            /* Parsed without errors and ended exactly at end */
+} Chunk;
+
+typedef struct {
+    TokenBuffer* tokens;
+    Chunk* chunks;
+    size_t chunk_count;
+    atomic_size_t next_chunk;
+} WorkQueue;
+
+typedef struct {
+    WorkQueue* queue;
+    AstArena* arena;
+    pthread_t thread;
+    bool started;
+} Worker;
+
+/* ===== Partitioning ===== */
+
+/* Token indices of 'func' at bracket depth 0; index 0 is always a boundary */
+static size_t scan_boundaries(TokenBuffer* tokens, size_t** out) {
+    size_t capacity = 64;
+    size_t count = 0;
+    size_t* boundaries = (size_t*)malloc(capacity * sizeof(size_t));
+    if (!boundaries) return 0;
+
+    boundaries[count++] = 0;
+    long depth = 0;
+
+    for (size_t i = 0; i < tokens->count; i++) {
+        switch (tokens->tokens[i].type) {
+            case TOKEN_LEFT_BRACE:
+            case TOKEN_LEFT_PAREN:
+            case TOKEN_LEFT_BRACKET:
+                depth++;
+                break;
+            case TOKEN_RIGHT_BRACE:
+            case TOKEN_RIGHT_PAREN:
+            case TOKEN_RIGHT_BRACKET:
+                if (depth > 0) depth--;
+                break;
+            case TOKEN_FUNC:
+                if (depth == 0 && i > 0) {
+                    if (count == capacity) {
+                        capacity *= 2;
+                        size_t* grown = (size_t*)realloc(boundaries, capacity * sizeof(size_t));
+                        if (!grown) {
+                            free(boundaries);
+                            return 0;
+                        }
+                        boundaries = grown;
+                    }
+                    boundaries[count++] = i;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    *out = boundaries;
+    return count;
+}
+
+/* Group consecutive declarations into chunks of roughly equal size */
+static size_t build_chunks(TokenBuffer* tokens, const size_t* boundaries, size_t boundary_count,
+                           int thread_count, Chunk** out) {
+    size_t eof_index = tokens->count - 1;
+    size_t target = eof_index / ((size_t)thread_count * CHUNKS_PER_THREAD);
+    if (target < MIN_CHUNK_TOKENS) target = MIN_CHUNK_TOKENS;
+
+    Chunk* chunks = (Chunk*)calloc(boundary_count, sizeof(Chunk));
+    if (!chunks) return 0;
+
+    size_t count = 0;
+    size_t start = boundaries[0];
+    for (size_t i = 1; i <= boundary_count; i++) {
+        size_t end = i < boundary_count ? boundaries[i] : eof_index;
+        if (end - start >= target || i == boundary_count) {
+            chunks[count].start = start;
+            chunks[count].end = end;
+            count++;
+            start = end;
+        }
+    }
+
+    *out = chunks;
+    return count;
+}
+
+/* ===== Workers ===== */
+
+static void parse_chunk(TokenBuffer* tokens, Chunk* chunk) {
+    /* Priming the parser would report this before it can be silenced */
+    if (tokens->tokens[chunk->start].type == TOKEN_ERROR) {
+        chunk->ok = false;
+        return;
+    }
+
+    Parser parser;
+    parser_init_tokens(&parser, tokens, chunk->start);
+    parser.silent = true;
+
+    chunk->decls = ast_list_create();
+    size_t range_capacity = 0;
+
+    /* Same loop as parser_parse(), bounded by the chunk */
+    while (!parser_is_at_end(&parser) && parser.position - 1 < chunk->end) {
+        size_t start = parser.position - 1;
+        AstNode* decl = parser_parse_declaration(&parser);
+        if (decl) {
+            ast_list_append(chunk->decls, decl);
+
+            if (chunk->decls->count > range_capacity) {
+                range_capacity = range_capacity ? range_capacity * 2 : 16;
+                TokenRange* grown = (TokenRange*)realloc(chunk->ranges, range_capacity * sizeof(TokenRange));
+                if (!grown) {
+                    parser.had_error = true;
+                    break;
+                }
+                chunk->ranges = grown;
+            }
+            chunk->ranges[chunk->decls->count - 1].start = start;
+            chunk->ranges[chunk->decls->count - 1].end = parser.position - 1;
+        }
+        if (parser.panic_mode) break;
+    }
+
+    chunk->ok = !parser.had_error && parser.position - 1 == chunk->end;
+    parser_free(&parser);
+}
+
+static void* worker_main(void* arg) {
+    Worker* worker = (Worker*)arg;
+    WorkQueue* queue = worker->queue;
+    AstArena* previous = ast_use_arena(worker->arena);
+
+    for (;;) {
+        size_t index = atomic_fetch_add(&queue->next_chunk, 1);
+        if (index >= queue->chunk_count) break;
+        parse_chunk(queue->tokens, &queue->chunks[index]);
+    }
+
+    ast_use_arena(previous);
+    return NULL;
+}
+
+/* ===== Merging ===== */
+
+/* Append count ranges to the array holding existing ranges */
+static bool append_ranges(TokenRange** ranges, size_t existing, const TokenRange* more, size_t count) {
+    if (count == 0) return true;
+    if (!more) return false;
+
+    TokenRange* grown = (TokenRange*)realloc(*ranges, (existing + count) * sizeof(TokenRange));
+    if (!grown) return false;
+
+    memcpy(grown + existing, more, count * sizeof(TokenRange));
+    *ranges = grown;
+    return true;
+}
+
+static void free_chunks(Chunk* chunks, size_t chunk_count) {
+    for (size_t i = 0; i < chunk_count; i++) {
+        free(chunks[i].ranges);
+    }
+    free(chunks);
+}
+
+/* ===== Main Entry Point ===== */
+
+/* parser_parse() of the tokens from start on */
+static AstNode* parse_sequential(TokenBuffer* tokens, size_t start, DiagBuffer* diags) {
+    Parser parser;
+    parser_init_tokens(&parser, tokens, start);
+    parser_set_diagnostics(&parser, diags);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+    return program;
+}
+
+AstNode* parser_parse_parallel(TokenBuffer* tokens, int thread_count, DiagBuffer* diags, ParallelParseStats* stats) {
+    if (thread_count < 1) thread_count = 1;
+
+    size_t* boundaries = NULL;
+    size_t boundary_count = scan_boundaries(tokens, &boundaries);
+    Chunk* chunks = NULL;
+    size_t chunk_count = boundary_count
+        ? build_chunks(tokens, boundaries, boundary_count, thread_count, &chunks)
+        : 0;
+    free(boundaries);
+
+    if (chunk_count == 0) {
+        /* Out of memory: the sequential parser still works */
+        free(chunks);
+        return parse_sequential(tokens, 0, diags);
+    }
+
+    if ((size_t)thread_count > chunk_count) thread_count = (int)chunk_count;
+    Worker* workers = (Worker*)calloc((size_t)thread_count, sizeof(Worker));
+    int ready = 0;
+    while (workers && ready < thread_count && (workers[ready].arena = ast_arena_create()) != NULL) ready++;
+    if (ready == 0) {
+        free(workers);
+        free_chunks(chunks, chunk_count);
+        return parse_sequential(tokens, 0, diags);
+    }
+    thread_count = ready;
+
+    WorkQueue queue;
+    queue.tokens = tokens;
+    queue.chunks = chunks;
+    queue.chunk_count = chunk_count;
+    atomic_init(&queue.next_chunk, 0);
+
+    for (int i = 0; i < thread_count; i++) workers[i].queue = &queue;
+
+    /* The calling thread is worker 0; it keeps taking chunks until none
+     * are left, so it also parses those of a thread that failed to start */
+    for (int i = 1; i < thread_count; i++) {
+        workers[i].started = pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) == 0;
+    }
+    worker_main(&workers[0]);
+    for (int i = 1; i < thread_count; i++) {
+        if (workers[i].started) pthread_join(workers[i].thread, NULL);
+    }
+
+    /* Merge in source order up to the first failed chunk */
+    AstArena* arenas = NULL;
+    for (int i = 0; i < thread_count; i++) {
+        if (arenas) {
+            ast_arena_chain(arenas, workers[i].arena);
+        } else {
+            arenas = workers[i].arena;
+        }
+    }
+    free(workers);
+
+    AstList* declarations = ast_list_create();
+    TokenRange* ranges = NULL;
+    size_t range_count = 0;
+    size_t failed = chunk_count;
+    for (size_t i = 0; i < chunk_count; i++) {
+        if (!chunks[i].ok) {
+            failed = i;
+            break;
+        }
+        if (!append_ranges(&ranges, range_count, chunks[i].ranges, chunks[i].decls->count)) {
+            failed = i;
+            break;
+        }
+        range_count += chunks[i].decls->count;
+        for (size_t j = 0; j < chunks[i].decls->count; j++) {
+            ast_list_append(declarations, chunks[i].decls->items[j]);
+        }
+    }
+
+    if (stats) {
+        stats->declarations = boundary_count;
+        stats->chunks = chunk_count;
+        stats->fallback_chunk = failed;
+        stats->threads = thread_count;
+    }
+
+    /* Reparse the rest sequentially so errors match parser_parse() */
+    if (failed < chunk_count) {
+        AstNode* rest = parse_sequential(tokens, chunks[failed].start, diags);
+
+        if (!rest) {
+            ast_list_free(declarations);
+            ast_arena_free(arenas);
+            free(ranges);
+            free_chunks(chunks, chunk_count);
+            return NULL;
+        }
+
+        AstList* rest_decls = rest->as.program.declarations;
+        if (append_ranges(&ranges, range_count, rest->as.program.decl_tokens, rest_decls->count)) {
+            range_count += rest_decls->count;
+        } else {
+            free(ranges);
+            ranges = NULL;
+        }
+        for (size_t j = 0; j < rest_decls->count; j++) {
+            ast_list_append(declarations, rest_decls->items[j]);
+        }
+        rest_decls->count = 0;
+        ast_free_node(rest);
+    }
+
+    free_chunks(chunks, chunk_count);
+
+    AstNode* program = ast_create_program(declarations);
+    program->length = (uint32_t)(tokens->tokens[tokens->count - 1].start - tokens->source);
+    program->as.program.arenas = arenas;
+    program->as.program.decl_tokens = ranges;
+    return program;
+}
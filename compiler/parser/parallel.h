@@ -0,0 +1,35 @@
+/* LAMC Compiler - Parallel Parser
+ * Parses top-level declarations of a token buffer on several threads
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "parser.h"
+
+/* What the parallel parse did */
+typedef struct {
+    size_t declarations;    /* Top-level declaration boundaries found by the scan */
+    size_t chunks;          /* Groups of declarations handed to workers */
+    size_t fallback_chunk;  /* First chunk reparsed sequentially, == chunks if none */
+    int threads;            /* Worker threads used */
+} ParallelParseStats;
+
+/* Parse a whole token buffer like parser_parse(), splitting it at
+ * top-level 'func' declarations found by a brace-depth scan. Each worker
+ * parses its chunks into an arena of its own; the merge assembles the
+ * program in source order and takes ownership of the arenas.
+ *
+ * Errors behave exactly like the sequential parser: workers parse
+ * silently, and from the first chunk that fails (or does not end on its
+ * boundary) the rest of the buffer is reparsed sequentially, which
+ * reports the same diagnostics and yields NULL on error. They go to diags
+ * as with parser_set_diagnostics(), or are printed when it is NULL.
+ *
+ * A worker thread that fails to start leaves its chunks to the calling
+ * thread. stats may be NULL. Hash-consing and lazy bodies are not
+ * supported. */
+AstNode* parser_parse_parallel(TokenBuffer* tokens, int thread_count, DiagBuffer* diags, ParallelParseStats* stats);
+
+#endif /* PARALLEL_H */
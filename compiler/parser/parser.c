@@ -4,42 +4,252 @@
  */
 
 #include "parser.h"
+#include "parser_events.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-/* Helper to duplicate a substring */
-static char* string_dup_n(const char* str, size_t len) {
-    char* result = (char*)malloc(len + 1);
-    if (!result) return NULL;
+/* Token text is only needed until a constructor has copied it, so short
+ * text goes into the caller's buffer and only longer text to the heap */
+#define TEXT_INLINE 64
+
+static char* token_text(const char* str, size_t len, char* buffer) {
+    char* result = buffer;
+    if (len >= TEXT_INLINE) {
+        result = (char*)malloc(len + 1);
+        if (!result) return NULL;
+        STATS_BYTES(STATS_BYTES_SCRATCH, len + 1);
+    }
     memcpy(result, str, len);
     result[len] = '\0';
     return result;
 }
 
+static void text_free(char* text, const char* buffer) {
+    if (text != buffer) free(text);
+}
+
 /* ===== Initialization ===== */
 
 void parser_init(Parser* parser, Lexer* lexer) {
     parser->lexer = lexer;
+    parser->tokens = NULL;
+    parser->position = 0;
     parser->had_error = false;
     parser->panic_mode = false;
+    parser->cons = NULL;
+    parser->lazy_bodies = false;
+    parser->fold_constants = false;
+    parser->silent = false;
+    parser->depth = 0;
+    parser->max_depth = PARSER_DEFAULT_NESTING_LIMIT;
+    diag_buffer_init(&parser->own_diags);
+    parser->diags = &parser->own_diags;
+    parser->events = NULL;
+    parser->current.start = NULL;   /* Nothing consumed yet; see with_span() */
     
     /* Prime the parser with the first token */
     parser_advance(parser);
 }
 
+void parser_init_tokens(Parser* parser, TokenBuffer* tokens, size_t start) {
+    parser->lexer = NULL;
+    parser->tokens = tokens;
+    parser->position = start;
+    parser->had_error = false;
+    parser->panic_mode = false;
+    parser->cons = NULL;
+    parser->lazy_bodies = false;
+    parser->fold_constants = false;
+    parser->silent = false;
+    parser->depth = 0;
+    parser->max_depth = PARSER_DEFAULT_NESTING_LIMIT;
+    diag_buffer_init(&parser->own_diags);
+    parser->diags = &parser->own_diags;
+    parser->events = NULL;
+    parser->current.start = NULL;   /* Nothing consumed yet; see with_span() */
+    
+    /* Prime the parser with the token at start */
+    parser_advance(parser);
+}
+
 void parser_free(Parser* parser) {
-    /* Nothing to free for now */
-    (void)parser;
+    diag_buffer_free(&parser->own_diags);
+}
+
+void parser_set_diagnostics(Parser* parser, DiagBuffer* diags) {
+    if (!diags) diags = &parser->own_diags;
+    if (diags == parser->diags) return;
+    
+    /* Errors recorded while priming move to the new buffer */
+    if (parser->diags == &parser->own_diags) {
+        for (size_t i = 0; i < parser->own_diags.count; i++) {
+            diag_report(diags, &parser->own_diags.items[i]);
+        }
+        diag_buffer_free(&parser->own_diags);
+    }
+    parser->diags = diags;
+}
+
+void parser_enable_hash_consing(Parser* parser, AstConsTable* table) {
+    parser->cons = table;
+}
+
+void parser_enable_lazy_bodies(Parser* parser, bool enabled) {
+    parser->lazy_bodies = enabled;
+}
+
+void parser_enable_constant_folding(Parser* parser, bool enabled) {
+    parser->fold_constants = enabled;
+}
+
+void parser_set_nesting_limit(Parser* parser, size_t limit) {
+    parser->max_depth = limit;
+}
+
+/* ===== Source Spans ===== */
+
+static const char* parser_source(Parser* parser);
+
+static size_t token_offset(Parser* parser, const Token* token) {
+    return (size_t)(token->start - parser_source(parser));
+}
+
+/* Where the node about to be parsed begins */
+static size_t span_start(Parser* parser) {
+    return token_offset(parser, &parser->current);
+}
+
+/* Bytes from start to the end of the last consumed token */
+static size_t span_length(Parser* parser, size_t start) {
+    if (!parser->previous.start) return 0;
+    size_t end = token_offset(parser, &parser->previous) + parser->previous.length;
+    return end > start ? end - start : 0;
+}
+
+/* Give a freshly built node the bytes from start to the end of the last
+ * consumed token. Nodes that already have a span, such as an operand
+ * that folding returns as it is, keep theirs. */
+static AstNode* with_span(Parser* parser, AstNode* node, size_t start) {
+    if (!node || node->length != 0 || (node->flags & AST_FLAG_INTERNED)) return node;
+    
+    node->offset = (uint32_t)start;
+    node->length = (uint32_t)span_length(parser, start);
+    return node;
+}
+
+/* ===== Parse Events ===== */
+
+/* In event-stream mode every node is also reported to the sink as it is
+ * parsed: ENTER when a declaration, statement or block begins, EXIT once
+ * it is built, LEAF for terminals and REDUCE for composite expressions.
+ * Outside that mode these are no-ops. */
+static void emit_event(Parser* parser, ParseEventKind kind, AstNodeType node,
+                       size_t offset, size_t length, int line, int column,
+                       const char* name, size_t name_length, int op, size_t arity) {
+    ParseEventSink* sink = parser->events;
+    ParseEvent event;
+    event.kind = kind;
+    event.node = node;
+    event.offset = offset;
+    event.length = length;
+    event.line = line;
+    event.column = column;
+    event.name = name;
+    event.name_length = name ? name_length : 0;
+    event.name_id = name && sink->interner ? string_intern(sink->interner, name, name_length) : 0;
+    event.op = op;
+    event.arity = arity;
+    sink->handler(&event, sink->context);
+}
+
+/* name is reported when it is an identifier token */
+static void event_enter(Parser* parser, AstNodeType node, const Token* first, const Token* name) {
+    if (!parser->events) return;
+    bool named = name && name->type == TOKEN_IDENTIFIER;
+    emit_event(parser, PARSE_EVENT_ENTER, node, token_offset(parser, first), first->length,
+               first->line, first->column, named ? name->start : NULL, named ? name->length : 0, 0, 0);
+}
+
+static void event_exit(Parser* parser, AstNodeType node, const Token* first) {
+    if (!parser->events) return;
+    size_t start = token_offset(parser, first);
+    emit_event(parser, PARSE_EVENT_EXIT, node, start, span_length(parser, start),
+               first->line, first->column, NULL, 0, 0, 0);
+}
+
+static void event_leaf(Parser* parser, AstNodeType node, const Token* token, bool named, int op) {
+    if (!parser->events) return;
+    emit_event(parser, PARSE_EVENT_LEAF, node, token_offset(parser, token), token->length,
+               token->line, token->column, named ? token->start : NULL, token->length, op, 0);
+}
+
+/* A composite expression from start to the last token, closing arity
+ * operand subtrees; built is the node made for it, if any */
+static void event_reduce(Parser* parser, AstNodeType node, const AstNode* built, size_t start,
+                         const char* name, size_t name_length, int op, size_t arity) {
+    if (!parser->events) return;
+    emit_event(parser, PARSE_EVENT_REDUCE, node, start, span_length(parser, start),
+               built ? built->line : 0, built ? built->column : 0, name, name_length, op, arity);
+}
+
+/* Route a freshly built expression through the hash-consing table */
+static AstNode* intern_expr(Parser* parser, AstNode* node) {
+    return parser->cons ? ast_cons_intern(parser->cons, node) : node;
 }
 
+/* All operator nodes are built here: folded when enabled, then interned */
+static AstNode* make_binary(Parser* parser, BinaryOp op, AstNode* left, AstNode* right,
+                            Token op_token, size_t start) {
+    if (parser->fold_constants) {
+        AstNode* folded = ast_fold_binary(op, left, right);
+        if (folded) {
+            if (folded->flags & AST_FLAG_INTERNED) return folded;
+            return intern_expr(parser, with_span(parser, folded, start));
+        }
+    }
+    AstNode* node = ast_create_binary(op, left, right, op_token.line, op_token.column);
+    /* Without a left operand the expression starts at the operator */
+    event_reduce(parser, AST_BINARY_EXPR, node, left ? start : token_offset(parser, &op_token),
+                 NULL, 0, (int)op, (left != NULL) + (right != NULL));
+    return intern_expr(parser, with_span(parser, node, start));
+}
+
+static AstNode* make_unary(Parser* parser, UnaryOp op, AstNode* operand, Token op_token) {
+    size_t start = token_offset(parser, &op_token);
+    if (parser->fold_constants) {
+        AstNode* folded = ast_fold_unary(op, operand);
+        if (folded) {
+            if (folded->flags & AST_FLAG_INTERNED) return folded;
+            return intern_expr(parser, with_span(parser, folded, start));
+        }
+    }
+    AstNode* node = ast_create_unary(op, operand, op_token.line, op_token.column);
+    event_reduce(parser, AST_UNARY_EXPR, node, start, NULL, 0, (int)op, operand != NULL);
+    return intern_expr(parser, with_span(parser, node, start));
+}
+
+static void report_at(Parser* parser, DiagCode code, Token* token, const char* message);
+
 /* ===== Helper Functions ===== */
 
+/* Next raw token from the buffer or the lexer; the buffer repeats EOF */
+static Token next_token(Parser* parser) {
+    if (!parser->tokens) return lexer_next_token(parser->lexer);
+    
+    if (parser->position >= parser->tokens->count) {
+        return parser->tokens->tokens[parser->tokens->count - 1];
+    }
+    return parser->tokens->tokens[parser->position++];
+}
+
 void parser_advance(Parser* parser) {
     parser->previous = parser->current;
     
     for (;;) {
-        parser->current = lexer_next_token(parser->lexer);
+        parser->current = next_token(parser);
+        STATS_TOKEN();
         
         if (parser->current.type != TOKEN_ERROR) break;
         
@@ -52,7 +262,9 @@ bool parser_check(Parser* parser, TokenType type) {
 }
 
 bool parser_match(Parser* parser, TokenType type) {
-    if (!parser_check(parser, type)) return false;
+    bool hit = parser_check(parser, type);
+    STATS_MATCH(hit);
+    if (!hit) return false;
     parser_advance(parser);
     return true;
 }
@@ -64,7 +276,7 @@ Token parser_expect(Parser* parser, TokenType type, const char* message) {
         return token;
     }
     
-    parser_error_at_current(parser, message);
+    report_at(parser, DIAG_EXPECTED_TOKEN, &parser->current, message);
     return parser->current;
 }
 
@@ -80,24 +292,114 @@ bool parser_is_at_end(Parser* parser) {
     return parser->current.type == TOKEN_EOF;
 }
 
+/* ===== Checkpoints ===== */
+
+ParserCheckpoint parser_checkpoint(Parser* parser) {
+    ParserCheckpoint checkpoint;
+    if (parser->lexer) checkpoint.lexer = *parser->lexer;
+    checkpoint.position = parser->position;
+    checkpoint.current = parser->current;
+    checkpoint.previous = parser->previous;
+    checkpoint.had_error = parser->had_error;
+    checkpoint.panic_mode = parser->panic_mode;
+    checkpoint.depth = parser->depth;
+    checkpoint.diag_count = parser->diags->count;
+    checkpoint.arena = ast_current_arena();
+    if (checkpoint.arena) checkpoint.arena_mark = ast_arena_mark(checkpoint.arena);
+    return checkpoint;
+}
+
+void parser_rewind(Parser* parser, const ParserCheckpoint* checkpoint) {
+    if (parser->lexer) *parser->lexer = checkpoint->lexer;
+    parser->position = checkpoint->position;
+    parser->current = checkpoint->current;
+    parser->previous = checkpoint->previous;
+    parser->had_error = checkpoint->had_error;
+    parser->panic_mode = checkpoint->panic_mode;
+    parser->depth = checkpoint->depth;
+    diag_buffer_truncate(parser->diags, checkpoint->diag_count);
+    
+    if (checkpoint->arena && checkpoint->arena == ast_current_arena() && !parser->cons) {
+        ast_arena_rewind(checkpoint->arena, checkpoint->arena_mark);
+    }
+}
+
 /* ===== Error Handling ===== */
 
-void parser_error_at(Parser* parser, Token* token, const char* message) {
+/* Text the tokens point into */
+static const char* parser_source(Parser* parser) {
+    return parser->tokens ? parser->tokens->source : parser->lexer->source;
+}
+
+/* Record an error; only the first one of a panic is kept */
+static void report_at(Parser* parser, DiagCode code, Token* token, const char* message) {
     if (parser->panic_mode) return;
     parser->panic_mode = true;
     parser->had_error = true;
     
-    fprintf(stderr, "[Line %d, Column %d] Error", token->line, token->column);
-    
-    if (token->type == TOKEN_EOF) {
-        fprintf(stderr, " at end");
-    } else if (token->type == TOKEN_ERROR) {
-        /* Nothing */
+    if (parser->silent) return;
+    
+    Diagnostic diag;
+    diag.severity = DIAG_ERROR;
+    diag.code = code;
+    diag.message = message;
+    diag.found = token->type;
+    diag.line = token->line;
+    diag.column = token->column;
+    
+    if (token->type == TOKEN_ERROR) {
+        /* Lexer errors carry their message instead of a lexeme */
+        diag.code = DIAG_LEXICAL;
+        diag.offset = DIAG_NO_OFFSET;
+        diag.length = 0;
     } else {
-        fprintf(stderr, " at '%.*s'", (int)token->length, token->start);
+        diag.offset = (size_t)(token->start - parser_source(parser));
+        diag.length = token->length;
     }
     
-    fprintf(stderr, ": %s\n", message);
+    diag_report(parser->diags, &diag);
+}
+
+/* Render and drop errors nobody else asked to see */
+static void flush_own_diagnostics(Parser* parser) {
+    if (parser->diags != &parser->own_diags || parser->own_diags.count == 0) return;
+    
+    diag_render_text(&parser->own_diags, parser_source(parser), NULL, stderr);
+    diag_buffer_free(&parser->own_diags);
+}
+
+/* Every construct that recurses in C enters a level first */
+static bool enter_nesting(Parser* parser) {
+    if (parser->depth >= parser->max_depth) {
+        report_at(parser, DIAG_NESTING_LIMIT, &parser->current, "Nesting too deep");
+        return false;
+    }
+    parser->depth++;
+    return true;
+}
+
+static void leave_nesting(Parser* parser) {
+    parser->depth--;
+}
+
+/* Double an explicit stack that starts out in the caller's inline array.
+ * Returns the new items, or NULL (leaving the stack as it was) when out
+ * of memory. */
+static void* grow_stack(void* items, size_t* capacity, size_t item_size, const void* inline_items) {
+    size_t grown_capacity = *capacity * 2;
+    void* grown;
+    if (items == inline_items) {
+        grown = malloc(grown_capacity * item_size);
+        if (grown) memcpy(grown, inline_items, *capacity * item_size);
+    } else {
+        grown = realloc(items, grown_capacity * item_size);
+    }
+    if (grown) *capacity = grown_capacity;
+    return grown;
+}
+
+void parser_error_at(Parser* parser, Token* token, const char* message) {
+    report_at(parser, DIAG_SYNTAX, token, message);
 }
 
 void parser_error_at_current(Parser* parser, const char* message) {
@@ -108,33 +410,117 @@ void parser_error(Parser* parser, const char* message) {
     parser_error_at(parser, &parser->previous, message);
 }
 
-void parser_synchronize(Parser* parser) {
-    parser->panic_mode = false;
+static bool is_statement_keyword(TokenType type) {
+    switch (type) {
+        case TOKEN_FUNC:
+        case TOKEN_IF:
+        case TOKEN_WHILE:
+        case TOKEN_FOR:
+        case TOKEN_LOOP:
+        case TOKEN_RETURN:
+        case TOKEN_IMPORT:
+        case TOKEN_CLASS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Skip the rest of a broken statement. The lexer emits no newline
+ * tokens, so a token on a later line than the one before it counts as
+ * a statement boundary. Braces opened while skipping are skipped as a
+ * whole; inside a block, the '}' closing it stops the scan. */
+static void synchronize(Parser* parser, bool in_block) {
+    int depth = 0;
     
     while (parser->current.type != TOKEN_EOF) {
-        /* Synchronize at statement boundaries */
-        if (parser->previous.type == TOKEN_NEWLINE) return;
+        TokenType type = parser->current.type;
         
-        switch (parser->current.type) {
-            case TOKEN_FUNC:
-            case TOKEN_IF:
-            case TOKEN_WHILE:
-            case TOKEN_FOR:
-            case TOKEN_LOOP:
-            case TOKEN_RETURN:
-            case TOKEN_IMPORT:
-            case TOKEN_CLASS:
-                return;
-            default:
-                ; /* Do nothing */
+        if (depth == 0) {
+            if (type == TOKEN_RIGHT_BRACE && in_block) break;
+            if (parser->previous.line < parser->current.line) break;
+            if (is_statement_keyword(type)) break;
         }
         
+        if (type == TOKEN_LEFT_BRACE) {
+            depth++;
+        } else if (type == TOKEN_RIGHT_BRACE && depth > 0) {
+            depth--;
+        }
+        parser_advance(parser);
+    }
+    
+    parser->panic_mode = false;
+}
+
+void parser_synchronize(Parser* parser) {
+    synchronize(parser, false);
+}
+
+/* A broken signature still has a body worth checking */
+static void recover_signature(Parser* parser) {
+    if (!parser->panic_mode) return;
+    
+    while (!parser_check(parser, TOKEN_LEFT_BRACE) && !parser_is_at_end(parser) &&
+           !is_statement_keyword(parser->current.type)) {
         parser_advance(parser);
     }
+    if (parser_check(parser, TOKEN_LEFT_BRACE)) {
+        parser->panic_mode = false;
+    }
 }
 
 /* ===== Primary Expression Parsing ===== */
 
+/* Dictionary literal after '{': { key: value, ... }, trailing comma allowed */
+static AstNode* parse_dict_literal(Parser* parser) {
+    Token brace = parser->previous;
+    size_t start = token_offset(parser, &brace);
+    AstList* entries = ast_list_create();
+    
+    /* First token of each key, to point at a repeated one */
+    Token* key_tokens = NULL;
+    size_t key_capacity = 0;
+    size_t operands = 0;
+    
+    while (!parser_check(parser, TOKEN_RIGHT_BRACE) && !parser_is_at_end(parser)) {
+        if (entries->count == key_capacity) {
+            key_capacity = key_capacity ? key_capacity * 2 : 8;
+            Token* grown = (Token*)realloc(key_tokens, key_capacity * sizeof(Token));
+            if (!grown) {
+                report_at(parser, DIAG_OUT_OF_MEMORY, &parser->current, "Out of memory");
+                break;
+            }
+            key_tokens = grown;
+        }
+        key_tokens[entries->count] = parser->current;
+        
+        AstNode* key = parser_parse_expression(parser);
+        parser_expect(parser, TOKEN_COLON, "Expected ':' after dictionary key");
+        AstNode* value = parser_parse_expression(parser);
+        ast_list_append(entries, ast_create_dict_entry(key, value));
+        operands += (key != NULL) + (value != NULL);
+        
+        if (!parser_match(parser, TOKEN_COMMA)) break;
+    }
+    
+    parser_expect(parser, TOKEN_RIGHT_BRACE, "Expected '}' after dictionary entries");
+    AstNode* dict = with_span(parser, ast_create_dict(entries, brace.line, brace.column), start);
+    event_reduce(parser, AST_DICT_EXPR, dict, start, NULL, 0, 0, operands);
+    
+    /* Constant keys without a layout: one of them repeats */
+    size_t duplicate;
+    if (dict && dict->as.dict.constant_keys && !dict->as.dict.layout && !parser->panic_mode &&
+        ast_dict_find_duplicate(entries, &duplicate)) {
+        report_at(parser, DIAG_DUPLICATE_KEY, &key_tokens[duplicate], "Duplicate key in dictionary literal");
+        /* The literal itself is complete; keep parsing after it */
+        parser->panic_mode = false;
+    }
+    
+    free(key_tokens);
+    return dict;
+}
+
 AstNode* parser_parse_primary(Parser* parser) {
     /* Check for empty expression in parens or brackets */
     if (parser->current.type == TOKEN_RIGHT_PAREN || 
@@ -146,56 +532,73 @@ AstNode* parser_parse_primary(Parser* parser) {
     /* Integer literal */
     if (parser_match(parser, TOKEN_INT)) {
         Token token = parser->previous;
-        char* num_str = string_dup_n(token.start, token.length);
+        char buffer[TEXT_INLINE];
+        char* num_str = token_text(token.start, token.length, buffer);
         long value = strtol(num_str, NULL, 10);
-        free(num_str);
-        return ast_create_literal_int(value, token.line, token.column);
+        text_free(num_str, buffer);
+        event_leaf(parser, AST_LITERAL_EXPR, &token, false, LIT_INT);
+        return intern_expr(parser, with_span(parser, ast_create_literal_int(value, token.line, token.column), token_offset(parser, &token)));
     }
     
     /* Float literal */
     if (parser_match(parser, TOKEN_FLOAT)) {
         Token token = parser->previous;
-        char* num_str = string_dup_n(token.start, token.length);
+        char buffer[TEXT_INLINE];
+        char* num_str = token_text(token.start, token.length, buffer);
         double value = strtod(num_str, NULL);
-        free(num_str);
-        return ast_create_literal_float(value, token.line, token.column);
+        text_free(num_str, buffer);
+        event_leaf(parser, AST_LITERAL_EXPR, &token, false, LIT_FLOAT);
+        return intern_expr(parser, with_span(parser, ast_create_literal_float(value, token.line, token.column), token_offset(parser, &token)));
     }
     
     /* String literal */
     if (parser_match(parser, TOKEN_STRING)) {
         Token token = parser->previous;
         /* Remove quotes from string */
-        char* str_value = string_dup_n(token.start + 1, token.length - 2);
+        char buffer[TEXT_INLINE];
+        char* str_value = token_text(token.start + 1, token.length - 2, buffer);
         AstNode* node = ast_create_literal_string(str_value, token.line, token.column);
-        free(str_value);
-        return node;
+        text_free(str_value, buffer);
+        event_leaf(parser, AST_LITERAL_EXPR, &token, false, LIT_STRING);
+        return intern_expr(parser, with_span(parser, node, token_offset(parser, &token)));
     }
     
     /* Boolean literals */
     if (parser_match(parser, TOKEN_TRUE)) {
         Token token = parser->previous;
-        return ast_create_literal_bool(true, token.line, token.column);
+        event_leaf(parser, AST_LITERAL_EXPR, &token, false, LIT_BOOL);
+        return intern_expr(parser, with_span(parser, ast_create_literal_bool(true, token.line, token.column), token_offset(parser, &token)));
     }
     
     if (parser_match(parser, TOKEN_FALSE)) {
         Token token = parser->previous;
-        return ast_create_literal_bool(false, token.line, token.column);
+        event_leaf(parser, AST_LITERAL_EXPR, &token, false, LIT_BOOL);
+        return intern_expr(parser, with_span(parser, ast_create_literal_bool(false, token.line, token.column), token_offset(parser, &token)));
     }
     
     /* Identifier */
     if (parser_match(parser, TOKEN_IDENTIFIER)) {
         Token token = parser->previous;
-        char* name = string_dup_n(token.start, token.length);
+        char buffer[TEXT_INLINE];
+        char* name = token_text(token.start, token.length, buffer);
         AstNode* node = ast_create_identifier(name, token.line, token.column);
-        free(name);
-        return node;
+        text_free(name, buffer);
+        event_leaf(parser, AST_IDENTIFIER_EXPR, &token, true, 0);
+        return intern_expr(parser, with_span(parser, node, token_offset(parser, &token)));
+    }
+    
+    /* 'this' inside a method reads like a variable named this */
+    if (parser_match(parser, TOKEN_THIS)) {
+        Token token = parser->previous;
+        event_leaf(parser, AST_IDENTIFIER_EXPR, &token, true, 0);
+        return intern_expr(parser, with_span(parser, ast_create_identifier("this", token.line, token.column), token_offset(parser, &token)));
     }
     
     /* Grouped expression */
     if (parser_match(parser, TOKEN_LEFT_PAREN)) {
         AstNode* expr = parser_parse_expression(parser);
         if (!expr) {
-            parser_error(parser, "Expected expression after '('");
+            report_at(parser, DIAG_EXPECTED_EXPRESSION, &parser->previous, "Expected expression after '('");
             return NULL;
         }
         parser_expect(parser, TOKEN_RIGHT_PAREN, "Expected ')' after expression");
@@ -206,32 +609,33 @@ AstNode* parser_parse_primary(Parser* parser) {
     if (parser_match(parser, TOKEN_LEFT_BRACKET)) {
         Token start_token = parser->previous;
         AstList* elements = ast_list_create();
+        size_t operands = 0;
         
         if (!parser_check(parser, TOKEN_RIGHT_BRACKET)) {
             do {
                 AstNode* element = parser_parse_expression(parser);
                 ast_list_append(elements, element);
+                operands += element != NULL;
             } while (parser_match(parser, TOKEN_COMMA));
         }
         
         parser_expect(parser, TOKEN_RIGHT_BRACKET, "Expected ']' after array elements");
-        return ast_create_array(elements, start_token.line, start_token.column);
+        AstNode* array = ast_create_array(elements, start_token.line, start_token.column);
+        size_t start = token_offset(parser, &start_token);
+        event_reduce(parser, AST_ARRAY_EXPR, array, start, NULL, 0, 0, operands);
+        return with_span(parser, array, start);
+    }
+    
+    /* Dictionary literal */
+    if (parser_match(parser, TOKEN_LEFT_BRACE)) {
+        return parse_dict_literal(parser);
     }
     
-    parser_error_at_current(parser, "Expected expression");
+    report_at(parser, DIAG_EXPECTED_EXPRESSION, &parser->current, "Expected expression");
     return NULL;
 }
 
-/* ===== Expression Parsing (Pratt Parser - Simple Version) ===== */
-
-/* Forward declarations for expression parsing */
-static AstNode* parse_unary(Parser* parser);
-static AstNode* parse_factor(Parser* parser);
-static AstNode* parse_term(Parser* parser);
-static AstNode* parse_comparison(Parser* parser);
-static AstNode* parse_equality(Parser* parser);
-static AstNode* parse_logical_and(Parser* parser);
-static AstNode* parse_logical_or(Parser* parser);
+/* ===== Expression Parsing ===== */
 
 /* Forward declarations for statement parsing */
 static AstNode* parse_if_statement(Parser* parser);
@@ -241,38 +645,56 @@ static AstNode* parse_loop_statement(Parser* parser);
 static AstNode* parse_return_statement(Parser* parser);
 static AstNode* parse_block_statement(Parser* parser);
 static AstNode* parse_function_declaration(Parser* parser);
+static AstNode* parse_class_declaration(Parser* parser);
 
-/* Postfix operators (call, index, member) */
-static AstNode* parse_postfix(Parser* parser) {
-    AstNode* expr = parser_parse_primary(parser);
-    
+/* Postfix operations (call, index, member) on an already-parsed
+ * expression that began at start */
+static AstNode* parse_postfix_continue(Parser* parser, AstNode* expr, size_t start) {
     for (;;) {
         /* Function call */
         if (parser_match(parser, TOKEN_LEFT_PAREN)) {
+            Token paren = parser->previous;
             AstList* args = ast_list_create();
+            size_t operands = expr != NULL;
             
             if (!parser_check(parser, TOKEN_RIGHT_PAREN)) {
                 do {
                     AstNode* arg = parser_parse_expression(parser);
                     ast_list_append(args, arg);
+                    operands += arg != NULL;
                 } while (parser_match(parser, TOKEN_COMMA));
             }
             
-            Token paren = parser_expect(parser, TOKEN_RIGHT_PAREN, "Expected ')' after arguments");
-            expr = ast_create_call(expr, args, paren.line, paren.column);
+            parser_expect(parser, TOKEN_RIGHT_PAREN, "Expected ')' after arguments");
+            
+            /* A call through a plain identifier carries the callee's name */
+            bool named = expr && expr->type == AST_IDENTIFIER_EXPR;
+            AstNode* call = ast_create_call(expr, args, paren.line, paren.column);
+            event_reduce(parser, AST_CALL_EXPR, call, start,
+                         named ? parser_source(parser) + expr->offset : NULL,
+                         named ? expr->length : 0, 0, operands);
+            expr = with_span(parser, call, start);
         }
         /* Array indexing */
         else if (parser_match(parser, TOKEN_LEFT_BRACKET)) {
+            Token bracket = parser->previous;
             AstNode* index = parser_parse_expression(parser);
-            Token bracket = parser_expect(parser, TOKEN_RIGHT_BRACKET, "Expected ']' after index");
-            expr = ast_create_index(expr, index, bracket.line, bracket.column);
+            parser_expect(parser, TOKEN_RIGHT_BRACKET, "Expected ']' after index");
+            AstNode* node = ast_create_index(expr, index, bracket.line, bracket.column);
+            event_reduce(parser, AST_INDEX_EXPR, node, start, NULL, 0, 0, (expr != NULL) + (index != NULL));
+            expr = intern_expr(parser, with_span(parser, node, start));
         }
         /* Member access */
         else if (parser_match(parser, TOKEN_DOT)) {
             Token member = parser_expect(parser, TOKEN_IDENTIFIER, "Expected property name after '.'");
-            char* member_name = string_dup_n(member.start, member.length);
-            expr = ast_create_member(expr, member_name, member.line, member.column);
-            free(member_name);
+            char buffer[TEXT_INLINE];
+            char* member_name = token_text(member.start, member.length, buffer);
+            AstNode* node = ast_create_member(expr, member_name, member.line, member.column);
+            bool named = member.type == TOKEN_IDENTIFIER;
+            event_reduce(parser, AST_MEMBER_EXPR, node, start, named ? member.start : NULL,
+                         member.length, 0, expr != NULL);
+            expr = intern_expr(parser, with_span(parser, node, start));
+            text_free(member_name, buffer);
         }
         else {
             break;
@@ -282,240 +704,362 @@ static AstNode* parse_postfix(Parser* parser) {
     return expr;
 }
 
-/* Continue parsing postfix operations on an already-parsed expression */
-static AstNode* parse_postfix_continue(Parser* parser, AstNode* expr) {
-    for (;;) {
-        /* Function call */
-        if (parser_match(parser, TOKEN_LEFT_PAREN)) {
-            AstList* args = ast_list_create();
-            
-            if (!parser_check(parser, TOKEN_RIGHT_PAREN)) {
-                do {
-                    AstNode* arg = parser_parse_expression(parser);
-                    ast_list_append(args, arg);
-                } while (parser_match(parser, TOKEN_COMMA));
-            }
-            
-            Token paren = parser_expect(parser, TOKEN_RIGHT_PAREN, "Expected ')' after arguments");
-            expr = ast_create_call(expr, args, paren.line, paren.column);
-        }
-        /* Array indexing */
-        else if (parser_match(parser, TOKEN_LEFT_BRACKET)) {
-            AstNode* index = parser_parse_expression(parser);
-            Token bracket = parser_expect(parser, TOKEN_RIGHT_BRACKET, "Expected ']' after index");
-            expr = ast_create_index(expr, index, bracket.line, bracket.column);
-        }
-        /* Member access */
-        else if (parser_match(parser, TOKEN_DOT)) {
-            Token member = parser_expect(parser, TOKEN_IDENTIFIER, "Expected property name after '.'");
-            char* member_name = string_dup_n(member.start, member.length);
-            expr = ast_create_member(expr, member_name, member.line, member.column);
-            free(member_name);
-        }
-        else {
-            break;
-        }
-    }
-    
-    return expr;
+/* Postfix operators (call, index, member) */
+static AstNode* parse_postfix(Parser* parser) {
+    size_t start = span_start(parser);
+    AstNode* expr = parser_parse_primary(parser);
+    return parse_postfix_continue(parser, expr, start);
 }
 
-/* Unary operators: -, !, ~ */
-static AstNode* parse_unary(Parser* parser) {
-    if (parser_match(parser, TOKEN_MINUS)) {
-        Token op = parser->previous;
-        AstNode* operand = parse_unary(parser);
-        return ast_create_unary(OP_NEG, operand, op.line, op.column);
+/* Binary operators bind loosest to tightest: ||, &&, equality,
+ * comparison, additive, multiplicative; all are left-associative.
+ * Returns the precedence, or 0 when the token is no binary operator. */
+static int binary_precedence(TokenType type, BinaryOp* op) {
+    switch (type) {
+        case TOKEN_OR: *op = OP_OR; return 1;
+        case TOKEN_AND: *op = OP_AND; return 2;
+        case TOKEN_EQUAL_EQUAL: *op = OP_EQ; return 3;
+        case TOKEN_NOT_EQUAL: *op = OP_NE; return 3;
+        case TOKEN_LESS: *op = OP_LT; return 4;
+        case TOKEN_GREATER: *op = OP_GT; return 4;
+        case TOKEN_LESS_EQUAL: *op = OP_LE; return 4;
+        case TOKEN_GREATER_EQUAL: *op = OP_GE; return 4;
+        case TOKEN_PLUS: *op = OP_ADD; return 5;
+        case TOKEN_MINUS: *op = OP_SUB; return 5;
+        case TOKEN_STAR: *op = OP_MUL; return 6;
+        case TOKEN_SLASH: *op = OP_DIV; return 6;
+        case TOKEN_PERCENT: *op = OP_MOD; return 6;
+        default: return 0;
     }
-    
-    if (parser_match(parser, TOKEN_NOT)) {
-        Token op = parser->previous;
-        AstNode* operand = parse_unary(parser);
-        return ast_create_unary(OP_NOT, operand, op.line, op.column);
+}
+
+/* Prefix operators: -, !, ~ (bind tighter than any binary operator) */
+static bool unary_operator(TokenType type, UnaryOp* op) {
+    switch (type) {
+        case TOKEN_MINUS: *op = OP_NEG; return true;
+        case TOKEN_NOT: *op = OP_NOT; return true;
+        case TOKEN_TILDE: *op = OP_BIT_NOT; return true;
+        default: return false;
     }
-    
-    if (parser_match(parser, TOKEN_TILDE)) {
-        Token op = parser->previous;
-        AstNode* operand = parse_unary(parser);
-        return ast_create_unary(OP_BIT_NOT, operand, op.line, op.column);
+}
+
+typedef enum {
+    PENDING_GROUP,      /* An open '(' */
+    PENDING_UNARY,
+    PENDING_BINARY
+} PendingKind;
+
+/* An operator still waiting for its operands */
+typedef struct {
+    PendingKind kind;
+    int precedence;     /* Binary operators only */
+    int op;             /* BinaryOp or UnaryOp */
+    Token token;
+    size_t start;       /* Span start of a group or prefix operator */
+} PendingOp;
+
+/* A finished operand and where its source begins (before any '(') */
+typedef struct {
+    AstNode* node;
+    size_t start;
+} Operand;
+
+/* Entries kept in the caller's frame; deeper expressions move to the heap */
+#define EXPR_STACK_INLINE 8
+
+typedef struct {
+    PendingOp* ops;
+    size_t op_count;
+    size_t op_capacity;
+    Operand* operands;
+    size_t operand_count;
+    size_t operand_capacity;
+    size_t groups;      /* Open parentheses among ops */
+    PendingOp inline_ops[EXPR_STACK_INLINE];
+    Operand inline_operands[EXPR_STACK_INLINE];
+} ExprStack;
+
+static void expr_stack_init(ExprStack* stack) {
+    stack->ops = stack->inline_ops;
+    stack->op_count = 0;
+    stack->op_capacity = EXPR_STACK_INLINE;
+    stack->operands = stack->inline_operands;
+    stack->operand_count = 0;
+    stack->operand_capacity = EXPR_STACK_INLINE;
+    stack->groups = 0;
+}
+
+static void expr_stack_free(ExprStack* stack) {
+    if (stack->ops != stack->inline_ops) free(stack->ops);
+    if (stack->operands != stack->inline_operands) free(stack->operands);
+}
+
+static bool push_op(ExprStack* stack, PendingOp op) {
+    if (stack->op_count == stack->op_capacity) {
+        PendingOp* grown = grow_stack(stack->ops, &stack->op_capacity,
+                                      sizeof(PendingOp), stack->inline_ops);
+        if (!grown) return false;
+        stack->ops = grown;
     }
-    
-    return parse_postfix(parser);
+    stack->ops[stack->op_count++] = op;
+    if (op.kind == PENDING_GROUP) stack->groups++;
+    return true;
 }
 
-/* Multiplicative operators: *, /, % */
-static AstNode* parse_factor(Parser* parser) {
-    AstNode* expr = parse_unary(parser);
-    
-    while (parser_match(parser, TOKEN_STAR) || 
-           parser_match(parser, TOKEN_SLASH) || 
-           parser_match(parser, TOKEN_PERCENT)) {
-        Token op = parser->previous;
-        AstNode* right = parse_unary(parser);
-        
-        BinaryOp bin_op;
-        if (op.type == TOKEN_STAR) bin_op = OP_MUL;
-        else if (op.type == TOKEN_SLASH) bin_op = OP_DIV;
-        else bin_op = OP_MOD;
-        
-        expr = ast_create_binary(bin_op, expr, right, op.line, op.column);
+static bool push_operand(ExprStack* stack, AstNode* node, size_t start) {
+    if (stack->operand_count == stack->operand_capacity) {
+        Operand* grown = grow_stack(stack->operands, &stack->operand_capacity,
+                                    sizeof(Operand), stack->inline_operands);
+        if (!grown) return false;
+        stack->operands = grown;
     }
-    
-    return expr;
+    stack->operands[stack->operand_count].node = node;
+    stack->operands[stack->operand_count++].start = start;
+    return true;
 }
 
-/* Additive operators: +, - */
-static AstNode* parse_term(Parser* parser) {
-    AstNode* expr = parse_factor(parser);
-    
-    while (parser_match(parser, TOKEN_PLUS) || parser_match(parser, TOKEN_MINUS)) {
-        Token op = parser->previous;
-        AstNode* right = parse_factor(parser);
-        
-        BinaryOp bin_op = (op.type == TOKEN_PLUS) ? OP_ADD : OP_SUB;
-        expr = ast_create_binary(bin_op, expr, right, op.line, op.column);
+/* Build the node of the operator on top of the stack. Everything it
+ * covers ends at the previous token, which gives its span. */
+static void reduce_top(Parser* parser, ExprStack* stack) {
+    PendingOp op = stack->ops[--stack->op_count];
+    Operand* top = &stack->operands[stack->operand_count - 1];
+    
+    if (op.kind == PENDING_UNARY) {
+        top->node = make_unary(parser, (UnaryOp)op.op, top->node, op.token);
+        top->start = op.start;
+        leave_nesting(parser);
+    } else {
+        Operand* left = top - 1;
+        left->node = make_binary(parser, (BinaryOp)op.op, left->node, top->node, op.token, left->start);
+        stack->operand_count--;
     }
-    
-    return expr;
 }
 
-/* Comparison operators: <, >, <=, >= */
-static AstNode* parse_comparison(Parser* parser) {
-    AstNode* expr = parse_term(parser);
-    
-    while (parser_match(parser, TOKEN_LESS) || 
-           parser_match(parser, TOKEN_GREATER) ||
-           parser_match(parser, TOKEN_LESS_EQUAL) ||
-           parser_match(parser, TOKEN_GREATER_EQUAL)) {
-        Token op = parser->previous;
-        AstNode* right = parse_term(parser);
+/* Read prefix operators and opening parentheses up to the next operand */
+static bool parse_prefixes(Parser* parser, ExprStack* stack) {
+    for (;;) {
+        PendingOp pending = { PENDING_GROUP, 0, 0, parser->current, span_start(parser) };
+        UnaryOp op;
         
-        BinaryOp bin_op;
-        switch (op.type) {
-            case TOKEN_LESS: bin_op = OP_LT; break;
-            case TOKEN_GREATER: bin_op = OP_GT; break;
-            case TOKEN_LESS_EQUAL: bin_op = OP_LE; break;
-            case TOKEN_GREATER_EQUAL: bin_op = OP_GE; break;
-            default: bin_op = OP_LT; /* Should never happen */
+        if (parser_check(parser, TOKEN_LEFT_PAREN)) {
+            pending.kind = PENDING_GROUP;
+        } else if (unary_operator(parser->current.type, &op)) {
+            pending.kind = PENDING_UNARY;
+            pending.op = (int)op;
+        } else {
+            return true;
         }
         
-        expr = ast_create_binary(bin_op, expr, right, op.line, op.column);
+        if (!enter_nesting(parser)) return false;
+        if (!push_op(stack, pending)) {
+            report_at(parser, DIAG_OUT_OF_MEMORY, &parser->current, "Out of memory");
+            return false;
+        }
+        parser_advance(parser);
     }
-    
-    return expr;
 }
 
-/* Equality operators: ==, != */
-static AstNode* parse_equality(Parser* parser) {
-    AstNode* expr = parse_comparison(parser);
-    
-    while (parser_match(parser, TOKEN_EQUAL_EQUAL) || parser_match(parser, TOKEN_NOT_EQUAL)) {
-        Token op = parser->previous;
-        AstNode* right = parse_comparison(parser);
-        
-        BinaryOp bin_op = (op.type == TOKEN_EQUAL_EQUAL) ? OP_EQ : OP_NE;
-        expr = ast_create_binary(bin_op, expr, right, op.line, op.column);
+/* Close the innermost group once its operand is complete; postfix
+ * operators may follow the ')' */
+static void close_group(Parser* parser, ExprStack* stack) {
+    while (stack->ops[stack->op_count - 1].kind != PENDING_GROUP) {
+        reduce_top(parser, stack);
     }
-    
-    return expr;
+    PendingOp group = stack->ops[--stack->op_count];
+    stack->groups--;
+    leave_nesting(parser);
+    
+    parser_expect(parser, TOKEN_RIGHT_PAREN, "Expected ')' after expression");
+    Operand* top = &stack->operands[stack->operand_count - 1];
+    top->start = group.start;
+    top->node = parse_postfix_continue(parser, top->node, group.start);
 }
 
-/* Logical AND: && */
-static AstNode* parse_logical_and(Parser* parser) {
-    AstNode* expr = parse_equality(parser);
-    
-    while (parser_match(parser, TOKEN_AND)) {
-        Token op = parser->previous;
-        AstNode* right = parse_equality(parser);
-        expr = ast_create_binary(OP_AND, expr, right, op.line, op.column);
+/* Operator precedence parsing with explicit stacks: nesting through
+ * parentheses and prefix operators uses heap memory, not C frames */
+static AstNode* parse_operators(Parser* parser, ExprStack* stack) {
+    for (;;) {
+        if (!parse_prefixes(parser, stack)) return NULL;
+        
+        size_t start = span_start(parser);
+        AstNode* operand = parse_postfix(parser);
+        if (!operand && stack->op_count > 0 && stack->ops[stack->op_count - 1].kind == PENDING_GROUP) {
+            report_at(parser, DIAG_EXPECTED_EXPRESSION, &parser->previous, "Expected expression after '('");
+            return NULL;
+        }
+        if (!push_operand(stack, operand, start)) {
+            ast_free_node(operand);
+            report_at(parser, DIAG_OUT_OF_MEMORY, &parser->current, "Out of memory");
+            return NULL;
+        }
+        
+        /* Close groups until a binary operator continues the expression */
+        BinaryOp op;
+        int precedence;
+        while ((precedence = binary_precedence(parser->current.type, &op)) == 0 && stack->groups > 0) {
+            close_group(parser, stack);
+        }
+        if (precedence == 0) break;
+        
+        while (stack->op_count > 0) {
+            PendingOp* top = &stack->ops[stack->op_count - 1];
+            if (top->kind == PENDING_GROUP ||
+                (top->kind == PENDING_BINARY && top->precedence < precedence)) {
+                break;
+            }
+            reduce_top(parser, stack);
+        }
+        
+        PendingOp pending = { PENDING_BINARY, precedence, (int)op, parser->current, 0 };
+        if (!push_op(stack, pending)) {
+            report_at(parser, DIAG_OUT_OF_MEMORY, &parser->current, "Out of memory");
+            return NULL;
+        }
+        parser_advance(parser);
     }
     
-    return expr;
+    while (stack->op_count > 0) {
+        reduce_top(parser, stack);
+    }
+    return stack->operands[0].node;
 }
 
-/* Logical OR: || */
-static AstNode* parse_logical_or(Parser* parser) {
-    AstNode* expr = parse_logical_and(parser);
+AstNode* parser_parse_expression(Parser* parser) {
+    size_t depth = parser->depth;
+    if (!enter_nesting(parser)) return NULL;
     
-    while (parser_match(parser, TOKEN_OR)) {
-        Token op = parser->previous;
-        AstNode* right = parse_logical_and(parser);
-        expr = ast_create_binary(OP_OR, expr, right, op.line, op.column);
-    }
+    ExprStack stack;
+    expr_stack_init(&stack);
+    AstNode* expr = parse_operators(parser, &stack);
     
+    /* After an error, operands not yet combined are dropped */
+    if (!expr) {
+        for (size_t i = 0; i < stack.operand_count; i++) {
+            ast_free_node(stack.operands[i].node);
+        }
+    }
+    expr_stack_free(&stack);
+    parser->depth = depth;
     return expr;
 }
 
-AstNode* parser_parse_expression(Parser* parser) {
-    return parse_logical_or(parser);
-}
-
 /* ===== Statement Parsing Helpers ===== */
 
 /* Parse a block of statements (for function bodies, control flow, etc.) */
 static AstNode* parse_block_statement(Parser* parser) {
+    size_t start = span_start(parser);
     Token brace = parser_expect(parser, TOKEN_LEFT_BRACE, "Expected '{' to begin block");
+    event_enter(parser, AST_BLOCK_STMT, &brace, NULL);
     
     AstList* statements = ast_list_create();
     
     while (!parser_check(parser, TOKEN_RIGHT_BRACE) && !parser_is_at_end(parser)) {
+        const char* before = parser->current.start;
         AstNode* stmt = parser_parse_statement(parser);
         if (stmt) {
             ast_list_append(statements, stmt);
         }
+        
+        if (parser->panic_mode) {
+            /* A statement that failed without consuming anything would loop forever */
+            if (parser->current.start == before) {
+                parser_advance(parser);
+            }
+            synchronize(parser, true);
+        }
     }
     
     parser_expect(parser, TOKEN_RIGHT_BRACE, "Expected '}' after block");
+    event_exit(parser, AST_BLOCK_STMT, &brace);
     
-    return ast_create_block(statements, brace.line, brace.column);
+    return with_span(parser, ast_create_block(statements, brace.line, brace.column), start);
 }
 
-/* Parse if statement: if condition { ... } else if condition { ... } else { ... } */
-static AstNode* parse_if_statement(Parser* parser) {
-    Token if_token = parser->previous;
-    
-    /* Parse condition */
-    AstNode* condition = parser_parse_expression(parser);
-    if (!condition) {
-        parser_error(parser, "Expected condition in if statement");
-        return NULL;
-    }
-    
-    /* Parse then branch */
-    AstNode* then_branch = NULL;
+/* One "if condition then" of an if/else-if chain */
+typedef struct {
+    Token if_token;
+    AstNode* condition;
+    AstNode* then_branch;
+} IfArm;
+
+#define IF_ARMS_INLINE 8
+
+static AstNode* parse_branch(Parser* parser) {
     if (parser_check(parser, TOKEN_LEFT_BRACE)) {
-        then_branch = parse_block_statement(parser);
-    } else {
-        /* Single statement without braces */
-        then_branch = parser_parse_statement(parser);
+        return parse_block_statement(parser);
     }
-    
-    /* Parse else branch (optional) */
+    /* Single statement without braces */
+    return parser_parse_statement(parser);
+}
+
+/* Parse if statement: if condition { ... } else if condition { ... } else { ... }
+ * The arms of an else-if chain are collected in a loop and linked from
+ * the last one back, so a long chain costs no C stack. Every arm stays
+ * open until the chain ends, so their EXIT events come last, innermost
+ * first. */
+static AstNode* parse_if_statement(Parser* parser) {
+    IfArm inline_arms[IF_ARMS_INLINE];
+    IfArm* arms = inline_arms;
+    size_t count = 0;
+    size_t capacity = IF_ARMS_INLINE;
     AstNode* else_branch = NULL;
-    if (parser_match(parser, TOKEN_ELSE)) {
-        if (parser_check(parser, TOKEN_IF)) {
-            /* else if - parse as another if statement */
-            parser_advance(parser);
-            else_branch = parse_if_statement(parser);
-        } else if (parser_check(parser, TOKEN_LEFT_BRACE)) {
-            else_branch = parse_block_statement(parser);
-        } else {
-            /* Single statement without braces */
-            else_branch = parser_parse_statement(parser);
+    
+    for (;;) {
+        Token if_token = parser->previous;
+        event_enter(parser, AST_IF_STMT, &if_token, NULL);
+        
+        /* Parse condition */
+        AstNode* condition = parser_parse_expression(parser);
+        if (!condition) {
+            report_at(parser, DIAG_EXPECTED_EXPRESSION, &parser->previous, "Expected condition in if statement");
+            event_exit(parser, AST_IF_STMT, &if_token);
+            break;
+        }
+        
+        if (count == capacity) {
+            IfArm* grown = grow_stack(arms, &capacity, sizeof(IfArm), inline_arms);
+            if (!grown) {
+                ast_free_node(condition);
+                report_at(parser, DIAG_OUT_OF_MEMORY, &parser->current, "Out of memory");
+                event_exit(parser, AST_IF_STMT, &if_token);
+                break;
+            }
+            arms = grown;
+        }
+        arms[count].if_token = if_token;
+        arms[count].condition = condition;
+        arms[count++].then_branch = parse_branch(parser);
+        
+        /* Parse else branch (optional) */
+        if (!parser_match(parser, TOKEN_ELSE)) break;
+        if (!parser_match(parser, TOKEN_IF)) {
+            else_branch = parse_branch(parser);
+            break;
         }
     }
     
-    return ast_create_if(condition, then_branch, else_branch, if_token.line, if_token.column);
+    /* An arm whose condition failed is dropped along with the rest */
+    AstNode* node = else_branch;
+    while (count > 0) {
+        IfArm* arm = &arms[--count];
+        node = ast_create_if(arm->condition, arm->then_branch, node, arm->if_token.line, arm->if_token.column);
+        with_span(parser, node, token_offset(parser, &arm->if_token));
+        event_exit(parser, AST_IF_STMT, &arm->if_token);
+    }
+    if (arms != inline_arms) free(arms);
+    return node;
 }
 
 /* Parse while loop: while condition { ... } */
 static AstNode* parse_while_statement(Parser* parser) {
     Token while_token = parser->previous;
+    event_enter(parser, AST_WHILE_STMT, &while_token, NULL);
     
     /* Parse condition */
     AstNode* condition = parser_parse_expression(parser);
     if (!condition) {
-        parser_error(parser, "Expected condition in while statement");
+        report_at(parser, DIAG_EXPECTED_EXPRESSION, &parser->previous, "Expected condition in while statement");
+        event_exit(parser, AST_WHILE_STMT, &while_token);
         return NULL;
     }
     
@@ -528,7 +1072,9 @@ static AstNode* parse_while_statement(Parser* parser) {
         body = parser_parse_statement(parser);
     }
     
-    return ast_create_while(condition, body, while_token.line, while_token.column);
+    AstNode* node = ast_create_while(condition, body, while_token.line, while_token.column);
+    event_exit(parser, AST_WHILE_STMT, &while_token);
+    return with_span(parser, node, token_offset(parser, &while_token));
 }
 
 /* Parse for loop: for i in 0..10 { ... } or for item in array { ... } */
@@ -537,25 +1083,26 @@ static AstNode* parse_for_statement(Parser* parser) {
     
     /* Parse iterator variable(s) */
     Token var = parser_expect(parser, TOKEN_IDENTIFIER, "Expected variable name in for loop");
-    char* var_name = string_dup_n(var.start, var.length);
     
     /* Check for index variable: for i, item in array */
-    char* index_var = NULL;
+    Token index = var;
+    bool indexed = false;
     if (parser_match(parser, TOKEN_COMMA)) {
-        index_var = var_name;
-        Token value_var = parser_expect(parser, TOKEN_IDENTIFIER, "Expected value variable after ','");
-        var_name = string_dup_n(value_var.start, value_var.length);
+        indexed = true;
+        var = parser_expect(parser, TOKEN_IDENTIFIER, "Expected value variable after ','");
     }
     
+    /* The event names the value variable, as ForStmt.variable does */
+    event_enter(parser, AST_FOR_STMT, &for_token, &var);
+    
     /* Expect 'in' keyword */
     parser_expect(parser, TOKEN_IN, "Expected 'in' in for loop");
     
     /* Parse iterable expression */
     AstNode* iterable = parser_parse_expression(parser);
     if (!iterable) {
-        parser_error(parser, "Expected iterable expression in for loop");
-        free(var_name);
-        if (index_var) free(index_var);
+        report_at(parser, DIAG_EXPECTED_EXPRESSION, &parser->previous, "Expected iterable expression in for loop");
+        event_exit(parser, AST_FOR_STMT, &for_token);
         return NULL;
     }
     
@@ -567,11 +1114,16 @@ static AstNode* parse_for_statement(Parser* parser) {
         body = parser_parse_statement(parser);
     }
     
+    char var_buffer[TEXT_INLINE], index_buffer[TEXT_INLINE];
+    char* var_name = token_text(var.start, var.length, var_buffer);
+    char* index_var = indexed ? token_text(index.start, index.length, index_buffer) : NULL;
     AstNode* result = ast_create_for(var_name, iterable, body, index_var,
                                      for_token.line, for_token.column);
+    with_span(parser, result, token_offset(parser, &for_token));
+    event_exit(parser, AST_FOR_STMT, &for_token);
     
-    free(var_name);
-    if (index_var) free(index_var);
+    text_free(var_name, var_buffer);
+    if (index_var) text_free(index_var, index_buffer);
     
     return result;
 }
@@ -579,6 +1131,7 @@ static AstNode* parse_for_statement(Parser* parser) {
 /* Parse infinite loop: loop { ... } */
 static AstNode* parse_loop_statement(Parser* parser) {
     Token loop_token = parser->previous;
+    event_enter(parser, AST_LOOP_STMT, &loop_token, NULL);
     
     /* Parse body */
     AstNode* body = NULL;
@@ -588,12 +1141,15 @@ static AstNode* parse_loop_statement(Parser* parser) {
         body = parser_parse_statement(parser);
     }
     
-    return ast_create_loop(body, loop_token.line, loop_token.column);
+    AstNode* node = ast_create_loop(body, loop_token.line, loop_token.column);
+    event_exit(parser, AST_LOOP_STMT, &loop_token);
+    return with_span(parser, node, token_offset(parser, &loop_token));
 }
 
 /* Parse return statement: return or return expr */
 static AstNode* parse_return_statement(Parser* parser) {
     Token return_token = parser->previous;
+    event_enter(parser, AST_RETURN_STMT, &return_token, NULL);
     
     AstNode* value = NULL;
     
@@ -606,7 +1162,47 @@ static AstNode* parse_return_statement(Parser* parser) {
         value = parser_parse_expression(parser);
     }
     
-    return ast_create_return(value, return_token.line, return_token.column);
+    AstNode* node = ast_create_return(value, return_token.line, return_token.column);
+    event_exit(parser, AST_RETURN_STMT, &return_token);
+    return with_span(parser, node, token_offset(parser, &return_token));
+}
+
+/* Skip a function body by brace matching over the token buffer.
+ * Bodies that are unbalanced or contain lexer errors are left for the
+ * eager parser so that errors are reported exactly as before. */
+static bool skip_function_body(Parser* parser, TokenRange* range) {
+    if (!parser->tokens || !parser_check(parser, TOKEN_LEFT_BRACE)) return false;
+    
+    const Token* tokens = parser->tokens->tokens;
+    size_t start = parser->position - 1;
+    size_t depth = 0;
+    
+    for (size_t i = start; i < parser->tokens->count; i++) {
+        switch (tokens[i].type) {
+            case TOKEN_LEFT_BRACE:
+                depth++;
+                break;
+            case TOKEN_RIGHT_BRACE:
+                if (--depth == 0) {
+                    range->start = start;
+                    range->end = i + 1;
+                    
+                    /* Resume as if the closing brace was just consumed */
+                    parser->current = tokens[i];
+                    parser->position = i + 1;
+                    parser_advance(parser);
+                    return true;
+                }
+                break;
+            case TOKEN_ERROR:
+            case TOKEN_EOF:
+                return false;
+            default:
+                break;
+        }
+    }
+    
+    return false;
 }
 
 /* Parse function declaration: func name(params) { ... } or func name(params) -> type { ... } */
@@ -615,7 +1211,7 @@ static AstNode* parse_function_declaration(Parser* parser) {
     
     /* Parse function name */
     Token name_token = parser_expect(parser, TOKEN_IDENTIFIER, "Expected function name");
-    char* func_name = string_dup_n(name_token.start, name_token.length);
+    event_enter(parser, AST_FUNCTION_DECL, &func_token, &name_token);
     
     /* Parse parameter list */
     parser_expect(parser, TOKEN_LEFT_PAREN, "Expected '(' after function name");
@@ -625,21 +1221,22 @@ static AstNode* parse_function_declaration(Parser* parser) {
     if (!parser_check(parser, TOKEN_RIGHT_PAREN)) {
         do {
             Token param = parser_expect(parser, TOKEN_IDENTIFIER, "Expected parameter name");
-            char* param_name = string_dup_n(param.start, param.length);
+            char name_buffer[TEXT_INLINE], type_buffer[TEXT_INLINE];
+            char* param_name = token_text(param.start, param.length, name_buffer);
             
             /* Check for type annotation: param: type */
             char* param_type = NULL;
             if (parser_match(parser, TOKEN_COLON)) {
                 Token type_token = parser_expect(parser, TOKEN_IDENTIFIER, "Expected parameter type");
-                param_type = string_dup_n(type_token.start, type_token.length);
+                param_type = token_text(type_token.start, type_token.length, type_buffer);
             }
             
             /* Create parameter object */
             Parameter* param_obj = ast_create_parameter(param_name, param_type, NULL);
             ast_list_append(params, param_obj);
             
-            free(param_name);
-            if (param_type) free(param_type);
+            text_free(param_name, name_buffer);
+            if (param_type) text_free(param_type, type_buffer);
             
         } while (parser_match(parser, TOKEN_COMMA));
     }
@@ -647,10 +1244,32 @@ static AstNode* parse_function_declaration(Parser* parser) {
     parser_expect(parser, TOKEN_RIGHT_PAREN, "Expected ')' after parameters");
     
     /* Check for return type annotation: -> type */
+    char name_buffer[TEXT_INLINE], type_buffer[TEXT_INLINE];
     char* return_type = NULL;
     if (parser_match(parser, TOKEN_ARROW)) {
         Token type_token = parser_expect(parser, TOKEN_IDENTIFIER, "Expected return type");
-        return_type = string_dup_n(type_token.start, type_token.length);
+        return_type = token_text(type_token.start, type_token.length, type_buffer);
+    }
+    
+    recover_signature(parser);
+    char* func_name = token_text(name_token.start, name_token.length, name_buffer);
+    
+    /* Lazy mode: record the body's token range instead of parsing it */
+    TokenRange body_tokens = { 0, 0 };
+    if (parser->lazy_bodies && skip_function_body(parser, &body_tokens)) {
+        AstNode* func = ast_create_function(func_name, params, NULL, return_type,
+                                            func_token.line, func_token.column);
+        with_span(parser, func, token_offset(parser, &func_token));
+        if (func) {
+            func->as.function.body_tokens = body_tokens;
+            func->as.function.body_pending = true;
+        }
+        event_exit(parser, AST_FUNCTION_DECL, &func_token);
+        
+        text_free(func_name, name_buffer);
+        if (return_type) text_free(return_type, type_buffer);
+        
+        return func;
     }
     
     /* Parse function body */
@@ -658,76 +1277,213 @@ static AstNode* parse_function_declaration(Parser* parser) {
     
     AstNode* func = ast_create_function(func_name, params, body, return_type,
                                         func_token.line, func_token.column);
+    with_span(parser, func, token_offset(parser, &func_token));
+    event_exit(parser, AST_FUNCTION_DECL, &func_token);
     
-    free(func_name);
-    if (return_type) free(return_type);
+    text_free(func_name, name_buffer);
+    if (return_type) text_free(return_type, type_buffer);
     
     return func;
 }
 
+AstNode* parser_materialize_body(Parser* parser, AstNode* function) {
+    if (!function || function->type != AST_FUNCTION_DECL) return NULL;
+    
+    FunctionDecl* decl = &function->as.function;
+    if (!decl->body_pending) return decl->body;
+    
+    /* Parse the recorded range with a parser of its own */
+    Parser body_parser;
+    parser_init_tokens(&body_parser, parser->tokens, decl->body_tokens.start);
+    body_parser.cons = parser->cons;
+    body_parser.fold_constants = parser->fold_constants;
+    body_parser.silent = parser->silent;
+    body_parser.max_depth = parser->max_depth;
+    parser_set_diagnostics(&body_parser, parser->diags);
+    
+    AstNode* body = parse_block_statement(&body_parser);
+    decl->body_pending = false;
+    function->hash = 0;
+    flush_own_diagnostics(parser);
+    
+    if (body_parser.had_error) {
+        parser->had_error = true;
+        ast_free_node(body);
+        return NULL;
+    }
+    
+    decl->body = body;
+    return body;
+}
+
+/* Parse class field: [hot] name [: type] [= default] */
+static AstNode* parse_field(Parser* parser) {
+    /* 'hot' is only a keyword in front of a field name */
+    size_t start = span_start(parser);
+    bool hot = false;
+    Token name_token = parser_expect(parser, TOKEN_IDENTIFIER, "Expected field or method in class body");
+    if (parser->panic_mode) return NULL;
+    if (name_token.length == 3 && memcmp(name_token.start, "hot", 3) == 0 &&
+        parser_check(parser, TOKEN_IDENTIFIER)) {
+        hot = true;
+        name_token = parser->current;
+        parser_advance(parser);
+    }
+    event_enter(parser, AST_VAR_DECL, &name_token, &name_token);
+    
+    char name_buffer[TEXT_INLINE], type_buffer[TEXT_INLINE];
+    char* type_name = NULL;
+    if (parser_match(parser, TOKEN_COLON)) {
+        Token type_token = parser_expect(parser, TOKEN_IDENTIFIER, "Expected field type");
+        type_name = token_text(type_token.start, type_token.length, type_buffer);
+    }
+    
+    AstNode* init = NULL;
+    if (parser_match(parser, TOKEN_EQUAL)) {
+        init = parser_parse_expression(parser);
+    }
+    
+    char* name = token_text(name_token.start, name_token.length, name_buffer);
+    AstNode* field = ast_create_var_decl(name, type_name, init, name_token.line, name_token.column);
+    with_span(parser, field, start);
+    if (field) field->as.var_decl.hot = hot;
+    event_exit(parser, AST_VAR_DECL, &name_token);
+    text_free(name, name_buffer);
+    if (type_name) text_free(type_name, type_buffer);
+    return field;
+}
+
+/* Parse class declaration: class Name { fields and methods } */
+static AstNode* parse_class_declaration(Parser* parser) {
+    Token class_token = parser->previous;
+    
+    Token name_token = parser_expect(parser, TOKEN_IDENTIFIER, "Expected class name");
+    event_enter(parser, AST_CLASS_DECL, &class_token, &name_token);
+    parser_expect(parser, TOKEN_LEFT_BRACE, "Expected '{' after class name");
+    
+    AstList* fields = ast_list_create();
+    AstList* methods = ast_list_create();
+    
+    while (!parser_check(parser, TOKEN_RIGHT_BRACE) && !parser_is_at_end(parser)) {
+        const char* before = parser->current.start;
+        
+        if (parser_match(parser, TOKEN_FUNC)) {
+            AstNode* method = parse_function_declaration(parser);
+            if (method) ast_list_append(methods, method);
+        } else {
+            AstNode* field = parse_field(parser);
+            if (field) ast_list_append(fields, field);
+        }
+        
+        if (parser->panic_mode) {
+            if (parser->current.start == before) {
+                parser_advance(parser);
+            }
+            synchronize(parser, true);
+        }
+    }
+    
+    parser_expect(parser, TOKEN_RIGHT_BRACE, "Expected '}' after class body");
+    
+    char buffer[TEXT_INLINE];
+    char* class_name = token_text(name_token.start, name_token.length, buffer);
+    AstNode* class_decl = ast_create_class(class_name, methods, fields,
+                                           class_token.line, class_token.column);
+    with_span(parser, class_decl, token_offset(parser, &class_token));
+    event_exit(parser, AST_CLASS_DECL, &class_token);
+    text_free(class_name, buffer);
+    return class_decl;
+}
+
+/* Parse import statement: import name */
+static AstNode* parse_import_statement(Parser* parser) {
+    Token import_token = parser->previous;
+    
+    Token name_token = parser_expect(parser, TOKEN_IDENTIFIER, "Expected module name after 'import'");
+    event_enter(parser, AST_IMPORT_STMT, &import_token, &name_token);
+    
+    char buffer[TEXT_INLINE];
+    char* module_name = token_text(name_token.start, name_token.length, buffer);
+    AstNode* node = ast_create_import(module_name, import_token.line, import_token.column);
+    with_span(parser, node, token_offset(parser, &import_token));
+    event_exit(parser, AST_IMPORT_STMT, &import_token);
+    text_free(module_name, buffer);
+    return node;
+}
+
 /* ===== Statement Parsing (Basic) ===== */
 
-AstNode* parser_parse_statement(Parser* parser) {
-    /* Variable declaration: identifier = expr OR identifier: type = expr */
+/* Finish target = value once '=' has been consumed; the target began at start */
+static AstNode* parse_assignment(Parser* parser, AstNode* target, size_t start) {
+    Token equal = parser->previous;
+    
+    if (target->type != AST_IDENTIFIER_EXPR && target->type != AST_MEMBER_EXPR &&
+        target->type != AST_INDEX_EXPR) {
+        report_at(parser, DIAG_SYNTAX, &equal, "Invalid assignment target");
+        ast_free_node(target);
+        return NULL;
+    }
+    
+    AstNode* value = parser_parse_expression(parser);
+    if (!value) {
+        report_at(parser, DIAG_EXPECTED_EXPRESSION, &parser->current, "Expected value after '='");
+        ast_free_node(target);
+        return NULL;
+    }
+    
+    AstNode* assign = ast_create_assign(target, value, target->line, target->column);
+    event_reduce(parser, AST_ASSIGN_STMT, assign, start, NULL, 0, 0, 2);
+    return with_span(parser, assign, start);
+}
+
+static AstNode* parse_statement(Parser* parser) {
+    /* Variable declaration: identifier = expr OR identifier: type = expr.
+     * Anything else led by an identifier ("print(...)", "a.b = c", "x + 1")
+     * is an expression statement: rewind and read the identifier again as
+     * the start of a full expression. */
     if (parser_check(parser, TOKEN_IDENTIFIER)) {
-        /* We need to peek ahead to distinguish:
-         * - "x = 42" (variable declaration)
-         * - "x: int = 42" (typed variable declaration)
-         * - "print(...)" (expression statement with function call)
-         */
-        
-        /* Since we can't easily backtrack with streaming lexer,
-         * we'll handle this by checking the NEXT token after identifier.
-         * This requires a two-token lookahead which we can hack with
-         * saving state temporarily.
-         */
+        ParserCheckpoint checkpoint = parser_checkpoint(parser);
         Token name_token = parser->current;
+        size_t start = span_start(parser);
         parser_advance(parser);
         
         /* Check for type annotation (x: type = value) */
         if (parser_check(parser, TOKEN_COLON)) {
             parser_advance(parser);
             Token type_token = parser_expect(parser, TOKEN_IDENTIFIER, "Expected type name");
-            char* type_name = string_dup_n(type_token.start, type_token.length);
             
             parser_expect(parser, TOKEN_EQUAL, "Expected '=' after type");
+            event_enter(parser, AST_VAR_DECL, &name_token, &name_token);
             AstNode* init = parser_parse_expression(parser);
             
-            char* var_name = string_dup_n(name_token.start, name_token.length);
+            char name_buffer[TEXT_INLINE], type_buffer[TEXT_INLINE];
+            char* var_name = token_text(name_token.start, name_token.length, name_buffer);
+            char* type_name = token_text(type_token.start, type_token.length, type_buffer);
             AstNode* var_decl = ast_create_var_decl(var_name, type_name, init, 
                                                      name_token.line, name_token.column);
-            free(var_name);
-            free(type_name);
+            with_span(parser, var_decl, start);
+            event_exit(parser, AST_VAR_DECL, &name_token);
+            text_free(var_name, name_buffer);
+            text_free(type_name, type_buffer);
             return var_decl;
         }
         /* Simple assignment: x = value (treat as variable declaration) */
-        else if (parser_check(parser, TOKEN_EQUAL)) {
+        if (parser_check(parser, TOKEN_EQUAL)) {
             parser_advance(parser);
+            event_enter(parser, AST_VAR_DECL, &name_token, &name_token);
             AstNode* value = parser_parse_expression(parser);
             
-            char* var_name = string_dup_n(name_token.start, name_token.length);
+            char buffer[TEXT_INLINE];
+            char* var_name = token_text(name_token.start, name_token.length, buffer);
             AstNode* var_decl = ast_create_var_decl(var_name, NULL, value,
                                                      name_token.line, name_token.column);
-            free(var_name);
+            with_span(parser, var_decl, start);
+            event_exit(parser, AST_VAR_DECL, &name_token);
+            text_free(var_name, buffer);
             return var_decl;
         }
-        else {
-            /* It's an expression like "print(...)" or "foo.bar" 
-             * We already consumed the identifier, so create it manually
-             * and then continue parsing postfix expressions
-             */
-            char* id_name = string_dup_n(name_token.start, name_token.length);
-            AstNode* expr = ast_create_identifier(id_name, name_token.line, name_token.column);
-            free(id_name);
-            
-            /* Now parse any postfix operations (calls, indexing, member access) */
-            expr = parse_postfix_continue(parser, expr);
-            
-            /* Parse any binary operations that follow */
-            /* This is a simplification - ideally we'd restart the precedence climb */
-            /* For now, just return as expression statement */
-            return ast_create_expr_stmt(expr, expr->line, expr->column);
-        }
+        
+        parser_rewind(parser, &checkpoint);
     }
     
     /* If statement */
@@ -758,21 +1514,44 @@ AstNode* parser_parse_statement(Parser* parser) {
     /* Break statement */
     if (parser_match(parser, TOKEN_BREAK)) {
         Token tok = parser->previous;
-        return ast_create_break(tok.line, tok.column);
+        event_leaf(parser, AST_BREAK_STMT, &tok, false, 0);
+        return with_span(parser, ast_create_break(tok.line, tok.column), token_offset(parser, &tok));
     }
     
     /* Continue statement */
     if (parser_match(parser, TOKEN_CONTINUE)) {
         Token tok = parser->previous;
-        return ast_create_continue(tok.line, tok.column);
+        event_leaf(parser, AST_CONTINUE_STMT, &tok, false, 0);
+        return with_span(parser, ast_create_continue(tok.line, tok.column), token_offset(parser, &tok));
     }
     
-    /* Default: expression statement */
+    /* Default: expression statement; an assignment is only recognised at
+     * its '=', so its event arrives inside the statement's */
+    Token first = parser->current;
+    size_t start = span_start(parser);
+    event_enter(parser, AST_EXPR_STMT, &first, NULL);
     AstNode* expr = parser_parse_expression(parser);
+    AstNode* stmt;
     if (!expr) {
-        return NULL;
+        /* A stray ')' or ']' yields no expression and no error; report it
+         * so that the caller's recovery skips the token */
+        report_at(parser, DIAG_EXPECTED_EXPRESSION, &parser->current, "Expected expression");
+        stmt = NULL;
+    } else if (parser_match(parser, TOKEN_EQUAL)) {
+        stmt = parse_assignment(parser, expr, start);
+    } else {
+        stmt = with_span(parser, ast_create_expr_stmt(expr, expr->line, expr->column), start);
     }
-    return ast_create_expr_stmt(expr, expr->line, expr->column);
+    event_exit(parser, AST_EXPR_STMT, &first);
+    return stmt;
+}
+
+/* Statements nest through blocks and branches; each one is a level */
+AstNode* parser_parse_statement(Parser* parser) {
+    if (!enter_nesting(parser)) return NULL;
+    AstNode* stmt = parse_statement(parser);
+    leave_nesting(parser);
+    return stmt;
 }
 
 AstNode* parser_parse_declaration(Parser* parser) {
@@ -781,6 +1560,16 @@ AstNode* parser_parse_declaration(Parser* parser) {
         return parse_function_declaration(parser);
     }
     
+    /* Class declaration */
+    if (parser_match(parser, TOKEN_CLASS)) {
+        return parse_class_declaration(parser);
+    }
+    
+    /* Imports are top-level only */
+    if (parser_match(parser, TOKEN_IMPORT)) {
+        return parse_import_statement(parser);
+    }
+    
     /* Otherwise, parse as statement */
     return parser_parse_statement(parser);
 }
@@ -790,25 +1579,113 @@ AstNode* parser_parse_declaration(Parser* parser) {
 AstNode* parser_parse(Parser* parser) {
     AstList* declarations = ast_list_create();
     
+    /* Buffer parses remember where each declaration came from */
+    TokenRange* ranges = NULL;
+    size_t range_capacity = 0;
+    
     while (!parser_is_at_end(parser)) {
+        size_t start = parser->position - 1;
+        const char* before = parser->current.start;
         AstNode* decl = parser_parse_declaration(parser);
         if (decl) {
             ast_list_append(declarations, decl);
+            
+            if (parser->tokens) {
+                if (declarations->count > range_capacity) {
+                    range_capacity = range_capacity ? range_capacity * 2 : 16;
+                    TokenRange* grown = (TokenRange*)realloc(ranges, range_capacity * sizeof(TokenRange));
+                    if (!grown) {
+                        report_at(parser, DIAG_OUT_OF_MEMORY, &parser->current, "Out of memory");
+                        break;
+                    }
+                    ranges = grown;
+                }
+                ranges[declarations->count - 1].start = start;
+                ranges[declarations->count - 1].end = parser->position - 1;
+            }
         }
         
         if (parser->panic_mode) {
+            if (parser->current.start == before) {
+                parser_advance(parser);
+            }
             parser_synchronize(parser);
         }
     }
     
+    flush_own_diagnostics(parser);
+    
     if (parser->had_error) {
         /* Free declarations and return NULL on error */
         for (size_t i = 0; i < declarations->count; i++) {
             ast_free_node((AstNode*)declarations->items[i]);
         }
         ast_list_free(declarations);
+        free(ranges);
         return NULL;
     }
     
-    return ast_create_program(declarations);
+    /* The program spans everything up to where parsing stopped */
+    AstNode* program = ast_create_program(declarations);
+    if (program) {
+        program->as.program.decl_tokens = ranges;
+        program->length = (uint32_t)span_start(parser);
+    }
+    return program;
+}
+
+/* ===== Event-Stream Parsing ===== */
+
+bool parser_parse_events(Parser* parser, StringInterner* interner,
+                         ParseEventHandler handler, void* context) {
+    ParseEventSink sink = { interner, handler, context };
+    
+    /* Options that keep nodes past their declaration are off meanwhile */
+    AstConsTable* cons = parser->cons;
+    bool lazy_bodies = parser->lazy_bodies;
+    bool fold_constants = parser->fold_constants;
+    parser->cons = NULL;
+    parser->lazy_bodies = false;
+    parser->fold_constants = false;
+    parser->events = &sink;
+    
+    /* Each declaration is built in the scratch arena, which is cut back
+     * once it has been reported; without one, it is freed instead */
+    AstArena* scratch = ast_arena_create();
+    AstArena* previous_arena = scratch ? ast_use_arena(scratch) : NULL;
+    AstArenaMark empty = { NULL, 0, 0 };
+    if (scratch) empty = ast_arena_mark(scratch);
+    
+    emit_event(parser, PARSE_EVENT_ENTER, AST_PROGRAM, 0, 0, 1, 1, NULL, 0, 0, 0);
+    
+    while (!parser_is_at_end(parser)) {
+        const char* before = parser->current.start;
+        AstNode* decl = parser_parse_declaration(parser);
+        if (scratch) {
+            ast_arena_rewind(scratch, empty);
+        } else {
+            ast_free_node(decl);
+        }
+        
+        if (parser->panic_mode) {
+            if (parser->current.start == before) {
+                parser_advance(parser);
+            }
+            parser_synchronize(parser);
+        }
+    }
+    
+    flush_own_diagnostics(parser);
+    
+    emit_event(parser, PARSE_EVENT_EXIT, AST_PROGRAM, 0, span_length(parser, 0), 1, 1, NULL, 0, 0, 0);
+    
+    if (scratch) {
+        ast_use_arena(previous_arena);
+        ast_arena_free(scratch);
+    }
+    parser->events = NULL;
+    parser->cons = cons;
+    parser->lazy_bodies = lazy_bodies;
+    parser->fold_constants = fold_constants;
+    return !parser->had_error;
 }
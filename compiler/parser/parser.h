@@ -8,23 +8,89 @@
 #define PARSER_H
 
 #include "ast.h"
+#include "ast_cons.h"
+#include "ast_fold.h"
+#include "diagnostics.h"
 #include "../lexer/lexer.h"
 #include "../lexer/token.h"
+#include "../lexer/token_buffer.h"
 #include <stdbool.h>
 
 /* Parser state */
 typedef struct {
-    Lexer* lexer;           /* Lexer for token generation */
+    Lexer* lexer;           /* Lexer for token generation (streaming mode) */
+    TokenBuffer* tokens;    /* Pre-lexed tokens (buffer mode), NULL when streaming */
+    size_t position;        /* Buffer index of the token after current */
     Token current;          /* Current token */
     Token previous;         /* Previous token */
     bool had_error;         /* Error flag */
     bool panic_mode;        /* Panic mode for error recovery */
+    AstConsTable* cons;     /* Hash-consing table, NULL when disabled */
+    bool lazy_bodies;       /* Skip function bodies (buffer mode only) */
+    bool fold_constants;    /* Fold literal operators while parsing */
+    bool silent;            /* Track errors without recording them */
+    size_t depth;           /* Current nesting (see parser_set_nesting_limit) */
+    size_t max_depth;
+    DiagBuffer* diags;      /* Where errors are recorded */
+    DiagBuffer own_diags;   /* Used until parser_set_diagnostics() */
+    struct ParseEventSink* events;  /* Event-stream mode (parser_events.h), else NULL */
 } Parser;
 
+/* Saved parser position (see parser_checkpoint) */
+typedef struct {
+    Lexer lexer;            /* Streaming mode only */
+    size_t position;        /* Buffer mode only */
+    Token current;
+    Token previous;
+    bool had_error;
+    bool panic_mode;
+    size_t depth;
+    size_t diag_count;
+    AstArena* arena;        /* Arena installed when taken, NULL for the heap */
+    AstArenaMark arena_mark;
+} ParserCheckpoint;
+
 /* Parser initialization and cleanup */
 void parser_init(Parser* parser, Lexer* lexer);
+void parser_init_tokens(Parser* parser, TokenBuffer* tokens, size_t start);
 void parser_free(Parser* parser);
 
+/* Diagnostics are appended to a buffer, never printed while parsing.
+ * Without a caller-provided buffer, parser_parse() renders its errors
+ * to stderr in one batch when it finishes. With one, the caller renders
+ * (see diag_render_text/json); errors already recorded are moved over. */
+void parser_set_diagnostics(Parser* parser, DiagBuffer* diags);
+
+/* Opt-in hash-consing: identical pure expressions share one node.
+ * The caller owns the table and frees it after the trees using it. */
+void parser_enable_hash_consing(Parser* parser, AstConsTable* table);
+
+/* Lazy function bodies: over a token buffer, parse_function_declaration()
+ * skips each body by brace matching and records its token range.
+ * parser_materialize_body() parses a skipped body on first access. */
+void parser_enable_lazy_bodies(Parser* parser, bool enabled);
+AstNode* parser_materialize_body(Parser* parser, AstNode* function);
+
+/* Opt-in constant folding (see ast_fold.h): literal operands and simple
+ * identities are reduced as the expression is built */
+void parser_enable_constant_folding(Parser* parser, bool enabled);
+
+/* Statements, parentheses, prefix operators and bracketed or call
+ * argument expressions nested deeper than limit are reported as
+ * DIAG_NESTING_LIMIT instead of exhausting the C stack. Binary operator
+ * chains and else-if chains are parsed iteratively and do not count. */
+#define PARSER_DEFAULT_NESTING_LIMIT 512
+void parser_set_nesting_limit(Parser* parser, size_t limit);
+
+/* Speculative parsing: parser_rewind() returns to a checkpoint as if the
+ * tokens since had never been read, dropping the diagnostics reported
+ * since. Over a token buffer this restores an index; over the lexer it
+ * restores the lexer state. When nodes come from an arena the rewind also
+ * releases those allocated since (except with hash-consing, whose table
+ * may still refer to them); heap nodes must be freed by the caller. */
+ParserCheckpoint parser_checkpoint(Parser* parser);
+void parser_rewind(Parser* parser, const ParserCheckpoint* checkpoint);
+
 /* Main parsing entry point */
 AstNode* parser_parse(Parser* parser);
 
@@ -0,0 +1,75 @@
+/* LAMC Compiler - Event-Stream Parser
+ * Reports the parse as a stream of callbacks instead of building a tree
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef PARSER_EVENTS_H
+#define PARSER_EVENTS_H
+
+#include "parser.h"
+#include "intern.h"
+
+typedef enum {
+    PARSE_EVENT_ENTER,      /* A declaration, statement or block begins */
+    PARSE_EVENT_EXIT,       /* It ends; the span covers all of it */
+    PARSE_EVENT_LEAF,       /* Literal, identifier, break or continue */
+    PARSE_EVENT_REDUCE      /* A composite expression, after its operands */
+} ParseEventKind;
+
+/* One parse event. Expression operators are only recognised after their
+ * left operand, so expressions arrive in postfix order: the operands'
+ * events first, then one REDUCE event for the node spanning them, where
+ * arity is the number of operand subtrees it closes (a call counts its
+ * callee and its arguments). Declarations, statements and blocks are
+ * bracketed by ENTER/EXIT. An assignment is only recognised at its '=',
+ * so it arrives as a REDUCE over target and value inside the ENTER/EXIT
+ * of an AST_EXPR_STMT. Class fields are reported as AST_VAR_DECL and
+ * imports are named after their module. Parameters and type annotations
+ * are not reported. */
+typedef struct {
+    ParseEventKind kind;
+    AstNodeType node;       /* Kind of the node, as it would appear in the tree */
+    size_t offset;          /* Byte span in the source */
+    size_t length;
+    int line;               /* Lexer position of the node's first token; */
+    int column;             /*   for REDUCE, the one its tree node records */
+    const char* name;       /* Declared, referenced or called name, else NULL; */
+    size_t name_length;     /*   points into the source, not terminated */
+    uint32_t name_id;       /* Interned name, 0 without an interner or name */
+    int op;                 /* BinaryOp, UnaryOp or LiteralType when relevant */
+    size_t arity;           /* Operand subtrees closed by a REDUCE event */
+} ParseEvent;
+
+typedef void (*ParseEventHandler)(const ParseEvent* event, void* context);
+
+/* Where parser.c delivers events while parser_parse_events() runs */
+typedef struct ParseEventSink {
+    StringInterner* interner;
+    ParseEventHandler handler;
+    void* context;
+} ParseEventSink;
+
+/* Parse the whole input with parser_parse()'s grammar, calling handler
+ * for every node as it is parsed. Calls whose callee is a plain
+ * identifier carry its name. Names are interned when interner is
+ * non-NULL.
+ *
+ * Nodes are still built: the shared grammar reads them back to check
+ * assignment targets and dictionary keys, to name callees and to place
+ * REDUCE events. They go to a scratch arena, together with their lists
+ * and names, which is cut back once each top-level declaration has been
+ * reported, so no tree is kept or walked to free it and the heap is
+ * only touched when a declaration outgrows the arena's chunks, for the
+ * key positions of a dictionary literal and for token text of 64 bytes
+ * or more. bench_events reports the arena bytes per event when built
+ * with STATS=1.
+ *
+ * Syntax errors are reported and recovered from exactly as in
+ * parser_parse(), but events already delivered stand: on failure the
+ * stream covers the recovered parse. Returns false if there was any
+ * error. Hash-consing, lazy bodies and constant folding are suspended
+ * for the call. */
+bool parser_parse_events(Parser* parser, StringInterner* interner,
+                         ParseEventHandler handler, void* context);
+
+#endif /* PARSER_EVENTS_H */
@@ -0,0 +1,159 @@
+/* LAMC Compiler - Parser Statistics
+ * Opt-in allocation and work counters for the parser and AST
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "stats.h"
+#include <stdatomic.h>
+#include <sys/resource.h>
+
+static _Atomic uint64_t node_counts[AST_NODE_TYPE_COUNT];
+static _Atomic uint64_t byte_counts[STATS_BYTES_CATEGORY_COUNT];
+static _Atomic uint64_t token_count;
+static _Atomic uint64_t match_calls;
+static _Atomic uint64_t match_hits;
+
+/* ===== Counting ===== */
+
+static uint64_t load(_Atomic uint64_t* counter) {
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+#ifdef LAMC_STATS
+/* Relaxed: counters are only read once the work being measured is done */
+static void bump(_Atomic uint64_t* counter, uint64_t amount) {
+    atomic_fetch_add_explicit(counter, amount, memory_order_relaxed);
+}
+
+void parse_stats_count_node(AstNodeType type) {
+    bump(&node_counts[type], 1);
+}
+
+void parse_stats_add_bytes(StatsBytesCategory category, size_t bytes) {
+    bump(&byte_counts[category], bytes);
+}
+
+void parse_stats_count_token(void) {
+    bump(&token_count, 1);
+}
+
+void parse_stats_count_match(bool hit) {
+    bump(&match_calls, 1);
+    if (hit) bump(&match_hits, 1);
+}
+#endif
+
+void parse_stats_reset(void) {
+    for (int i = 0; i < AST_NODE_TYPE_COUNT; i++) {
+        atomic_store_explicit(&node_counts[i], 0, memory_order_relaxed);
+    }
+    for (int i = 0; i < STATS_BYTES_CATEGORY_COUNT; i++) {
+        atomic_store_explicit(&byte_counts[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&token_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&match_calls, 0, memory_order_relaxed);
+    atomic_store_explicit(&match_hits, 0, memory_order_relaxed);
+}
+
+void parse_stats_snapshot(ParseStats* stats) {
+#ifdef LAMC_STATS
+    stats->enabled = true;
+#else
+    stats->enabled = false;
+#endif
+    for (int i = 0; i < AST_NODE_TYPE_COUNT; i++) {
+        stats->nodes[i] = load(&node_counts[i]);
+    }
+    for (int i = 0; i < STATS_BYTES_CATEGORY_COUNT; i++) {
+        stats->bytes[i] = load(&byte_counts[i]);
+    }
+    stats->tokens = load(&token_count);
+    stats->match_calls = load(&match_calls);
+    stats->match_hits = load(&match_hits);
+
+    /* ru_maxrss is in kilobytes on Linux */
+    struct rusage usage;
+    stats->peak_rss_kb = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+}
+
+const char* stats_bytes_category_name(StatsBytesCategory category) {
+    switch (category) {
+        case STATS_BYTES_NODES: return "nodes";
+        case STATS_BYTES_LISTS: return "lists";
+        case STATS_BYTES_LIST_GROWTH: return "list_growth";
+        case STATS_BYTES_STRINGS: return "strings";
+        case STATS_BYTES_AUX: return "aux";
+        case STATS_BYTES_SCRATCH: return "scratch";
+        default: return "unknown";
+    }
+}
+
+/* ===== Reports ===== */
+
+static uint64_t total(const uint64_t* counts, int count) {
+    uint64_t sum = 0;
+    for (int i = 0; i < count; i++) sum += counts[i];
+    return sum;
+}
+
+void parse_stats_print(const ParseStats* stats, FILE* out) {
+    fprintf(out, "Parser statistics:\n");
+    if (stats->peak_rss_kb >= 0) {
+        fprintf(out, "  peak RSS:           %ld KB\n", stats->peak_rss_kb);
+    }
+    if (!stats->enabled) {
+        fprintf(out, "  (counters not compiled in; rebuild with make STATS=1)\n");
+        return;
+    }
+
+    fprintf(out, "  tokens consumed:    %llu\n", (unsigned long long)stats->tokens);
+    fprintf(out, "  parser_match calls: %llu (%llu matched)\n",
+            (unsigned long long)stats->match_calls, (unsigned long long)stats->match_hits);
+
+    fprintf(out, "  bytes allocated:\n");
+    for (int i = 0; i < STATS_BYTES_CATEGORY_COUNT; i++) {
+        fprintf(out, "    %-16s %llu\n", stats_bytes_category_name((StatsBytesCategory)i),
+                (unsigned long long)stats->bytes[i]);
+    }
+    fprintf(out, "    %-16s %llu\n", "total",
+            (unsigned long long)total(stats->bytes, STATS_BYTES_CATEGORY_COUNT));
+
+    fprintf(out, "  nodes created:\n");
+    for (int i = 0; i < AST_NODE_TYPE_COUNT; i++) {
+        if (stats->nodes[i] == 0) continue;
+        fprintf(out, "    %-16s %llu\n", ast_node_type_name((AstNodeType)i),
+                (unsigned long long)stats->nodes[i]);
+    }
+    fprintf(out, "    %-16s %llu\n", "total",
+            (unsigned long long)total(stats->nodes, AST_NODE_TYPE_COUNT));
+}
+
+void parse_stats_print_json(const ParseStats* stats, FILE* out) {
+    fprintf(out, "{\"enabled\": %s", stats->enabled ? "true" : "false");
+    if (stats->peak_rss_kb >= 0) {
+        fprintf(out, ", \"peak_rss_kb\": %ld", stats->peak_rss_kb);
+    } else {
+        fputs(", \"peak_rss_kb\": null", out);
+    }
+    if (!stats->enabled) {
+        fputs("}\n", out);
+        return;
+    }
+
+    fprintf(out, ", \"tokens\": %llu, \"match_calls\": %llu, \"match_hits\": %llu",
+            (unsigned long long)stats->tokens, (unsigned long long)stats->match_calls,
+            (unsigned long long)stats->match_hits);
+
+    fputs(",\n  \"bytes\": {", out);
+    for (int i = 0; i < STATS_BYTES_CATEGORY_COUNT; i++) {
+        fprintf(out, "%s\"%s\": %llu", i > 0 ? ", " : "",
+                stats_bytes_category_name((StatsBytesCategory)i),
+                (unsigned long long)stats->bytes[i]);
+    }
+    fputs("},\n  \"nodes\": {", out);
+    for (int i = 0; i < AST_NODE_TYPE_COUNT; i++) {
+        fprintf(out, "%s\"%s\": %llu", i > 0 ? ", " : "", ast_node_type_name((AstNodeType)i),
+                (unsigned long long)stats->nodes[i]);
+    }
+    fputs("}}\n", out);
+}
@@ -0,0 +1,67 @@
+/* LAMC Compiler - Parser Statistics
+ * Opt-in allocation and work counters for the parser and AST
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "ast.h"
+
+#define AST_NODE_TYPE_COUNT (AST_PROGRAM + 1)
+
+/* What allocated bytes were spent on */
+typedef enum {
+    STATS_BYTES_NODES,          /* AstNode structs */
+    STATS_BYTES_LISTS,          /* AstList headers */
+    STATS_BYTES_LIST_GROWTH,    /* Item arrays grown by ast_list_append */
+    STATS_BYTES_STRINGS,        /* Names and string values owned by nodes */
+    STATS_BYTES_AUX,            /* Parameters, dictionary entries, layouts */
+    STATS_BYTES_SCRATCH,        /* Token text copied by the parser, freed after use */
+    STATS_BYTES_CATEGORY_COUNT
+} StatsBytesCategory;
+
+typedef struct {
+    bool enabled;               /* Built with LAMC_STATS; otherwise only peak_rss_kb is set */
+    uint64_t nodes[AST_NODE_TYPE_COUNT];
+    uint64_t bytes[STATS_BYTES_CATEGORY_COUNT];
+    uint64_t tokens;            /* Tokens consumed by parser_advance */
+    uint64_t match_calls;       /* parser_match calls */
+    uint64_t match_hits;        /* ... that consumed a token */
+    long peak_rss_kb;           /* Peak resident set of the process, -1 if unknown */
+} ParseStats;
+
+/* The counters are process-wide and safe to update from several threads.
+ * Bytes are counted as requested, whether from an arena or the heap;
+ * frees are not tracked. */
+void parse_stats_reset(void);
+void parse_stats_snapshot(ParseStats* stats);
+
+void parse_stats_print(const ParseStats* stats, FILE* out);
+void parse_stats_print_json(const ParseStats* stats, FILE* out);
+
+const char* stats_bytes_category_name(StatsBytesCategory category);
+
+/* Instrumentation points compile away unless LAMC_STATS is defined
+ * (make STATS=1) */
+#ifdef LAMC_STATS
+void parse_stats_count_node(AstNodeType type);
+void parse_stats_add_bytes(StatsBytesCategory category, size_t bytes);
+void parse_stats_count_token(void);
+void parse_stats_count_match(bool hit);
+
+#define STATS_NODE(type)             parse_stats_count_node(type)
+#define STATS_BYTES(category, bytes) parse_stats_add_bytes(category, bytes)
+#define STATS_TOKEN()                parse_stats_count_token()
+#define STATS_MATCH(hit)             parse_stats_count_match(hit)
+#else
+#define STATS_NODE(type)             ((void)0)
+#define STATS_BYTES(category, bytes) ((void)0)
+#define STATS_TOKEN()                ((void)0)
+#define STATS_MATCH(hit)             ((void)0)
+#endif
+
+#endif /* STATS_H */
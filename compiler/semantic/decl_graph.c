@@ -0,0 +1,1014 @@
+/* LAMC Compiler - Declaration Graph Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "decl_graph.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../parser/ast_index.h"
+#include "infer.h"
+#include "resolve.h"
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+
+/* No unit: a free map slot, a chain's end, a declaration seen first */
+#define UNIT_NONE UINT32_MAX
+
+/* Where a node's span meets its parent's, part of its shape */
+#define EDGE_START 0x1u
+#define EDGE_END   0x2u
+
+/* Types nested deeper than this are imported as dynamic */
+#define TYPE_DEPTH_LIMIT 64
+
+/* A diagnostic of a declaration, kept with the node it points at */
+typedef struct {
+    Diagnostic diag;
+    uint32_t node;          /* Preorder id in the declaration, UNIT_NONE if
+                             * no node starts where it does */
+    bool sized;             /* Spans the node rather than being empty */
+} UnitDiag;
+
+/* One top-level declaration or statement */
+typedef struct {
+    AstNode* node;          /* Retained until the next check */
+    uint64_t shape;         /* Hash of its tree without literal values */
+    uint32_t name;          /* Global it declares, 0 for none */
+    bool typed;             /* name is a function, class or variable */
+    uint32_t* mentions;     /* Names spelled in it, each once */
+    uint32_t mention_count;
+    uint32_t component;     /* First unit of its component */
+    uint32_t old;           /* Unit of the last check it matched, or UNIT_NONE */
+    bool reparsed;          /* Matched by shape, not as the same node */
+
+    TypeId signature;       /* Type of name, in the graph's table */
+    uint64_t interface;     /* A function's, in its component (see
+                             * infer_program_interfaces()); 0 for none */
+    UnitDiag* diags;
+    size_t diag_count;
+    size_t diag_capacity;
+    size_t error_count;
+    uint32_t offset;        /* Where node was when diags were placed */
+    int line;
+    int column;
+} Unit;
+
+typedef struct {
+    char* spelling;
+    uint32_t declared;      /* Stamp of the check that set owner and last */
+    uint32_t owner;         /* First unit declaring it */
+    uint32_t last;          /* Last function, class or variable by the name */
+    uint32_t seen;          /* Stamp of the walk that last met it */
+} Name;
+
+/* Old units by key, those with equal keys chained in source order */
+typedef struct {
+    uint64_t* keys;
+    uint32_t* heads;        /* First unit of each slot's key, UNIT_NONE if free */
+    uint32_t* next;         /* By unit */
+    size_t mask;
+} UnitMap;
+
+struct DeclGraph {
+    TypeTable* types;       /* Signatures; classes are keyed by name id */
+    Name* names;            /* By id, from 1 */
+    size_t name_count;
+    size_t name_capacity;
+    uint32_t* slots;        /* Names by spelling, id (internal) */
+    size_t slot_mask;
+    Unit* units;            /* In source order */
+    size_t unit_count;
+    uint32_t* sizes;        /* By first unit of a component: its unit count */
+    size_t error_count;
+    uint32_t stamp;
+    uint32_t checked;       /* Stamp names were declared with by the last check */
+    bool failed;            /* Out of memory during a check */
+};
+
+/* ===== Helpers ===== */
+
+static bool reserve(void** items, size_t* capacity, size_t index, size_t item_size) {
+    if (index < *capacity) return true;
+    size_t grown_capacity = *capacity ? *capacity : 16;
+    while (grown_capacity <= index) grown_capacity *= 2;
+    void* grown = realloc(*items, grown_capacity * item_size);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+/* FNV-1a, continued from h */
+static uint64_t hash_bytes(uint64_t h, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static uint64_t hash_value(uint64_t h, uint64_t value) {
+    return hash_bytes(h, &value, sizeof(value));
+}
+
+static uint64_t hash_string(uint64_t h, const char* text) {
+    if (!text) return hash_value(h, 0);
+    size_t length = strlen(text);
+    return hash_bytes(hash_value(h, length + 1), text, length);
+}
+
+static bool same_string(const char* a, const char* b) {
+    return a == b || (a && b && strcmp(a, b) == 0);
+}
+
+/* ===== Names ===== */
+
+static size_t find_slot(const DeclGraph* graph, const char* spelling, size_t length) {
+    size_t slot = (size_t)hash_bytes(FNV_OFFSET, spelling, length) & graph->slot_mask;
+    while (graph->slots[slot]) {
+        const char* known = graph->names[graph->slots[slot]].spelling;
+        if (strncmp(known, spelling, length) == 0 && known[length] == '\0') break;
+        slot = (slot + 1) & graph->slot_mask;
+    }
+    return slot;
+}
+
+static uint32_t find_name(const DeclGraph* graph, const char* spelling) {
+    return graph->slots ? graph->slots[find_slot(graph, spelling, strlen(spelling))] : 0;
+}
+
+/* Id of the spelling, added with a copy of it if new; 0 when out of memory */
+static uint32_t intern_name(DeclGraph* graph, const char* spelling) {
+    size_t length = strlen(spelling);
+    if (!graph->slots || graph->name_count * 2 >= graph->slot_mask + 1) {
+        size_t capacity = graph->slots ? (graph->slot_mask + 1) * 2 : 256;
+        uint32_t* slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        if (!slots) return 0;
+        free(graph->slots);
+        graph->slots = slots;
+        graph->slot_mask = capacity - 1;
+        for (uint32_t id = 1; id < graph->name_count; id++) {
+            const char* known = graph->names[id].spelling;
+            graph->slots[find_slot(graph, known, strlen(known))] = id;
+        }
+    }
+
+    size_t slot = find_slot(graph, spelling, length);
+    if (graph->slots[slot]) return graph->slots[slot];
+    if (!reserve((void**)&graph->names, &graph->name_capacity, graph->name_count, sizeof(Name))) return 0;
+    Name* name = &graph->names[graph->name_count];
+    memset(name, 0, sizeof(*name));
+    name->spelling = (char*)malloc(length + 1);
+    if (!name->spelling) return 0;
+    memcpy(name->spelling, spelling, length + 1);
+    graph->slots[slot] = (uint32_t)graph->name_count;
+    return (uint32_t)graph->name_count++;
+}
+
+/* ===== Shapes ===== */
+
+/* A node's shape is everything inference and resolution read from it:
+ * its own fields apart from literal values, and where its span meets its
+ * parent's so that diagnostics can be placed on the same node again */
+
+static size_t list_count(const AstList* list) {
+    return list ? list->count : 0;
+}
+
+static uint64_t hash_fields(uint64_t h, const AstNode* node) {
+    h = hash_value(h, (uint64_t)node->type);
+    switch (node->type) {
+        case AST_BINARY_EXPR:
+            return hash_value(h, (uint64_t)node->as.binary.op);
+        case AST_UNARY_EXPR:
+            return hash_value(h, (uint64_t)node->as.unary.op);
+        case AST_LITERAL_EXPR:
+            return hash_value(h, (uint64_t)node->as.literal.type);
+        case AST_IDENTIFIER_EXPR:
+            return hash_string(h, node->as.identifier);
+        case AST_CALL_EXPR:
+            return hash_value(h, list_count(node->as.call.arguments));
+        case AST_MEMBER_EXPR:
+            return hash_string(h, node->as.member.member);
+        case AST_ARRAY_EXPR:
+            return hash_value(h, list_count(node->as.array.elements));
+        case AST_DICT_EXPR:
+            return hash_value(h, list_count(node->as.dict.entries));
+        case AST_VAR_DECL:
+            h = hash_string(hash_string(h, node->as.var_decl.name), node->as.var_decl.type_name);
+            return hash_value(h, (uint64_t)node->as.var_decl.hot << 1 | (node->as.var_decl.initializer != NULL));
+        case AST_IF_STMT:
+            return hash_value(h, node->as.if_stmt.else_branch != NULL);
+        case AST_FOR_STMT:
+            return hash_string(hash_string(h, node->as.for_stmt.variable), node->as.for_stmt.index_var);
+        case AST_RETURN_STMT:
+            return hash_value(h, node->as.return_stmt.value != NULL);
+        case AST_BLOCK_STMT:
+            return hash_value(h, list_count(node->as.block.statements));
+        case AST_FUNCTION_DECL: {
+            const AstList* params = node->as.function.parameters;
+            h = hash_string(hash_string(h, node->as.function.name), node->as.function.return_type);
+            h = hash_value(h, list_count(params));
+            for (size_t i = 0; i < list_count(params); i++) {
+                const Parameter* param = (const Parameter*)params->items[i];
+                h = hash_string(hash_string(h, param->name), param->type_name);
+                h = hash_value(h, param->default_value != NULL);
+            }
+            return hash_value(h, node->as.function.body_pending);
+        }
+        case AST_CLASS_DECL:
+            h = hash_string(h, node->as.class_decl.name);
+            h = hash_value(h, list_count(node->as.class_decl.fields));
+            return hash_value(h, list_count(node->as.class_decl.methods));
+        case AST_IMPORT_STMT:
+            return hash_string(h, node->as.import.module_name);
+        default:
+            return h;
+    }
+}
+
+static bool same_fields(const AstNode* a, const AstNode* b) {
+    if (a->type != b->type) return false;
+    switch (a->type) {
+        case AST_BINARY_EXPR:
+            return a->as.binary.op == b->as.binary.op;
+        case AST_UNARY_EXPR:
+            return a->as.unary.op == b->as.unary.op;
+        case AST_LITERAL_EXPR:
+            return a->as.literal.type == b->as.literal.type;
+        case AST_IDENTIFIER_EXPR:
+            return same_string(a->as.identifier, b->as.identifier);
+        case AST_CALL_EXPR:
+            return list_count(a->as.call.arguments) == list_count(b->as.call.arguments);
+        case AST_MEMBER_EXPR:
+            return same_string(a->as.member.member, b->as.member.member);
+        case AST_ARRAY_EXPR:
+            return list_count(a->as.array.elements) == list_count(b->as.array.elements);
+        case AST_DICT_EXPR:
+            return list_count(a->as.dict.entries) == list_count(b->as.dict.entries);
+        case AST_VAR_DECL:
+            return same_string(a->as.var_decl.name, b->as.var_decl.name) &&
+                   same_string(a->as.var_decl.type_name, b->as.var_decl.type_name) &&
+                   a->as.var_decl.hot == b->as.var_decl.hot &&
+                   (a->as.var_decl.initializer != NULL) == (b->as.var_decl.initializer != NULL);
+        case AST_IF_STMT:
+            return (a->as.if_stmt.else_branch != NULL) == (b->as.if_stmt.else_branch != NULL);
+        case AST_FOR_STMT:
+            return same_string(a->as.for_stmt.variable, b->as.for_stmt.variable) &&
+                   same_string(a->as.for_stmt.index_var, b->as.for_stmt.index_var);
+        case AST_RETURN_STMT:
+            return (a->as.return_stmt.value != NULL) == (b->as.return_stmt.value != NULL);
+        case AST_BLOCK_STMT:
+            return list_count(a->as.block.statements) == list_count(b->as.block.statements);
+        case AST_FUNCTION_DECL: {
+            const AstList* x = a->as.function.parameters;
+            const AstList* y = b->as.function.parameters;
+            if (!same_string(a->as.function.name, b->as.function.name) ||
+                !same_string(a->as.function.return_type, b->as.function.return_type) ||
+                list_count(x) != list_count(y) || a->as.function.body_pending != b->as.function.body_pending) {
+                return false;
+            }
+            for (size_t i = 0; i < list_count(x); i++) {
+                const Parameter* p = (const Parameter*)x->items[i];
+                const Parameter* q = (const Parameter*)y->items[i];
+                if (!same_string(p->name, q->name) || !same_string(p->type_name, q->type_name) ||
+                    (p->default_value != NULL) != (q->default_value != NULL)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case AST_CLASS_DECL:
+            return same_string(a->as.class_decl.name, b->as.class_decl.name) &&
+                   list_count(a->as.class_decl.fields) == list_count(b->as.class_decl.fields) &&
+                   list_count(a->as.class_decl.methods) == list_count(b->as.class_decl.methods);
+        case AST_IMPORT_STMT:
+            return same_string(a->as.import.module_name, b->as.import.module_name);
+        default:
+            return true;
+    }
+}
+
+static uint32_t edges(const AstIndex* index, uint32_t id) {
+    uint32_t parent = index->parent[id];
+    if (parent == AST_INDEX_NONE) return 0;
+    const AstNode* node = index->nodes[id];
+    const AstNode* outer = index->nodes[parent];
+    uint64_t end = (uint64_t)node->offset + node->length;
+    return (node->offset == outer->offset ? EDGE_START : 0) |
+           (end == (uint64_t)outer->offset + outer->length ? EDGE_END : 0);
+}
+
+static uint64_t hash_shape(const AstIndex* index) {
+    uint64_t h = FNV_OFFSET;
+    for (uint32_t id = 0; id < index->count; id++) {
+        h = hash_fields(h, index->nodes[id]);
+        h = hash_value(h, (uint64_t)index->size[id] << 2 | edges(index, id));
+    }
+    return h;
+}
+
+/* Sets *same to whether the trees have one shape; false when out of memory */
+static bool same_shape(AstNode* a, AstNode* b, bool* same) {
+    AstIndex x, y;
+    if (!ast_index_build(&x, a)) return false;
+    if (!ast_index_build(&y, b)) {
+        ast_index_free(&x);
+        return false;
+    }
+    *same = x.count == y.count;
+    for (uint32_t id = 0; *same && id < x.count; id++) {
+        *same = x.size[id] == y.size[id] && edges(&x, id) == edges(&y, id) && same_fields(x.nodes[id], y.nodes[id]);
+    }
+    ast_index_free(&x);
+    ast_index_free(&y);
+    return true;
+}
+
+/* ===== Declarations ===== */
+
+static bool mention(DeclGraph* graph, Unit* unit, size_t* capacity, uint32_t stamp, const char* spelling) {
+    if (!spelling) return true;
+    uint32_t name = intern_name(graph, spelling);
+    if (!name || !reserve((void**)&unit->mentions, capacity, unit->mention_count, sizeof(uint32_t))) return false;
+    if (graph->names[name].seen != stamp) {
+        graph->names[name].seen = stamp;
+        unit->mentions[unit->mention_count++] = name;
+    }
+    return true;
+}
+
+/* Shape, declared name and mentions of a declaration not seen before.
+ * Mentions are the names a body may share a global through: identifiers,
+ * variables it binds (which may be globals it assigns) and annotations. */
+static bool describe(DeclGraph* graph, Unit* unit) {
+    AstNode* node = unit->node;
+    AstIndex index;
+    if (!ast_index_build(&index, node)) return false;
+    unit->shape = hash_shape(&index);
+
+    const char* declared = NULL;
+    unit->typed = true;
+    switch (node->type) {
+        case AST_FUNCTION_DECL: declared = node->as.function.name; break;
+        case AST_CLASS_DECL: declared = node->as.class_decl.name; break;
+        case AST_VAR_DECL: declared = node->as.var_decl.name; break;
+        case AST_IMPORT_STMT:
+            declared = node->as.import.module_name;
+            unit->typed = false;
+            break;
+        default:
+            unit->typed = false;
+            break;
+    }
+    unit->name = declared ? intern_name(graph, declared) : 0;
+    bool ok = !declared || unit->name != 0;
+
+    size_t capacity = 0;
+    uint32_t stamp = ++graph->stamp;
+    for (uint32_t id = 0; id < index.count && ok; id++) {
+        const AstNode* at = index.nodes[id];
+        uint32_t parent = index.parent[id];
+        switch (at->type) {
+            case AST_IDENTIFIER_EXPR:
+                ok = mention(graph, unit, &capacity, stamp, at->as.identifier);
+                break;
+            case AST_VAR_DECL:
+                if (parent == AST_INDEX_NONE || index.nodes[parent]->type != AST_CLASS_DECL) {
+                    ok = mention(graph, unit, &capacity, stamp, at->as.var_decl.name);
+                }
+                ok = ok && mention(graph, unit, &capacity, stamp, at->as.var_decl.type_name);
+                break;
+            case AST_FOR_STMT:
+                ok = mention(graph, unit, &capacity, stamp, at->as.for_stmt.variable) &&
+                     mention(graph, unit, &capacity, stamp, at->as.for_stmt.index_var);
+                break;
+            case AST_FUNCTION_DECL: {
+                const AstList* params = at->as.function.parameters;
+                ok = mention(graph, unit, &capacity, stamp, at->as.function.return_type);
+                for (size_t i = 0; ok && i < list_count(params); i++) {
+                    ok = mention(graph, unit, &capacity, stamp, ((const Parameter*)params->items[i])->type_name);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    ast_index_free(&index);
+    return ok;
+}
+
+static void release_units(Unit* units, size_t count) {
+    for (size_t i = 0; units && i < count; i++) {
+        if (units[i].node) ast_free_node(units[i].node);
+        free(units[i].mentions);
+        free(units[i].diags);
+    }
+    free(units);
+}
+
+/* ===== Unit Maps ===== */
+
+static bool map_init(UnitMap* map, size_t count) {
+    size_t capacity = 16;
+    while (capacity < count * 2) capacity *= 2;
+    map->mask = capacity - 1;
+    map->keys = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+    map->heads = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    map->next = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    if (!map->keys || !map->heads || !map->next) return false;
+    memset(map->heads, 0xff, capacity * sizeof(uint32_t));
+    return true;
+}
+
+static void map_free(UnitMap* map) {
+    free(map->keys);
+    free(map->heads);
+    free(map->next);
+}
+
+static size_t map_slot(const UnitMap* map, uint64_t key) {
+    size_t slot = (size_t)((key ^ (key >> 29)) * 0x9e3779b97f4a7c15ULL >> 32) & map->mask;
+    while (map->heads[slot] != UNIT_NONE && map->keys[slot] != key) slot = (slot + 1) & map->mask;
+    return slot;
+}
+
+/* Units must be added last to first, so that chains run in source order */
+static void map_add(UnitMap* map, uint64_t key, uint32_t unit) {
+    size_t slot = map_slot(map, key);
+    map->next[unit] = map->heads[slot];
+    map->keys[slot] = key;
+    map->heads[slot] = unit;
+}
+
+static uint32_t map_first(const UnitMap* map, uint64_t key) {
+    return map->heads[map_slot(map, key)];
+}
+
+/* ===== Types ===== */
+
+/* Copy of a type of another table in the graph's; classes are keyed by
+ * their name there */
+static TypeId import_type(DeclGraph* graph, const TypeTable* from, TypeId type, int depth) {
+    const Type* t = type_get(from, type);
+    if (type < TYPE_PRIMITIVE_COUNT || !t) return type;
+    if (depth > TYPE_DEPTH_LIMIT) return TYPE_DYNAMIC;
+
+    TypeId result = TYPE_NONE;
+    switch (t->kind) {
+        case TYPE_KIND_ARRAY:
+            result = type_array(graph->types, import_type(graph, from, type_operand(from, type, 0), depth + 1));
+            break;
+        case TYPE_KIND_DICT: {
+            TypeId key = import_type(graph, from, type_operand(from, type, 0), depth + 1);
+            result = type_dict(graph->types, key, import_type(graph, from, type_operand(from, type, 1), depth + 1));
+            break;
+        }
+        case TYPE_KIND_FUNCTION: {
+            uint32_t count = t->count - 1;
+            TypeId* params = (TypeId*)malloc((count + 1) * sizeof(TypeId));
+            if (!params) break;
+            TypeId ret = import_type(graph, from, type_operand(from, type, 0), depth + 1);
+            for (uint32_t i = 0; i < count; i++) {
+                params[i] = import_type(graph, from, type_operand(from, type, i + 1), depth + 1);
+            }
+            result = type_function(graph->types, ret, params, count);
+            free(params);
+            break;
+        }
+        case TYPE_KIND_CLASS: {
+            uint32_t name = intern_name(graph, t->name);
+            if (name) result = type_class(graph->types, name, graph->names[name].spelling);
+            break;
+        }
+        default:
+            return type;
+    }
+    if (result == TYPE_NONE) graph->failed = true;
+    return result;
+}
+
+/* ===== Diagnostics ===== */
+
+static bool add_diag(Unit* unit, const Diagnostic* diag) {
+    if (!reserve((void**)&unit->diags, &unit->diag_capacity, unit->diag_count, sizeof(UnitDiag))) return false;
+    UnitDiag* kept = &unit->diags[unit->diag_count++];
+    kept->diag = *diag;
+    kept->node = UNIT_NONE;
+    kept->sized = false;
+    if (diag->severity == DIAG_ERROR) unit->error_count++;
+    return true;
+}
+
+static void note_position(Unit* unit) {
+    unit->offset = unit->node->offset;
+    unit->line = unit->node->line;
+    unit->column = unit->node->column;
+}
+
+/* Ties each diagnostic of a freshly checked unit to the first node, in
+ * preorder, that it was reported at */
+static bool attach_diags(Unit* unit) {
+    note_position(unit);
+    if (unit->diag_count == 0) return true;
+    AstIndex index;
+    if (!ast_index_build(&index, unit->node)) return false;
+    for (size_t d = 0; d < unit->diag_count; d++) {
+        UnitDiag* kept = &unit->diags[d];
+        const Diagnostic* diag = &kept->diag;
+        for (uint32_t id = 0; id < index.count; id++) {
+            const AstNode* at = index.nodes[id];
+            if (at->offset == diag->offset && at->line == diag->line && at->column == diag->column &&
+                (diag->length == 0 || diag->length == at->length)) {
+                kept->node = id;
+                kept->sized = diag->length == at->length;
+                break;
+            }
+        }
+    }
+    ast_index_free(&index);
+    return true;
+}
+
+/* Moves kept diagnostics to where their nodes are now. A declaration
+ * moved by a reparse was shifted as a whole; a reparsed one has the
+ * same shape, so its nodes are found again by preorder id. */
+static bool place_diags(Unit* unit) {
+    AstNode* node = unit->node;
+    ptrdiff_t bytes = (ptrdiff_t)node->offset - (ptrdiff_t)unit->offset;
+    int lines = node->line - unit->line;
+    bool relocate = unit->reparsed || node->column != unit->column;
+    AstIndex index;
+    index.count = 0;
+    if (relocate && unit->diag_count > 0 && !ast_index_build(&index, node)) return false;
+
+    for (size_t d = 0; d < unit->diag_count; d++) {
+        UnitDiag* kept = &unit->diags[d];
+        if (kept->node < index.count) {
+            const AstNode* at = index.nodes[kept->node];
+            kept->diag.offset = at->offset;
+            kept->diag.length = kept->sized ? at->length : 0;
+            kept->diag.line = at->line;
+            kept->diag.column = at->column;
+        } else {
+            if (kept->diag.offset != DIAG_NO_OFFSET) kept->diag.offset = (size_t)((ptrdiff_t)kept->diag.offset + bytes);
+            kept->diag.line += lines;
+        }
+    }
+    if (relocate && unit->diag_count > 0) ast_index_free(&index);
+    note_position(unit);
+    return true;
+}
+
+/* ===== Components ===== */
+
+static uint32_t find_root(uint32_t* parent, uint32_t unit) {
+    while (parent[unit] != unit) {
+        parent[unit] = parent[parent[unit]];
+        unit = parent[unit];
+    }
+    return unit;
+}
+
+/* The earlier unit stays the root, so a component is named by its first */
+static void join(uint32_t* parent, uint32_t a, uint32_t b) {
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a < b) {
+        parent[b] = a;
+    } else {
+        parent[a] = b;
+    }
+}
+
+/* Index of the member whose span a diagnostic falls in: the last one
+ * starting at or before it */
+static uint32_t member_at(const Unit* units, const uint32_t* members, uint32_t count, size_t offset) {
+    if (offset == DIAG_NO_OFFSET) return 0;
+    uint32_t lo = 0, hi = count;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (units[members[mid]].node->offset <= offset) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Takes the results a unit had in the last check, as its component
+ * inferred as it did then */
+static bool adopt(Unit* unit, Unit* old) {
+    unit->signature = old->signature;
+    unit->interface = old->interface;
+    unit->diags = old->diags;
+    unit->diag_count = old->diag_count;
+    unit->diag_capacity = old->diag_capacity;
+    unit->error_count = old->error_count;
+    unit->offset = old->offset;
+    unit->line = old->line;
+    unit->column = old->column;
+    old->diags = NULL;
+    old->diag_count = 0;
+    return place_diags(unit);
+}
+
+/* Resolves and infers the members of a component, in source order, as
+ * a program of their own; count is at least 1. When members[edited]
+ * replaced the body of old, a function of the last check, in an
+ * otherwise unchanged component, the pass stops after that body if its
+ * interface is old's: the rest of the component then infers as it did,
+ * so the other members keep their results and it keeps old's signature
+ * (*cut is set). */
+static bool check_component(DeclGraph* graph, Unit* units, const uint32_t* members, uint32_t count,
+                            uint32_t edited, Unit* old, bool* cut) {
+    AstList* list = ast_list_create();
+    AstNode* program = list ? ast_create_program(list) : NULL;
+    if (!program) {
+        if (list) ast_list_free(list);
+        return false;
+    }
+    uint64_t* hashes = (uint64_t*)malloc(count * sizeof(uint64_t));
+    bool ok = hashes != NULL;
+    for (uint32_t k = 0; k < count && ok; k++) {
+        ast_list_append(list, units[members[k]].node);
+        ok = list->count == k + 1;
+        if (ok) ast_retain(units[members[k]].node);
+    }
+
+    DiagBuffer diags;
+    Resolution res;
+    TypeInference types;
+    InferInterfaces interfaces = { hashes, count, old ? edited : SIZE_MAX, old ? old->interface : 0, false };
+    diag_buffer_init(&diags);
+    bool resolved = ok && resolve_program(&res, program, &diags);
+    bool inferred = resolved && infer_program_interfaces(&types, &res, &diags, &interfaces);
+    ok = inferred;
+    *cut = ok && interfaces.stopped;
+
+    if (*cut) {
+        for (uint32_t k = 0; ok && k < count; k++) {
+            Unit* unit = &units[members[k]];
+            if (k != edited) ok = adopt(unit, &graph->units[unit->old]);
+        }
+        Unit* unit = &units[members[edited]];
+        unit->signature = old->signature;
+        unit->interface = hashes[edited];
+        for (size_t d = 0; ok && d < diags.count; d++) {
+            if (member_at(units, members, count, diags.items[d].offset) == edited) {
+                ok = add_diag(unit, &diags.items[d]);
+            }
+        }
+        ok = ok && attach_diags(unit);
+    }
+
+    uint32_t k = 0;
+    for (uint32_t id = 1; ok && !*cut && id < res.index.count; id += res.index.size[id], k++) {
+        Unit* unit = &units[members[k]];
+        unit->signature = unit->typed ? import_type(graph, types.types, inference_type(&types, id), 0) : TYPE_NONE;
+        unit->interface = hashes[k];
+        ok = !graph->failed;
+    }
+    for (size_t d = 0; ok && !*cut && d < diags.count; d++) {
+        ok = add_diag(&units[members[member_at(units, members, count, diags.items[d].offset)]], &diags.items[d]);
+    }
+    for (k = 0; ok && !*cut && k < count; k++) ok = attach_diags(&units[members[k]]);
+
+    if (inferred) type_inference_free(&types);
+    if (resolved) resolution_free(&res);
+    diag_buffer_free(&diags);
+    ast_free_node(program);
+    free(hashes);
+    return ok;
+}
+
+/* ===== Public Interface ===== */
+
+DeclGraph* decl_graph_create(void) {
+    DeclGraph* graph = (DeclGraph*)calloc(1, sizeof(DeclGraph));
+    if (!graph) return NULL;
+    graph->types = type_table_create();
+    graph->name_count = 1;
+    if (!graph->types || !reserve((void**)&graph->names, &graph->name_capacity, 0, sizeof(Name))) {
+        decl_graph_free(graph);
+        return NULL;
+    }
+    memset(&graph->names[0], 0, sizeof(Name));
+    return graph;
+}
+
+void decl_graph_free(DeclGraph* graph) {
+    if (!graph) return;
+    release_units(graph->units, graph->unit_count);
+    for (size_t id = 1; id < graph->name_count; id++) free(graph->names[id].spelling);
+    free(graph->names);
+    free(graph->slots);
+    free(graph->sizes);
+    type_table_free(graph->types);
+    free(graph);
+}
+
+/* Scratch of one check, by new unit */
+typedef struct {
+    Unit* units;
+    uint32_t count;
+    bool* taken;            /* By old unit: matched by a new one */
+    uint32_t* parent;       /* Union-find over units */
+    uint32_t* sizes;        /* By root */
+    uint32_t* old_root;     /* By root: old component its units came from */
+    uint32_t* last_old;     /* By root: old unit of its last member so far */
+    bool* dirty;            /* By root */
+    uint32_t* first;        /* By root: where its members start */
+    uint32_t* members;      /* Units grouped by component, in source order */
+} Check;
+
+static void check_free(Check* c) {
+    free(c->taken);
+    free(c->parent);
+    free(c->old_root);
+    free(c->last_old);
+    free(c->dirty);
+    free(c->first);
+    free(c->members);
+}
+
+/* Pairs units with those of the last check: the same node first, then a
+ * reparsed one of the same shape, the earliest not yet taken */
+static bool match_units(DeclGraph* graph, Check* c, AstList* decls) {
+    Unit* old = graph->units;
+    UnitMap map;
+    bool ok = map_init(&map, graph->unit_count);
+    for (size_t j = graph->unit_count; ok && j-- > 0;) map_add(&map, (uint64_t)(uintptr_t)old[j].node, (uint32_t)j);
+    for (uint32_t i = 0; ok && i < c->count; i++) {
+        Unit* unit = &c->units[i];
+        unit->node = (AstNode*)decls->items[i];
+        uint32_t j = map_first(&map, (uint64_t)(uintptr_t)unit->node);
+        while (j != UNIT_NONE && c->taken[j]) j = map.next[j];
+        if (j == UNIT_NONE) {
+            ast_retain(unit->node);
+            ok = describe(graph, unit);
+            continue;
+        }
+        /* The same node: its description and reference carry over */
+        unit->shape = old[j].shape;
+        unit->name = old[j].name;
+        unit->typed = old[j].typed;
+        unit->mentions = old[j].mentions;
+        unit->mention_count = old[j].mention_count;
+        unit->old = j;
+        old[j].node = NULL;
+        old[j].mentions = NULL;
+        c->taken[j] = true;
+    }
+    map_free(&map);
+    if (!ok) return false;
+
+    ok = map_init(&map, graph->unit_count);
+    for (size_t j = graph->unit_count; ok && j-- > 0;) {
+        if (!c->taken[j]) map_add(&map, old[j].shape, (uint32_t)j);
+    }
+    for (uint32_t i = 0; ok && i < c->count; i++) {
+        Unit* unit = &c->units[i];
+        if (unit->old != UNIT_NONE) continue;
+        for (uint32_t j = map_first(&map, unit->shape); ok && j != UNIT_NONE; j = map.next[j]) {
+            bool same = false;
+            if (c->taken[j]) continue;
+            ok = same_shape(old[j].node, unit->node, &same);
+            if (ok && same) {
+                unit->old = j;
+                unit->reparsed = true;
+                c->taken[j] = true;
+                break;
+            }
+        }
+    }
+    map_free(&map);
+    return ok;
+}
+
+/* Joins units that declare or mention one global name */
+static void build_components(DeclGraph* graph, Check* c) {
+    uint32_t stamp = ++graph->stamp;
+    for (uint32_t i = 0; i < c->count; i++) {
+        c->parent[i] = i;
+        Unit* unit = &c->units[i];
+        if (!unit->name) continue;
+        Name* name = &graph->names[unit->name];
+        if (name->declared != stamp) {
+            name->declared = stamp;
+            name->owner = i;
+            name->last = UNIT_NONE;
+        } else {
+            join(c->parent, i, name->owner);
+        }
+        if (unit->typed) name->last = i;
+    }
+    for (uint32_t i = 0; i < c->count; i++) {
+        const Unit* unit = &c->units[i];
+        for (uint32_t m = 0; m < unit->mention_count; m++) {
+            const Name* name = &graph->names[unit->mentions[m]];
+            if (name->declared == stamp) join(c->parent, i, name->owner);
+        }
+    }
+    graph->checked = stamp;
+}
+
+/* A component is unchanged when its units matched, in order, every unit
+ * of one component of the last check */
+static void find_dirty(const DeclGraph* graph, Check* c) {
+    for (uint32_t i = 0; i < c->count; i++) {
+        c->sizes[i] = 0;
+        c->old_root[i] = UNIT_NONE;
+        c->dirty[i] = false;
+    }
+    for (uint32_t i = 0; i < c->count; i++) {
+        Unit* unit = &c->units[i];
+        uint32_t root = find_root(c->parent, i);
+        unit->component = root;
+        c->sizes[root]++;
+        if (unit->old == UNIT_NONE) {
+            c->dirty[root] = true;
+            continue;
+        }
+        uint32_t was = graph->units[unit->old].component;
+        if (c->old_root[root] == UNIT_NONE) {
+            c->old_root[root] = was;
+        } else if (c->old_root[root] != was || unit->old < c->last_old[root]) {
+            c->dirty[root] = true;
+        }
+        c->last_old[root] = unit->old;
+    }
+    for (uint32_t i = 0; i < c->count; i++) {
+        if (c->units[i].component == i && !c->dirty[i]) c->dirty[i] = c->sizes[i] != graph->sizes[c->old_root[i]];
+    }
+}
+
+/* Index in members of the one member of a changed component that was
+ * not matched, when the others are the rest of one component of the
+ * last check, in order, and that component's member at its place is a
+ * function declared the same way that no unit matched: its body was
+ * edited. *old is set to that function's unit. UNIT_NONE otherwise. */
+static uint32_t find_edited(const DeclGraph* graph, const Check* c, const uint32_t* members, uint32_t count,
+                            uint32_t* old) {
+    uint32_t edited = UNIT_NONE;
+    uint32_t was = UNIT_NONE;
+    for (uint32_t k = 0; k < count; k++) {
+        const Unit* unit = &c->units[members[k]];
+        if (unit->old == UNIT_NONE) {
+            if (edited != UNIT_NONE) return UNIT_NONE;
+            edited = k;
+        } else if (was == UNIT_NONE) {
+            was = graph->units[unit->old].component;
+        } else if (graph->units[unit->old].component != was) {
+            return UNIT_NONE;
+        }
+    }
+    if (edited == UNIT_NONE || was == UNIT_NONE || graph->sizes[was] != count) return UNIT_NONE;
+
+    /* The last check's members of was are the others', and one more */
+    *old = UNIT_NONE;
+    uint32_t k = 0;
+    for (uint32_t j = was; j < graph->unit_count && k < count; j++) {
+        if (graph->units[j].component != was) continue;
+        if (k == edited) {
+            if (c->taken[j]) return UNIT_NONE;
+            *old = j;
+        } else if (c->units[members[k]].old != j) {
+            return UNIT_NONE;
+        }
+        k++;
+    }
+    const Unit* before = *old != UNIT_NONE ? &graph->units[*old] : NULL;
+    const AstNode* node = c->units[members[edited]].node;
+    if (!before || before->interface == 0 || node->type != AST_FUNCTION_DECL || !same_fields(before->node, node)) {
+        return UNIT_NONE;
+    }
+    return edited;
+}
+
+bool decl_graph_check(DeclGraph* graph, AstNode* program, DeclCheckStats* stats) {
+    DeclCheckStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    if (!program || program->type != AST_PROGRAM) return false;
+
+    AstList* decls = program->as.program.declarations;
+    Check c;
+    memset(&c, 0, sizeof(c));
+    c.count = (uint32_t)list_count(decls);
+    size_t n = (size_t)c.count + 1;
+    c.units = (Unit*)calloc(n, sizeof(Unit));
+    c.taken = (bool*)calloc(graph->unit_count + 1, sizeof(bool));
+    c.parent = (uint32_t*)malloc(n * sizeof(uint32_t));
+    c.sizes = (uint32_t*)malloc(n * sizeof(uint32_t));
+    c.old_root = (uint32_t*)malloc(n * sizeof(uint32_t));
+    c.last_old = (uint32_t*)malloc(n * sizeof(uint32_t));
+    c.dirty = (bool*)malloc(n * sizeof(bool));
+    c.first = (uint32_t*)malloc(n * sizeof(uint32_t));
+    c.members = (uint32_t*)malloc(n * sizeof(uint32_t));
+    graph->failed = !c.units || !c.taken || !c.parent || !c.sizes || !c.old_root || !c.last_old || !c.dirty ||
+                    !c.first || !c.members;
+    for (uint32_t i = 0; c.units && i < c.count; i++) {
+        c.units[i].old = UNIT_NONE;
+        c.units[i].signature = TYPE_NONE;
+    }
+
+    if (!graph->failed) graph->failed = !match_units(graph, &c, decls);
+    if (!graph->failed) {
+        build_components(graph, &c);
+        find_dirty(graph, &c);
+
+        /* Members of each component, in source order */
+        uint32_t at = 0;
+        for (uint32_t i = 0; i < c.count; i++) {
+            if (c.units[i].component != i) continue;
+            c.first[i] = at;
+            at += c.sizes[i];
+            stats->components++;
+        }
+        for (uint32_t i = 0; i < c.count; i++) c.members[c.first[c.units[i].component]++] = i;
+        for (uint32_t i = 0; i < c.count; i++) {
+            if (c.units[i].component == i) c.first[i] -= c.sizes[i];
+        }
+    }
+
+    for (uint32_t i = 0; !graph->failed && i < c.count; i++) {
+        if (c.units[i].component != i) continue;
+        const uint32_t* members = &c.members[c.first[i]];
+        if (c.dirty[i]) {
+            uint32_t old = UNIT_NONE;
+            uint32_t edited = find_edited(graph, &c, members, c.sizes[i], &old);
+            bool cut = false;
+            graph->failed = !check_component(graph, c.units, members, c.sizes[i], edited,
+                                             edited != UNIT_NONE ? &graph->units[old] : NULL, &cut);
+            if (cut) {
+                /* Inferred up to the edited body, resolved throughout */
+                stats->rechecked += edited + 1;
+                stats->reused += c.sizes[i] - edited - 1;
+                stats->cutoffs++;
+            } else {
+                stats->rechecked += c.sizes[i];
+            }
+            continue;
+        }
+        for (uint32_t k = 0; k < c.sizes[i] && !graph->failed; k++) {
+            Unit* unit = &c.units[members[k]];
+            graph->failed = !adopt(unit, &graph->units[unit->old]);
+            if (unit->reparsed) stats->cutoffs++;
+        }
+        stats->reused += c.sizes[i];
+    }
+
+    bool ok = !graph->failed;
+    release_units(graph->units, graph->unit_count);
+    free(graph->sizes);
+    graph->units = NULL;
+    graph->unit_count = 0;
+    graph->sizes = NULL;
+    graph->error_count = 0;
+    if (ok) {
+        graph->units = c.units;
+        graph->unit_count = c.count;
+        graph->sizes = c.sizes;
+        for (uint32_t i = 0; i < c.count; i++) graph->error_count += c.units[i].error_count;
+        stats->declarations = c.count;
+    } else {
+        release_units(c.units, c.count);
+        free(c.sizes);
+        graph->checked = 0;
+        memset(stats, 0, sizeof(*stats));
+    }
+    check_free(&c);
+    return ok;
+}
+
+TypeId decl_graph_signature(const DeclGraph* graph, const char* name) {
+    uint32_t id = find_name(graph, name);
+    if (!id || graph->names[id].declared != graph->checked || graph->names[id].last >= graph->unit_count) {
+        return TYPE_NONE;
+    }
+    return graph->units[graph->names[id].last].signature;
+}
+
+const TypeTable* decl_graph_types(const DeclGraph* graph) {
+    return graph->types;
+}
+
+bool decl_graph_diagnostics(const DeclGraph* graph, DiagBuffer* out) {
+    for (size_t i = 0; i < graph->unit_count; i++) {
+        const Unit* unit = &graph->units[i];
+        for (size_t d = 0; d < unit->diag_count; d++) {
+            if (!diag_report(out, &unit->diags[d].diag)) return false;
+        }
+    }
+    return true;
+}
+
+size_t decl_graph_error_count(const DeclGraph* graph) {
+    return graph->error_count;
+}
@@ -0,0 +1,77 @@
+/* LAMC Compiler - Declaration Graph
+ * Incremental type checking over the declarations types flow between
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef DECL_GRAPH_H
+#define DECL_GRAPH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "../parser/ast.h"
+#include "../parser/diagnostics.h"
+#include "types.h"
+
+/* What one check did */
+typedef struct {
+    size_t declarations;    /* Top-level functions, classes and statements */
+    size_t components;      /* Groups of them no type can flow between */
+    size_t rechecked;       /* Declarations inferred again */
+    size_t reused;          /* Declarations that kept the last check's results */
+    size_t cutoffs;         /* Reused although reparsed, as only literal values
+                             * changed, and edited bodies inference stopped
+                             * after, as they passed on what they did before */
+} DeclCheckStats;
+
+/* The results of the last check, kept as the cache of the next */
+typedef struct DeclGraph DeclGraph;
+
+DeclGraph* decl_graph_create(void);
+void decl_graph_free(DeclGraph* graph);
+
+/* Type-checks program with the results resolve_program() and
+ * infer_program() give for the whole of it.
+ *
+ * Inference only relates two top-level declarations through a name: a
+ * function, class, import or global one of them declares and the other
+ * spells (calls, reads, assigns, annotates with). Those names split the
+ * declarations into components, and each component is resolved and
+ * inferred as a program of its own, its declarations in source order:
+ * every unification happens within one component and in the same order,
+ * so its types and diagnostics are those of the whole program.
+ *
+ * Called again after an edit (see parser_reparse()), a component keeps
+ * its results when it has the same declarations in the same order as a
+ * component of the last check. A declaration moved by the reparse counts
+ * as the same, as does a reparsed one that differs only in literal
+ * values of the same kind (inference does not look at them); their
+ * diagnostics follow their nodes. Any other change rechecks the
+ * component it falls in, which may be most of a program whose functions
+ * call each other.
+ *
+ * When the only change to a component is one function's body, such as
+ * a new statement in it, the component is resolved again and inferred up
+ * to the end of that body. If the body left the types outside it as it
+ * did in the last check (its interface, see infer_program_interfaces()),
+ * the rest of the component would infer as it did then: the pass stops
+ * there, the other declarations keep their results, the function keeps
+ * its signature and takes the diagnostics of its new body.
+ *
+ * program must be parsed eagerly, without hash-consing or an arena: its
+ * top-level declarations are retained until the next check. stats may
+ * be NULL. Returns false when out of memory, leaving the graph empty. */
+bool decl_graph_check(DeclGraph* graph, AstNode* program, DeclCheckStats* stats);
+
+/* Type of the last top-level function, class (its instances) or global
+ * declaration called name, in decl_graph_types(); TYPE_NONE if there is
+ * none. Classes are told apart by name there. */
+TypeId decl_graph_signature(const DeclGraph* graph, const char* name);
+const TypeTable* decl_graph_types(const DeclGraph* graph);
+
+/* Appends the diagnostics of the last check to out, positioned in the
+ * program it checked, declaration by declaration in source order.
+ * Returns false when out of memory. */
+bool decl_graph_diagnostics(const DeclGraph* graph, DiagBuffer* out);
+size_t decl_graph_error_count(const DeclGraph* graph);
+
+#endif /* DECL_GRAPH_H */
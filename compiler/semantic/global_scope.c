@@ -0,0 +1,95 @@
+/* LAMC Compiler - Global Scope Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "global_scope.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char* name;
+    uint32_t length;
+    uint32_t hash;
+    SymbolId symbol;
+} GlobalEntry;
+
+struct GlobalScope {
+    GlobalEntry* entries;
+    size_t count;
+    uint32_t* slots;        /* Entry index + 1, 0 for empty slots */
+    size_t mask;
+};
+
+/* FNV-1a, folded to 32 bits, as the interner hashes */
+static uint32_t hash_span(const char* start, size_t length) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)start[i];
+        h *= 0x100000001b3ULL;
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+static size_t find_slot(const GlobalScope* scope, const char* name, size_t length, uint32_t hash) {
+    size_t slot = hash & scope->mask;
+    while (scope->slots[slot]) {
+        const GlobalEntry* entry = &scope->entries[scope->slots[slot] - 1];
+        if (entry->hash == hash && entry->length == length && memcmp(entry->name, name, length) == 0) break;
+        slot = (slot + 1) & scope->mask;
+    }
+    return slot;
+}
+
+GlobalScope* global_scope_freeze(const SymbolTable* symbols, const StringInterner* names) {
+    GlobalScope* scope = (GlobalScope*)calloc(1, sizeof(GlobalScope));
+    if (!scope) return NULL;
+
+    size_t total = symbol_table_count(symbols);
+    size_t capacity = 64;
+    while (capacity < total * 2) capacity *= 2;
+    scope->entries = (GlobalEntry*)malloc((total + 1) * sizeof(GlobalEntry));
+    scope->slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+    scope->mask = capacity - 1;
+    if (!scope->entries || !scope->slots) {
+        global_scope_free(scope);
+        return NULL;
+    }
+
+    /* In id order, so a later declaration of a name replaces an earlier one */
+    for (SymbolId id = 0; id < total; id++) {
+        const Symbol* symbol = symbol_table_get(symbols, id);
+        size_t length = 0;
+        const char* name = symbol->depth == 0 ? string_interner_lookup(names, symbol->name, &length) : NULL;
+        if (!name) continue;
+
+        uint32_t hash = hash_span(name, length);
+        size_t slot = find_slot(scope, name, length, hash);
+        if (scope->slots[slot]) {
+            scope->entries[scope->slots[slot] - 1].symbol = id;
+            continue;
+        }
+        GlobalEntry* entry = &scope->entries[scope->count++];
+        entry->name = name;
+        entry->length = (uint32_t)length;
+        entry->hash = hash;
+        entry->symbol = id;
+        scope->slots[slot] = (uint32_t)scope->count;
+    }
+    return scope;
+}
+
+void global_scope_free(GlobalScope* scope) {
+    if (!scope) return;
+    free(scope->entries);
+    free(scope->slots);
+    free(scope);
+}
+
+SymbolId global_scope_lookup(const GlobalScope* scope, const char* name, size_t length) {
+    size_t slot = find_slot(scope, name, length, hash_span(name, length));
+    return scope->slots[slot] ? scope->entries[scope->slots[slot] - 1].symbol : SYMBOL_NONE;
+}
+
+size_t global_scope_count(const GlobalScope* scope) {
+    return scope->count;
+}
@@ -0,0 +1,31 @@
+/* LAMC Compiler - Global Scope
+ * Frozen snapshot of a program's top-level names, safe to read from any thread
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef GLOBAL_SCOPE_H
+#define GLOBAL_SCOPE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../parser/intern.h"
+#include "symbol_table.h"
+
+/* An open-addressing table from spelling to symbol, built once and never
+ * written again, so lookups need no locks. It is keyed by spelling rather
+ * than interned id so that threads with interners of their own can share
+ * it. */
+typedef struct GlobalScope GlobalScope;
+
+/* Freezes the depth-0 bindings of symbols: for each name, the symbol last
+ * declared at depth 0, which is the one lookups see while every scope
+ * above it is closed. Spellings come from names and must outlive the
+ * scope. NULL when out of memory. */
+GlobalScope* global_scope_freeze(const SymbolTable* symbols, const StringInterner* names);
+void global_scope_free(GlobalScope* scope);
+
+/* Binding of the spelling, SYMBOL_NONE if there is none */
+SymbolId global_scope_lookup(const GlobalScope* scope, const char* name, size_t length);
+size_t global_scope_count(const GlobalScope* scope);
+
+#endif /* GLOBAL_SCOPE_H */
@@ -0,0 +1,1585 @@
+/* LAMC Compiler - Type Inference Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "infer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Index of a type variable */
+typedef uint32_t TermId;
+#define TERM_NONE UINT32_MAX
+
+/* Type of a finished term not yet computed */
+#define TYPE_PENDING UINT32_MAX
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+
+/* Types nested deeper than this leave a body without an interface */
+#define INTERFACE_DEPTH_LIMIT 64
+
+typedef enum {
+    TERM_VAR,           /* Unbound; numeric restricts what may bind it */
+    TERM_PRIMITIVE,     /* value: TypeId */
+    TERM_ARRAY,         /* Operands as in TypeKind */
+    TERM_DICT,
+    TERM_FUNCTION,
+    TERM_CLASS,         /* value: preorder id of the class declaration */
+    TERM_DYNAMIC
+} TermKind;
+
+/* What an unbound variable may become */
+typedef enum {
+    NUM_NONE,           /* Anything */
+    NUM_ANY,            /* Any number: integer literals, arithmetic */
+    NUM_INTEGRAL,       /* Bitwise operands */
+    NUM_FLOATING,       /* Float literals */
+    NUM_CONFLICT
+} NumClass;
+
+/* A union-find node. Only a root's kind and content are meaningful. */
+typedef struct {
+    TermId parent;
+    uint8_t rank;
+    uint8_t kind;
+    uint8_t numeric;
+    uint32_t value;
+    uint32_t first;     /* First operand in Infer.operands */
+    uint32_t count;
+} Term;
+
+typedef struct {
+    TermId a;
+    TermId b;
+} TermPair;
+
+/* A call of a top-level function in an instance body, answered by the
+ * instance hook once its argument types settle */
+typedef struct {
+    uint32_t call;          /* Preorder id of the call */
+    uint32_t function;      /* Preorder id of the callee */
+    TermId ret;
+    uint32_t first_arg;     /* Argument types last asked about, in Infer.asked */
+    uint32_t arg_count;
+    bool asked;
+} PendingCall;
+
+typedef struct {
+    const Resolution* res;
+    const AstIndex* index;
+    TypeInference* result;
+    DiagBuffer* diags;
+    Term* terms;
+    size_t term_capacity;
+    TermId* operands;
+    size_t operand_count;
+    size_t operand_capacity;
+    TermId* node_terms;         /* By preorder id, TERM_NONE for untyped nodes */
+    TermId* symbol_terms;       /* By SymbolId, made on first use */
+    TermId dynamic;             /* The one dynamic class */
+    TermPair* pending;          /* Unification worklist */
+    size_t pending_count;
+    size_t pending_capacity;
+    uint32_t* deferred;         /* Members whose object was still unbound */
+    size_t deferred_count;
+    size_t deferred_capacity;
+    uint32_t* args;             /* Argument ids of the call being inferred */
+    size_t arg_capacity;
+    TermId ret;                 /* Return term of the function being checked */
+    TermId* frame_rets;         /* Return term of each frame's function */
+    bool returns_value;
+    bool failed;                /* Out of memory */
+
+    /* Instance mode (see instance_infer()): nodes in [node_lo, node_hi)
+     * and the locals of frame belong to the body being checked; the rest
+     * of the program keeps the types base gave it */
+    const TypeInference* base;
+    uint32_t frame;             /* Whose locals are the body's own */
+    uint32_t node_lo;
+    uint32_t node_hi;
+    InstanceCallHook hook;
+    void* hook_context;
+    PendingCall* calls;
+    size_t call_count;
+    size_t call_capacity;
+    TypeId* asked;
+    size_t asked_count;
+    size_t asked_capacity;
+
+    /* Interface mode (see infer_program_interfaces()). Terms made before
+     * the bodies are the same in programs that differ only in bodies, and
+     * name the classes they are in; the roots older than mark that the
+     * body being inferred merged are noted with those names. */
+    TermId* anchors;            /* By term: least such term in its class,
+                                 * TERM_NONE for none; kept up by roots */
+    size_t anchor_capacity;
+    TermId bodies;              /* First term made in a body */
+    TermId mark;                /* 0 outside a traced body */
+    TermId* touched;
+    TermId* names;              /* Anchor of each touched root */
+    size_t touched_count;
+    size_t touched_capacity;
+    size_t name_capacity;
+    bool unnamed;               /* The body met a class with no anchor */
+    SymbolId* typed;
+    size_t typed_count;
+    size_t typed_capacity;
+    uint32_t* visits;           /* By term: the hash that numbered its class */
+    uint32_t* numbers;          /* By term: that number */
+    size_t visit_capacity;
+    uint32_t visit;
+    uint32_t visited;
+    bool deep;
+} Infer;
+
+static bool reserve(void** items, size_t* capacity, size_t index, size_t item_size) {
+    if (index < *capacity) return true;
+    size_t grown_capacity = *capacity ? *capacity : 64;
+    while (grown_capacity <= index) grown_capacity *= 2;
+    void* grown = realloc(*items, grown_capacity * item_size);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+static AstNode* node_at(const Infer* in, uint32_t id) {
+    return in->index->nodes[id];
+}
+
+/* Id of a direct child of parent, AST_INDEX_NONE for an empty slot */
+static uint32_t child_id(const Infer* in, uint32_t parent, const AstNode* child) {
+    const AstIndex* index = in->index;
+    if (!child) return AST_INDEX_NONE;
+    for (uint32_t id = parent + 1; id < parent + index->size[parent]; id += index->size[id]) {
+        if (index->nodes[id] == child) return id;
+    }
+    return AST_INDEX_NONE;
+}
+
+static void report(Infer* in, DiagSeverity severity, DiagCode code, uint32_t id, const char* message) {
+    if (id == AST_INDEX_NONE || !in->diags) return;
+    const AstNode* node = node_at(in, id);
+    Diagnostic diag;
+    diag.severity = severity;
+    diag.code = code;
+    diag.message = message;
+    diag.found = TOKEN_ERROR;
+    diag.offset = node->offset;
+    diag.length = node->length;
+    diag.line = node->line;
+    diag.column = node->column;
+    diag_report(in->diags, &diag);
+}
+
+/* ===== Terms ===== */
+
+/* A new root; the dynamic term when out of memory, which keeps every
+ * caller's term valid until the pass gives up */
+static TermId fresh(Infer* in, TermKind kind, uint8_t numeric, uint32_t value, uint32_t count) {
+    size_t id = in->result->variables;
+    if (id >= TERM_NONE ||
+        !reserve((void**)&in->terms, &in->term_capacity, id, sizeof(Term)) ||
+        (count && !reserve((void**)&in->operands, &in->operand_capacity,
+                           in->operand_count + count - 1, sizeof(TermId)))) {
+        in->failed = true;
+        return in->dynamic;
+    }
+    if (in->anchors) {
+        if (!reserve((void**)&in->anchors, &in->anchor_capacity, id, sizeof(TermId))) {
+            in->failed = true;
+            return in->dynamic;
+        }
+        in->anchors[id] = id < in->bodies ? (TermId)id : TERM_NONE;
+    }
+    Term* term = &in->terms[id];
+    term->parent = (TermId)id;
+    term->rank = 0;
+    term->kind = (uint8_t)kind;
+    term->numeric = numeric;
+    term->value = value;
+    term->first = (uint32_t)in->operand_count;
+    term->count = count;
+    in->operand_count += count;
+    in->result->variables++;
+    return (TermId)id;
+}
+
+static TermId var(Infer* in, NumClass numeric) {
+    return fresh(in, TERM_VAR, (uint8_t)numeric, 0, 0);
+}
+
+/* Every use gets a term of its own: a conflict then makes dynamic only
+ * the values unified with that use, not every value of the type */
+static TermId primitive(Infer* in, TypeId type) {
+    return type == TYPE_DYNAMIC ? in->dynamic : fresh(in, TERM_PRIMITIVE, NUM_NONE, type, 0);
+}
+
+static TermId operand(const Infer* in, TermId term, uint32_t i) {
+    return in->operands[in->terms[term].first + i];
+}
+
+static void set_operand(Infer* in, TermId term, uint32_t i, TermId value) {
+    in->operands[in->terms[term].first + i] = value;
+}
+
+static TermId array_of(Infer* in, TermId element) {
+    TermId term = fresh(in, TERM_ARRAY, NUM_NONE, 0, 1);
+    if (!in->failed) set_operand(in, term, 0, element);
+    return term;
+}
+
+static TermId dict_of(Infer* in, TermId key, TermId value) {
+    TermId term = fresh(in, TERM_DICT, NUM_NONE, 0, 2);
+    if (!in->failed) {
+        set_operand(in, term, 0, key);
+        set_operand(in, term, 1, value);
+    }
+    return term;
+}
+
+/* Root of term's class; every node on the way is then pointed straight
+ * at the root (path compression) */
+static TermId find(Infer* in, TermId term) {
+    TermId root = term;
+    while (in->terms[root].parent != root) root = in->terms[root].parent;
+    while (in->terms[term].parent != root) {
+        TermId next = in->terms[term].parent;
+        in->terms[term].parent = root;
+        term = next;
+    }
+    return root;
+}
+
+static uint8_t numeric_meet(uint8_t a, uint8_t b) {
+    if (a == b || b == NUM_NONE) return a;
+    if (a == NUM_NONE || a == NUM_ANY) return b;
+    if (b == NUM_ANY) return a;
+    return NUM_CONFLICT;
+}
+
+/* Whether a bound term may take the place of a variable of class numeric */
+static bool satisfies(const Infer* in, const Term* term, uint8_t numeric) {
+    if (numeric == NUM_NONE) return true;
+    if (term->kind != TERM_PRIMITIVE) return false;
+    TypeKind kind = type_get(in->result->types, term->value)->kind;
+    if (kind == TYPE_KIND_INTEGER) return numeric != NUM_FLOATING;
+    if (kind == TYPE_KIND_FLOAT) return numeric != NUM_INTEGRAL;
+    return false;
+}
+
+/* Notes a class older than the traced body that the body changed */
+static void touch(Infer* in, TermId root) {
+    if (!reserve((void**)&in->touched, &in->touched_capacity, in->touched_count, sizeof(TermId)) ||
+        !reserve((void**)&in->names, &in->name_capacity, in->touched_count, sizeof(TermId))) {
+        in->failed = true;
+        return;
+    }
+    if (in->anchors[root] == TERM_NONE) in->unnamed = true;
+    in->touched[in->touched_count] = root;
+    in->names[in->touched_count++] = in->anchors[root];
+}
+
+/* Union by rank; the surviving root takes content */
+static void merge(Infer* in, TermId a, TermId b, const Term* content) {
+    Term saved = *content;
+    if (a < in->mark) touch(in, a);
+    if (b < in->mark) touch(in, b);
+    TermId root = a;
+    if (in->terms[a].rank < in->terms[b].rank) {
+        in->terms[a].parent = b;
+        root = b;
+    } else {
+        in->terms[b].parent = a;
+        if (in->terms[a].rank == in->terms[b].rank) in->terms[a].rank++;
+    }
+    if (in->anchors) {
+        TermId anchor = in->anchors[a] < in->anchors[b] ? in->anchors[a] : in->anchors[b];
+        in->anchors[root] = anchor;
+    }
+    Term* term = &in->terms[root];
+    term->kind = saved.kind;
+    term->numeric = saved.numeric;
+    term->value = saved.value;
+    term->first = saved.first;
+    term->count = saved.count;
+}
+
+static void push_pair(Infer* in, TermId a, TermId b) {
+    if (!reserve((void**)&in->pending, &in->pending_capacity, in->pending_count, sizeof(TermPair))) {
+        in->failed = true;
+        return;
+    }
+    in->pending[in->pending_count].a = a;
+    in->pending[in->pending_count].b = b;
+    in->pending_count++;
+}
+
+/* Makes a and b one type, operands included, with a worklist rather than
+ * recursion. A pair that cannot be made equal merges into a dynamic class,
+ * counted and reported once per call at node. Returns false on a conflict. */
+static bool unify(Infer* in, TermId a, TermId b, uint32_t node) {
+    bool ok = true;
+    in->pending_count = 0;
+    push_pair(in, a, b);
+
+    while (in->pending_count > 0 && !in->failed) {
+        TermPair pair = in->pending[--in->pending_count];
+        TermId x = find(in, pair.a);
+        TermId y = find(in, pair.b);
+        if (x == y) continue;
+        Term tx = in->terms[x];
+        Term ty = in->terms[y];
+
+        if (tx.kind == TERM_DYNAMIC || ty.kind == TERM_DYNAMIC) {
+            merge(in, x, y, tx.kind == TERM_DYNAMIC ? &tx : &ty);
+            continue;
+        }
+        if (tx.kind == TERM_VAR && ty.kind == TERM_VAR) {
+            tx.numeric = numeric_meet(tx.numeric, ty.numeric);
+            if (tx.numeric != NUM_CONFLICT) {
+                merge(in, x, y, &tx);
+                continue;
+            }
+        } else if (tx.kind == TERM_VAR || ty.kind == TERM_VAR) {
+            const Term* bound = tx.kind == TERM_VAR ? &ty : &tx;
+            uint8_t numeric = tx.kind == TERM_VAR ? tx.numeric : ty.numeric;
+            if (satisfies(in, bound, numeric)) {
+                merge(in, x, y, bound);
+                continue;
+            }
+        } else if (tx.kind == ty.kind && tx.value == ty.value && tx.count == ty.count) {
+            merge(in, x, y, &tx);
+            for (uint32_t i = 0; i < tx.count; i++) {
+                push_pair(in, in->operands[tx.first + i], in->operands[ty.first + i]);
+            }
+            continue;
+        }
+
+        merge(in, x, y, &in->terms[in->dynamic]);
+        ok = false;
+    }
+
+    if (!ok) {
+        in->result->conflicts++;
+        report(in, DIAG_WARNING, DIAG_TYPE_CONFLICT, node, "Conflicting types, value falls back to dynamic");
+    }
+    return ok;
+}
+
+static void constrain(Infer* in, TermId term, NumClass numeric, uint32_t node) {
+    unify(in, term, var(in, numeric), node);
+}
+
+/* ===== Instance Mode ===== */
+
+/* A term standing for a type found by an earlier pass. Types come from
+ * finished terms, so their nesting is bounded; the cap only guards the
+ * C stack. */
+static TermId term_from_type(Infer* in, TypeId type, int depth) {
+    const Type* t = type_get(in->result->types, type);
+    if (!t || type == TYPE_NONE) return var(in, NUM_NONE);
+
+    TermKind kind;
+    switch (t->kind) {
+        case TYPE_KIND_DYNAMIC: return in->dynamic;
+        case TYPE_KIND_CLASS: return fresh(in, TERM_CLASS, NUM_NONE, t->decl, 0);
+        case TYPE_KIND_ARRAY: kind = TERM_ARRAY; break;
+        case TYPE_KIND_DICT: kind = TERM_DICT; break;
+        case TYPE_KIND_FUNCTION: kind = TERM_FUNCTION; break;
+        default: return primitive(in, type);
+    }
+    if (depth > 64) return in->dynamic;
+
+    uint32_t count = t->count;
+    TermId term = fresh(in, kind, NUM_NONE, 0, count);
+    for (uint32_t i = 0; i < count && !in->failed; i++) {
+        TermId operand_term = term_from_type(in, type_operand(in->result->types, type, i), depth + 1);
+        set_operand(in, term, i, operand_term);
+    }
+    return term;
+}
+
+static bool outside_body(const Infer* in, uint32_t id) {
+    return in->base && (id < in->node_lo || id >= in->node_hi);
+}
+
+/* Term of a declaration: a class, field or method */
+static TermId decl_term(Infer* in, uint32_t id) {
+    if (outside_body(in, id)) return term_from_type(in, in->base->node_types[id], 0);
+    return in->node_terms[id];
+}
+
+/* The type a term has so far, unbound variables defaulted as finishing
+ * would; open is set when one was, as the type may still change */
+static TypeId peek_type(Infer* in, TermId term, bool* open, int depth) {
+    const Term* t = &in->terms[find(in, term)];
+    switch (t->kind) {
+        case TERM_VAR:
+            *open = true;
+            if (t->numeric == NUM_NONE) return TYPE_DYNAMIC;
+            return t->numeric == NUM_FLOATING ? TYPE_FLOAT : TYPE_INT;
+        case TERM_PRIMITIVE:
+            return t->value;
+        case TERM_CLASS:
+            return type_class(in->result->types, t->value, node_at(in, t->value)->as.class_decl.name);
+        case TERM_DYNAMIC:
+            return TYPE_DYNAMIC;
+        default:
+            break;
+    }
+
+    /* Small enough for the stack; wider or deeper types are dynamic */
+    TypeId operands[16];
+    uint32_t count = t->count;
+    uint32_t first = t->first;
+    TermKind kind = (TermKind)t->kind;
+    if (count > 16 || depth > 64) return TYPE_DYNAMIC;
+    for (uint32_t i = 0; i < count; i++) operands[i] = peek_type(in, in->operands[first + i], open, depth + 1);
+    if (kind == TERM_ARRAY) return type_array(in->result->types, operands[0]);
+    if (kind == TERM_DICT) return type_dict(in->result->types, operands[0], operands[1]);
+    return type_function(in->result->types, operands[0], operands + 1, count - 1);
+}
+
+static TermId symbol_term(Infer* in, SymbolId symbol) {
+    if (symbol == SYMBOL_NONE) return in->dynamic;
+    if (in->base && in->res->variables[symbol].frame != in->frame) {
+        return term_from_type(in, in->base->symbol_types[symbol], 0);
+    }
+    if (in->symbol_terms[symbol] == TERM_NONE) {
+        in->symbol_terms[symbol] = var(in, NUM_NONE);
+        if (in->mark && in->res->variables[symbol].frame == RESOLVE_NO_FRAME) {
+            if (!reserve((void**)&in->typed, &in->typed_capacity, in->typed_count, sizeof(SymbolId))) {
+                in->failed = true;
+            } else {
+                in->typed[in->typed_count++] = symbol;
+            }
+        }
+    }
+    return in->symbol_terms[symbol];
+}
+
+/* The type an annotation names: a primitive, a class, otherwise dynamic.
+ * A name the program never spelled elsewhere names no class. */
+static TermId annotation_term(Infer* in, const char* name) {
+    TypeId type = type_from_name(name);
+    if (type != TYPE_NONE) return primitive(in, type);
+
+    uint32_t id = string_interner_find(in->res->interner, name, strlen(name));
+    SymbolId symbol = id ? symbol_table_lookup(in->res->symbols, id) : SYMBOL_NONE;
+    if (symbol != SYMBOL_NONE && symbol_table_get(in->res->symbols, symbol)->kind == SYMBOL_CLASS) {
+        uint32_t decl = ast_index_id(in->index, symbol_table_get(in->res->symbols, symbol)->decl);
+        if (decl != AST_INDEX_NONE) return decl_term(in, decl);
+    }
+    return in->dynamic;
+}
+
+/* ===== Expressions ===== */
+
+/* Id of a field or method, AST_INDEX_NONE if the class has none by that name */
+static uint32_t class_member(const Infer* in, uint32_t class_id, const char* name) {
+    const AstIndex* index = in->index;
+    for (uint32_t id = class_id + 1; id < class_id + index->size[class_id]; id += index->size[id]) {
+        AstNode* node = index->nodes[id];
+        if ((node->type == AST_VAR_DECL && strcmp(node->as.var_decl.name, name) == 0) ||
+            (node->type == AST_FUNCTION_DECL && strcmp(node->as.function.name, name) == 0)) {
+            return id;
+        }
+    }
+    return AST_INDEX_NONE;
+}
+
+/* Parameters a call must pass: those before the first default */
+static uint32_t required_params(const AstNode* function) {
+    AstList* params = function->as.function.parameters;
+    uint32_t count = 0;
+    while (params && count < params->count && !((Parameter*)params->items[count])->default_value) count++;
+    return count;
+}
+
+/* Settles a member access once its object's class is known; false while
+ * the object is still unbound */
+static bool infer_member(Infer* in, uint32_t id) {
+    TermId object = find(in, in->node_terms[id + 1]);
+    const Term* term = &in->terms[object];
+    if (term->kind == TERM_VAR) return false;
+
+    uint32_t member_id = AST_INDEX_NONE;
+    if (term->kind == TERM_CLASS) member_id = class_member(in, term->value, node_at(in, id)->as.member.member);
+    TermId member = member_id != AST_INDEX_NONE ? decl_term(in, member_id) : in->dynamic;
+    if (in->node_terms[id] == TERM_NONE) {
+        in->node_terms[id] = member;
+    } else {
+        unify(in, in->node_terms[id], member, id);
+    }
+    return true;
+}
+
+/* Calls a function term with the arguments in in->args */
+static TermId call_function(Infer* in, uint32_t id, TermId callee, size_t arg_count, const AstNode* decl) {
+    TermId root = find(in, callee);
+    if (in->terms[root].kind == TERM_FUNCTION) {
+        uint32_t params = in->terms[root].count - 1;
+        uint32_t required = decl ? required_params(decl) : params;
+        TermId ret = operand(in, root, 0);
+        if (arg_count < required || arg_count > params) {
+            report(in, DIAG_ERROR, DIAG_ARGUMENT_COUNT, id, "Wrong number of arguments");
+        }
+        for (size_t i = 0; i < arg_count && i < params; i++) {
+            unify(in, in->node_terms[in->args[i]], operand(in, root, (uint32_t)i + 1), in->args[i]);
+        }
+        return ret;
+    }
+
+    /* Anything else must be a function of these arguments */
+    TermId function = fresh(in, TERM_FUNCTION, NUM_NONE, 0, (uint32_t)arg_count + 1);
+    if (in->failed) return function;
+    TermId ret = var(in, NUM_NONE);
+    set_operand(in, function, 0, ret);
+    for (size_t i = 0; i < arg_count; i++) set_operand(in, function, (uint32_t)i + 1, in->node_terms[in->args[i]]);
+    unify(in, callee, function, id);
+    return ret;
+}
+
+static TermId call_builtin(Infer* in, uint32_t slot, size_t arg_count) {
+    TermId first = arg_count > 0 ? in->node_terms[in->args[0]] : TERM_NONE;
+    switch ((BuiltinSlot)slot) {
+        case BUILTIN_PRINT:
+            return primitive(in, TYPE_VOID);
+        case BUILTIN_INPUT:
+        case BUILTIN_STRING:
+            return primitive(in, TYPE_STRING);
+        case BUILTIN_LEN:
+        case BUILTIN_INT:
+            return primitive(in, TYPE_INT);
+        case BUILTIN_FLOAT:
+            return primitive(in, TYPE_FLOAT);
+        case BUILTIN_RANGE:
+            for (size_t i = 0; i < arg_count; i++) {
+                unify(in, in->node_terms[in->args[i]], primitive(in, TYPE_INT), in->args[i]);
+            }
+            return array_of(in, primitive(in, TYPE_INT));
+        case BUILTIN_SUM: {
+            TermId element = var(in, NUM_ANY);
+            if (first != TERM_NONE) unify(in, first, array_of(in, element), in->args[0]);
+            return element;
+        }
+        case BUILTIN_ABS:
+            if (first == TERM_NONE) return var(in, NUM_ANY);
+            constrain(in, first, NUM_ANY, in->args[0]);
+            return first;
+        case BUILTIN_MIN:
+        case BUILTIN_MAX:
+            if (arg_count == 1) {
+                TermId element = var(in, NUM_NONE);
+                unify(in, first, array_of(in, element), in->args[0]);
+                return element;
+            }
+            for (size_t i = 1; i < arg_count; i++) unify(in, first, in->node_terms[in->args[i]], in->args[i]);
+            return first != TERM_NONE ? first : in->dynamic;
+        case BUILTIN_ROUND:
+            if (first != TERM_NONE) constrain(in, first, NUM_ANY, in->args[0]);
+            return primitive(in, TYPE_INT);
+        case BUILTIN_SQRT:
+        case BUILTIN_POW:
+            for (size_t i = 0; i < arg_count; i++) constrain(in, in->node_terms[in->args[i]], NUM_ANY, in->args[i]);
+            return primitive(in, TYPE_FLOAT);
+    }
+    return in->dynamic;
+}
+
+static TermId infer_call(Infer* in, uint32_t id) {
+    const AstIndex* index = in->index;
+    uint32_t callee = id + 1;
+    size_t arg_count = 0;
+    for (uint32_t arg = callee + index->size[callee]; arg < id + index->size[id]; arg += index->size[arg]) {
+        if (!reserve((void**)&in->args, &in->arg_capacity, arg_count, sizeof(uint32_t))) {
+            in->failed = true;
+            return in->dynamic;
+        }
+        in->args[arg_count++] = arg;
+    }
+
+    AstNode* callee_node = node_at(in, callee);
+    if (callee_node->type == AST_IDENTIFIER_EXPR && in->res->names[callee].symbol != SYMBOL_NONE) {
+        const NameRef* ref = &in->res->names[callee];
+        const Symbol* symbol = symbol_table_get(in->res->symbols, ref->symbol);
+        if (symbol->kind == SYMBOL_BUILTIN) return call_builtin(in, ref->slot, arg_count);
+        if (symbol->kind == SYMBOL_FUNCTION && in->base) {
+            /* Which instance answers depends on the argument types, known
+             * only once the body has been checked */
+            uint32_t function = ast_index_id(in->index, symbol->decl);
+            if (function != AST_INDEX_NONE &&
+                reserve((void**)&in->calls, &in->call_capacity, in->call_count, sizeof(PendingCall))) {
+                PendingCall* pending = &in->calls[in->call_count++];
+                pending->call = id;
+                pending->function = function;
+                pending->ret = var(in, NUM_NONE);
+                pending->asked = false;
+                return pending->ret;
+            }
+            in->failed = function != AST_INDEX_NONE;
+            return in->dynamic;
+        }
+        if (symbol->kind == SYMBOL_FUNCTION) {
+            return call_function(in, id, in->node_terms[callee], arg_count, symbol->decl);
+        }
+        if (symbol->kind == SYMBOL_CLASS) {
+            /* Constructing an instance runs its init method, if it has one */
+            uint32_t class_id = ast_index_id(in->index, symbol->decl);
+            if (class_id == AST_INDEX_NONE) return in->dynamic;
+            uint32_t init = class_member(in, class_id, "init");
+            if (init != AST_INDEX_NONE && node_at(in, init)->type == AST_FUNCTION_DECL) {
+                call_function(in, id, decl_term(in, init), arg_count, node_at(in, init));
+            }
+            return decl_term(in, class_id);
+        }
+    }
+    return call_function(in, id, in->node_terms[callee], arg_count, NULL);
+}
+
+static TermId infer_index(Infer* in, uint32_t id) {
+    uint32_t object_id = id + 1;
+    uint32_t key_id = object_id + in->index->size[object_id];
+    TermId object = in->node_terms[object_id];
+    TermId key = in->node_terms[key_id];
+    const Term* term = &in->terms[find(in, object)];
+
+    switch (term->kind) {
+        case TERM_ARRAY: {
+            TermId element = operand(in, find(in, object), 0);
+            unify(in, key, primitive(in, TYPE_INT), key_id);
+            return element;
+        }
+        case TERM_DICT: {
+            TermId value = operand(in, find(in, object), 1);
+            unify(in, key, operand(in, find(in, object), 0), key_id);
+            return value;
+        }
+        case TERM_DYNAMIC:
+            return in->dynamic;
+        case TERM_VAR: {
+            TermId element = var(in, NUM_NONE);
+            const Term* key_term = &in->terms[find(in, key)];
+            if (key_term->kind == TERM_PRIMITIVE && key_term->value == TYPE_STRING) {
+                unify(in, object, dict_of(in, key, element), id);
+            } else {
+                unify(in, key, primitive(in, TYPE_INT), key_id);
+                unify(in, object, array_of(in, element), id);
+            }
+            return element;
+        }
+        default:
+            if (term->kind == TERM_PRIMITIVE && term->value == TYPE_STRING) {
+                unify(in, key, primitive(in, TYPE_INT), key_id);
+                return primitive(in, TYPE_STRING);
+            }
+            unify(in, object, array_of(in, var(in, NUM_NONE)), id);
+            return in->dynamic;
+    }
+}
+
+static TermId infer_binary(Infer* in, uint32_t id) {
+    AstNode* node = node_at(in, id);
+    uint32_t left_id = id + 1;
+    uint32_t right_id = left_id + in->index->size[left_id];
+    TermId left = in->node_terms[left_id];
+    TermId right = in->node_terms[right_id];
+
+    switch (node->as.binary.op) {
+        case OP_ADD: {
+            /* String concatenation converts the other side */
+            const Term* l = &in->terms[find(in, left)];
+            const Term* r = &in->terms[find(in, right)];
+            if ((l->kind == TERM_PRIMITIVE && l->value == TYPE_STRING) ||
+                (r->kind == TERM_PRIMITIVE && r->value == TYPE_STRING)) {
+                return primitive(in, TYPE_STRING);
+            }
+            unify(in, left, right, id);
+            return left;
+        }
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_MOD:
+            constrain(in, left, NUM_ANY, left_id);
+            unify(in, left, right, id);
+            return left;
+        case OP_BIT_AND:
+        case OP_BIT_OR:
+        case OP_BIT_XOR:
+        case OP_SHL:
+        case OP_SHR:
+            constrain(in, left, NUM_INTEGRAL, left_id);
+            unify(in, left, right, id);
+            return left;
+        case OP_EQ:
+        case OP_NE:
+        case OP_LT:
+        case OP_GT:
+        case OP_LE:
+        case OP_GE:
+            unify(in, left, right, id);
+            return primitive(in, TYPE_BOOL);
+        case OP_AND:
+        case OP_OR:
+            unify(in, left, primitive(in, TYPE_BOOL), left_id);
+            unify(in, right, primitive(in, TYPE_BOOL), right_id);
+            return primitive(in, TYPE_BOOL);
+    }
+    return in->dynamic;
+}
+
+static void infer_node(Infer* in, uint32_t id) {
+    AstNode* node = node_at(in, id);
+    const AstIndex* index = in->index;
+    TermId term = TERM_NONE;
+
+    switch (node->type) {
+        case AST_LITERAL_EXPR:
+            switch (node->as.literal.type) {
+                case LIT_INT: term = var(in, NUM_ANY); break;
+                case LIT_FLOAT: term = var(in, NUM_FLOATING); break;
+                case LIT_STRING: term = primitive(in, TYPE_STRING); break;
+                case LIT_BOOL: term = primitive(in, TYPE_BOOL); break;
+                case LIT_NULL: term = var(in, NUM_NONE); break;
+            }
+            break;
+
+        case AST_IDENTIFIER_EXPR: {
+            SymbolId symbol = in->res->names[id].symbol;
+            term = symbol == SYMBOL_NONE ? in->dynamic : symbol_term(in, symbol);
+            break;
+        }
+
+        case AST_BINARY_EXPR:
+            term = infer_binary(in, id);
+            break;
+
+        case AST_UNARY_EXPR: {
+            TermId operand_term = in->node_terms[id + 1];
+            if (node->as.unary.op == OP_NOT) {
+                unify(in, operand_term, primitive(in, TYPE_BOOL), id + 1);
+                term = primitive(in, TYPE_BOOL);
+            } else {
+                constrain(in, operand_term, node->as.unary.op == OP_NEG ? NUM_ANY : NUM_INTEGRAL, id + 1);
+                term = operand_term;
+            }
+            break;
+        }
+
+        case AST_CALL_EXPR:
+            term = infer_call(in, id);
+            break;
+
+        case AST_INDEX_EXPR:
+            term = infer_index(in, id);
+            break;
+
+        case AST_MEMBER_EXPR:
+            if (!infer_member(in, id)) {
+                in->node_terms[id] = var(in, NUM_NONE);
+                if (!reserve((void**)&in->deferred, &in->deferred_capacity, in->deferred_count, sizeof(uint32_t))) {
+                    in->failed = true;
+                    return;
+                }
+                in->deferred[in->deferred_count++] = id;
+            }
+            return;
+
+        case AST_ARRAY_EXPR: {
+            TermId element = var(in, NUM_NONE);
+            for (uint32_t child = id + 1; child < id + index->size[id]; child += index->size[child]) {
+                unify(in, element, in->node_terms[child], child);
+            }
+            term = array_of(in, element);
+            break;
+        }
+
+        case AST_DICT_EXPR: {
+            TermId key = var(in, NUM_NONE);
+            TermId value = var(in, NUM_NONE);
+            bool is_key = true;
+            for (uint32_t child = id + 1; child < id + index->size[id]; child += index->size[child]) {
+                unify(in, is_key ? key : value, in->node_terms[child], child);
+                is_key = !is_key;
+            }
+            term = dict_of(in, key, value);
+            break;
+        }
+
+        default:
+            return;
+    }
+    in->node_terms[id] = term;
+}
+
+/* Children come after their parent in preorder, so a backward scan over
+ * the subtree's ids types every operand before the node that uses it */
+static TermId infer_expression(Infer* in, uint32_t id) {
+    if (id == AST_INDEX_NONE) return TERM_NONE;
+    for (uint32_t i = id + in->index->size[id]; i > id && !in->failed; i--) {
+        infer_node(in, i - 1);
+    }
+    return in->node_terms[id];
+}
+
+static void infer_condition(Infer* in, uint32_t id) {
+    TermId term = infer_expression(in, id);
+    if (term != TERM_NONE) unify(in, term, primitive(in, TYPE_BOOL), id);
+}
+
+/* ===== Statements ===== */
+
+static void infer_statement(Infer* in, uint32_t id);
+
+static void infer_statements(Infer* in, uint32_t block) {
+    const AstIndex* index = in->index;
+    for (uint32_t id = block + 1; id < block + index->size[block] && !in->failed; id += index->size[id]) {
+        infer_statement(in, id);
+    }
+}
+
+static void infer_body(Infer* in, uint32_t id) {
+    if (id == AST_INDEX_NONE) return;
+    if (node_at(in, id)->type == AST_BLOCK_STMT) {
+        infer_statements(in, id);
+    } else {
+        infer_statement(in, id);
+    }
+}
+
+/* A variable declaration, or a class field (which has no symbol) */
+static void infer_var_decl(Infer* in, uint32_t id) {
+    AstNode* node = node_at(in, id);
+    SymbolId symbol = in->res->names[id].symbol;
+    TermId term = symbol != SYMBOL_NONE ? symbol_term(in, symbol) : in->node_terms[id];
+    if (term == TERM_NONE) term = var(in, NUM_NONE);
+    in->node_terms[id] = term;
+
+    if (node->as.var_decl.type_name) unify(in, term, annotation_term(in, node->as.var_decl.type_name), id);
+    uint32_t init = child_id(in, id, node->as.var_decl.initializer);
+    TermId value = infer_expression(in, init);
+    if (value != TERM_NONE) unify(in, term, value, init);
+}
+
+static void infer_for(Infer* in, uint32_t id) {
+    AstNode* node = node_at(in, id);
+    uint32_t iterable_id = child_id(in, id, node->as.for_stmt.iterable);
+    TermId iterable = infer_expression(in, iterable_id);
+    SymbolId item_symbol = in->res->names[id].symbol;
+    TermId item = symbol_term(in, item_symbol);
+    in->node_terms[id] = item;
+
+    if (iterable != TERM_NONE) {
+        const Term* term = &in->terms[find(in, iterable)];
+        if (term->kind == TERM_DICT) {
+            unify(in, item, operand(in, find(in, iterable), 0), id);
+        } else if (term->kind == TERM_PRIMITIVE && term->value == TYPE_STRING) {
+            unify(in, item, primitive(in, TYPE_STRING), id);
+        } else {
+            unify(in, iterable, array_of(in, item), iterable_id);
+        }
+    }
+    if (node->as.for_stmt.index_var && item_symbol != SYMBOL_NONE) {
+        unify(in, symbol_term(in, item_symbol + 1), primitive(in, TYPE_INT), id);
+    }
+    infer_body(in, child_id(in, id, node->as.for_stmt.body));
+}
+
+static void infer_statement(Infer* in, uint32_t id) {
+    AstNode* node = node_at(in, id);
+    switch (node->type) {
+        case AST_VAR_DECL:
+            infer_var_decl(in, id);
+            break;
+
+        case AST_ASSIGN_STMT: {
+            uint32_t target = child_id(in, id, node->as.assign.target);
+            uint32_t value = child_id(in, id, node->as.assign.value);
+            TermId target_term = infer_expression(in, target);
+            TermId value_term = infer_expression(in, value);
+            if (target_term != TERM_NONE && value_term != TERM_NONE) unify(in, target_term, value_term, value);
+            break;
+        }
+
+        case AST_EXPR_STMT:
+            infer_expression(in, child_id(in, id, node->as.expr_stmt));
+            break;
+
+        case AST_IF_STMT:
+            for (;;) {
+                infer_condition(in, child_id(in, id, node->as.if_stmt.condition));
+                infer_body(in, child_id(in, id, node->as.if_stmt.then_branch));
+                AstNode* next = node->as.if_stmt.else_branch;
+                uint32_t next_id = child_id(in, id, next);
+                if (!next || next->type != AST_IF_STMT || in->failed) {
+                    infer_body(in, next_id);
+                    break;
+                }
+                node = next;
+                id = next_id;
+            }
+            break;
+
+        case AST_WHILE_STMT:
+            infer_condition(in, child_id(in, id, node->as.while_stmt.condition));
+            infer_body(in, child_id(in, id, node->as.while_stmt.body));
+            break;
+
+        case AST_FOR_STMT:
+            infer_for(in, id);
+            break;
+
+        case AST_LOOP_STMT:
+            infer_body(in, child_id(in, id, node->as.loop_stmt.body));
+            break;
+
+        case AST_BLOCK_STMT:
+            infer_statements(in, id);
+            break;
+
+        case AST_RETURN_STMT: {
+            uint32_t value = child_id(in, id, node->as.return_stmt.value);
+            TermId term = value != AST_INDEX_NONE ? infer_expression(in, value) : primitive(in, TYPE_VOID);
+            if (in->ret != TERM_NONE) {
+                unify(in, in->ret, term, value != AST_INDEX_NONE ? value : id);
+                if (value != AST_INDEX_NONE) in->returns_value = true;
+            }
+            break;
+        }
+
+        default:
+            /* Declarations are set up by infer_program(); breaks and
+             * continues have no type */
+            break;
+    }
+}
+
+/* ===== Declarations ===== */
+
+/* The signature of a function or method: its return and each parameter,
+ * 'this' excluded */
+static void declare_function(Infer* in, const FrameInfo* frame) {
+    uint32_t id = frame->node;
+    uint32_t parent = in->index->parent[id];
+    bool method = parent != AST_INDEX_NONE && node_at(in, parent)->type == AST_CLASS_DECL;
+    uint32_t skip = method && frame->param_count > 0 ? 1 : 0;
+
+    if (skip) unify(in, symbol_term(in, frame->first_param), decl_term(in, parent), id);
+    TermId function = fresh(in, TERM_FUNCTION, NUM_NONE, 0, frame->param_count - skip + 1);
+    TermId ret = var(in, NUM_NONE);
+    if (in->failed) return;
+    set_operand(in, function, 0, ret);
+    in->frame_rets[frame - in->res->frames] = ret;
+    for (uint32_t i = skip; i < frame->param_count; i++) {
+        set_operand(in, function, i - skip + 1, symbol_term(in, frame->first_param + i));
+    }
+    in->node_terms[id] = function;
+
+    SymbolId symbol = in->res->names[id].symbol;
+    if (!method && !in->base && symbol != SYMBOL_NONE) in->symbol_terms[symbol] = function;
+}
+
+static void infer_function(Infer* in, const FrameInfo* frame, TermId ret) {
+    uint32_t id = frame->node;
+    AstNode* node = node_at(in, id);
+    uint32_t parent = in->index->parent[id];
+    bool method = parent != AST_INDEX_NONE && node_at(in, parent)->type == AST_CLASS_DECL;
+    uint32_t skip = method && frame->param_count > 0 ? 1 : 0;
+
+    AstList* params = node->as.function.parameters;
+    for (size_t i = 0; params && i < params->count && i + skip < frame->param_count && !in->failed; i++) {
+        uint32_t value = child_id(in, id, ((Parameter*)params->items[i])->default_value);
+        TermId term = infer_expression(in, value);
+        if (term != TERM_NONE) unify(in, symbol_term(in, frame->first_param + (uint32_t)i + skip), term, value);
+    }
+
+    uint32_t body = child_id(in, id, node->as.function.body);
+    if (body == AST_INDEX_NONE) return;   /* Pending lazy body: the return stays open */
+    in->ret = ret;
+    in->returns_value = false;
+    infer_statements(in, body);
+    if (!in->returns_value) unify(in, in->ret, primitive(in, TYPE_VOID), id);
+    in->ret = TERM_NONE;
+}
+
+/* Resolves the deferred members whose objects are now known */
+static bool retry_members(Infer* in) {
+    bool any = false;
+    bool progress = true;
+    while (progress && in->deferred_count > 0 && !in->failed) {
+        progress = false;
+        size_t kept = 0;
+        for (size_t i = 0; i < in->deferred_count; i++) {
+            if (infer_member(in, in->deferred[i])) {
+                progress = true;
+            } else {
+                in->deferred[kept++] = in->deferred[i];
+            }
+        }
+        in->deferred_count = kept;
+        any = any || progress;
+    }
+    return any;
+}
+
+/* Members settle as their objects do; whatever is left is dynamic */
+static void settle_members(Infer* in) {
+    retry_members(in);
+    for (size_t i = 0; i < in->deferred_count && !in->failed; i++) {
+        unify(in, in->node_terms[in->deferred[i]], in->dynamic, AST_INDEX_NONE);
+    }
+    in->deferred_count = 0;
+}
+
+/* Asks the hook about each pending call whose argument types changed
+ * since it last asked, until none do. Unification only ever refines a
+ * class, so this ends. Calls whose arguments are still open wait for the
+ * others and for deferred members first, then go with the defaults. */
+static void settle_calls(Infer* in) {
+    const AstIndex* index = in->index;
+    bool forced = false;
+    for (;;) {
+        bool changed = false;
+        for (size_t c = 0; c < in->call_count && !in->failed; c++) {
+            PendingCall* pending = &in->calls[c];
+            uint32_t callee = pending->call + 1;
+            uint32_t end = pending->call + index->size[pending->call];
+            size_t start = in->asked_count;
+            bool open = false;
+            for (uint32_t arg = callee + index->size[callee]; arg < end; arg += index->size[arg]) {
+                if (!reserve((void**)&in->asked, &in->asked_capacity, in->asked_count, sizeof(TypeId))) {
+                    in->failed = true;
+                    return;
+                }
+                TermId term = in->node_terms[arg];
+                in->asked[in->asked_count++] = term == TERM_NONE ? TYPE_DYNAMIC : peek_type(in, term, &open, 0);
+            }
+            pending = &in->calls[c];
+            uint32_t count = (uint32_t)(in->asked_count - start);
+            bool same = pending->asked && pending->arg_count == count &&
+                        memcmp(&in->asked[pending->first_arg], &in->asked[start], count * sizeof(TypeId)) == 0;
+            if (same || (open && !forced)) {
+                in->asked_count = start;
+                continue;
+            }
+
+            pending->asked = true;
+            pending->first_arg = (uint32_t)start;
+            pending->arg_count = count;
+            TypeId ret = in->hook(in->hook_context, pending->call, pending->function, &in->asked[start], count);
+            if (ret != TYPE_NONE) unify(in, in->calls[c].ret, term_from_type(in, ret, 0), pending->call);
+            changed = true;
+        }
+        if (in->failed || (!changed && forced)) return;
+        if (!changed && !retry_members(in)) forced = true;
+    }
+}
+
+/* ===== Finishing ===== */
+
+typedef struct {
+    TypeId* types;          /* By root term, TYPE_PENDING until computed */
+    uint8_t* visiting;
+    TermId* stack;
+    size_t stack_count;
+    size_t stack_capacity;
+    TypeId* scratch;        /* Operand types of the term being built */
+    size_t scratch_capacity;
+} Finisher;
+
+static TypeId default_type(Infer* in, const Term* term) {
+    switch (term->numeric) {
+        case NUM_ANY:
+        case NUM_INTEGRAL:
+            in->result->defaulted++;
+            return TYPE_INT;
+        case NUM_FLOATING:
+            in->result->defaulted++;
+            return TYPE_FLOAT;
+        default:
+            return TYPE_DYNAMIC;
+    }
+}
+
+/* The concrete type of a term, built bottom-up with an explicit stack.
+ * A term reached again while its operands are still being built is a
+ * cyclic type (x = [x]), which no concrete type describes: dynamic. */
+static TypeId finish(Infer* in, Finisher* f, TermId start) {
+    TypeTable* types = in->result->types;
+    TermId start_root = find(in, start);
+    if (f->types[start_root] != TYPE_PENDING) return f->types[start_root];
+    f->stack_count = 0;
+    f->stack[f->stack_count++] = start_root;
+
+    while (f->stack_count > 0 && !in->failed) {
+        TermId root = f->stack[f->stack_count - 1];
+        if (f->types[root] != TYPE_PENDING) {
+            f->stack_count--;
+            continue;
+        }
+        const Term* term = &in->terms[root];
+        TypeId type = TYPE_DYNAMIC;
+
+        if (term->kind == TERM_ARRAY || term->kind == TERM_DICT || term->kind == TERM_FUNCTION) {
+            if (!f->visiting[root]) {
+                f->visiting[root] = 1;
+                for (uint32_t i = 0; i < term->count; i++) {
+                    TermId child = find(in, in->operands[term->first + i]);
+                    if (f->types[child] != TYPE_PENDING || f->visiting[child]) continue;
+                    if (!reserve((void**)&f->stack, &f->stack_capacity, f->stack_count, sizeof(TermId))) {
+                        in->failed = true;
+                        return TYPE_DYNAMIC;
+                    }
+                    f->stack[f->stack_count++] = child;
+                }
+                continue;
+            }
+            if (!reserve((void**)&f->scratch, &f->scratch_capacity, term->count, sizeof(TypeId))) {
+                in->failed = true;
+                return TYPE_DYNAMIC;
+            }
+            for (uint32_t i = 0; i < term->count; i++) {
+                TypeId operand_type = f->types[find(in, in->operands[term->first + i])];
+                f->scratch[i] = operand_type == TYPE_PENDING ? TYPE_DYNAMIC : operand_type;
+            }
+            if (term->kind == TERM_ARRAY) {
+                type = type_array(types, f->scratch[0]);
+            } else if (term->kind == TERM_DICT) {
+                type = type_dict(types, f->scratch[0], f->scratch[1]);
+            } else {
+                type = type_function(types, f->scratch[0], f->scratch + 1, term->count - 1);
+            }
+            if (type == TYPE_NONE) in->failed = true;
+        } else if (term->kind == TERM_VAR) {
+            type = default_type(in, term);
+        } else if (term->kind == TERM_PRIMITIVE) {
+            type = term->value;
+        } else if (term->kind == TERM_CLASS) {
+            type = type_class(types, term->value, node_at(in, term->value)->as.class_decl.name);
+            if (type == TYPE_NONE) in->failed = true;
+        }
+        f->types[root] = type;
+        f->stack_count--;
+    }
+    return f->types[start_root] == TYPE_PENDING ? TYPE_DYNAMIC : f->types[start_root];
+}
+
+static bool finisher_init(Finisher* f, size_t term_count) {
+    memset(f, 0, sizeof(*f));
+    f->types = (TypeId*)malloc((term_count + 1) * sizeof(TypeId));
+    f->visiting = (uint8_t*)calloc(term_count + 1, 1);
+    if (!f->types || !f->visiting || !reserve((void**)&f->stack, &f->stack_capacity, 0, sizeof(TermId))) {
+        return false;
+    }
+    for (size_t i = 0; i < term_count; i++) f->types[i] = TYPE_PENDING;
+    return true;
+}
+
+static void finisher_free(Finisher* f) {
+    free(f->types);
+    free(f->visiting);
+    free(f->stack);
+    free(f->scratch);
+}
+
+static bool finish_all(Infer* in) {
+    TypeInference* result = in->result;
+    Finisher f;
+    bool ok = finisher_init(&f, result->variables);
+
+    if (ok) {
+        for (uint32_t id = 0; id < in->index->count && !in->failed; id++) {
+            TermId term = in->node_terms[id];
+            TypeId type = term == TERM_NONE ? TYPE_NONE : finish(in, &f, term);
+            result->node_types[id] = type;
+            if (type == TYPE_DYNAMIC && node_at(in, id)->type < AST_VAR_DECL) result->dynamic++;
+        }
+        for (size_t s = 0; s < result->symbol_count && !in->failed; s++) {
+            TermId term = in->symbol_terms[s];
+            result->symbol_types[s] = term == TERM_NONE ? TYPE_NONE : finish(in, &f, term);
+        }
+        ok = !in->failed;
+    }
+    finisher_free(&f);
+    return ok;
+}
+
+/* ===== Interfaces ===== */
+
+static uint64_t hash_value(uint64_t h, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        h ^= (value >> (i * 8)) & 0xff;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static uint64_t hash_string(uint64_t h, const char* text) {
+    for (const unsigned char* c = (const unsigned char*)text; c && *c; c++) {
+        h ^= *c;
+        h *= 0x100000001b3ULL;
+    }
+    return hash_value(h, 0);
+}
+
+static int compare_ids(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Sorts ids, dropping repeats; returns how many are left */
+static size_t sort_unique(uint32_t* ids, size_t count) {
+    if (count == 0) return 0;
+    qsort(ids, count, sizeof(uint32_t), compare_ids);
+    size_t kept = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (ids[i] != ids[kept - 1]) ids[kept++] = ids[i];
+    }
+    return kept;
+}
+
+static bool was_touched(const Infer* in, TermId root) {
+    size_t lo = 0, hi = in->touched_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (in->touched[mid] < root) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < in->touched_count && in->touched[lo] == root;
+}
+
+/* Continues h with the class of term. A class older than the body that
+ * it left alone is hashed by its anchor; the others by their content,
+ * classes met before by the order they were first met in. */
+static uint64_t hash_class(Infer* in, uint64_t h, TermId term, int depth) {
+    TermId root = find(in, term);
+    if (root < in->mark && !was_touched(in, root)) {
+        if (in->anchors[root] == TERM_NONE) in->unnamed = true;
+        return hash_value(hash_value(h, 1), in->anchors[root]);
+    }
+    if (in->visits[root] == in->visit) return hash_value(hash_value(h, 2), in->numbers[root]);
+    in->visits[root] = in->visit;
+    in->numbers[root] = in->visited++;
+
+    const Term* t = &in->terms[root];
+    uint32_t first = t->first;
+    uint32_t count = t->count;
+    h = hash_value(h, 3u | (uint32_t)t->kind << 8 | (uint32_t)t->numeric << 16 | (uint64_t)count << 32);
+    if (t->kind == TERM_CLASS) {
+        /* Declarations after the body may have moved: classes go by name */
+        h = hash_string(h, node_at(in, t->value)->as.class_decl.name);
+    } else {
+        h = hash_value(h, t->value);
+    }
+    if (depth > INTERFACE_DEPTH_LIMIT) {
+        in->deep = true;
+        return h;
+    }
+    for (uint32_t i = 0; i < count; i++) h = hash_class(in, h, in->operands[first + i], depth + 1);
+    return h;
+}
+
+/* Interface of the body inferred since mark; 0 when it has none: when
+ * members of it wait for their objects, or it met a class that no term
+ * made before the bodies names */
+static uint64_t interface_hash(Infer* in, size_t deferred) {
+    size_t terms = in->result->variables;
+    if (in->failed || in->unnamed || in->deferred_count != deferred) return 0;
+    if (terms > in->visit_capacity) {
+        size_t capacity = in->visit_capacity ? in->visit_capacity : 64;
+        while (capacity < terms) capacity *= 2;
+        uint32_t* visits = (uint32_t*)realloc(in->visits, capacity * sizeof(uint32_t));
+        if (visits) in->visits = visits;
+        uint32_t* numbers = visits ? (uint32_t*)realloc(in->numbers, capacity * sizeof(uint32_t)) : NULL;
+        if (!numbers) {
+            in->failed = true;
+            return 0;
+        }
+        in->numbers = numbers;
+        memset(in->visits + in->visit_capacity, 0, (capacity - in->visit_capacity) * sizeof(uint32_t));
+        in->visit_capacity = capacity;
+    }
+    size_t named = sort_unique(in->names, in->touched_count);
+    in->touched_count = sort_unique(in->touched, in->touched_count);
+    in->typed_count = sort_unique(in->typed, in->typed_count);
+    in->visit++;
+    in->visited = 0;
+    in->deep = false;
+
+    uint64_t h = FNV_OFFSET;
+    for (size_t i = 0; i < named; i++) h = hash_class(in, hash_value(h, in->names[i]), in->names[i], 0);
+    for (size_t i = 0; i < in->typed_count; i++) {
+        h = hash_class(in, hash_value(h, in->typed[i]), in->symbol_terms[in->typed[i]], 0);
+    }
+    if (in->deep || in->unnamed) return 0;
+    return h ? h : 1;
+}
+
+/* ===== Driver ===== */
+
+static bool infer_init(Infer* in, TypeInference* result, const Resolution* res, DiagBuffer* diags) {
+    memset(result, 0, sizeof(*result));
+    memset(in, 0, sizeof(*in));
+    in->res = res;
+    in->index = &res->index;
+    in->result = result;
+    in->diags = diags;
+    in->ret = TERM_NONE;
+
+    uint32_t count = res->index.count;
+    result->node_count = count;
+    result->symbol_count = symbol_table_count(res->symbols);
+    result->types = type_table_create();
+    result->node_types = (TypeId*)malloc((count + 1) * sizeof(TypeId));
+    result->symbol_types = (TypeId*)malloc((result->symbol_count + 1) * sizeof(TypeId));
+    in->node_terms = (TermId*)malloc((count + 1) * sizeof(TermId));
+    in->symbol_terms = (TermId*)malloc((result->symbol_count + 1) * sizeof(TermId));
+    in->frame_rets = (TermId*)malloc(res->frame_count * sizeof(TermId));
+    if (!result->types || !result->node_types || !result->symbol_types || !in->node_terms ||
+        !in->symbol_terms || !in->frame_rets) {
+        return false;
+    }
+    for (uint32_t id = 0; id < count; id++) in->node_terms[id] = TERM_NONE;
+    for (size_t s = 0; s < result->symbol_count; s++) in->symbol_terms[s] = TERM_NONE;
+
+    /* The dynamic term comes first: fresh() falls back to it */
+    in->dynamic = fresh(in, TERM_DYNAMIC, NUM_NONE, TYPE_DYNAMIC, 0);
+    return !in->failed;
+}
+
+static void infer_free(Infer* in) {
+    free(in->terms);
+    free(in->operands);
+    free(in->node_terms);
+    free(in->symbol_terms);
+    free(in->pending);
+    free(in->deferred);
+    free(in->args);
+    free(in->frame_rets);
+    free(in->calls);
+    free(in->asked);
+    free(in->anchors);
+    free(in->touched);
+    free(in->names);
+    free(in->typed);
+    free(in->visits);
+    free(in->numbers);
+}
+
+/* Infers the body of every frame in order, tracing those of top-level
+ * functions when interfaces is set. False when the pass stops at one. */
+static bool infer_bodies(Infer* in, InferInterfaces* interfaces) {
+    const AstIndex* index = in->index;
+    uint32_t top = 1;
+    size_t decl = 0;
+    in->bodies = (TermId)in->result->variables;
+    for (size_t frame = 1; frame < in->res->frame_count && !in->failed; frame++) {
+        const FrameInfo* info = &in->res->frames[frame];
+        if (!interfaces || index->parent[info->node] != 0) {
+            infer_function(in, info, in->frame_rets[frame]);
+            continue;
+        }
+
+        /* Frames come in source order, so the declaration is found by
+         * walking on from the last one's */
+        if (info->node < top) {
+            top = 1;
+            decl = 0;
+        }
+        while (top < info->node) {
+            top += index->size[top];
+            decl++;
+        }
+        size_t deferred = in->deferred_count;
+        in->mark = (TermId)in->result->variables;
+        in->touched_count = 0;
+        in->typed_count = 0;
+        in->unnamed = false;
+        infer_function(in, info, in->frame_rets[frame]);
+        uint64_t hash = interface_hash(in, deferred);
+        in->mark = 0;
+        if (decl < interfaces->count) interfaces->hashes[decl] = hash;
+        if (decl == interfaces->stop && hash != 0 && hash == interfaces->expected) {
+            interfaces->stopped = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool infer_run(TypeInference* result, const Resolution* resolution, DiagBuffer* diags,
+                      InferInterfaces* interfaces) {
+    Infer in;
+    bool ok = infer_init(&in, result, resolution, diags);
+    const AstIndex* index = &resolution->index;
+    bool finished = true;
+    if (ok && interfaces) {
+        /* Every term anchors its class until the bodies begin */
+        in.bodies = TERM_NONE;
+        ok = reserve((void**)&in.anchors, &in.anchor_capacity, result->variables, sizeof(TermId));
+        for (size_t t = 0; ok && t < result->variables; t++) in.anchors[t] = (TermId)t;
+    }
+
+    if (ok && index->count > 0 && index->nodes[0]->type == AST_PROGRAM) {
+        /* Classes, fields and signatures exist before any use */
+        for (uint32_t id = 1; id < index->count && !in.failed; id += index->size[id]) {
+            AstNode* node = index->nodes[id];
+            if (node->type == AST_CLASS_DECL) {
+                in.node_terms[id] = fresh(&in, TERM_CLASS, NUM_NONE, id, 0);
+                for (uint32_t m = id + 1; m < id + index->size[id]; m += index->size[m]) {
+                    if (index->nodes[m]->type == AST_VAR_DECL) in.node_terms[m] = var(&in, NUM_NONE);
+                }
+            }
+        }
+        for (size_t frame = 1; frame < resolution->frame_count && !in.failed; frame++) {
+            declare_function(&in, &resolution->frames[frame]);
+        }
+
+        /* Top-level statements, in order */
+        for (uint32_t id = 1; id < index->count && !in.failed; id += index->size[id]) {
+            infer_statement(&in, id);
+        }
+
+        /* Fields and bodies */
+        for (uint32_t id = 1; id < index->count && !in.failed; id += index->size[id]) {
+            if (index->nodes[id]->type != AST_CLASS_DECL) continue;
+            for (uint32_t m = id + 1; m < id + index->size[id]; m += index->size[m]) {
+                if (index->nodes[m]->type == AST_VAR_DECL) infer_var_decl(&in, m);
+            }
+        }
+        finished = infer_bodies(&in, interfaces);
+        if (finished) settle_members(&in);
+    } else if (ok && index->count > 0) {
+        infer_statement(&in, 0);
+    }
+
+    if (ok && !finished && !in.failed) {
+        for (uint32_t id = 0; id < index->count; id++) result->node_types[id] = TYPE_NONE;
+        for (size_t s = 0; s < result->symbol_count; s++) result->symbol_types[s] = TYPE_NONE;
+    } else {
+        ok = ok && !in.failed && finish_all(&in);
+    }
+    infer_free(&in);
+    if (!ok) type_inference_free(result);
+    return ok;
+}
+
+bool infer_program(TypeInference* result, const Resolution* resolution, DiagBuffer* diags) {
+    return infer_run(result, resolution, diags, NULL);
+}
+
+bool infer_program_interfaces(TypeInference* result, const Resolution* resolution, DiagBuffer* diags,
+                              InferInterfaces* interfaces) {
+    for (size_t i = 0; i < interfaces->count; i++) interfaces->hashes[i] = 0;
+    interfaces->stopped = false;
+    return infer_run(result, resolution, diags, interfaces);
+}
+
+void type_inference_free(TypeInference* result) {
+    type_table_free(result->types);
+    free(result->node_types);
+    free(result->symbol_types);
+    memset(result, 0, sizeof(*result));
+}
+
+TypeId inference_type(const TypeInference* result, uint32_t id) {
+    return id < result->node_count ? result->node_types[id] : TYPE_NONE;
+}
+
+/* ===== Instances ===== */
+
+struct InstanceInference {
+    Infer in;
+    TypeInference local;    /* Counters, over the program's type table */
+};
+
+InstanceInference* instance_inference_create(const Resolution* resolution, const TypeInference* program,
+                                             InstanceCallHook hook, void* context) {
+    InstanceInference* session = (InstanceInference*)calloc(1, sizeof(InstanceInference));
+    if (!session) return NULL;
+    Infer* in = &session->in;
+    in->res = resolution;
+    in->index = &resolution->index;
+    in->result = &session->local;
+    in->ret = TERM_NONE;
+    in->base = program;
+    in->hook = hook;
+    in->hook_context = context;
+    session->local.types = program->types;
+    session->local.node_count = program->node_count;
+    session->local.symbol_count = program->symbol_count;
+
+    in->node_terms = (TermId*)malloc((program->node_count + 1) * sizeof(TermId));
+    in->symbol_terms = (TermId*)malloc((program->symbol_count + 1) * sizeof(TermId));
+    in->frame_rets = (TermId*)malloc(resolution->frame_count * sizeof(TermId));
+    if (!in->node_terms || !in->symbol_terms || !in->frame_rets) {
+        instance_inference_free(session);
+        return NULL;
+    }
+    for (uint32_t id = 0; id < program->node_count; id++) in->node_terms[id] = TERM_NONE;
+    for (size_t s = 0; s < program->symbol_count; s++) in->symbol_terms[s] = TERM_NONE;
+    return session;
+}
+
+void instance_inference_free(InstanceInference* session) {
+    if (!session) return;
+    infer_free(&session->in);
+    free(session);
+}
+
+bool instance_infer(InstanceInference* session, size_t frame, const TypeId* params, uint32_t param_count,
+                    TypeId* node_types, TypeId* ret, size_t* conflicts) {
+    Infer* in = &session->in;
+    const Resolution* res = in->res;
+    const FrameInfo* info = &res->frames[frame];
+    if (frame == 0 || frame >= res->frame_count) return false;
+
+    /* A function's locals are the symbols from its first parameter up to
+     * the next frame's: bodies are resolved one after another */
+    SymbolId symbol_hi = frame + 1 < res->frame_count ? res->frames[frame + 1].first_param
+                                                      : (SymbolId)session->local.symbol_count;
+    in->frame = (uint32_t)frame;
+    in->node_lo = info->node;
+    in->node_hi = info->node + in->index->size[info->node];
+    for (uint32_t id = in->node_lo; id < in->node_hi; id++) in->node_terms[id] = TERM_NONE;
+    for (SymbolId s = info->first_param; s < symbol_hi; s++) in->symbol_terms[s] = TERM_NONE;
+    session->local.variables = 0;
+    session->local.conflicts = 0;
+    in->operand_count = 0;
+    in->deferred_count = 0;
+    in->call_count = 0;
+    in->asked_count = 0;
+    in->failed = false;
+    in->dynamic = fresh(in, TERM_DYNAMIC, NUM_NONE, TYPE_DYNAMIC, 0);
+
+    uint32_t parent = in->index->parent[info->node];
+    uint32_t skip = parent != AST_INDEX_NONE && node_at(in, parent)->type == AST_CLASS_DECL &&
+                    info->param_count > 0 ? 1 : 0;
+    for (uint32_t i = 0; i < param_count && i + skip < info->param_count && !in->failed; i++) {
+        in->symbol_terms[info->first_param + skip + i] = term_from_type(in, params[i], 0);
+    }
+    declare_function(in, info);
+    if (!in->failed) infer_function(in, info, in->frame_rets[frame]);
+    settle_calls(in);
+    settle_members(in);
+
+    Finisher f;
+    bool ok = finisher_init(&f, session->local.variables) && !in->failed;
+    if (ok) {
+        for (uint32_t id = in->node_lo; id < in->node_hi && !in->failed; id++) {
+            TermId term = in->node_terms[id];
+            node_types[id - in->node_lo] = term == TERM_NONE ? TYPE_NONE : finish(in, &f, term);
+        }
+        *ret = finish(in, &f, in->frame_rets[frame]);
+        *conflicts = session->local.conflicts;
+        ok = !in->failed;
+    }
+    finisher_free(&f);
+    return ok;
+}
+
@@ -0,0 +1,116 @@
+/* LAMC Compiler - Type Inference
+ * Constraint-based inference over union-find type variables
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef INFER_H
+#define INFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../parser/diagnostics.h"
+#include "resolve.h"
+#include "types.h"
+
+/* The result of inference over one resolved program. Types are
+ * monomorphic: every function has one signature, unified across all of
+ * its call sites. */
+typedef struct {
+    TypeTable* types;
+    TypeId* node_types;     /* By preorder id of the resolution's index:
+                             * expressions get their value's type, variable
+                             * declarations and for loops their variable's,
+                             * functions their signature, classes their
+                             * instances'; other statements TYPE_NONE */
+    uint32_t node_count;
+    TypeId* symbol_types;   /* By SymbolId */
+    size_t symbol_count;
+    size_t variables;       /* Type variables created */
+    size_t conflicts;       /* Constraints that made a class dynamic */
+    size_t defaulted;       /* Numeric literal classes defaulted to int or float */
+    size_t dynamic;         /* Expressions left TYPE_DYNAMIC */
+} TypeInference;
+
+/* Infers a type for every node of a program resolved by resolve_program().
+ * Each expression, variable and signature slot is a type variable in a
+ * union-find forest (path compression, union by rank); every constraint
+ * is a unification, so the pass is near-linear in the program's size.
+ *
+ * An integer literal is a variable that only a numeric type can bind and
+ * a float literal one that only a float type can; classes left unbound
+ * default to int and float. Other unbound classes, and classes given two
+ * incompatible types, become TYPE_DYNAMIC (boxed); a conflict is reported
+ * to diags as a warning at the node that caused it. Calls with the wrong
+ * number of arguments are errors.
+ *
+ * Conditions are bool. '+' with a string operand yields a string; other
+ * arithmetic unifies its operands. Indexing an unknown value with a string
+ * makes it a dict, with anything else an array. Members resolve once the
+ * object is known to be a class instance, dynamic otherwise.
+ *
+ * Returns false when out of memory, with result freed. */
+bool infer_program(TypeInference* result, const Resolution* resolution, DiagBuffer* diags);
+void type_inference_free(TypeInference* result);
+
+/* Type of the node with preorder id, TYPE_NONE outside the tree */
+TypeId inference_type(const TypeInference* result, uint32_t id);
+
+/* ===== Interfaces ===== */
+
+/* What a function body passed on to the rest of its program. Bodies are
+ * inferred one after another, each against the types those before it
+ * left; a body's interface hashes what it changed outside itself: the
+ * classes of earlier terms it merged, as it left them, and the globals
+ * it typed first. Two programs that differ only in one body, with the
+ * same interface for it, infer the rest of the program alike: the same
+ * types outside that body and the same diagnostics outside it. */
+typedef struct {
+    uint64_t* hashes;       /* By top-level declaration: a function's
+                             * interface, 0 for other declarations and for
+                             * a body with members that wait on their
+                             * objects (they settle after every body) */
+    size_t count;           /* Top-level declarations of the program */
+    size_t stop;            /* Declaration whose interface, when it is
+                             * expected, ends the pass; SIZE_MAX for none */
+    uint64_t expected;
+    bool stopped;           /* Set when the pass ended there */
+} InferInterfaces;
+
+/* infer_program(), writing each function's interface to interfaces. A
+ * pass that stops has reported the diagnostics of everything inferred up
+ * to that body and found no types: result holds only TYPE_NONE. */
+bool infer_program_interfaces(TypeInference* result, const Resolution* resolution, DiagBuffer* diags,
+                              InferInterfaces* interfaces);
+
+/* ===== Instances ===== */
+
+/* Asked, while an instance body is checked, for the return type of the
+ * top-level function at preorder id function when called at call with
+ * args; TYPE_NONE when not known yet. Asked again when the argument types
+ * change. */
+typedef TypeId (*InstanceCallHook)(void* context, uint32_t call, uint32_t function,
+                                   const TypeId* args, uint32_t arg_count);
+
+/* Re-checks single function bodies against given parameter types, with
+ * the rest of the program as infer_program() typed it. Buffers are kept
+ * between instances, so a session costs each instance its body's size. */
+typedef struct InstanceInference InstanceInference;
+
+/* Program must be the inference of resolution and outlive the session;
+ * its type table receives the instances' types. NULL when out of memory. */
+InstanceInference* instance_inference_create(const Resolution* resolution, const TypeInference* program,
+                                             InstanceCallHook hook, void* context);
+void instance_inference_free(InstanceInference* session);
+
+/* Checks the body of frame with parameter i of type params[i] ('this'
+ * excluded; TYPE_NONE or missing ones are inferred from the body). Calls
+ * of top-level functions go to the hook instead of their shared signature.
+ * Writes the type of each node of the function to node_types[id - node],
+ * the instance's signature first, and its return type to ret. Nothing is
+ * reported; conflicts counts what made a value dynamic. Returns false
+ * when out of memory. */
+bool instance_infer(InstanceInference* session, size_t frame, const TypeId* params, uint32_t param_count,
+                    TypeId* node_types, TypeId* ret, size_t* conflicts);
+
+#endif /* INFER_H */
@@ -0,0 +1,841 @@
+/* LAMC Compiler - Modules Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "modules.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../parser/parser.h"
+#include "global_scope.h"
+#include "infer.h"
+#include "resolve.h"
+
+/* Key component of an import that has no interface */
+#define NO_INTERFACE 0x9e3779b97f4a7c15ULL
+
+/* ===== Helpers ===== */
+
+static bool reserve(void** items, size_t* capacity, size_t index, size_t item_size) {
+    if (index < *capacity) return true;
+    size_t grown_capacity = *capacity ? *capacity : 16;
+    while (grown_capacity <= index) grown_capacity *= 2;
+    void* grown = realloc(*items, grown_capacity * item_size);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+/* FNV-1a, continued from h */
+static uint64_t hash_bytes(uint64_t h, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static char* string_copy(const char* text) {
+    size_t length = strlen(text);
+    char* copy = (char*)malloc(length + 1);
+    if (copy) memcpy(copy, text, length + 1);
+    return copy;
+}
+
+static void report(DiagBuffer* diags, DiagCode code, int line, int column, size_t offset,
+                   size_t length, const char* message) {
+    Diagnostic diag;
+    diag.severity = DIAG_ERROR;
+    diag.code = code;
+    diag.message = message;
+    diag.found = length ? TOKEN_IDENTIFIER : TOKEN_ERROR;
+    diag.offset = offset;
+    diag.length = length;
+    diag.line = line;
+    diag.column = column;
+    diag_report(diags, &diag);
+}
+
+static void report_import(Module* module, const ModuleImport* import, DiagCode code, const char* message) {
+    report(&module->diags, code, import->line, import->column, import->offset, 0, message);
+}
+
+char* module_read_file(void* directory, const char* name, size_t* length) {
+    size_t path_length = strlen((const char*)directory) + strlen(name) + 7;
+    char* path = (char*)malloc(path_length);
+    if (!path) return NULL;
+    snprintf(path, path_length, "%s/%s.lamc", (const char*)directory, name);
+
+    FILE* file = fopen(path, "rb");
+    free(path);
+    if (!file) return NULL;
+
+    char* source = NULL;
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        source = (char*)malloc((size_t)size + 1);
+        if (source && fread(source, 1, (size_t)size, file) != (size_t)size) {
+            free(source);
+            source = NULL;
+        }
+    }
+    fclose(file);
+    if (!source) return NULL;
+    source[size] = '\0';
+    *length = (size_t)size;
+    return source;
+}
+
+/* ===== Interfaces ===== */
+
+static void interface_free(ModuleInterface* interface) {
+    for (size_t i = 0; i < interface->count; i++) {
+        free(interface->exports[i].name);
+        free(interface->exports[i].signature);
+    }
+    free(interface->exports);
+    interface->exports = NULL;
+    interface->count = 0;
+    interface->hash = 0;
+}
+
+static int compare_exports(const void* a, const void* b) {
+    return strcmp(((const ModuleExport*)a)->name, ((const ModuleExport*)b)->name);
+}
+
+const ModuleExport* module_interface_find(const ModuleInterface* interface, const char* name) {
+    size_t lo = 0;
+    size_t hi = interface->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int order = strcmp(interface->exports[mid].name, name);
+        if (order == 0) return &interface->exports[mid];
+        if (order < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t init_arity(const AstNode* class_decl) {
+    const AstList* methods = class_decl->as.class_decl.methods;
+    for (size_t i = 0; methods && i < methods->count; i++) {
+        const AstNode* method = methods->items[i];
+        if (strcmp(method->as.function.name, "init") == 0) {
+            return method->as.function.parameters ? (uint32_t)method->as.function.parameters->count : 0;
+        }
+    }
+    return MODULE_ANY_ARITY;
+}
+
+/* Top-level functions, classes and variables; of names declared twice,
+ * the later declaration, which is the one bound once the module has run */
+static bool extract_interface(ModuleInterface* interface, const Resolution* res, const TypeInference* types) {
+    size_t total = symbol_table_count(res->symbols);
+    GlobalScope* scope = global_scope_freeze(res->symbols, res->interner);
+    ModuleExport* exports = (ModuleExport*)calloc(total + 1, sizeof(ModuleExport));
+    if (!scope || !exports) {
+        global_scope_free(scope);
+        free(exports);
+        return false;
+    }
+
+    size_t count = 0;
+    bool ok = true;
+    for (SymbolId id = 0; id < total && ok; id++) {
+        const Symbol* symbol = symbol_table_get(res->symbols, id);
+        if (symbol->depth != 0 || !symbol->decl) continue;
+        if (symbol->kind != SYMBOL_FUNCTION && symbol->kind != SYMBOL_CLASS && symbol->kind != SYMBOL_VARIABLE) continue;
+        size_t length;
+        const char* name = string_interner_lookup(res->interner, symbol->name, &length);
+        if (global_scope_lookup(scope, name, length) != id) continue;
+
+        ModuleExport* export = &exports[count++];
+        export->kind = symbol->kind;
+        export->param_count = MODULE_ANY_ARITY;
+        if (symbol->kind == SYMBOL_FUNCTION) {
+            const AstList* params = symbol->decl->as.function.parameters;
+            export->param_count = params ? (uint32_t)params->count : 0;
+        } else if (symbol->kind == SYMBOL_CLASS) {
+            export->param_count = init_arity(symbol->decl);
+        }
+
+        char buffer[256];
+        TypeId type = inference_type(types, ast_index_id(&res->index, symbol->decl));
+        export->name = (char*)malloc(length + 1);
+        export->signature = string_copy(type_format(types->types, type, buffer, sizeof(buffer)));
+        ok = export->name && export->signature;
+        if (export->name) {
+            memcpy(export->name, name, length);
+            export->name[length] = '\0';
+        }
+    }
+    global_scope_free(scope);
+
+    ModuleInterface built = { exports, count, 0 };
+    if (!ok) {
+        interface_free(&built);
+        return false;
+    }
+    qsort(exports, count, sizeof(ModuleExport), compare_exports);
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < count; i++) {
+        const ModuleExport* export = &exports[i];
+        h = hash_bytes(h, export->name, strlen(export->name) + 1);
+        h = hash_bytes(h, &export->kind, sizeof(export->kind));
+        h = hash_bytes(h, &export->param_count, sizeof(export->param_count));
+        h = hash_bytes(h, export->signature, strlen(export->signature) + 1);
+    }
+    built.hash = h;
+
+    interface_free(interface);
+    *interface = built;
+    return true;
+}
+
+/* ===== Graph ===== */
+
+void module_graph_init(ModuleGraph* graph, ModuleReader read, void* context) {
+    memset(graph, 0, sizeof(*graph));
+    graph->read = read;
+    graph->context = context;
+}
+
+void module_graph_free(ModuleGraph* graph) {
+    for (size_t i = 0; i < graph->count; i++) {
+        Module* module = &graph->modules[i];
+        free(module->name);
+        free(module->source);
+        free(module->imports);
+        interface_free(&module->interface);
+        diag_buffer_free(&module->diags);
+        if (module->program) ast_free_node(module->program);
+    }
+    free(graph->modules);
+    free(graph->slots);
+    free(graph->order);
+    memset(graph, 0, sizeof(*graph));
+}
+
+static size_t find_slot(const ModuleGraph* graph, const char* name) {
+    size_t slot = (size_t)hash_bytes(0xcbf29ce484222325ULL, name, strlen(name)) & graph->slot_mask;
+    while (graph->slots[slot] && strcmp(graph->modules[graph->slots[slot] - 1].name, name) != 0) {
+        slot = (slot + 1) & graph->slot_mask;
+    }
+    return slot;
+}
+
+const Module* module_graph_find(const ModuleGraph* graph, const char* name) {
+    if (!graph->slots) return NULL;
+    uint32_t index = graph->slots[find_slot(graph, name)];
+    return index ? &graph->modules[index - 1] : NULL;
+}
+
+/* Index of the module called name, added if new; UINT32_MAX when out of memory */
+static uint32_t intern_module(ModuleGraph* graph, const char* name) {
+    if (graph->count * 2 >= graph->slot_mask + 1 || !graph->slots) {
+        size_t capacity = graph->slots ? (graph->slot_mask + 1) * 2 : 64;
+        uint32_t* slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        if (!slots) return UINT32_MAX;
+        free(graph->slots);
+        graph->slots = slots;
+        graph->slot_mask = capacity - 1;
+        for (size_t i = 0; i < graph->count; i++) {
+            graph->slots[find_slot(graph, graph->modules[i].name)] = (uint32_t)i + 1;
+        }
+    }
+
+    size_t slot = find_slot(graph, name);
+    if (graph->slots[slot]) return graph->slots[slot] - 1;
+
+    if (!reserve((void**)&graph->modules, &graph->capacity, graph->count, sizeof(Module))) return UINT32_MAX;
+    Module* module = &graph->modules[graph->count];
+    memset(module, 0, sizeof(*module));
+    module->name = string_copy(name);
+    if (!module->name) return UINT32_MAX;
+    diag_buffer_init(&module->diags);
+    graph->slots[slot] = (uint32_t)graph->count + 1;
+    return (uint32_t)graph->count++;
+}
+
+/* ===== Thread Pool ===== */
+
+typedef struct ModuleBuild ModuleBuild;
+typedef void (*ModuleTask)(ModuleBuild* build, uint32_t module);
+
+/* Workers sleep between batches; the building thread runs each batch
+ * with them and returns once every module of it is done */
+struct ModuleBuild {
+    ModuleGraph* graph;
+    const uint32_t* batch;
+    size_t batch_count;
+    ModuleTask task;
+    atomic_size_t next;
+    atomic_size_t parsed;
+    atomic_size_t analyzed;
+    atomic_bool failed;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    uint64_t generation;
+    int busy;
+    bool stop;
+    pthread_t* threads;
+    int thread_count;       /* Workers started, the building thread aside */
+};
+
+static void drain(ModuleBuild* build) {
+    for (;;) {
+        size_t item = atomic_fetch_add(&build->next, 1);
+        if (item >= build->batch_count) return;
+        build->task(build, build->batch[item]);
+    }
+}
+
+static void* pool_worker(void* arg) {
+    ModuleBuild* build = (ModuleBuild*)arg;
+    uint64_t seen = 0;
+    pthread_mutex_lock(&build->lock);
+    for (;;) {
+        while (!build->stop && build->generation == seen) pthread_cond_wait(&build->wake, &build->lock);
+        if (build->stop) break;
+        seen = build->generation;
+        pthread_mutex_unlock(&build->lock);
+        drain(build);
+        pthread_mutex_lock(&build->lock);
+        if (--build->busy == 0) pthread_cond_signal(&build->idle);
+    }
+    pthread_mutex_unlock(&build->lock);
+    return NULL;
+}
+
+static void run_batch(ModuleBuild* build, const uint32_t* batch, size_t count, ModuleTask task) {
+    pthread_mutex_lock(&build->lock);
+    build->batch = batch;
+    build->batch_count = count;
+    build->task = task;
+    atomic_store(&build->next, 0);
+    build->busy = build->thread_count;
+    build->generation++;
+    pthread_cond_broadcast(&build->wake);
+    pthread_mutex_unlock(&build->lock);
+
+    drain(build);
+
+    pthread_mutex_lock(&build->lock);
+    while (build->busy > 0) pthread_cond_wait(&build->idle, &build->lock);
+    pthread_mutex_unlock(&build->lock);
+}
+
+static bool pool_start(ModuleBuild* build, ModuleGraph* graph, int thread_count) {
+    memset(build, 0, sizeof(*build));
+    build->graph = graph;
+    atomic_init(&build->next, 0);
+    atomic_init(&build->parsed, 0);
+    atomic_init(&build->analyzed, 0);
+    atomic_init(&build->failed, false);
+    if (pthread_mutex_init(&build->lock, NULL) != 0) return false;
+    pthread_cond_init(&build->wake, NULL);
+    pthread_cond_init(&build->idle, NULL);
+
+    /* Too few threads is slower, not wrong, so failures to start one are not errors */
+    int extra = thread_count > 1 ? thread_count - 1 : 0;
+    build->threads = extra ? (pthread_t*)malloc((size_t)extra * sizeof(pthread_t)) : NULL;
+    for (int i = 0; build->threads && i < extra; i++) {
+        if (pthread_create(&build->threads[i], NULL, pool_worker, build) != 0) break;
+        build->thread_count++;
+    }
+    return true;
+}
+
+static void pool_stop(ModuleBuild* build) {
+    pthread_mutex_lock(&build->lock);
+    build->stop = true;
+    pthread_cond_broadcast(&build->wake);
+    pthread_mutex_unlock(&build->lock);
+    for (int i = 0; i < build->thread_count; i++) pthread_join(build->threads[i], NULL);
+    free(build->threads);
+    pthread_cond_destroy(&build->idle);
+    pthread_cond_destroy(&build->wake);
+    pthread_mutex_destroy(&build->lock);
+}
+
+/* ===== Tasks ===== */
+
+/* Lex and parse the source into module->program, its errors into module->diags */
+static void parse_module(ModuleBuild* build, Module* module) {
+    diag_buffer_truncate(&module->diags, 0);
+    Lexer lexer;
+    Parser parser;
+    lexer_init(&lexer, module->source);
+    parser_init(&parser, &lexer);
+    parser_set_diagnostics(&parser, &module->diags);
+    module->program = parser_parse(&parser);
+    parser_free(&parser);
+    module->state = module->program ? MODULE_PENDING : MODULE_PARSE_FAILED;
+    
+    /* The imports of the source it replaced no longer hold */
+    if (!module->program) module->import_count = 0;
+    atomic_fetch_add(&build->parsed, 1);
+}
+
+/* Reads a module, and parses it unless its source is the one already
+ * compiled: its imports are then still known */
+static void load_module(ModuleBuild* build, uint32_t index) {
+    Module* module = &build->graph->modules[index];
+    size_t length = 0;
+    char* source = build->graph->read(build->graph->context, module->name, &length);
+    if (!source) {
+        free(module->source);
+        module->source = NULL;
+        module->import_count = 0;
+        module->fresh = false;
+        module->state = MODULE_MISSING;
+        diag_buffer_truncate(&module->diags, 0);
+        return;
+    }
+
+    uint64_t hash = hash_bytes(0xcbf29ce484222325ULL, source, length);
+    if (module->source && module->length == length && module->source_hash == hash &&
+        memcmp(module->source, source, length) == 0) {
+        free(source);
+        module->fresh = module->state == MODULE_COMPILED || module->state == MODULE_REUSED;
+        return;
+    }
+
+    free(module->source);
+    module->source = source;
+    module->length = length;
+    module->source_hash = hash;
+    module->fresh = false;
+    parse_module(build, module);
+}
+
+/* Hash of the interfaces a module was checked against */
+static uint64_t import_key(const ModuleGraph* graph, const Module* module) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < module->import_count; i++) {
+        const Module* import = &graph->modules[module->imports[i].module];
+        bool usable = import->state == MODULE_COMPILED || import->state == MODULE_REUSED;
+        uint64_t part = usable ? import->interface.hash : NO_INTERFACE + import->state;
+        h = hash_bytes(h, &part, sizeof(part));
+    }
+    return h;
+}
+
+/* The module a name bound by an import statement refers to */
+static const Module* imported_module(const ModuleGraph* graph, const Module* module, const Resolution* res,
+                                     uint32_t id) {
+    const NameRef* ref = &res->names[id];
+    if (res->index.nodes[id]->type != AST_IDENTIFIER_EXPR || ref->symbol == SYMBOL_NONE) return NULL;
+    const Symbol* symbol = symbol_table_get(res->symbols, ref->symbol);
+    if (symbol->kind != SYMBOL_IMPORT || !symbol->decl) return NULL;
+
+    const char* name = symbol->decl->as.import.module_name;
+    for (size_t i = 0; i < module->import_count; i++) {
+        const Module* import = &graph->modules[module->imports[i].module];
+        if (strcmp(import->name, name) == 0) {
+            return import->state == MODULE_COMPILED || import->state == MODULE_REUSED ? import : NULL;
+        }
+    }
+    return NULL;
+}
+
+/* Checks every 'm.name' against the interface of m, and the argument
+ * count of each call of one */
+static void check_imports(const ModuleGraph* graph, Module* module, const Resolution* res) {
+    for (size_t i = 0; i < module->import_count; i++) {
+        if (graph->modules[module->imports[i].module].state == MODULE_MISSING) {
+            report_import(module, &module->imports[i], DIAG_UNDEFINED_NAME, "No module with this name");
+        }
+    }
+
+    const AstIndex* index = &res->index;
+    for (uint32_t id = 0; id < index->count; id++) {
+        AstNode* node = index->nodes[id];
+        if (node->type != AST_MEMBER_EXPR) continue;
+        const Module* import = imported_module(graph, module, res, id + 1);
+        if (!import) continue;
+
+        const ModuleExport* export = module_interface_find(&import->interface, node->as.member.member);
+        if (!export) {
+            report(&module->diags, DIAG_UNDEFINED_NAME, node->line, node->column, node->offset, node->length,
+                   "Module exports no such name");
+            continue;
+        }
+
+        uint32_t parent = index->parent[id];
+        if (parent == AST_INDEX_NONE || parent + 1 != id || index->nodes[parent]->type != AST_CALL_EXPR ||
+            export->param_count == MODULE_ANY_ARITY) {
+            continue;
+        }
+        uint32_t arg_count = 0;
+        for (uint32_t arg = id + index->size[id]; arg < parent + index->size[parent]; arg += index->size[arg]) {
+            arg_count++;
+        }
+        if (arg_count != export->param_count) {
+            AstNode* call = index->nodes[parent];
+            report(&module->diags, DIAG_ARGUMENT_COUNT, call->line, call->column, call->offset, 0,
+                   "Call passes a different number of arguments than the export takes");
+        }
+    }
+}
+
+/* Resolves and type-checks a module whose imports are all done, unless
+ * neither its source nor their interfaces changed since it last was */
+static void analyze_module(ModuleBuild* build, uint32_t index) {
+    ModuleGraph* graph = build->graph;
+    Module* module = &graph->modules[index];
+    if (module->state == MODULE_MISSING || module->state == MODULE_PARSE_FAILED) return;
+
+    uint64_t key = import_key(graph, module);
+    if (module->fresh && module->import_key == key) {
+        module->state = MODULE_REUSED;
+        return;
+    }
+    if (!module->program) {
+        parse_module(build, module);
+        if (!module->program) return;
+    }
+
+    Resolution res;
+    TypeInference types;
+    bool ok = resolve_program(&res, module->program, &module->diags);
+    if (ok) {
+        ok = infer_program(&types, &res, &module->diags);
+        if (ok) {
+            check_imports(graph, module, &res);
+            ok = extract_interface(&module->interface, &res, &types);
+            type_inference_free(&types);
+        }
+        resolution_free(&res);
+    }
+    ast_free_node(module->program);
+    module->program = NULL;
+    if (!ok) {
+        atomic_store(&build->failed, true);
+        return;
+    }
+
+    module->import_key = key;
+    module->fresh = true;
+    module->state = MODULE_COMPILED;
+    atomic_fetch_add(&build->analyzed, 1);
+}
+
+/* ===== Build ===== */
+
+/* Records the imports of a freshly parsed module, adding the modules they name */
+static bool collect_imports(ModuleGraph* graph, uint32_t index) {
+    AstList* decls = graph->modules[index].program->as.program.declarations;
+    ModuleImport* imports = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    for (size_t i = 0; decls && i < decls->count; i++) {
+        const AstNode* decl = decls->items[i];
+        if (decl->type != AST_IMPORT_STMT) continue;
+        uint32_t target = intern_module(graph, decl->as.import.module_name);
+        if (target == UINT32_MAX || !reserve((void**)&imports, &capacity, count, sizeof(ModuleImport))) {
+            free(imports);
+            return false;
+        }
+        bool repeated = false;
+        for (size_t j = 0; j < count && !repeated; j++) repeated = imports[j].module == target;
+        if (repeated) continue;
+        imports[count++] = (ModuleImport){ target, decl->line, decl->column, decl->offset, decl->length };
+    }
+
+    Module* module = &graph->modules[index];
+    free(module->imports);
+    module->imports = imports;
+    module->import_count = count;
+    return true;
+}
+
+/* Breadth-first from root: each frontier is loaded in one batch, then its
+ * imports not yet reached form the next */
+static bool discover(ModuleBuild* build, uint32_t root, uint32_t** reached, size_t* reached_count) {
+    ModuleGraph* graph = build->graph;
+    size_t capacity = 0;
+    uint32_t* list = NULL;
+    size_t count = 0;
+    if (!reserve((void**)&list, &capacity, 0, sizeof(uint32_t))) return false;
+    list[count++] = root;
+    graph->modules[root].reached = true;
+
+    size_t frontier = 0;
+    while (frontier < count) {
+        size_t end = count;
+        run_batch(build, list + frontier, end - frontier, load_module);
+        for (size_t i = frontier; i < end; i++) {
+            uint32_t index = list[i];
+            if (graph->modules[index].program && !collect_imports(graph, index)) {
+                free(list);
+                return false;
+            }
+            for (size_t j = 0; j < graph->modules[index].import_count; j++) {
+                uint32_t target = graph->modules[index].imports[j].module;
+                if (graph->modules[target].reached) continue;
+                if (!reserve((void**)&list, &capacity, count, sizeof(uint32_t))) {
+                    free(list);
+                    return false;
+                }
+                graph->modules[target].reached = true;
+                list[count++] = target;
+            }
+        }
+        frontier = end;
+    }
+
+    *reached = list;
+    *reached_count = count;
+    return true;
+}
+
+/* Tarjan's strongly connected components over the modules left out of the
+ * waves, which are on a cycle or import one. Each component of more than
+ * one module, or of one importing itself, is a cycle. */
+typedef struct {
+    ModuleGraph* graph;
+    const uint32_t* pending;    /* Imports not done, by module: nonzero for those left out */
+    uint32_t* visit;            /* Visit number by module, 0 unvisited */
+    uint32_t* low;
+    uint32_t* stack;
+    bool* on_stack;
+    size_t depth;
+    uint32_t visits;
+    size_t cycles;
+} CycleSearch;
+
+/* The component is stack[first..depth): each of its imports of a module in
+ * it closes the cycle */
+static void mark_cycle(CycleSearch* search, size_t first) {
+    ModuleGraph* graph = search->graph;
+    for (size_t i = first; i < search->depth; i++) {
+        graph->modules[search->stack[i]].state = MODULE_IN_CYCLE;
+    }
+    for (size_t i = first; i < search->depth; i++) {
+        Module* module = &graph->modules[search->stack[i]];
+        for (size_t j = 0; j < module->import_count; j++) {
+            uint32_t target = module->imports[j].module;
+            if (graph->modules[target].state == MODULE_IN_CYCLE && search->on_stack[target]) {
+                report_import(module, &module->imports[j], DIAG_IMPORT_CYCLE,
+                              "Import cycle: the imported module imports this one back");
+            }
+        }
+    }
+    search->cycles++;
+}
+
+static void strong_connect(CycleSearch* search, uint32_t index) {
+    search->visit[index] = search->low[index] = ++search->visits;
+    search->stack[search->depth++] = index;
+    search->on_stack[index] = true;
+
+    bool self_import = false;
+    const Module* module = &search->graph->modules[index];
+    for (size_t j = 0; j < module->import_count; j++) {
+        uint32_t target = module->imports[j].module;
+        if (!search->pending[target]) continue;
+        self_import |= target == index;
+        if (!search->visit[target]) {
+            strong_connect(search, target);
+            if (search->low[target] < search->low[index]) search->low[index] = search->low[target];
+        } else if (search->on_stack[target] && search->visit[target] < search->low[index]) {
+            search->low[index] = search->visit[target];
+        }
+    }
+    if (search->low[index] != search->visit[index]) return;
+
+    size_t first = search->depth - 1;
+    while (search->stack[first] != index) first--;
+    if (search->depth - first > 1 || self_import) mark_cycle(search, first);
+    for (size_t i = first; i < search->depth; i++) search->on_stack[search->stack[i]] = false;
+    search->depth = first;
+}
+
+/* Modules left out of the waves are not analyzed in this build, whatever
+ * they had before: blocked, or in a cycle */
+static bool find_cycles(ModuleGraph* graph, const uint32_t* reached, size_t count, const uint32_t* pending,
+                        size_t* cycles) {
+    CycleSearch search = { graph, pending, NULL, NULL, NULL, NULL, 0, 0, 0 };
+    search.visit = (uint32_t*)calloc(graph->count, sizeof(uint32_t));
+    search.low = (uint32_t*)calloc(graph->count, sizeof(uint32_t));
+    search.stack = (uint32_t*)malloc(graph->count * sizeof(uint32_t));
+    search.on_stack = (bool*)calloc(graph->count, sizeof(bool));
+    bool ok = search.visit && search.low && search.stack && search.on_stack;
+
+    for (size_t i = 0; ok && i < count; i++) {
+        Module* module = &graph->modules[reached[i]];
+        if (!pending[reached[i]]) continue;
+        if (module->program) {
+            ast_free_node(module->program);
+            module->program = NULL;
+        } else {
+            diag_buffer_truncate(&module->diags, 0);
+        }
+        module->state = MODULE_BLOCKED;
+        module->fresh = false;
+        module->wave = 0;
+    }
+    for (size_t i = 0; ok && i < count; i++) {
+        if (pending[reached[i]] && !search.visit[reached[i]]) strong_connect(&search, reached[i]);
+    }
+
+    *cycles = search.cycles;
+    free(search.visit);
+    free(search.low);
+    free(search.stack);
+    free(search.on_stack);
+    return ok;
+}
+
+/* Splits the reached modules into waves by Kahn's algorithm: a module is
+ * dequeued after all of its imports, so its wave, one past the latest of
+ * theirs, is known by then. graph->order lists the waves one after another. */
+static bool plan_waves(ModuleGraph* graph, const uint32_t* reached, size_t count, size_t* cycles) {
+    size_t edges = 0;
+    for (size_t i = 0; i < count; i++) edges += graph->modules[reached[i]].import_count;
+    uint32_t* pending = (uint32_t*)calloc(graph->count, sizeof(uint32_t));
+    uint32_t* first_importer = (uint32_t*)calloc(graph->count + 1, sizeof(uint32_t));
+    uint32_t* cursor = (uint32_t*)malloc(graph->count * sizeof(uint32_t));
+    uint32_t* importers = (uint32_t*)malloc((edges + 1) * sizeof(uint32_t));
+    uint32_t* queue = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    uint32_t* order = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    size_t* wave_start = (size_t*)calloc(count + 1, sizeof(size_t));
+    bool ok = pending && first_importer && cursor && importers && queue && order && wave_start;
+
+    size_t queued = 0;
+    size_t waves = 0;
+    if (ok) {
+        /* Importers of each module, grouped by module */
+        for (size_t i = 0; i < count; i++) {
+            Module* module = &graph->modules[reached[i]];
+            module->wave = 0;
+            pending[reached[i]] = (uint32_t)module->import_count;
+            for (size_t j = 0; j < module->import_count; j++) first_importer[module->imports[j].module + 1]++;
+        }
+        for (size_t i = 0; i < graph->count; i++) {
+            first_importer[i + 1] += first_importer[i];
+            cursor[i] = first_importer[i];
+        }
+        for (size_t i = 0; i < count; i++) {
+            const Module* module = &graph->modules[reached[i]];
+            for (size_t j = 0; j < module->import_count; j++) {
+                importers[cursor[module->imports[j].module]++] = reached[i];
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (!pending[reached[i]]) queue[queued++] = reached[i];
+        }
+        for (size_t head = 0; head < queued; head++) {
+            uint32_t done = queue[head];
+            uint32_t wave = graph->modules[done].wave;
+            wave_start[wave]++;
+            if (wave + 1 > waves) waves = wave + 1;
+            for (uint32_t e = first_importer[done]; e < first_importer[done + 1]; e++) {
+                Module* importer = &graph->modules[importers[e]];
+                if (importer->wave < wave + 1) importer->wave = wave + 1;
+                if (--pending[importers[e]] == 0) queue[queued++] = importers[e];
+            }
+        }
+
+        /* Counting sort by wave, keeping the queue order within one */
+        size_t sum = 0;
+        for (size_t wave = 0; wave < waves; wave++) {
+            size_t size = wave_start[wave];
+            wave_start[wave] = sum;
+            sum += size;
+        }
+        for (size_t i = 0; i < queued; i++) order[wave_start[graph->modules[queue[i]].wave]++] = queue[i];
+
+        *cycles = 0;
+        ok = queued == count || find_cycles(graph, reached, count, pending, cycles);
+    }
+
+    if (ok) {
+        free(graph->order);
+        graph->order = order;
+        graph->order_count = queued;
+        graph->wave_count = waves;
+    } else {
+        free(order);
+    }
+    free(pending);
+    free(first_importer);
+    free(cursor);
+    free(importers);
+    free(queue);
+    free(wave_start);
+    return ok;
+}
+
+bool module_graph_build(ModuleGraph* graph, const char* root, int thread_count, ModuleBuildStats* stats) {
+    for (size_t i = 0; i < graph->count; i++) graph->modules[i].reached = false;
+    uint32_t root_index = intern_module(graph, root);
+    if (root_index == UINT32_MAX) return false;
+
+    ModuleBuild build;
+    if (!pool_start(&build, graph, thread_count)) return false;
+
+    uint32_t* reached = NULL;
+    size_t reached_count = 0;
+    size_t cycles = 0;
+    size_t widest = 0;
+    bool ok = discover(&build, root_index, &reached, &reached_count) &&
+              plan_waves(graph, reached, reached_count, &cycles);
+
+    /* A wave starts once every module of the one before it is done */
+    for (size_t start = 0; ok && start < graph->order_count;) {
+        size_t end = start;
+        uint32_t wave = graph->modules[graph->order[start]].wave;
+        while (end < graph->order_count && graph->modules[graph->order[end]].wave == wave) end++;
+        if (end - start > widest) widest = end - start;
+        run_batch(&build, graph->order + start, end - start, analyze_module);
+        ok = !atomic_load(&build.failed);
+        start = end;
+    }
+
+    if (stats) {
+        size_t reused = 0;
+        for (size_t i = 0; i < reached_count; i++) reused += graph->modules[reached[i]].state == MODULE_REUSED;
+        stats->modules = reached_count;
+        stats->waves = graph->wave_count;
+        stats->widest_wave = widest;
+        stats->parsed = atomic_load(&build.parsed);
+        stats->analyzed = atomic_load(&build.analyzed);
+        stats->reused = reused;
+        stats->cycles = cycles;
+        stats->threads = build.thread_count + 1;
+    }
+    pool_stop(&build);
+    free(reached);
+    return ok;
+}
+
+/* ===== Reporting ===== */
+
+size_t module_graph_error_count(const ModuleGraph* graph) {
+    size_t errors = 0;
+    for (size_t i = 0; i < graph->count; i++) {
+        if (graph->modules[i].reached) errors += graph->modules[i].diags.error_count;
+    }
+    return errors;
+}
+
+void module_graph_render(const ModuleGraph* graph, FILE* out) {
+    for (size_t i = 0; i < graph->count; i++) {
+        const Module* module = &graph->modules[i];
+        if (module->reached && module->source && module->diags.count) {
+            diag_render_text(&module->diags, module->source, module->name, out);
+        }
+    }
+}
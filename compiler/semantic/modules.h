@@ -0,0 +1,138 @@
+/* LAMC Compiler - Modules
+ * Import graph of a project, compiled in dependency order on several threads
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef MODULES_H
+#define MODULES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "../parser/diagnostics.h"
+#include "../parser/ast.h"
+#include "symbol_table.h"
+
+/* Returns the source of the module called name in memory from malloc,
+ * its length in *length, or NULL when there is no such module. Called
+ * from worker threads, so it must be safe to run concurrently. */
+typedef char* (*ModuleReader)(void* context, const char* name, size_t* length);
+
+/* Reader of "<directory>/<name>.lamc", with directory as the context */
+char* module_read_file(void* directory, const char* name, size_t* length);
+
+/* Arity of an export that takes any number of arguments, or none */
+#define MODULE_ANY_ARITY UINT32_MAX
+
+/* One top-level name of a module, as dependents see it */
+typedef struct {
+    char* name;
+    SymbolKind kind;        /* SYMBOL_FUNCTION, SYMBOL_CLASS or SYMBOL_VARIABLE */
+    uint32_t param_count;   /* A function's, or a class's init; MODULE_ANY_ARITY otherwise */
+    char* signature;        /* Its type as type_format() spells it */
+} ModuleExport;
+
+/* Everything a dependent may use, kept after the module's tree is freed */
+typedef struct {
+    ModuleExport* exports;  /* Sorted by name */
+    size_t count;
+    uint64_t hash;          /* Of every export; an edit that keeps it keeps the dependents */
+} ModuleInterface;
+
+typedef enum {
+    MODULE_PENDING,
+    MODULE_COMPILED,        /* Analyzed in this build */
+    MODULE_REUSED,          /* Source and imported interfaces unchanged: nothing reparsed */
+    MODULE_MISSING,         /* The reader had no source for it */
+    MODULE_PARSE_FAILED,
+    MODULE_IN_CYCLE,        /* Imports itself through its imports */
+    MODULE_BLOCKED          /* Imports a module in a cycle, directly or not */
+} ModuleState;
+
+/* An import statement, with its position for diagnostics */
+typedef struct {
+    uint32_t module;        /* Index in ModuleGraph.modules */
+    int line;
+    int column;
+    uint32_t offset;
+    uint32_t length;
+} ModuleImport;
+
+typedef struct {
+    char* name;
+    char* source;           /* As last read; diagnostics point into it */
+    size_t length;
+    uint64_t source_hash;
+    ModuleImport* imports;  /* In statement order, each module once */
+    size_t import_count;
+    ModuleState state;
+    uint32_t wave;          /* 1 + the latest wave of its imports, 0 without any */
+    ModuleInterface interface;
+    DiagBuffer diags;
+    uint64_t import_key;    /* Interfaces of its imports when last analyzed (internal) */
+    AstNode* program;       /* Parsed and not yet analyzed (internal) */
+    bool reached;           /* Imported from the root in the last build (internal) */
+    bool fresh;             /* Interface and diags match the source (internal) */
+} Module;
+
+/* Every module ever reached, kept between builds as the cache of their
+ * interfaces */
+typedef struct {
+    ModuleReader read;
+    void* context;
+    Module* modules;
+    size_t count;
+    size_t capacity;
+    uint32_t* slots;        /* Modules by name, index + 1 (internal) */
+    size_t slot_mask;
+    uint32_t* order;        /* Reached modules by wave, then by discovery */
+    size_t order_count;
+    size_t wave_count;
+} ModuleGraph;
+
+/* What one build did */
+typedef struct {
+    size_t modules;         /* Reached from the root */
+    size_t waves;
+    size_t widest_wave;     /* Most modules compiled side by side */
+    size_t parsed;          /* Lexed and parsed */
+    size_t analyzed;        /* Resolved and type-checked */
+    size_t reused;
+    size_t cycles;          /* Import cycles found */
+    int threads;
+} ModuleBuildStats;
+
+void module_graph_init(ModuleGraph* graph, ModuleReader read, void* context);
+void module_graph_free(ModuleGraph* graph);
+
+/* Compiles root and every module it imports, transitively. Modules are
+ * discovered breadth first, each frontier read, lexed and parsed on a pool
+ * of threads; the import graph is then split into waves, a module's wave
+ * coming after those of its imports, and the modules of a wave are
+ * resolved and type-checked side by side. A module is checked against the
+ * interfaces of its imports only: 'm.name' must be an export of m, and a
+ * call of it must pass as many arguments as it takes. Types do not flow
+ * across modules; imported values are dynamic.
+ *
+ * Called again on the same graph, a module whose source and imported
+ * interfaces are unchanged keeps its interface and diagnostics without
+ * being parsed, and an edit that leaves a module's interface as it was
+ * recompiles none of its dependents.
+ *
+ * Import cycles are reported to each module on them, which are not
+ * analyzed, nor are the modules importing them. stats may be NULL.
+ * Returns false when out of memory. */
+bool module_graph_build(ModuleGraph* graph, const char* root, int thread_count, ModuleBuildStats* stats);
+
+/* The module called name, NULL if none has been reached */
+const Module* module_graph_find(const ModuleGraph* graph, const char* name);
+
+/* The export called name, NULL if there is none */
+const ModuleExport* module_interface_find(const ModuleInterface* interface, const char* name);
+
+/* Diagnostics of the modules reached by the last build */
+size_t module_graph_error_count(const ModuleGraph* graph);
+void module_graph_render(const ModuleGraph* graph, FILE* out);
+
+#endif /* MODULES_H */
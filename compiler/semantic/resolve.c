@@ -0,0 +1,918 @@
+/* LAMC Compiler - Name Resolution Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "resolve.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "global_scope.h"
+
+const char* const RESOLVE_BUILTINS[] = {
+    "print", "input", "len", "range", "sum", "abs", "min", "max",
+    "round", "sqrt", "pow", "int", "float", "string"
+};
+const size_t RESOLVE_BUILTIN_COUNT = sizeof(RESOLVE_BUILTINS) / sizeof(RESOLVE_BUILTINS[0]);
+
+/* In a worker, locals live in the worker's own table under ids with this
+ * bit set; they are renumbered when the bodies are merged */
+#define LOCAL_BIT 0x80000000u
+
+typedef struct ResolveWorker ResolveWorker;
+typedef struct StealPool StealPool;
+
+typedef struct {
+    Resolution* result;
+    DiagBuffer* diags;
+    SymbolTable* symbols;       /* Where declarations go: the result's, or a worker's */
+    ResolveWorker* worker;      /* Set while resolving bodies in parallel */
+    size_t unresolved;
+    uint32_t frame;             /* Frame new locals go to */
+    uint32_t next_slot;         /* Its first free slot */
+    uint32_t* saved_slots;      /* next_slot at the start of each open scope */
+    size_t saved_count;
+    size_t saved_capacity;
+    size_t variable_capacity;
+    size_t frame_capacity;
+    bool failed;                /* Out of memory */
+} Resolver;
+
+/* What a worker knows of one of its private name ids */
+typedef struct {
+    uint32_t task;          /* The task that last met it, + 1 */
+    uint32_t global;        /* Global symbol + 1, 0 if not looked up yet,
+                             * SYMBOL_NONE if there is none */
+    uint32_t shared;        /* Id in the result's interner, set by the merge */
+} WorkerName;
+
+/* A thread resolving bodies against the frozen global scope. What it
+ * writes is its own, apart from the names and frames of its bodies. */
+struct ResolveWorker {
+    Resolver r;
+    const GlobalScope* globals;
+    StringInterner* interner;   /* Spellings met in its bodies, private ids */
+    WorkerName* names;          /* By private id */
+    size_t name_capacity;
+    uint32_t* first_names;      /* Private ids in the order each task met them first */
+    size_t first_count;
+    size_t first_capacity;
+    VariableInfo* variables;    /* By id in the worker's table */
+    uint32_t* global_flags;     /* VAR_* bits set on globals, by SymbolId */
+    uint32_t task;              /* Task being resolved, + 1 */
+    uint32_t frame_cursor;      /* Next frame of that task */
+    DiagBuffer diags;
+    size_t steals;
+    _Atomic uint64_t range;     /* Tasks it owns: next << 32 | end */
+    StealPool* pool;
+    uint32_t id;
+    pthread_t thread;
+};
+
+/* Make room for items[index] */
+static bool reserve(void** items, size_t* capacity, size_t index, size_t item_size) {
+    if (index < *capacity) return true;
+    size_t grown_capacity = *capacity ? *capacity : 64;
+    while (grown_capacity <= index) grown_capacity *= 2;
+    void* grown = realloc(*items, grown_capacity * item_size);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+static AstNode* node_at(const Resolver* r, uint32_t id) {
+    return r->result->index.nodes[id];
+}
+
+/* Id of a direct child of parent, AST_INDEX_NONE for an empty slot */
+static uint32_t child_id(const Resolver* r, uint32_t parent, const AstNode* child) {
+    const AstIndex* index = &r->result->index;
+    if (!child) return AST_INDEX_NONE;
+    for (uint32_t id = parent + 1; id < parent + index->size[parent]; id += index->size[id]) {
+        if (index->nodes[id] == child) return id;
+    }
+    return AST_INDEX_NONE;
+}
+
+static void report(Resolver* r, DiagCode code, const AstNode* node, bool quote, const char* message) {
+    Diagnostic diag;
+    diag.severity = DIAG_ERROR;
+    diag.code = code;
+    diag.message = message;
+    diag.found = quote ? TOKEN_IDENTIFIER : TOKEN_ERROR;
+    diag.offset = node->offset;
+    diag.length = quote ? node->length : 0;
+    diag.line = node->line;
+    diag.column = node->column;
+    diag_report(r->diags, &diag);
+}
+
+/* ===== Symbols ===== */
+
+/* A worker interns into its own table, noting the spellings each task
+ * met first so the merge can intern them in the sequential order */
+static uint32_t intern_name(Resolver* r, const char* name) {
+    ResolveWorker* w = r->worker;
+    uint32_t id = string_intern(w ? w->interner : r->result->interner, name, strlen(name));
+    if (id == 0) {
+        r->failed = true;
+        return 0;
+    }
+    if (!w) return id;
+
+    size_t known = w->name_capacity;
+    if (!reserve((void**)&w->names, &w->name_capacity, id, sizeof(WorkerName))) {
+        r->failed = true;
+        return 0;
+    }
+    if (w->name_capacity > known) memset(&w->names[known], 0, (w->name_capacity - known) * sizeof(WorkerName));
+    if (w->names[id].task != w->task) {
+        if (!reserve((void**)&w->first_names, &w->first_capacity, w->first_count, sizeof(uint32_t))) {
+            r->failed = true;
+            return 0;
+        }
+        w->names[id].task = w->task;
+        w->first_names[w->first_count++] = id;
+    }
+    return id;
+}
+
+/* Global binding of a private name, looked up once per worker */
+static SymbolId worker_global(Resolver* r, uint32_t name) {
+    WorkerName* known = &r->worker->names[name];
+    if (known->global == 0) {
+        size_t length = 0;
+        const char* spelling = string_interner_lookup(r->worker->interner, name, &length);
+        SymbolId symbol = global_scope_lookup(r->worker->globals, spelling, length);
+        known->global = symbol == SYMBOL_NONE ? SYMBOL_NONE : symbol + 1;
+    }
+    return known->global == SYMBOL_NONE ? SYMBOL_NONE : known->global - 1;
+}
+
+static VariableInfo* worker_variable(Resolver* r, SymbolId local) {
+    ResolveWorker* w = r->worker;
+    if (!reserve((void**)&w->variables, &r->variable_capacity, local, sizeof(VariableInfo))) return NULL;
+    return &w->variables[local];
+}
+
+static bool is_local_id(const Resolver* r, SymbolId symbol) {
+    return r->worker && symbol != SYMBOL_NONE && (symbol & LOCAL_BIT);
+}
+
+static const Symbol* symbol_at(const Resolver* r, SymbolId symbol) {
+    if (is_local_id(r, symbol)) return symbol_table_get(r->symbols, symbol & ~LOCAL_BIT);
+    return symbol_table_get(r->result->symbols, symbol);
+}
+
+static VariableInfo* variable_at(Resolver* r, SymbolId symbol) {
+    if (is_local_id(r, symbol)) return worker_variable(r, symbol & ~LOCAL_BIT);
+    return &r->result->variables[symbol];
+}
+
+/* Innermost visible binding; a worker's globals come from the frozen scope */
+static SymbolId lookup(Resolver* r, uint32_t name) {
+    SymbolId symbol = symbol_table_lookup(r->symbols, name);
+    if (!r->worker) return symbol;
+    return symbol != SYMBOL_NONE ? symbol | LOCAL_BIT : worker_global(r, name);
+}
+
+static SymbolId lookup_local(Resolver* r, uint32_t name) {
+    SymbolId symbol = symbol_table_lookup_local(r->symbols, name);
+    return symbol != SYMBOL_NONE && r->worker ? symbol | LOCAL_BIT : symbol;
+}
+
+/* Binds name in the current scope and gives it storage: a global slot
+ * at depth 0, otherwise the next slot of the current frame */
+static SymbolId declare(Resolver* r, uint32_t name, SymbolKind kind, AstNode* decl) {
+    Resolution* result = r->result;
+    SymbolId symbol = name ? symbol_table_declare(r->symbols, name, kind, decl) : SYMBOL_NONE;
+    if (symbol != SYMBOL_NONE && r->worker) symbol |= LOCAL_BIT;
+    VariableInfo* var = NULL;
+    if (symbol != SYMBOL_NONE && r->worker) {
+        var = variable_at(r, symbol);
+    } else if (symbol != SYMBOL_NONE &&
+               reserve((void**)&result->variables, &r->variable_capacity, symbol, sizeof(VariableInfo))) {
+        var = &result->variables[symbol];
+    }
+    if (!var) {
+        r->failed = true;
+        return SYMBOL_NONE;
+    }
+
+    var->flags = 0;
+    if (kind == SYMBOL_BUILTIN) {
+        var->frame = RESOLVE_NO_FRAME;
+        var->slot = 0;
+    } else if (symbol_table_depth(r->symbols) == 0) {
+        var->frame = RESOLVE_NO_FRAME;
+        var->slot = result->global_count++;
+    } else {
+        var->frame = r->frame;
+        var->slot = r->next_slot++;
+        FrameInfo* frame = &result->frames[r->frame];
+        if (r->next_slot > frame->slot_count) frame->slot_count = r->next_slot;
+    }
+    return symbol;
+}
+
+static void set_name(Resolver* r, uint32_t id, SymbolId symbol) {
+    Resolution* result = r->result;
+    NameRef* ref = &result->names[id];
+    ref->symbol = symbol;
+    if (symbol == SYMBOL_NONE) {
+        ref->kind = NAME_UNRESOLVED;
+        ref->slot = 0;
+        return;
+    }
+
+    const VariableInfo* var = variable_at(r, symbol);
+    ref->slot = var->slot;
+    if (symbol_at(r, symbol)->kind == SYMBOL_BUILTIN) {
+        ref->kind = NAME_BUILTIN;
+    } else {
+        ref->kind = var->frame == RESOLVE_NO_FRAME ? NAME_GLOBAL : NAME_LOCAL;
+    }
+}
+
+static bool is_variable(const Resolver* r, SymbolId symbol) {
+    SymbolKind kind = symbol_at(r, symbol)->kind;
+    return kind == SYMBOL_VARIABLE || kind == SYMBOL_PARAMETER;
+}
+
+/* A worker collects the flags it sets on globals apart, merged later */
+static void add_flags(Resolver* r, SymbolId symbol, uint32_t flags) {
+    if (r->worker && !is_local_id(r, symbol)) {
+        r->worker->global_flags[symbol] |= flags;
+    } else {
+        variable_at(r, symbol)->flags |= flags;
+    }
+}
+
+/* Globals belong to the top-level code of frame 0 */
+static void note_access(Resolver* r, SymbolId symbol) {
+    VariableInfo* var = variable_at(r, symbol);
+    uint32_t owner = var->frame == RESOLVE_NO_FRAME ? 0 : var->frame;
+    if (owner != r->frame) add_flags(r, symbol, VAR_CAPTURED);
+}
+
+/* Whether the identifier with this id hands its value on rather than
+ * just reading it */
+static bool escapes_at(const Resolver* r, uint32_t id) {
+    uint32_t parent = r->result->index.parent[id];
+    if (parent == AST_INDEX_NONE) return false;
+    switch (node_at(r, parent)->type) {
+        case AST_CALL_EXPR:     /* An argument, not the callee */
+        case AST_ASSIGN_STMT:   /* The value, not the target */
+            return id != parent + 1;
+        case AST_ARRAY_EXPR:
+        case AST_DICT_EXPR:
+        case AST_RETURN_STMT:
+        case AST_VAR_DECL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* ===== Scopes ===== */
+
+static void open_scope(Resolver* r) {
+    if (!symbol_table_push_scope(r->symbols) ||
+        !reserve((void**)&r->saved_slots, &r->saved_capacity, r->saved_count, sizeof(uint32_t))) {
+        r->failed = true;
+        return;
+    }
+    r->saved_slots[r->saved_count++] = r->next_slot;
+}
+
+/* The scope's slots become free for its siblings */
+static void close_scope(Resolver* r) {
+    if (r->saved_count == 0) return;
+    symbol_table_pop_scope(r->symbols);
+    r->next_slot = r->saved_slots[--r->saved_count];
+}
+
+/* ===== Expressions ===== */
+
+static void resolve_use(Resolver* r, uint32_t id) {
+    AstNode* node = node_at(r, id);
+    SymbolId symbol = lookup(r, intern_name(r, node->as.identifier));
+    set_name(r, id, symbol);
+
+    if (symbol == SYMBOL_NONE) {
+        if (!r->failed) {
+            report(r, DIAG_UNDEFINED_NAME, node, true, "Undefined name");
+            r->unresolved++;
+        }
+    } else if (is_variable(r, symbol)) {
+        note_access(r, symbol);
+        if (escapes_at(r, id)) add_flags(r, symbol, VAR_ESCAPES);
+    }
+}
+
+/* Expressions declare nothing, so their identifiers are found by a scan
+ * of the subtree's id range rather than a recursive walk */
+static void resolve_expression(Resolver* r, uint32_t id) {
+    if (id == AST_INDEX_NONE) return;
+    const AstIndex* index = &r->result->index;
+    for (uint32_t i = id; i < id + index->size[id] && !r->failed; i++) {
+        if (index->nodes[i]->type == AST_IDENTIFIER_EXPR) resolve_use(r, i);
+    }
+}
+
+/* ===== Statements ===== */
+
+static void resolve_statement(Resolver* r, uint32_t id);
+
+/* The children of a block, in the current scope */
+static void resolve_statements(Resolver* r, uint32_t block) {
+    const AstIndex* index = &r->result->index;
+    for (uint32_t id = block + 1; id < block + index->size[block] && !r->failed; id += index->size[id]) {
+        resolve_statement(r, id);
+    }
+}
+
+/* A branch or loop body in a scope of its own */
+static void resolve_body(Resolver* r, uint32_t id) {
+    if (id == AST_INDEX_NONE) return;
+    open_scope(r);
+    if (node_at(r, id)->type == AST_BLOCK_STMT) {
+        resolve_statements(r, id);
+    } else {
+        resolve_statement(r, id);
+    }
+    close_scope(r);
+}
+
+static void resolve_var_decl(Resolver* r, uint32_t id) {
+    AstNode* node = node_at(r, id);
+    resolve_expression(r, child_id(r, id, node->as.var_decl.initializer));
+
+    uint32_t name = intern_name(r, node->as.var_decl.name);
+    SymbolId symbol = SYMBOL_NONE;
+    if (!node->as.var_decl.type_name) {
+        symbol = lookup(r, name);
+        if (symbol != SYMBOL_NONE && !is_variable(r, symbol)) symbol = SYMBOL_NONE;
+    }
+    if (symbol == SYMBOL_NONE) {
+        symbol = declare(r, name, SYMBOL_VARIABLE, node);
+    } else {
+        note_access(r, symbol);
+    }
+    set_name(r, id, symbol);
+}
+
+static void resolve_for(Resolver* r, uint32_t id) {
+    AstNode* node = node_at(r, id);
+    resolve_expression(r, child_id(r, id, node->as.for_stmt.iterable));
+
+    open_scope(r);
+    SymbolId item = declare(r, intern_name(r, node->as.for_stmt.variable), SYMBOL_VARIABLE, node);
+    if (node->as.for_stmt.index_var) {
+        declare(r, intern_name(r, node->as.for_stmt.index_var), SYMBOL_VARIABLE, node);
+    }
+    set_name(r, id, item);
+
+    uint32_t body = child_id(r, id, node->as.for_stmt.body);
+    if (body != AST_INDEX_NONE && node_at(r, body)->type == AST_BLOCK_STMT) {
+        resolve_statements(r, body);
+    } else if (body != AST_INDEX_NONE) {
+        resolve_statement(r, body);
+    }
+    close_scope(r);
+}
+
+static void resolve_statement(Resolver* r, uint32_t id) {
+    AstNode* node = node_at(r, id);
+    switch (node->type) {
+        case AST_VAR_DECL:
+            resolve_var_decl(r, id);
+            break;
+
+        case AST_IF_STMT:
+            /* Else-if chains are followed by the loop, not by recursion */
+            for (;;) {
+                resolve_expression(r, child_id(r, id, node->as.if_stmt.condition));
+                resolve_body(r, child_id(r, id, node->as.if_stmt.then_branch));
+                AstNode* next = node->as.if_stmt.else_branch;
+                uint32_t next_id = child_id(r, id, next);
+                if (!next || next->type != AST_IF_STMT || r->failed) {
+                    resolve_body(r, next_id);
+                    break;
+                }
+                node = next;
+                id = next_id;
+            }
+            break;
+
+        case AST_WHILE_STMT:
+            resolve_expression(r, child_id(r, id, node->as.while_stmt.condition));
+            resolve_body(r, child_id(r, id, node->as.while_stmt.body));
+            break;
+
+        case AST_FOR_STMT:
+            resolve_for(r, id);
+            break;
+
+        case AST_LOOP_STMT:
+            resolve_body(r, child_id(r, id, node->as.loop_stmt.body));
+            break;
+
+        case AST_BLOCK_STMT:
+            resolve_body(r, id);
+            break;
+
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            break;
+
+        case AST_FUNCTION_DECL:
+        case AST_CLASS_DECL:
+        case AST_IMPORT_STMT:
+        case AST_PROGRAM:
+            /* Only found at the top level, see resolve_program() */
+            break;
+
+        default:
+            /* Expression and assignment statements, returns */
+            resolve_expression(r, id);
+            break;
+    }
+}
+
+/* ===== Declarations ===== */
+
+static void declare_global(Resolver* r, uint32_t id, const char* spelling, SymbolKind kind) {
+    AstNode* node = node_at(r, id);
+    uint32_t name = intern_name(r, spelling);
+    SymbolId existing = lookup_local(r, name);
+
+    if (existing != SYMBOL_NONE) {
+        SymbolKind existing_kind = symbol_at(r, existing)->kind;
+        if (kind == SYMBOL_IMPORT && existing_kind == SYMBOL_IMPORT) {
+            set_name(r, id, existing);
+            return;
+        }
+        if (existing_kind != SYMBOL_BUILTIN) {
+            report(r, DIAG_DUPLICATE_NAME, node, false, "Name already defined");
+        }
+    }
+    set_name(r, id, declare(r, name, kind, node));
+}
+
+/* A worker's frames were numbered before it started */
+static uint32_t next_frame(Resolver* r) {
+    Resolution* result = r->result;
+    if (r->worker) return r->worker->frame_cursor++;
+    if (!reserve((void**)&result->frames, &r->frame_capacity, result->frame_count, sizeof(FrameInfo))) {
+        return RESOLVE_NO_FRAME;
+    }
+    return (uint32_t)result->frame_count++;
+}
+
+static void resolve_function(Resolver* r, uint32_t id, bool method) {
+    Resolution* result = r->result;
+    AstNode* node = node_at(r, id);
+    uint32_t frame = next_frame(r);
+    if (frame == RESOLVE_NO_FRAME) {
+        r->failed = true;
+        return;
+    }
+    result->frames[frame].node = id;
+    result->frames[frame].first_param = (SymbolId)symbol_table_count(r->symbols) | (r->worker ? LOCAL_BIT : 0);
+    result->frames[frame].param_count = 0;
+    result->frames[frame].slot_count = 0;
+    r->frame = frame;
+    r->next_slot = 0;
+
+    open_scope(r);
+    if (method) declare(r, intern_name(r, "this"), SYMBOL_PARAMETER, node);
+
+    AstList* params = node->as.function.parameters;
+    for (size_t i = 0; params && i < params->count && !r->failed; i++) {
+        Parameter* param = (Parameter*)params->items[i];
+        resolve_expression(r, child_id(r, id, param->default_value));
+        uint32_t name = intern_name(r, param->name);
+        if (lookup_local(r, name) != SYMBOL_NONE) {
+            report(r, DIAG_DUPLICATE_NAME, node, false, "Parameter name already used");
+        }
+        declare(r, name, SYMBOL_PARAMETER, node);
+    }
+    result->frames[frame].param_count = r->next_slot;
+
+    /* The body shares the parameters' scope; a pending lazy body is skipped */
+    uint32_t body = child_id(r, id, node->as.function.body);
+    if (body != AST_INDEX_NONE) resolve_statements(r, body);
+    close_scope(r);
+
+    r->frame = 0;
+    r->next_slot = 0;
+}
+
+static void resolve_class(Resolver* r, uint32_t id) {
+    AstNode* node = node_at(r, id);
+    AstList* fields = node->as.class_decl.fields;
+    for (size_t i = 0; fields && i < fields->count; i++) {
+        AstNode* field = (AstNode*)fields->items[i];
+        uint32_t field_id = child_id(r, id, field);
+        if (field_id != AST_INDEX_NONE) {
+            resolve_expression(r, child_id(r, field_id, field->as.var_decl.initializer));
+        }
+    }
+
+    AstList* methods = node->as.class_decl.methods;
+    for (size_t i = 0; methods && i < methods->count && !r->failed; i++) {
+        uint32_t method = child_id(r, id, (AstNode*)methods->items[i]);
+        if (method != AST_INDEX_NONE) resolve_function(r, method, true);
+    }
+}
+
+/* ===== Driver ===== */
+
+static bool resolver_init(Resolver* r, Resolution* result, AstNode* program, DiagBuffer* diags) {
+    memset(result, 0, sizeof(*result));
+    memset(r, 0, sizeof(*r));
+    r->result = result;
+    r->diags = diags;
+
+    result->interner = string_interner_create();
+    result->symbols = symbol_table_create();
+    r->symbols = result->symbols;
+    if (!result->interner || !result->symbols || !ast_index_build(&result->index, program)) return false;
+
+    result->names = (NameRef*)malloc((result->index.count + 1) * sizeof(NameRef));
+    if (!result->names ||
+        !reserve((void**)&result->frames, &r->frame_capacity, 0, sizeof(FrameInfo))) {
+        return false;
+    }
+    for (uint32_t id = 0; id < result->index.count; id++) {
+        result->names[id].kind = NAME_UNRESOLVED;
+        result->names[id].slot = 0;
+        result->names[id].symbol = SYMBOL_NONE;
+    }
+
+    /* Frame 0: top-level code */
+    result->frames[0].node = 0;
+    result->frames[0].first_param = SYMBOL_NONE;
+    result->frames[0].param_count = 0;
+    result->frames[0].slot_count = 0;
+    result->frame_count = 1;
+
+    for (size_t i = 0; i < RESOLVE_BUILTIN_COUNT; i++) {
+        SymbolId symbol = declare(r, intern_name(r, RESOLVE_BUILTINS[i]), SYMBOL_BUILTIN, NULL);
+        if (symbol == SYMBOL_NONE) return false;
+        result->variables[symbol].slot = (uint32_t)i;
+    }
+    return true;
+}
+
+/* Declares the top-level names, then resolves top-level statements */
+static void resolve_globals(Resolver* r) {
+    const AstIndex* index = &r->result->index;
+
+    /* Top-level declarations are visible everywhere */
+    for (uint32_t id = 1; id < index->count && !r->failed; id += index->size[id]) {
+        AstNode* node = index->nodes[id];
+        if (node->type == AST_FUNCTION_DECL) {
+            declare_global(r, id, node->as.function.name, SYMBOL_FUNCTION);
+        } else if (node->type == AST_CLASS_DECL) {
+            declare_global(r, id, node->as.class_decl.name, SYMBOL_CLASS);
+        } else if (node->type == AST_IMPORT_STMT) {
+            declare_global(r, id, node->as.import.module_name, SYMBOL_IMPORT);
+        }
+    }
+
+    /* Top-level statements, in order */
+    for (uint32_t id = 1; id < index->count && !r->failed; id += index->size[id]) {
+        resolve_statement(r, id);
+    }
+}
+
+bool resolve_program(Resolution* result, AstNode* program, DiagBuffer* diags) {
+    Resolver r;
+    bool ok = resolver_init(&r, result, program, diags);
+    const AstIndex* index = &result->index;
+
+    if (ok && index->count > 0 && program->type == AST_PROGRAM) {
+        resolve_globals(&r);
+
+        /* Bodies, with every global declared */
+        for (uint32_t id = 1; id < index->count && !r.failed; id += index->size[id]) {
+            AstNode* node = index->nodes[id];
+            if (node->type == AST_FUNCTION_DECL) {
+                resolve_function(&r, id, false);
+            } else if (node->type == AST_CLASS_DECL) {
+                resolve_class(&r, id);
+            }
+        }
+    } else if (ok && index->count > 0) {
+        resolve_statement(&r, 0);
+    }
+
+    ok = ok && !r.failed;
+    result->unresolved += r.unresolved;
+    free(r.saved_slots);
+    if (!ok) resolution_free(result);
+    return ok;
+}
+
+/* ===== Parallel Bodies ===== */
+
+/* A top-level function or class, resolved by one worker */
+typedef struct {
+    uint32_t node;
+    uint32_t first_frame;
+    uint32_t worker;
+    SymbolId first_local;       /* Its symbols in the worker's table */
+    SymbolId local_count;
+    size_t first_name;          /* Spellings it met first, in the worker's first_names */
+    size_t name_count;
+    size_t first_diag;          /* Its diagnostics in the worker's buffer */
+    size_t diag_count;
+    SymbolId base;              /* Id of its first symbol once merged */
+} BodyTask;
+
+typedef void (*TaskRun)(ResolveWorker* w, BodyTask* task, uint32_t index);
+
+/* Tasks are split evenly between the workers up front; a worker that runs
+ * out takes half of what another has left. A range is one atomic word, so
+ * the owner's take and a thief's split never hand out a task twice. */
+struct StealPool {
+    ResolveWorker* workers;
+    uint32_t count;
+    BodyTask* tasks;
+    uint32_t task_count;
+    TaskRun run;
+};
+
+static uint64_t pack_range(uint32_t next, uint32_t end) {
+    return (uint64_t)next << 32 | end;
+}
+
+/* Next task for w, UINT32_MAX once every range is empty */
+static uint32_t take_task(ResolveWorker* w) {
+    StealPool* pool = w->pool;
+    uint64_t range = atomic_load(&w->range);
+    for (;;) {
+        uint32_t next = (uint32_t)(range >> 32);
+        uint32_t end = (uint32_t)range;
+        if (next >= end) break;
+        if (atomic_compare_exchange_weak(&w->range, &range, pack_range(next + 1, end))) return next;
+    }
+
+    for (uint32_t k = 1; k < pool->count; k++) {
+        ResolveWorker* victim = &pool->workers[(w->id + k) % pool->count];
+        range = atomic_load(&victim->range);
+        for (;;) {
+            uint32_t next = (uint32_t)(range >> 32);
+            uint32_t end = (uint32_t)range;
+            if (next >= end) break;
+            uint32_t split = next + (end - next) / 2;
+            if (atomic_compare_exchange_weak(&victim->range, &range, pack_range(next, split))) {
+                atomic_store(&w->range, pack_range(split + 1, end));
+                w->steals++;
+                return split;
+            }
+        }
+    }
+    return UINT32_MAX;
+}
+
+static void* worker_main(void* arg) {
+    ResolveWorker* w = (ResolveWorker*)arg;
+    StealPool* pool = w->pool;
+    for (uint32_t index = take_task(w); index != UINT32_MAX; index = take_task(w)) {
+        pool->run(w, &pool->tasks[index], index);
+    }
+    return NULL;
+}
+
+/* Runs every task once; the calling thread is worker 0 and finishes
+ * whatever a thread that failed to start leaves behind */
+static void run_pool(StealPool* pool, TaskRun run) {
+    pool->run = run;
+    for (uint32_t i = 0; i < pool->count; i++) {
+        uint32_t start = (uint32_t)((uint64_t)pool->task_count * i / pool->count);
+        uint32_t end = (uint32_t)((uint64_t)pool->task_count * (i + 1) / pool->count);
+        atomic_store(&pool->workers[i].range, pack_range(start, end));
+    }
+
+    bool* started = (bool*)calloc(pool->count, sizeof(bool));
+    for (uint32_t i = 1; started && i < pool->count; i++) {
+        started[i] = pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]) == 0;
+    }
+    worker_main(&pool->workers[0]);
+    for (uint32_t i = 1; started && i < pool->count; i++) {
+        if (started[i]) pthread_join(pool->workers[i].thread, NULL);
+    }
+    free(started);
+}
+
+static void resolve_task(ResolveWorker* w, BodyTask* task, uint32_t index) {
+    Resolver* r = &w->r;
+    task->worker = w->id;
+    task->first_local = (SymbolId)symbol_table_count(r->symbols);
+    task->first_name = w->first_count;
+    task->first_diag = w->diags.count;
+    w->task = index + 1;
+    w->frame_cursor = task->first_frame;
+
+    if (node_at(r, task->node)->type == AST_FUNCTION_DECL) {
+        resolve_function(r, task->node, false);
+    } else {
+        resolve_class(r, task->node);
+    }
+    task->local_count = (SymbolId)symbol_table_count(r->symbols) - task->first_local;
+    task->name_count = w->first_count - task->first_name;
+    task->diag_count = w->diags.count - task->first_diag;
+}
+
+/* Points the local names of a body at the merged symbols */
+static void renumber_task(ResolveWorker* w, BodyTask* task, uint32_t index) {
+    Resolution* result = w->r.result;
+    (void)index;
+    for (uint32_t id = task->node; id < task->node + result->index.size[task->node]; id++) {
+        NameRef* ref = &result->names[id];
+        if (ref->kind == NAME_LOCAL) ref->symbol = task->base + ((ref->symbol & ~LOCAL_BIT) - task->first_local);
+    }
+}
+
+/* Appends each body's diagnostics, spellings and symbols in source order,
+ * which is the order resolve_program() makes them in */
+static bool merge_tasks(Resolver* r, StealPool* pool, const GlobalScope* globals, size_t global_count) {
+    Resolution* result = r->result;
+    for (uint32_t t = 0; t < pool->task_count; t++) {
+        BodyTask* task = &pool->tasks[t];
+        ResolveWorker* w = &pool->workers[task->worker];
+        for (size_t d = task->first_diag; d < task->first_diag + task->diag_count; d++) {
+            diag_report(r->diags, &w->diags.items[d]);
+        }
+        for (size_t n = task->first_name; n < task->first_name + task->name_count; n++) {
+            size_t length = 0;
+            const char* spelling = string_interner_lookup(w->interner, w->first_names[n], &length);
+            w->names[w->first_names[n]].shared = string_intern(result->interner, spelling, length);
+            if (w->names[w->first_names[n]].shared == 0) return false;
+        }
+
+        task->base = (SymbolId)symbol_table_count(result->symbols);
+        for (SymbolId local = task->first_local; local < task->first_local + task->local_count; local++) {
+            Symbol symbol = *symbol_table_get(w->r.symbols, local);
+            size_t length = 0;
+            const char* spelling = string_interner_lookup(w->interner, symbol.name, &length);
+            symbol.shadowed = symbol.shadowed != SYMBOL_NONE ? task->base + (symbol.shadowed - task->first_local)
+                                                             : global_scope_lookup(globals, spelling, length);
+            symbol.name = w->names[symbol.name].shared;
+            SymbolId id = symbol_table_append(result->symbols, &symbol);
+            if (id == SYMBOL_NONE ||
+                !reserve((void**)&result->variables, &r->variable_capacity, id, sizeof(VariableInfo))) {
+                return false;
+            }
+            result->variables[id] = w->variables[local];
+        }
+
+        uint32_t frame_end = t + 1 < pool->task_count ? pool->tasks[t + 1].first_frame : (uint32_t)result->frame_count;
+        for (uint32_t f = task->first_frame; f < frame_end; f++) {
+            FrameInfo* frame = &result->frames[f];
+            frame->first_param = task->base + ((frame->first_param & ~LOCAL_BIT) - task->first_local);
+        }
+    }
+
+    for (uint32_t i = 0; i < pool->count; i++) {
+        for (size_t g = 0; g < global_count; g++) result->variables[g].flags |= pool->workers[i].global_flags[g];
+        result->unresolved += pool->workers[i].r.unresolved;
+    }
+    return true;
+}
+
+static bool worker_init(ResolveWorker* w, Resolution* result, StealPool* pool, uint32_t id,
+                        const GlobalScope* globals, size_t global_count) {
+    memset(w, 0, sizeof(*w));
+    w->r.result = result;
+    w->r.diags = &w->diags;
+    w->r.worker = w;
+    w->r.symbols = symbol_table_create();
+    w->globals = globals;
+    w->interner = string_interner_create();
+    w->global_flags = (uint32_t*)calloc(global_count + 1, sizeof(uint32_t));
+    w->pool = pool;
+    w->id = id;
+    diag_buffer_init(&w->diags);
+    atomic_init(&w->range, 0);
+    return w->r.symbols && w->interner && w->global_flags;
+}
+
+static void worker_free(ResolveWorker* w) {
+    symbol_table_free(w->r.symbols);
+    free(w->r.saved_slots);
+    string_interner_free(w->interner);
+    free(w->names);
+    free(w->first_names);
+    free(w->variables);
+    free(w->global_flags);
+    diag_buffer_free(&w->diags);
+}
+
+/* Frames are numbered in source order before any body is resolved */
+static BodyTask* plan_tasks(Resolver* r, uint32_t* task_count) {
+    Resolution* result = r->result;
+    const AstIndex* index = &result->index;
+    BodyTask* tasks = NULL;
+    size_t capacity = 0;
+    uint32_t count = 0;
+    uint32_t frames = (uint32_t)result->frame_count;
+
+    for (uint32_t id = 1; id < index->count; id += index->size[id]) {
+        AstNode* node = index->nodes[id];
+        if (node->type != AST_FUNCTION_DECL && node->type != AST_CLASS_DECL) continue;
+        if (!reserve((void**)&tasks, &capacity, count, sizeof(BodyTask))) {
+            free(tasks);
+            return NULL;
+        }
+        memset(&tasks[count], 0, sizeof(BodyTask));
+        tasks[count].node = id;
+        tasks[count].first_frame = frames;
+        count++;
+
+        if (node->type == AST_FUNCTION_DECL) {
+            frames++;
+            continue;
+        }
+        AstList* methods = node->as.class_decl.methods;
+        for (size_t i = 0; methods && i < methods->count; i++) {
+            if (child_id(r, id, (AstNode*)methods->items[i]) != AST_INDEX_NONE) frames++;
+        }
+    }
+
+    if (frames > 0 && !reserve((void**)&result->frames, &r->frame_capacity, frames - 1, sizeof(FrameInfo))) {
+        free(tasks);
+        return NULL;
+    }
+    result->frame_count = frames;
+    *task_count = count;
+    return tasks ? tasks : (BodyTask*)calloc(1, sizeof(BodyTask));
+}
+
+bool resolve_program_parallel(Resolution* result, AstNode* program, DiagBuffer* diags, int thread_count,
+                              ParallelResolveStats* stats) {
+    if (thread_count < 1) thread_count = 1;
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!program || program->type != AST_PROGRAM) return resolve_program(result, program, diags);
+
+    Resolver r;
+    bool ok = resolver_init(&r, result, program, diags);
+    if (ok) resolve_globals(&r);
+    ok = ok && !r.failed;
+
+    /* The global scope is complete: freeze it for lock-free lookups */
+    size_t global_count = ok ? symbol_table_count(result->symbols) : 0;
+    GlobalScope* globals = ok ? global_scope_freeze(result->symbols, result->interner) : NULL;
+    StealPool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.tasks = globals ? plan_tasks(&r, &pool.task_count) : NULL;
+    ok = pool.tasks != NULL;
+
+    pool.count = (uint32_t)thread_count;
+    if (pool.count > pool.task_count) pool.count = pool.task_count > 0 ? pool.task_count : 1;
+    pool.workers = ok ? (ResolveWorker*)calloc(pool.count, sizeof(ResolveWorker)) : NULL;
+    uint32_t ready = pool.workers ? pool.count : 0;
+    ok = ok && pool.workers;
+    for (uint32_t i = 0; i < ready; i++) {
+        ok = worker_init(&pool.workers[i], result, &pool, i, globals, global_count) && ok;
+    }
+
+    if (ok) {
+        run_pool(&pool, resolve_task);
+        for (uint32_t i = 0; i < pool.count; i++) ok = ok && !pool.workers[i].r.failed;
+    }
+    ok = ok && merge_tasks(&r, &pool, globals, global_count);
+    if (ok) run_pool(&pool, renumber_task);
+
+    if (stats) {
+        stats->bodies = pool.task_count;
+        stats->threads = (int)pool.count;
+        for (uint32_t i = 0; i < ready; i++) stats->steals += pool.workers[i].steals;
+    }
+    for (uint32_t i = 0; i < ready; i++) worker_free(&pool.workers[i]);
+    free(pool.workers);
+    free(pool.tasks);
+    global_scope_free(globals);
+    free(r.saved_slots);
+    result->unresolved += r.unresolved;
+    if (!ok) resolution_free(result);
+    return ok;
+}
+
+void resolution_free(Resolution* result) {
+    ast_index_free(&result->index);
+    free(result->names);
+    string_interner_free(result->interner);
+    symbol_table_free(result->symbols);
+    free(result->variables);
+    free(result->frames);
+    memset(result, 0, sizeof(*result));
+}
+
+const NameRef* resolution_name(const Resolution* result, uint32_t id) {
+    return id < result->index.count ? &result->names[id] : NULL;
+}
@@ -0,0 +1,123 @@
+/* LAMC Compiler - Name Resolution
+ * Binds every name to a storage location: frame slot, global or builtin
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef RESOLVE_H
+#define RESOLVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../parser/ast.h"
+#include "../parser/ast_index.h"
+#include "../parser/diagnostics.h"
+#include "../parser/intern.h"
+#include "symbol_table.h"
+
+/* Functions every program can call, in builtin slot order */
+extern const char* const RESOLVE_BUILTINS[];
+extern const size_t RESOLVE_BUILTIN_COUNT;
+
+/* Builtin slots, the index of each name in RESOLVE_BUILTINS */
+typedef enum {
+    BUILTIN_PRINT, BUILTIN_INPUT, BUILTIN_LEN, BUILTIN_RANGE, BUILTIN_SUM,
+    BUILTIN_ABS, BUILTIN_MIN, BUILTIN_MAX, BUILTIN_ROUND, BUILTIN_SQRT,
+    BUILTIN_POW, BUILTIN_INT, BUILTIN_FLOAT, BUILTIN_STRING
+} BuiltinSlot;
+
+/* Owner of globals and builtins, which live in no frame */
+#define RESOLVE_NO_FRAME UINT32_MAX
+
+typedef enum {
+    NAME_UNRESOLVED,
+    NAME_LOCAL,     /* Slot in the current function's frame */
+    NAME_GLOBAL,    /* Slot in the program's global table */
+    NAME_BUILTIN    /* Index into RESOLVE_BUILTINS */
+} NameKind;
+
+/* Storage a name occurrence refers to */
+typedef struct {
+    NameKind kind;
+    uint32_t slot;
+    SymbolId symbol;    /* SYMBOL_NONE when unresolved */
+} NameRef;
+
+/* Variable flags */
+#define VAR_CAPTURED 0x1u  /* Used from a function other than its own: a
+                            * global read or written by a function body,
+                            * as LAMC has no nested functions */
+#define VAR_ESCAPES  0x2u  /* Its value may outlive the frame: returned,
+                            * passed to a call, stored in an array, dict,
+                            * member or index, or copied to another name */
+
+/* Where one symbol lives, indexed by SymbolId */
+typedef struct {
+    uint32_t frame;     /* Owning frame, RESOLVE_NO_FRAME for globals and builtins */
+    uint32_t slot;      /* Frame slot, global slot or builtin index */
+    uint32_t flags;     /* VAR_* bits */
+} VariableInfo;
+
+/* One function's locals. Parameters take the first slots ('this' before
+ * them in a method); a scope's slots are reused once it closes, so
+ * slot_count is the most that are live at once. Frame 0 holds the locals
+ * of top-level code nested in blocks; top-level names are globals. */
+typedef struct {
+    uint32_t node;          /* Preorder id of the function, 0 (the program) for frame 0 */
+    SymbolId first_param;   /* Parameters are the symbols first_param .. + param_count - 1 */
+    uint32_t param_count;
+    uint32_t slot_count;
+} FrameInfo;
+
+/* The result of a pass over one program, indexed by the preorder ids of
+ * index. The tree must outlive it: names are interned in place. */
+typedef struct {
+    AstIndex index;
+    NameRef* names;             /* By id: what an identifier uses, a variable
+                                 * declaration defines or assigns, a for loop
+                                 * binds (its item; the index variable is the
+                                 * next symbol and slot) and a function, class
+                                 * or import declares. Others are unresolved. */
+    StringInterner* interner;
+    SymbolTable* symbols;       /* Every symbol, scopes closed */
+    VariableInfo* variables;    /* By SymbolId */
+    FrameInfo* frames;
+    size_t frame_count;
+    uint32_t global_count;
+    size_t unresolved;          /* Uses reported as undefined */
+} Resolution;
+
+/* Resolves the program in three steps: top-level functions, classes and
+ * imports are declared first, then top-level statements are resolved in
+ * order, then class members and function bodies, so bodies see every
+ * global whatever the order. Undefined names and reused function, class
+ * and parameter names are reported to diags. A name bound with '=' reuses
+ * a visible variable or parameter and declares a new one otherwise; an
+ * annotation ('x: int = ...') always declares. Returns false when out of
+ * memory, with result freed. */
+bool resolve_program(Resolution* result, AstNode* program, DiagBuffer* diags);
+void resolution_free(Resolution* result);
+
+/* What the parallel resolution did */
+typedef struct {
+    size_t bodies;      /* Top-level functions and classes resolved apart */
+    size_t steals;      /* Times a worker took tasks from another's range */
+    int threads;        /* Workers used */
+} ParallelResolveStats;
+
+/* Resolves like resolve_program(), with the same result and diagnostics
+ * whatever the thread count. Top-level names and statements are resolved
+ * first, and the global scope is then frozen into a read-only table. Each
+ * top-level function and class body is then resolved by a pool of threads
+ * stealing work from each other, every worker with its own symbol table,
+ * interner and diagnostics; those are merged in source order, and a second
+ * parallel pass renumbers the bodies' local names.
+ *
+ * stats may be NULL. Returns false when out of memory, with result freed. */
+bool resolve_program_parallel(Resolution* result, AstNode* program, DiagBuffer* diags, int thread_count,
+                              ParallelResolveStats* stats);
+
+/* Name of the node with preorder id */
+const NameRef* resolution_name(const Resolution* result, uint32_t id);
+
+#endif /* RESOLVE_H */
@@ -0,0 +1,469 @@
+/* LAMC Compiler - Specialization Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "specialize.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Times an instance's body is checked before a return type that keeps
+ * changing is taken as dynamic */
+#define MAX_RUNS 8
+
+/* A caller to check again when the callee's return type changes */
+typedef struct {
+    uint32_t callee;
+    uint32_t caller;
+    uint32_t next;          /* Next edge of the same callee, SPECIALIZATION_NONE at the end */
+} CallerEdge;
+
+typedef struct {
+    uint32_t first_edge;    /* Callers, SPECIALIZATION_NONE when none */
+    bool queued;
+} InstanceState;
+
+typedef struct {
+    SpecializationSet* set;
+    const Resolution* res;
+    const TypeInference* types;
+    InstanceInference* session;
+    uint32_t* cache;            /* Instances by (function, tuple), index + 1 */
+    size_t cache_mask;
+    uint32_t* queue;            /* Instances to check, FIFO */
+    size_t queue_head;
+    size_t queue_count;
+    size_t queue_capacity;
+    InstanceState* states;      /* By instance */
+    size_t state_capacity;
+    CallerEdge* edges;
+    size_t edge_count;
+    size_t edge_capacity;
+    uint32_t* edge_slots;       /* Edges by (callee, caller), index + 1 */
+    size_t edge_mask;
+    TypeId* tuple;              /* Scratch parameter types */
+    size_t tuple_capacity;
+    size_t item_capacity;
+    size_t param_count;
+    size_t param_capacity;
+    size_t call_capacity;
+    uint32_t current;           /* Instance being checked */
+    bool failed;
+} Specializer;
+
+static bool reserve(void** items, size_t* capacity, size_t index, size_t item_size) {
+    if (index < *capacity) return true;
+    size_t grown_capacity = *capacity ? *capacity : 64;
+    while (grown_capacity <= index) grown_capacity *= 2;
+    void* grown = realloc(*items, grown_capacity * item_size);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+static uint64_t mix(uint64_t h, uint64_t value) {
+    h ^= value + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+static uint64_t finalize(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/* ===== Open Addressing ===== */
+
+/* A table of index + 1 values kept at most half full. key re-derives the
+ * hash of a stored index when the table doubles. */
+typedef uint64_t (*SlotKey)(const Specializer* sp, uint32_t index);
+
+static bool slots_grow(Specializer* sp, uint32_t** slots, size_t* mask, size_t count, SlotKey key) {
+    if (*slots && count * 2 <= *mask) return true;
+    size_t capacity = *slots ? (*mask + 1) * 2 : 64;
+    uint32_t* grown = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+    if (!grown) return false;
+    for (size_t i = 0; *slots && i <= *mask; i++) {
+        if (!(*slots)[i]) continue;
+        size_t slot = key(sp, (*slots)[i] - 1) & (capacity - 1);
+        while (grown[slot]) slot = (slot + 1) & (capacity - 1);
+        grown[slot] = (*slots)[i];
+    }
+    free(*slots);
+    *slots = grown;
+    *mask = capacity - 1;
+    return true;
+}
+
+static uint64_t tuple_hash(uint32_t function, const TypeId* params, uint32_t count) {
+    uint64_t h = mix(0, function);
+    for (uint32_t i = 0; i < count; i++) h = mix(h, params[i]);
+    return finalize(h);
+}
+
+static uint64_t instance_key(const Specializer* sp, uint32_t index) {
+    const Specialization* item = &sp->set->items[index];
+    return tuple_hash(item->function, &sp->set->param_types[item->first_param], item->param_count);
+}
+
+static uint64_t call_hash(uint32_t caller, uint32_t call) {
+    return finalize(mix(mix(0, caller), call));
+}
+
+static uint64_t call_key(const Specializer* sp, uint32_t index) {
+    const SpecializedCall* call = &sp->set->calls[index];
+    return call_hash(call->caller, call->call);
+}
+
+static uint64_t edge_key(const Specializer* sp, uint32_t index) {
+    const CallerEdge* edge = &sp->edges[index];
+    return call_hash(edge->callee, edge->caller);
+}
+
+/* ===== Instances ===== */
+
+/* Frame of the function at preorder id: frames are in node order */
+static uint32_t frame_of(const Resolution* res, uint32_t function) {
+    size_t lo = 1;
+    size_t hi = res->frame_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (res->frames[mid].node < function) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < res->frame_count && res->frames[lo].node == function ? (uint32_t)lo : SPECIALIZATION_NONE;
+}
+
+static void enqueue(Specializer* sp, uint32_t instance) {
+    if (sp->states[instance].queued) return;
+    if (sp->queue_head > 0 && sp->queue_head == sp->queue_count) {
+        sp->queue_head = 0;
+        sp->queue_count = 0;
+    }
+    if (!reserve((void**)&sp->queue, &sp->queue_capacity, sp->queue_count, sizeof(uint32_t))) {
+        sp->failed = true;
+        return;
+    }
+    sp->queue[sp->queue_count++] = instance;
+    sp->states[instance].queued = true;
+}
+
+/* The instance of function for these argument types, made and queued on
+ * first sight. Missing arguments leave their parameter to the body. */
+static uint32_t instantiate(Specializer* sp, uint32_t function, const TypeId* args, uint32_t arg_count) {
+    SpecializationSet* set = sp->set;
+    uint32_t frame = frame_of(sp->res, function);
+    if (frame == SPECIALIZATION_NONE) return SPECIALIZATION_NONE;
+    uint32_t param_count = sp->res->frames[frame].param_count;
+    if (!reserve((void**)&sp->tuple, &sp->tuple_capacity, param_count, sizeof(TypeId))) {
+        sp->failed = true;
+        return SPECIALIZATION_NONE;
+    }
+
+    bool boxed = false;
+    for (uint32_t i = 0; i < param_count; i++) {
+        sp->tuple[i] = i < arg_count ? args[i] : TYPE_NONE;
+        boxed = boxed || sp->tuple[i] == TYPE_DYNAMIC;
+    }
+    if (boxed) {
+        for (uint32_t i = 0; i < param_count; i++) sp->tuple[i] = TYPE_DYNAMIC;
+    }
+
+    size_t slot = tuple_hash(function, sp->tuple, param_count) & sp->cache_mask;
+    while (sp->cache[slot]) {
+        uint32_t index = sp->cache[slot] - 1;
+        const Specialization* item = &set->items[index];
+        if (item->function == function &&
+            (param_count == 0 ||
+             memcmp(&set->param_types[item->first_param], sp->tuple, param_count * sizeof(TypeId)) == 0)) {
+            set->cache_hits++;
+            return index;
+        }
+        slot = (slot + 1) & sp->cache_mask;
+    }
+
+    uint32_t index = (uint32_t)set->count;
+    TypeId* node_types = (TypeId*)calloc(sp->res->index.size[function], sizeof(TypeId));
+    if (!node_types || index == SPECIALIZATION_NONE ||
+        !reserve((void**)&set->items, &sp->item_capacity, index, sizeof(Specialization)) ||
+        !reserve((void**)&sp->states, &sp->state_capacity, index, sizeof(InstanceState)) ||
+        (param_count && !reserve((void**)&set->param_types, &sp->param_capacity,
+                                 sp->param_count + param_count - 1, sizeof(TypeId)))) {
+        free(node_types);
+        sp->failed = true;
+        return SPECIALIZATION_NONE;
+    }
+
+    Specialization* item = &set->items[index];
+    item->function = function;
+    item->frame = frame;
+    item->first_param = (uint32_t)sp->param_count;
+    item->param_count = param_count;
+    item->signature = TYPE_NONE;
+    item->ret = TYPE_NONE;
+    item->node_types = node_types;
+    item->conflicts = 0;
+    item->runs = 0;
+    item->boxed = boxed;
+    if (param_count) memcpy(&set->param_types[sp->param_count], sp->tuple, param_count * sizeof(TypeId));
+    sp->param_count += param_count;
+    sp->states[index].first_edge = SPECIALIZATION_NONE;
+    sp->states[index].queued = false;
+    set->count++;
+    if (boxed) set->boxed++;
+
+    sp->cache[slot] = index + 1;
+    if (!slots_grow(sp, &sp->cache, &sp->cache_mask, set->count, instance_key)) {
+        sp->failed = true;
+        return SPECIALIZATION_NONE;
+    }
+    enqueue(sp, index);
+    return index;
+}
+
+/* Remembers that call in caller runs callee, replacing an earlier answer */
+static void record_call(Specializer* sp, uint32_t caller, uint32_t call, uint32_t callee) {
+    SpecializationSet* set = sp->set;
+    size_t slot = call_hash(caller, call) & set->call_mask;
+    while (set->call_slots[slot]) {
+        SpecializedCall* known = &set->calls[set->call_slots[slot] - 1];
+        if (known->caller == caller && known->call == call) {
+            known->callee = callee;
+            return;
+        }
+        slot = (slot + 1) & set->call_mask;
+    }
+
+    if (!reserve((void**)&set->calls, &sp->call_capacity, set->call_count, sizeof(SpecializedCall))) {
+        sp->failed = true;
+        return;
+    }
+    SpecializedCall* added = &set->calls[set->call_count++];
+    added->caller = caller;
+    added->call = call;
+    added->callee = callee;
+    set->call_slots[slot] = (uint32_t)set->call_count;
+    if (!slots_grow(sp, &set->call_slots, &set->call_mask, set->call_count, call_key)) sp->failed = true;
+}
+
+/* Links caller into the callers of callee, once */
+static void add_caller(Specializer* sp, uint32_t callee, uint32_t caller) {
+    size_t slot = call_hash(callee, caller) & sp->edge_mask;
+    while (sp->edge_slots[slot]) {
+        const CallerEdge* edge = &sp->edges[sp->edge_slots[slot] - 1];
+        if (edge->callee == callee && edge->caller == caller) return;
+        slot = (slot + 1) & sp->edge_mask;
+    }
+
+    if (!reserve((void**)&sp->edges, &sp->edge_capacity, sp->edge_count, sizeof(CallerEdge))) {
+        sp->failed = true;
+        return;
+    }
+    CallerEdge* edge = &sp->edges[sp->edge_count++];
+    edge->callee = callee;
+    edge->caller = caller;
+    edge->next = sp->states[callee].first_edge;
+    sp->states[callee].first_edge = (uint32_t)(sp->edge_count - 1);
+    sp->edge_slots[slot] = (uint32_t)sp->edge_count;
+    if (!slots_grow(sp, &sp->edge_slots, &sp->edge_mask, sp->edge_count, edge_key)) sp->failed = true;
+}
+
+/* InstanceCallHook: a call in the instance being checked */
+static TypeId call_hook(void* context, uint32_t call, uint32_t function, const TypeId* args, uint32_t arg_count) {
+    Specializer* sp = (Specializer*)context;
+    if (sp->failed) return TYPE_NONE;
+    uint32_t callee = instantiate(sp, function, args, arg_count);
+    if (callee == SPECIALIZATION_NONE) return TYPE_NONE;
+    record_call(sp, sp->current, call, callee);
+    add_caller(sp, callee, sp->current);
+    return sp->failed ? TYPE_NONE : sp->set->items[callee].ret;
+}
+
+/* Checks one queued instance; callers see a changed return type */
+static void check(Specializer* sp, uint32_t index) {
+    SpecializationSet* set = sp->set;
+    Specialization* item = &set->items[index];
+    TypeId ret = TYPE_DYNAMIC;
+
+    if (item->runs < MAX_RUNS) {
+        /* The hook may add instances, moving items and param_types */
+        uint32_t frame = item->frame;
+        uint32_t param_count = item->param_count;
+        TypeId* node_types = item->node_types;
+        TypeId* params = (TypeId*)malloc((param_count + 1) * sizeof(TypeId));
+        if (!params) {
+            sp->failed = true;
+            return;
+        }
+        if (param_count) memcpy(params, &set->param_types[item->first_param], param_count * sizeof(TypeId));
+        item->runs++;
+        set->runs++;
+
+        size_t conflicts = 0;
+        sp->current = index;
+        bool ok = instance_infer(sp->session, frame, params, param_count, node_types, &ret, &conflicts);
+        free(params);
+        if (!ok || sp->failed) {
+            sp->failed = true;
+            return;
+        }
+        item = &set->items[index];
+        item->signature = node_types[0];
+        item->conflicts = conflicts;
+    }
+
+    if (ret == item->ret) return;
+    item->ret = ret;
+    for (uint32_t e = sp->states[index].first_edge; e != SPECIALIZATION_NONE; e = sp->edges[e].next) {
+        enqueue(sp, sp->edges[e].caller);
+    }
+}
+
+/* ===== Driver ===== */
+
+/* A call of a top-level function by name: the function's id */
+static uint32_t called_function(const Resolution* res, uint32_t call) {
+    uint32_t callee = call + 1;
+    SymbolId symbol = res->names[callee].symbol;
+    if (res->index.nodes[callee]->type != AST_IDENTIFIER_EXPR || symbol == SYMBOL_NONE) return SPECIALIZATION_NONE;
+    const Symbol* info = symbol_table_get(res->symbols, symbol);
+    if (info->kind != SYMBOL_FUNCTION) return SPECIALIZATION_NONE;
+    uint32_t function = ast_index_id(&res->index, info->decl);
+    return function != AST_INDEX_NONE ? function : SPECIALIZATION_NONE;
+}
+
+/* Calls in top-level code, typed by whole-program inference */
+static void instantiate_roots(Specializer* sp) {
+    const AstIndex* index = &sp->res->index;
+    TypeId* args = NULL;
+    size_t arg_capacity = 0;
+
+    for (uint32_t id = 1; id < index->count && !sp->failed;) {
+        AstNodeType type = index->nodes[id]->type;
+        if (type == AST_FUNCTION_DECL || type == AST_CLASS_DECL) {
+            if (type == AST_FUNCTION_DECL && strcmp(index->nodes[id]->as.function.name, "main") == 0) {
+                instantiate(sp, id, NULL, 0);
+            }
+            id += index->size[id];
+            continue;
+        }
+
+        uint32_t function = type == AST_CALL_EXPR ? called_function(sp->res, id) : SPECIALIZATION_NONE;
+        if (function != SPECIALIZATION_NONE) {
+            uint32_t callee = id + 1;
+            uint32_t arg_count = 0;
+            for (uint32_t arg = callee + index->size[callee]; arg < id + index->size[id]; arg += index->size[arg]) {
+                if (!reserve((void**)&args, &arg_capacity, arg_count, sizeof(TypeId))) {
+                    sp->failed = true;
+                    break;
+                }
+                args[arg_count++] = inference_type(sp->types, arg);
+            }
+            uint32_t instance = sp->failed ? SPECIALIZATION_NONE : instantiate(sp, function, args, arg_count);
+            if (instance != SPECIALIZATION_NONE) record_call(sp, SPECIALIZATION_NONE, id, instance);
+        }
+        id++;
+    }
+    free(args);
+}
+
+bool specialize_program(SpecializationSet* set, const Resolution* resolution, const TypeInference* types) {
+    memset(set, 0, sizeof(*set));
+    Specializer sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.set = set;
+    sp.res = resolution;
+    sp.types = types;
+    sp.current = SPECIALIZATION_NONE;
+    sp.session = instance_inference_create(resolution, types, call_hook, &sp);
+    sp.failed = !sp.session ||
+                !slots_grow(&sp, &sp.cache, &sp.cache_mask, 0, instance_key) ||
+                !slots_grow(&sp, &sp.edge_slots, &sp.edge_mask, 0, edge_key) ||
+                !slots_grow(&sp, &set->call_slots, &set->call_mask, 0, call_key);
+
+    if (!sp.failed && resolution->index.count > 0 && resolution->index.nodes[0]->type == AST_PROGRAM) {
+        instantiate_roots(&sp);
+    }
+    while (sp.queue_head < sp.queue_count && !sp.failed) {
+        uint32_t index = sp.queue[sp.queue_head++];
+        sp.states[index].queued = false;
+        check(&sp, index);
+    }
+
+    bool ok = !sp.failed;
+    instance_inference_free(sp.session);
+    free(sp.cache);
+    free(sp.queue);
+    free(sp.states);
+    free(sp.edges);
+    free(sp.edge_slots);
+    free(sp.tuple);
+    if (!ok) specialization_set_free(set);
+    return ok;
+}
+
+void specialization_set_free(SpecializationSet* set) {
+    for (size_t i = 0; i < set->count; i++) free(set->items[i].node_types);
+    free(set->items);
+    free(set->param_types);
+    free(set->calls);
+    free(set->call_slots);
+    memset(set, 0, sizeof(*set));
+}
+
+/* ===== Queries ===== */
+
+uint32_t specialization_target(const SpecializationSet* set, uint32_t caller, uint32_t call) {
+    if (!set->call_slots) return SPECIALIZATION_NONE;
+    size_t slot = call_hash(caller, call) & set->call_mask;
+    while (set->call_slots[slot]) {
+        const SpecializedCall* known = &set->calls[set->call_slots[slot] - 1];
+        if (known->caller == caller && known->call == call) return known->callee;
+        slot = (slot + 1) & set->call_mask;
+    }
+    return SPECIALIZATION_NONE;
+}
+
+size_t specialization_count(const SpecializationSet* set, uint32_t function) {
+    size_t count = 0;
+    for (size_t i = 0; i < set->count; i++) count += set->items[i].function == function;
+    return count;
+}
+
+/* ===== Report ===== */
+
+static int compare_keys(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+void specialization_report(const SpecializationSet* set, const Resolution* resolution,
+                           const TypeInference* types, FILE* out) {
+    /* Instances grouped by function in source order: (function, index) keys */
+    uint64_t* keys = (uint64_t*)malloc((set->count + 1) * sizeof(uint64_t));
+    if (!keys) return;
+    for (size_t i = 0; i < set->count; i++) keys[i] = (uint64_t)set->items[i].function << 32 | i;
+    qsort(keys, set->count, sizeof(uint64_t), compare_keys);
+
+    size_t functions = 0;
+    char buffer[256];
+    for (size_t n = 0; n < set->count; n++) {
+        const Specialization* item = &set->items[(uint32_t)keys[n]];
+        if (n == 0 || (uint32_t)(keys[n - 1] >> 32) != item->function) {
+            size_t count = specialization_count(set, item->function);
+            fprintf(out, "%s: %zu instance%s\n", resolution->index.nodes[item->function]->as.function.name,
+                    count, count == 1 ? "" : "s");
+            functions++;
+        }
+        fprintf(out, "    %s%s\n", type_format(types->types, item->signature, buffer, sizeof(buffer)),
+                item->boxed ? " (boxed)" : "");
+    }
+    fprintf(out, "%zu functions, %zu instances, %zu cache hits, %zu boxed, %zu body checks\n",
+            functions, set->count, set->cache_hits, set->boxed, set->runs);
+    free(keys);
+}
@@ -0,0 +1,83 @@
+/* LAMC Compiler - Specialization
+ * One type-specialized instance of a function per argument type tuple
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef SPECIALIZE_H
+#define SPECIALIZE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "infer.h"
+#include "resolve.h"
+#include "types.h"
+
+/* No instance: a call answered by the shared signature, or top-level code
+ * as a caller */
+#define SPECIALIZATION_NONE UINT32_MAX
+
+/* One copy of a top-level function, typed for one tuple of parameter types */
+typedef struct {
+    uint32_t function;      /* Preorder id of the function */
+    uint32_t frame;
+    uint32_t first_param;   /* Its parameter types, in SpecializationSet.param_types */
+    uint32_t param_count;
+    TypeId signature;       /* func(params) -> ret, as checked */
+    TypeId ret;
+    TypeId* node_types;     /* Type of each node of the function, by id - function */
+    size_t conflicts;       /* Values of this instance left dynamic by a conflict */
+    uint32_t runs;          /* Times its body was checked */
+    bool boxed;             /* The fallback: every parameter dynamic */
+} Specialization;
+
+/* The instance one call runs */
+typedef struct {
+    uint32_t caller;        /* Calling instance, SPECIALIZATION_NONE for top-level code */
+    uint32_t call;          /* Preorder id of the call */
+    uint32_t callee;        /* Called instance */
+} SpecializedCall;
+
+typedef struct {
+    Specialization* items;      /* In the order they were first reached */
+    size_t count;
+    TypeId* param_types;
+    SpecializedCall* calls;
+    size_t call_count;
+    uint32_t* call_slots;       /* calls by (caller, call), index + 1 (internal) */
+    size_t call_mask;
+    size_t cache_hits;          /* Calls answered by an existing instance */
+    size_t runs;                /* Bodies checked, re-checks included */
+    size_t boxed;               /* Instances that fell back to dynamic */
+} SpecializationSet;
+
+/* Instantiates every top-level function reachable from main and from
+ * top-level code, once per distinct tuple of argument types it is called
+ * with. Each body is re-checked by instance_infer() with its parameters
+ * fixed, so a call inside it picks the instance for the argument types of
+ * that instance, and so on transitively. Instances are cached by
+ * (function, tuple): a tuple seen before costs one hash lookup.
+ *
+ * An instance's return type feeds its callers, so when it changes they are
+ * checked again, a bounded number of times before it is taken as dynamic.
+ * A call with an argument inference left dynamic goes to the function's
+ * boxed instance instead of one specialized for a dynamic slot. Methods and
+ * calls through values keep the signatures of types; calls from them run
+ * no instance.
+ *
+ * Returns false when out of memory, with set freed. */
+bool specialize_program(SpecializationSet* set, const Resolution* resolution, const TypeInference* types);
+void specialization_set_free(SpecializationSet* set);
+
+/* Instance that call in caller runs, SPECIALIZATION_NONE when none does */
+uint32_t specialization_target(const SpecializationSet* set, uint32_t caller, uint32_t call);
+
+/* Instances of the function at preorder id */
+size_t specialization_count(const SpecializationSet* set, uint32_t function);
+
+/* Lists each function's instances by signature, then totals */
+void specialization_report(const SpecializationSet* set, const Resolution* resolution,
+                           const TypeInference* types, FILE* out);
+
+#endif /* SPECIALIZE_H */
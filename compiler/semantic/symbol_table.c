@@ -0,0 +1,177 @@
+/* LAMC Compiler - Symbol Table Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "symbol_table.h"
+#include <stdlib.h>
+
+#define SYMBOL_TABLE_INITIAL_BITS 8
+
+typedef struct {
+    uint32_t name;      /* 0 for an empty slot */
+    SymbolId binding;   /* Innermost live binding, SYMBOL_NONE between scopes */
+} NameSlot;
+
+struct SymbolTable {
+    NameSlot* slots;
+    uint32_t bits;          /* log2 of the slot count */
+    size_t names;           /* Occupied slots */
+    Symbol* symbols;
+    size_t count;
+    size_t capacity;
+    SymbolId* log;          /* Undo log: symbols bound in the open scopes */
+    size_t log_count;
+    size_t log_capacity;
+    size_t* marks;          /* Undo log length at each scope's start */
+    size_t mark_capacity;
+    uint32_t depth;
+};
+
+/* Fibonacci hashing: the top bits of the product spread dense ids */
+static size_t name_hash(uint32_t name, uint32_t bits) {
+    return (size_t)((name * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+}
+
+/* Slot holding name, or the empty slot where it belongs */
+static size_t find_slot(const SymbolTable* table, uint32_t name) {
+    size_t mask = ((size_t)1 << table->bits) - 1;
+    size_t slot = name_hash(name, table->bits);
+    while (table->slots[slot].name && table->slots[slot].name != name) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static bool grow_array(void** items, size_t* capacity, size_t count, size_t item_size) {
+    if (count < *capacity) return true;
+    size_t grown_capacity = *capacity ? *capacity * 2 : 64;
+    void* grown = realloc(*items, grown_capacity * item_size);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+/* ===== Table Management ===== */
+
+SymbolTable* symbol_table_create(void) {
+    SymbolTable* table = (SymbolTable*)calloc(1, sizeof(SymbolTable));
+    if (!table) return NULL;
+
+    table->bits = SYMBOL_TABLE_INITIAL_BITS;
+    table->slots = (NameSlot*)calloc((size_t)1 << table->bits, sizeof(NameSlot));
+    if (!table->slots) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+void symbol_table_free(SymbolTable* table) {
+    if (!table) return;
+    free(table->slots);
+    free(table->symbols);
+    free(table->log);
+    free(table->marks);
+    free(table);
+}
+
+static bool table_grow(SymbolTable* table) {
+    NameSlot* old_slots = table->slots;
+    size_t old_capacity = (size_t)1 << table->bits;
+    NameSlot* new_slots = (NameSlot*)calloc(old_capacity * 2, sizeof(NameSlot));
+    if (!new_slots) return false;
+
+    table->slots = new_slots;
+    table->bits++;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].name) table->slots[find_slot(table, old_slots[i].name)] = old_slots[i];
+    }
+    free(old_slots);
+    return true;
+}
+
+/* ===== Scopes ===== */
+
+bool symbol_table_push_scope(SymbolTable* table) {
+    if (!grow_array((void**)&table->marks, &table->mark_capacity, table->depth, sizeof(size_t))) {
+        return false;
+    }
+    table->marks[table->depth++] = table->log_count;
+    return true;
+}
+
+void symbol_table_pop_scope(SymbolTable* table) {
+    if (table->depth == 0) return;
+
+    size_t mark = table->marks[--table->depth];
+    while (table->log_count > mark) {
+        const Symbol* symbol = &table->symbols[table->log[--table->log_count]];
+        table->slots[find_slot(table, symbol->name)].binding = symbol->shadowed;
+    }
+}
+
+uint32_t symbol_table_depth(const SymbolTable* table) {
+    return table->depth;
+}
+
+/* ===== Bindings ===== */
+
+SymbolId symbol_table_declare(SymbolTable* table, uint32_t name, SymbolKind kind, AstNode* decl) {
+    if (name == 0 || table->count >= SYMBOL_NONE) return SYMBOL_NONE;
+    if (!grow_array((void**)&table->symbols, &table->capacity, table->count, sizeof(Symbol)) ||
+        !grow_array((void**)&table->log, &table->log_capacity, table->log_count, sizeof(SymbolId))) {
+        return SYMBOL_NONE;
+    }
+
+    size_t slot = find_slot(table, name);
+    if (!table->slots[slot].name) {
+        /* Keep the load factor under 1/2 */
+        if ((table->names + 1) * 2 > ((size_t)1 << table->bits)) {
+            if (!table_grow(table)) return SYMBOL_NONE;
+            slot = find_slot(table, name);
+        }
+        table->slots[slot].name = name;
+        table->slots[slot].binding = SYMBOL_NONE;
+        table->names++;
+    }
+
+    SymbolId id = (SymbolId)table->count++;
+    Symbol* symbol = &table->symbols[id];
+    symbol->name = name;
+    symbol->depth = table->depth;
+    symbol->kind = kind;
+    symbol->decl = decl;
+    symbol->shadowed = table->slots[slot].binding;
+    table->slots[slot].binding = id;
+    table->log[table->log_count++] = id;
+    return id;
+}
+
+SymbolId symbol_table_append(SymbolTable* table, const Symbol* symbol) {
+    if (table->count >= SYMBOL_NONE ||
+        !grow_array((void**)&table->symbols, &table->capacity, table->count, sizeof(Symbol))) {
+        return SYMBOL_NONE;
+    }
+    table->symbols[table->count] = *symbol;
+    return (SymbolId)table->count++;
+}
+
+SymbolId symbol_table_lookup(const SymbolTable* table, uint32_t name) {
+    if (name == 0) return SYMBOL_NONE;
+    const NameSlot* slot = &table->slots[find_slot(table, name)];
+    return slot->name ? slot->binding : SYMBOL_NONE;
+}
+
+SymbolId symbol_table_lookup_local(const SymbolTable* table, uint32_t name) {
+    SymbolId id = symbol_table_lookup(table, name);
+    return id != SYMBOL_NONE && table->symbols[id].depth == table->depth ? id : SYMBOL_NONE;
+}
+
+const Symbol* symbol_table_get(const SymbolTable* table, SymbolId id) {
+    return id < table->count ? &table->symbols[id] : NULL;
+}
+
+size_t symbol_table_count(const SymbolTable* table) {
+    return table->count;
+}
@@ -0,0 +1,72 @@
+/* LAMC Compiler - Symbol Table
+ * Scoped name bindings in one flat open-addressing table
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../parser/ast.h"
+
+/* Index of a symbol; symbols keep their ids after their scope closes */
+typedef uint32_t SymbolId;
+#define SYMBOL_NONE UINT32_MAX
+
+typedef enum {
+    SYMBOL_VARIABLE,
+    SYMBOL_PARAMETER,
+    SYMBOL_FUNCTION,
+    SYMBOL_CLASS,
+    SYMBOL_IMPORT,
+    SYMBOL_BUILTIN
+} SymbolKind;
+
+typedef struct {
+    uint32_t name;      /* Interned name id (see intern.h) */
+    uint32_t depth;     /* Scope depth, 0 for globals */
+    SymbolKind kind;
+    AstNode* decl;      /* Declaring node, NULL for predeclared names */
+    SymbolId shadowed;  /* Binding of the same name this one hides */
+} Symbol;
+
+/* One slot per interned name, holding its innermost live binding; that
+ * binding carries its depth, so (name, depth) questions take one probe
+ * sequence. A name's slot stays once created and just empties when its
+ * last binding goes out of scope, so scope exit never deletes from the
+ * table. Every declaration is also pushed on an undo log; closing a
+ * scope pops the log back to the scope's mark and restores each popped
+ * binding's shadowed one. Push and pop are O(1) amortized per binding. */
+typedef struct SymbolTable SymbolTable;
+
+SymbolTable* symbol_table_create(void);
+void symbol_table_free(SymbolTable* table);
+
+/* Scope 0 is open from the start and cannot be popped.
+ * symbol_table_push_scope() returns false when out of memory. */
+bool symbol_table_push_scope(SymbolTable* table);
+void symbol_table_pop_scope(SymbolTable* table);
+uint32_t symbol_table_depth(const SymbolTable* table);
+
+/* Binds name (an id > 0) in the current scope, hiding any outer binding
+ * and any earlier one in the same scope; check symbol_table_lookup_local()
+ * first to report redeclarations. SYMBOL_NONE when out of memory. */
+SymbolId symbol_table_declare(SymbolTable* table, uint32_t name, SymbolKind kind, AstNode* decl);
+
+/* Adds a symbol of a scope that has already closed, fields as given: for
+ * merging symbols resolved in tables of their own. No binding changes.
+ * SYMBOL_NONE when out of memory. */
+SymbolId symbol_table_append(SymbolTable* table, const Symbol* symbol);
+
+/* Innermost visible binding of name, SYMBOL_NONE if there is none */
+SymbolId symbol_table_lookup(const SymbolTable* table, uint32_t name);
+/* The same, restricted to the current scope */
+SymbolId symbol_table_lookup_local(const SymbolTable* table, uint32_t name);
+
+/* Every symbol ever declared, open scope or not */
+const Symbol* symbol_table_get(const SymbolTable* table, SymbolId id);
+size_t symbol_table_count(const SymbolTable* table);
+
+#endif /* SYMBOL_TABLE_H */
@@ -0,0 +1,272 @@
+/* LAMC Compiler - Types Implementation
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include "types.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct TypeTable {
+    Type* types;
+    size_t count;
+    size_t capacity;
+    TypeId* operands;
+    size_t operand_count;
+    size_t operand_capacity;
+    TypeId* slots;      /* Constructed types by hash, id + 1, 0 when empty */
+    size_t mask;
+};
+
+typedef struct {
+    const char* name;
+    TypeKind kind;
+    uint32_t size;
+} Primitive;
+
+/* Indexed by TypeId */
+static const Primitive PRIMITIVES[TYPE_PRIMITIVE_COUNT] = {
+    { "none", TYPE_KIND_NONE, 0 },
+    { "dynamic", TYPE_KIND_DYNAMIC, 0 },
+    { "void", TYPE_KIND_VOID, 0 },
+    { "bool", TYPE_KIND_BOOL, 1 },
+    { "int", TYPE_KIND_INTEGER, 8 },
+    { "i8", TYPE_KIND_INTEGER, 1 },
+    { "i16", TYPE_KIND_INTEGER, 2 },
+    { "i32", TYPE_KIND_INTEGER, 4 },
+    { "u8", TYPE_KIND_INTEGER, 1 },
+    { "u16", TYPE_KIND_INTEGER, 2 },
+    { "u32", TYPE_KIND_INTEGER, 4 },
+    { "u64", TYPE_KIND_INTEGER, 8 },
+    { "float", TYPE_KIND_FLOAT, 8 },
+    { "f32", TYPE_KIND_FLOAT, 4 },
+    { "string", TYPE_KIND_STRING, 0 },
+};
+
+/* Annotation spellings that name a primitive under another name */
+static const struct { const char* name; TypeId type; } ALIASES[] = {
+    { "i64", TYPE_INT }, { "f64", TYPE_FLOAT }, { "byte", TYPE_U8 }, { "str", TYPE_STRING }
+};
+
+static bool grow(void** items, size_t* capacity, size_t needed, size_t item_size) {
+    if (needed <= *capacity) return true;
+    size_t grown_capacity = *capacity ? *capacity : 64;
+    while (grown_capacity < needed) grown_capacity *= 2;
+    void* grown = realloc(*items, grown_capacity * item_size);
+    if (!grown) return false;
+    *items = grown;
+    *capacity = grown_capacity;
+    return true;
+}
+
+static uint64_t mix(uint64_t h, uint64_t value) {
+    h ^= value + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+static uint64_t key_hash(TypeKind kind, uint32_t decl, const TypeId* operands, uint32_t count) {
+    uint64_t h = mix((uint64_t)kind, decl);
+    for (uint32_t i = 0; i < count; i++) h = mix(h, operands[i]);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static bool same_key(const TypeTable* table, const Type* type, TypeKind kind, uint32_t decl,
+                     const TypeId* operands, uint32_t count) {
+    return type->kind == kind && type->decl == decl && type->count == count &&
+           (count == 0 || memcmp(&table->operands[type->first], operands, count * sizeof(TypeId)) == 0);
+}
+
+/* Doubles the slot array, keeping it at most half full */
+static bool rehash(TypeTable* table) {
+    size_t capacity = (table->mask + 1) * 2;
+    TypeId* slots = (TypeId*)calloc(capacity, sizeof(TypeId));
+    if (!slots) return false;
+    for (size_t id = TYPE_PRIMITIVE_COUNT; id < table->count; id++) {
+        const Type* type = &table->types[id];
+        size_t slot = key_hash(type->kind, type->decl, &table->operands[type->first], type->count) & (capacity - 1);
+        while (slots[slot]) slot = (slot + 1) & (capacity - 1);
+        slots[slot] = (TypeId)id + 1;
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->mask = capacity - 1;
+    return true;
+}
+
+/* The id of a constructed type, added on first sight */
+static TypeId intern(TypeTable* table, TypeKind kind, uint32_t decl, const char* name,
+                     const TypeId* operands, uint32_t count) {
+    size_t slot = key_hash(kind, decl, operands, count) & table->mask;
+    while (table->slots[slot]) {
+        TypeId id = table->slots[slot] - 1;
+        if (same_key(table, &table->types[id], kind, decl, operands, count)) return id;
+        slot = (slot + 1) & table->mask;
+    }
+
+    if (!grow((void**)&table->types, &table->capacity, table->count + 1, sizeof(Type)) ||
+        !grow((void**)&table->operands, &table->operand_capacity, table->operand_count + count, sizeof(TypeId))) {
+        return TYPE_NONE;
+    }
+    TypeId id = (TypeId)table->count++;
+    Type* type = &table->types[id];
+    type->kind = kind;
+    type->size = 0;
+    type->count = count;
+    type->first = (uint32_t)table->operand_count;
+    type->decl = decl;
+    type->name = name;
+    if (count) memcpy(&table->operands[table->operand_count], operands, count * sizeof(TypeId));
+    table->operand_count += count;
+    table->slots[slot] = id + 1;
+
+    if ((table->count - TYPE_PRIMITIVE_COUNT) * 2 > table->mask && !rehash(table)) {
+        table->count--;
+        table->operand_count -= count;
+        table->slots[slot] = 0;
+        return TYPE_NONE;
+    }
+    return id;
+}
+
+/* ===== Table Management ===== */
+
+TypeTable* type_table_create(void) {
+    TypeTable* table = (TypeTable*)calloc(1, sizeof(TypeTable));
+    if (!table) return NULL;
+    table->mask = 63;
+    table->slots = (TypeId*)calloc(table->mask + 1, sizeof(TypeId));
+    if (!table->slots || !grow((void**)&table->types, &table->capacity, TYPE_PRIMITIVE_COUNT, sizeof(Type))) {
+        type_table_free(table);
+        return NULL;
+    }
+    for (TypeId id = 0; id < TYPE_PRIMITIVE_COUNT; id++) {
+        Type* type = &table->types[id];
+        type->kind = PRIMITIVES[id].kind;
+        type->size = PRIMITIVES[id].kind == TYPE_KIND_INTEGER || PRIMITIVES[id].kind == TYPE_KIND_FLOAT
+                         ? PRIMITIVES[id].size : 0;
+        type->count = 0;
+        type->first = 0;
+        type->decl = 0;
+        type->name = PRIMITIVES[id].name;
+    }
+    table->count = TYPE_PRIMITIVE_COUNT;
+    return table;
+}
+
+void type_table_free(TypeTable* table) {
+    if (!table) return;
+    free(table->types);
+    free(table->operands);
+    free(table->slots);
+    free(table);
+}
+
+/* ===== Construction ===== */
+
+TypeId type_array(TypeTable* table, TypeId element) {
+    return intern(table, TYPE_KIND_ARRAY, 0, NULL, &element, 1);
+}
+
+TypeId type_dict(TypeTable* table, TypeId key, TypeId value) {
+    TypeId operands[2] = { key, value };
+    return intern(table, TYPE_KIND_DICT, 0, NULL, operands, 2);
+}
+
+TypeId type_function(TypeTable* table, TypeId ret, const TypeId* params, uint32_t param_count) {
+    TypeId small[8];
+    TypeId* operands = param_count < 8 ? small : (TypeId*)malloc((param_count + 1) * sizeof(TypeId));
+    if (!operands) return TYPE_NONE;
+    operands[0] = ret;
+    if (param_count) memcpy(operands + 1, params, param_count * sizeof(TypeId));
+    TypeId id = intern(table, TYPE_KIND_FUNCTION, 0, NULL, operands, param_count + 1);
+    if (operands != small) free(operands);
+    return id;
+}
+
+TypeId type_class(TypeTable* table, uint32_t decl, const char* name) {
+    return intern(table, TYPE_KIND_CLASS, decl, name, NULL, 0);
+}
+
+/* ===== Queries ===== */
+
+const Type* type_get(const TypeTable* table, TypeId id) {
+    return id < table->count ? &table->types[id] : NULL;
+}
+
+TypeId type_operand(const TypeTable* table, TypeId id, uint32_t index) {
+    const Type* type = type_get(table, id);
+    return type && index < type->count ? table->operands[type->first + index] : TYPE_NONE;
+}
+
+size_t type_table_count(const TypeTable* table) {
+    return table->count;
+}
+
+TypeId type_from_name(const char* name) {
+    for (TypeId id = TYPE_VOID; id < TYPE_PRIMITIVE_COUNT; id++) {
+        if (strcmp(PRIMITIVES[id].name, name) == 0) return id;
+    }
+    for (size_t i = 0; i < sizeof(ALIASES) / sizeof(ALIASES[0]); i++) {
+        if (strcmp(ALIASES[i].name, name) == 0) return ALIASES[i].type;
+    }
+    return TYPE_NONE;
+}
+
+/* ===== Formatting ===== */
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t length;
+} TextOut;
+
+static void put(TextOut* out, const char* text) {
+    for (; *text && out->length + 1 < out->size; text++) out->data[out->length++] = *text;
+    out->data[out->length] = '\0';
+}
+
+/* Nesting is bounded by what inference built, which is bounded by the
+ * source; a depth limit keeps pathological types printable */
+static void format_type(const TypeTable* table, TypeId id, TextOut* out, int depth) {
+    const Type* type = type_get(table, id);
+    if (!type || depth > 32) {
+        put(out, "...");
+        return;
+    }
+    switch (type->kind) {
+        case TYPE_KIND_ARRAY:
+            put(out, "array[");
+            format_type(table, type_operand(table, id, 0), out, depth + 1);
+            put(out, "]");
+            break;
+        case TYPE_KIND_DICT:
+            put(out, "dict[");
+            format_type(table, type_operand(table, id, 0), out, depth + 1);
+            put(out, ", ");
+            format_type(table, type_operand(table, id, 1), out, depth + 1);
+            put(out, "]");
+            break;
+        case TYPE_KIND_FUNCTION:
+            put(out, "func(");
+            for (uint32_t i = 1; i < type->count; i++) {
+                if (i > 1) put(out, ", ");
+                format_type(table, type_operand(table, id, i), out, depth + 1);
+            }
+            put(out, ") -> ");
+            format_type(table, type_operand(table, id, 0), out, depth + 1);
+            break;
+        default:
+            put(out, type->name ? type->name : "?");
+            break;
+    }
+}
+
+char* type_format(const TypeTable* table, TypeId id, char* buffer, size_t size) {
+    if (size == 0) return buffer;
+    TextOut out = { buffer, size, 0 };
+    buffer[0] = '\0';
+    format_type(table, id, &out, 0);
+    return buffer;
+}
@@ -0,0 +1,83 @@
+/* LAMC Compiler - Types
+ * Hash-consed table of concrete types with dense ids
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Index of a type; equal types have equal ids */
+typedef uint32_t TypeId;
+
+/* Ids every table starts with, in this order */
+enum {
+    TYPE_NONE,      /* Not a value: statements, imports */
+    TYPE_DYNAMIC,   /* Boxed value whose type inference could not fix */
+    TYPE_VOID,
+    TYPE_BOOL,
+    TYPE_INT,       /* 64-bit signed, what integer literals default to */
+    TYPE_I8,
+    TYPE_I16,
+    TYPE_I32,
+    TYPE_U8,
+    TYPE_U16,
+    TYPE_U32,
+    TYPE_U64,
+    TYPE_FLOAT,     /* 64-bit, what float literals default to */
+    TYPE_F32,
+    TYPE_STRING,
+    TYPE_PRIMITIVE_COUNT
+};
+
+typedef enum {
+    TYPE_KIND_NONE,
+    TYPE_KIND_DYNAMIC,
+    TYPE_KIND_VOID,
+    TYPE_KIND_BOOL,
+    TYPE_KIND_INTEGER,
+    TYPE_KIND_FLOAT,
+    TYPE_KIND_STRING,
+    TYPE_KIND_ARRAY,        /* Operand: element */
+    TYPE_KIND_DICT,         /* Operands: key, value */
+    TYPE_KIND_FUNCTION,     /* Operands: return, then each parameter */
+    TYPE_KIND_CLASS         /* Instances of one class declaration */
+} TypeKind;
+
+typedef struct {
+    TypeKind kind;
+    uint32_t size;          /* Bytes of a number, 0 for other kinds */
+    uint32_t count;         /* Operands */
+    uint32_t first;         /* Where the operands start (internal) */
+    uint32_t decl;          /* Preorder id of a class declaration */
+    const char* name;       /* Primitive or class name, NULL otherwise */
+} Type;
+
+typedef struct TypeTable TypeTable;
+
+TypeTable* type_table_create(void);
+void type_table_free(TypeTable* table);
+
+/* Constructed types, TYPE_NONE when out of memory. A class type is
+ * keyed by decl alone; name must outlive the table. */
+TypeId type_array(TypeTable* table, TypeId element);
+TypeId type_dict(TypeTable* table, TypeId key, TypeId value);
+TypeId type_function(TypeTable* table, TypeId ret, const TypeId* params, uint32_t param_count);
+TypeId type_class(TypeTable* table, uint32_t decl, const char* name);
+
+const Type* type_get(const TypeTable* table, TypeId id);
+TypeId type_operand(const TypeTable* table, TypeId id, uint32_t index);
+size_t type_table_count(const TypeTable* table);
+
+/* Primitive named by a type annotation ("int", "i32", "f64", "byte"...),
+ * TYPE_NONE for any other name */
+TypeId type_from_name(const char* name);
+
+/* Writes e.g. "func(int, array[float]) -> bool" into buffer, truncated
+ * to size; returns buffer */
+char* type_format(const TypeTable* table, TypeId id, char* buffer, size_t size);
+
+#endif /* TYPES_H */
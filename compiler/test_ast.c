@@ -6,6 +6,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "parser/ast.h"
+#include "parser/ast_cons.h"
+#include "parser/ast_emit.h"
+#include "parser/ast_index.h"
+#include "parser/ast_persist.h"
+#include "parser/incremental.h"
+#include "parser/parallel.h"
+#include "parser/parser_events.h"
+#include "parser/stats.h"
+#include "lexer/line_table.h"
+#include <string.h>
+#include <limits.h>
 
 void test_literals() {
     printf("\n=== Testing Literals ===\n");
@@ -183,6 +194,1068 @@ void test_complete_program() {
     printf("✓ Complete program test passed\n");
 }
 
+void test_hashing() {
+    printf("\n=== Testing Structural Hashing ===\n");
+    
+    // a * (b + 1) built twice at different positions, and a * (b + 2)
+    AstNode* first = ast_create_binary(OP_MUL,
+        ast_create_identifier("a", 1, 1),
+        ast_create_binary(OP_ADD, ast_create_identifier("b", 1, 6),
+                          ast_create_literal_int(1, 1, 10), 1, 8), 1, 3);
+    AstNode* second = ast_create_binary(OP_MUL,
+        ast_create_identifier("a", 7, 5),
+        ast_create_binary(OP_ADD, ast_create_identifier("b", 7, 10),
+                          ast_create_literal_int(1, 7, 14), 7, 12), 7, 7);
+    AstNode* third = ast_create_binary(OP_MUL,
+        ast_create_identifier("a", 9, 1),
+        ast_create_binary(OP_ADD, ast_create_identifier("b", 9, 6),
+                          ast_create_literal_int(2, 9, 10), 9, 8), 9, 3);
+    
+    bool ok = ast_hash(first) == ast_hash(second) &&
+              ast_equal(first, second) &&
+              !ast_equal(first, third) &&
+              first->hash != 0;
+    
+    ast_free_node(first);
+    ast_free_node(second);
+    ast_free_node(third);
+    
+    if (!ok) {
+        printf("✗ Structural hashing test failed\n");
+        exit(1);
+    }
+    printf("✓ Structural hashing test passed\n");
+}
+
+void test_hash_consing() {
+    printf("\n=== Testing Hash-Consing ===\n");
+    
+    // obj.size seen twice shares one node; obj.len does not
+    AstConsTable* table = ast_cons_table_create();
+    AstNode* obj1 = ast_cons_intern(table, ast_create_identifier("obj", 1, 1));
+    AstNode* size1 = ast_cons_intern(table, ast_create_member(obj1, "size", 1, 5));
+    AstNode* obj2 = ast_cons_intern(table, ast_create_identifier("obj", 2, 1));
+    AstNode* size2 = ast_cons_intern(table, ast_create_member(obj2, "size", 2, 5));
+    AstNode* obj3 = ast_cons_intern(table, ast_create_identifier("obj", 3, 1));
+    AstNode* len = ast_cons_intern(table, ast_create_member(obj3, "len", 3, 5));
+    
+    AstConsStats stats;
+    ast_cons_get_stats(table, &stats);
+    bool ok = size1 == size2 && obj1 == obj3 && len != size1 &&
+              stats.lookups == 6 && stats.hits == 3 && stats.unique == 3;
+    
+    ast_free_node(size1);
+    ast_free_node(size2);
+    ast_free_node(len);
+    ast_cons_table_free(table);
+    
+    if (!ok) {
+        printf("✗ Hash-consing test failed\n");
+        exit(1);
+    }
+    printf("✓ Hash-consing test passed\n");
+}
+
+/* Parse of source from a token buffer, skipping bodies when lazy */
+static AstNode* parse_tokens(TokenBuffer* tokens, const char* source, bool lazy, Parser* parser, DiagBuffer* diags) {
+    if (!token_buffer_lex(tokens, source)) return NULL;
+    parser_init_tokens(parser, tokens, 0);
+    parser_set_diagnostics(parser, diags);
+    parser_enable_lazy_bodies(parser, lazy);
+    return parser_parse(parser);
+}
+
+void test_lazy_bodies() {
+    printf("\n=== Testing Lazy Function Bodies ===\n");
+    
+    const char* good =
+        "func area(w, h) {\n"
+        "    if w > 0 { return w * h }\n"
+        "    return 0\n"
+        "}\n"
+        "func nested() {\n"
+        "    d = {\"k\": [1, 2, {\"x\": 3}]}\n"
+        "    while true { if d { break } }\n"
+        "}\n"
+        "func empty() {}\n"
+        "total = area(2, 3)\n";
+    // The same program with a broken body: skipping it only matches braces
+    const char* broken =
+        "func area(w, h) {\n"
+        "    if w > 0 { return w * h }\n"
+        "    return 0\n"
+        "}\n"
+        "func nested() {\n"
+        "    d = {\"k\": [1, 2, {\"x\": 3}]}\n"
+        "    while true { if d { break } }\n"
+        "}\n"
+        "func empty() {}\n"
+        "total = area(2, 3)\n"
+        "func bad() {\n"
+        "    x = (1 +\n"
+        "}\n";
+    
+    TokenBuffer eager_tokens, lazy_tokens;
+    Parser eager_parser, lazy_parser;
+    DiagBuffer eager_diags, lazy_diags;
+    diag_buffer_init(&eager_diags);
+    diag_buffer_init(&lazy_diags);
+    AstNode* eager = parse_tokens(&eager_tokens, good, false, &eager_parser, &eager_diags);
+    AstNode* lazy = parse_tokens(&lazy_tokens, broken, true, &lazy_parser, &lazy_diags);
+    
+    AstList* eager_decls = eager ? eager->as.program.declarations : NULL;
+    AstList* lazy_decls = lazy ? lazy->as.program.declarations : NULL;
+    bool ok = eager && lazy && eager_decls->count == 4 && lazy_decls->count == 5 && lazy_diags.count == 0;
+    
+    // Every body is skipped, then parses to what an eager parse builds
+    for (size_t i = 0; ok && i < 4; i++) {
+        AstNode* decl = (AstNode*)lazy_decls->items[i];
+        if (decl->type != AST_FUNCTION_DECL) {
+            ok = ast_equal(decl, (AstNode*)eager_decls->items[i]);
+            continue;
+        }
+        ok = decl->as.function.body_pending && decl->as.function.body == NULL;
+        AstNode* body = ok ? parser_materialize_body(&lazy_parser, decl) : NULL;
+        ok = ok && body && !decl->as.function.body_pending && ast_equal(decl, (AstNode*)eager_decls->items[i]);
+        // A second access returns the body already parsed
+        ok = ok && parser_materialize_body(&lazy_parser, decl) == body;
+    }
+    
+    // The broken body reports its error only when it is materialized
+    AstNode* bad = ok ? (AstNode*)lazy_decls->items[4] : NULL;
+    ok = ok && lazy_diags.count == 0 && parser_materialize_body(&lazy_parser, bad) == NULL;
+    ok = ok && lazy_diags.count == 1 && lazy_diags.items[0].code == DIAG_EXPECTED_EXPRESSION &&
+         lazy_diags.items[0].line == 13 && !bad->as.function.body_pending;
+    
+    ast_free_node(eager);
+    ast_free_node(lazy);
+    parser_free(&eager_parser);
+    parser_free(&lazy_parser);
+    token_buffer_free(&eager_tokens);
+    token_buffer_free(&lazy_tokens);
+    diag_buffer_free(&eager_diags);
+    diag_buffer_free(&lazy_diags);
+    
+    if (!ok) {
+        printf("✗ Lazy function bodies test failed\n");
+        exit(1);
+    }
+    printf("✓ Lazy function bodies test passed\n");
+}
+
+/* Parses source in parallel and sequentially; true when both give equal
+ * trees (or both fail) with the same diagnostics */
+static bool parallel_matches(const char* source, int thread_count, size_t* chunks) {
+    TokenBuffer tokens;
+    if (!token_buffer_lex(&tokens, source)) return false;
+    Parser parser;
+    DiagBuffer expected, found;
+    diag_buffer_init(&expected);
+    diag_buffer_init(&found);
+    parser_init_tokens(&parser, &tokens, 0);
+    parser_set_diagnostics(&parser, &expected);
+    AstNode* sequential = parser_parse(&parser);
+    ParallelParseStats stats;
+    AstNode* parallel = parser_parse_parallel(&tokens, thread_count, &found, &stats);
+    
+    bool ok = (sequential == NULL) == (parallel == NULL) && (!sequential || ast_equal(sequential, parallel)) &&
+              expected.count == found.count && stats.threads <= thread_count;
+    for (size_t i = 0; ok && i < expected.count; i++) {
+        ok = expected.items[i].code == found.items[i].code && expected.items[i].offset == found.items[i].offset &&
+             expected.items[i].line == found.items[i].line;
+    }
+    *chunks = stats.chunks;
+    
+    ast_free_node(sequential);
+    ast_free_node(parallel);
+    parser_free(&parser);
+    diag_buffer_free(&expected);
+    diag_buffer_free(&found);
+    token_buffer_free(&tokens);
+    return ok;
+}
+
+void test_parallel_parse() {
+    printf("\n=== Testing Parallel Parsing ===\n");
+    
+    // Enough functions for several chunks per thread
+    size_t capacity = 200 * 96 + 64;
+    char* source = (char*)malloc(capacity);
+    char* broken = (char*)malloc(capacity + 64);
+    source[0] = '\0';
+    for (int i = 0; i < 200; i++) {
+        sprintf(source + strlen(source), "func f%d(a, b) {\n    x = [a, b * %d]\n    return f%d(x[0], b)\n}\n",
+                i, i, (i + 1) % 200);
+    }
+    strcat(source, "total = f0(1, 2)\n");
+    
+    // The same program with an error two thirds of the way in
+    char* cut = strstr(source, "func f133(");
+    size_t head = (size_t)(cut - source);
+    memcpy(broken, source, head);
+    strcpy(broken + head, "func broken(a {\n    y = (1 +\n}\n");
+    strcat(broken, cut);
+    
+    static const int THREADS[] = { 1, 2, 8 };
+    size_t chunks = 0;
+    bool ok = true;
+    for (size_t t = 0; ok && t < sizeof(THREADS) / sizeof(THREADS[0]); t++) {
+        ok = parallel_matches(source, THREADS[t], &chunks) && chunks > 1;
+        ok = ok && parallel_matches(broken, THREADS[t], &chunks);
+    }
+    // Errors in the first declaration, and a program too small to split
+    ok = ok && parallel_matches("func f( {\n}\nx = 1\n", 4, &chunks);
+    ok = ok && parallel_matches("x = 1\n", 4, &chunks) && chunks == 1;
+    
+    free(source);
+    free(broken);
+    
+    if (!ok) {
+        printf("✗ Parallel parsing test failed\n");
+        exit(1);
+    }
+    printf("✓ Parallel parsing test passed\n");
+}
+
+/* Replace removed bytes at start of source with text */
+static char* apply_edit(const char* source, size_t start, size_t removed, const char* text,
+                        SourceEdit* edit) {
+    size_t length = strlen(source);
+    size_t inserted = strlen(text);
+    char* result = (char*)malloc(length - removed + inserted + 1);
+    memcpy(result, source, start);
+    memcpy(result + start, text, inserted);
+    strcpy(result + start + inserted, source + start + removed);
+    
+    edit->start = start;
+    edit->removed = removed;
+    edit->inserted = inserted;
+    return result;
+}
+
+void test_incremental_reparse() {
+    printf("\n=== Testing Incremental Reparse ===\n");
+    
+    SourceEdit edit;
+    char* source = apply_edit(
+        "func first(a) {\n    return a + 1\n}\n"
+        "func second(b) {\n    let x = b * 2\n    return x\n}\n"
+        "func third() { return 3 }\n"
+        "func fourth() {\n    return second(first(4))\n}\n", 0, 0, "", &edit);
+    TokenBuffer tokens;
+    token_buffer_lex(&tokens, source);
+    Parser parser;
+    parser_init_tokens(&parser, &tokens, 0);
+    AstNode* program = parser_parse(&parser);
+    
+    // Each edit is {anchor, bytes removed after it, inserted text}
+    static const struct { const char* anchor; size_t removed; const char* text; } EDITS[] = {
+        { "b * 2", 1, "c" },                                  // one token in a body
+        { "return a", 0, "let y = 0\n    " },               // adds a line
+        { "func third", 0, "func extra() {}\n" },            // new declaration
+        { "func extra", 16, "" },                              // removes it again
+        { "3 }", 1, "3 + 4" },                                 // one-line body
+        { "func second", 0, "/* " },                           // comment swallows the rest
+    };
+    
+    bool ok = program != NULL;
+    size_t reused = 0;
+    for (size_t i = 0; ok && i < sizeof(EDITS) / sizeof(EDITS[0]); i++) {
+        size_t start = (size_t)(strstr(source, EDITS[i].anchor) - source);
+        char* edited = apply_edit(source, start, EDITS[i].removed, EDITS[i].text, &edit);
+        
+        ReparseStats stats;
+        program = parser_reparse(program, &tokens, edited, edit, &stats);
+        ok = program && parser_reparse_matches_full(program, &tokens) && !stats.full_reparse;
+        reused += stats.reused;
+        
+        free(source);
+        source = edited;
+    }
+    ok = ok && reused > 0;
+    ast_free_node(program);
+    token_buffer_free(&tokens);
+    free(source);
+    
+    // A declaration ends on the token after it: inserting "(b)" there
+    // turns "x = a" into a call, so it cannot be kept
+    source = apply_edit("x = a\ny = 2\n", 6, 0, "(b)\n", &edit);
+    token_buffer_lex(&tokens, "x = a\ny = 2\n");
+    parser_init_tokens(&parser, &tokens, 0);
+    program = parser_parse(&parser);
+    ok = ok && program;
+    if (program) {
+        ReparseStats stats;
+        program = parser_reparse(program, &tokens, source, edit, &stats);
+        ok = ok && program && parser_reparse_matches_full(program, &tokens) &&
+             program->as.program.declarations->count == 2;
+    }
+    ast_free_node(program);
+    token_buffer_free(&tokens);
+    free(source);
+    
+    if (!ok) {
+        printf("✗ Incremental reparse test failed\n");
+        exit(1);
+    }
+    printf("✓ Incremental reparse test passed\n");
+}
+
+void test_diagnostics() {
+    printf("\n=== Testing Diagnostics Buffer ===\n");
+    
+    // Three broken statements; recovery reports each of them once
+    const char* source =
+        "func f(a {\n"
+        "    print(1 2)\n"
+        "    x = (3 +\n"
+        "}\n"
+        "y = [1, 2\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
+    parser_init(&parser, &lexer);
+    parser_set_diagnostics(&parser, &diags);
+    AstNode* program = parser_parse(&parser);
+    
+    static const DiagCode EXPECTED[] = {
+        DIAG_EXPECTED_TOKEN, DIAG_EXPECTED_TOKEN, DIAG_EXPECTED_EXPRESSION, DIAG_EXPECTED_TOKEN
+    };
+    bool ok = program == NULL && diags.count == 4 && diags.error_count == 4;
+    for (size_t i = 0; ok && i < diags.count; i++) {
+        ok = diags.items[i].code == EXPECTED[i];
+    }
+    // Spans point into the source: the first error is at '{'
+    ok = ok && diags.items[0].offset == 9 && diags.items[0].length == 1;
+    
+    diag_buffer_free(&diags);
+    
+    if (!ok) {
+        printf("✗ Diagnostics test failed\n");
+        exit(1);
+    }
+    printf("✓ Diagnostics test passed\n");
+}
+
+void test_constant_folding() {
+    printf("\n=== Testing Constant Folding ===\n");
+    
+    const char* source =
+        "a = (2 + 3) * 4\n"
+        "b = ~x * 1 + 0\n"
+        "c = !!(n > 1)\n"
+        "d = 7 / 0\n"
+        "e = \"ab\" + \"cd\"\n"
+        "f = 9223372036854775807 + 1\n"
+        "g = -(-(~y))\n"
+        "h = 7 / -2 == -3\n"
+        "i = s + 0\n"
+        "j = !!5\n"
+        "k = -(-z) * 1\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    parser_enable_constant_folding(&parser, true);
+    AstNode* program = parser_parse(&parser);
+    
+    AstNode* init[11] = { NULL };
+    bool ok = program && program->as.program.declarations->count == 11;
+    for (size_t i = 0; ok && i < 11; i++) {
+        init[i] = ((AstNode*)program->as.program.declarations->items[i])->as.var_decl.initializer;
+    }
+    
+    ok = ok &&
+        init[0]->type == AST_LITERAL_EXPR && init[0]->as.literal.as.int_value == 20 &&
+        init[1]->type == AST_UNARY_EXPR && init[1]->as.unary.op == OP_BIT_NOT &&
+        init[2]->type == AST_BINARY_EXPR && init[2]->as.binary.op == OP_GT &&
+        init[3]->type == AST_BINARY_EXPR &&                       // division by zero stays
+        init[4]->type == AST_LITERAL_EXPR && strcmp(init[4]->as.literal.as.string_value, "abcd") == 0 &&
+        init[5]->type == AST_LITERAL_EXPR && init[5]->as.literal.as.int_value == LONG_MIN &&
+        init[6]->type == AST_UNARY_EXPR && init[6]->as.unary.op == OP_BIT_NOT &&
+        init[7]->type == AST_LITERAL_EXPR && init[7]->as.literal.as.bool_value &&
+        // Operands of unknown type keep their operators: s may be a string
+        init[8]->type == AST_BINARY_EXPR && init[8]->as.binary.op == OP_ADD &&
+        init[9]->type == AST_UNARY_EXPR && init[9]->as.unary.operand->type == AST_UNARY_EXPR &&
+        init[10]->type == AST_BINARY_EXPR && init[10]->as.binary.left->type == AST_UNARY_EXPR;
+    
+    ast_free_node(program);
+    
+    if (!ok) {
+        printf("✗ Constant folding test failed\n");
+        exit(1);
+    }
+    printf("✓ Constant folding test passed\n");
+}
+
+#define MAX_TEST_EVENTS 64
+
+typedef struct {
+    ParseEvent events[MAX_TEST_EVENTS];
+    size_t count;
+} EventLog;
+
+static void record_event(const ParseEvent* event, void* context) {
+    EventLog* log = (EventLog*)context;
+    if (log->count < MAX_TEST_EVENTS) log->events[log->count] = *event;
+    log->count++;
+}
+
+void test_event_stream() {
+    printf("\n=== Testing Event-Stream Parser ===\n");
+    
+    const char* source =
+        "func add(a, b) {\n"
+        "    return a + b\n"
+        "}\n"
+        "func main() {\n"
+        "    x = add(1, 2)\n"
+        "    print(add(x, 3))\n"
+        "}\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    StringInterner* interner = string_interner_create();
+    EventLog log = { .count = 0 };
+    bool ok = parser_parse_events(&parser, interner, record_event, &log);
+    ok = ok && log.count <= MAX_TEST_EVENTS;
+    
+    // ENTER/EXIT nest; calls come after their operands and carry the callee
+    uint32_t add_id = string_intern(interner, "add", 3);
+    int depth = 0;
+    size_t calls = 0, add_calls = 0;
+    for (size_t i = 0; ok && i < log.count; i++) {
+        ParseEvent* event = &log.events[i];
+        if (event->kind == PARSE_EVENT_ENTER) depth++;
+        if (event->kind == PARSE_EVENT_EXIT) ok = --depth >= 0;
+        if (event->kind == PARSE_EVENT_REDUCE && event->node == AST_CALL_EXPR) {
+            calls++;
+            if (event->name_id == add_id) add_calls++;
+        }
+    }
+    ok = ok && depth == 0 && calls == 3 && add_calls == 2 && string_interner_count(interner) == 6;
+    
+    // The first function's EXIT spans it exactly
+    for (size_t i = 0; ok && i < log.count; i++) {
+        ParseEvent* event = &log.events[i];
+        if (event->kind == PARSE_EVENT_EXIT && event->node == AST_FUNCTION_DECL) {
+            ok = event->offset == 0 && event->length == 35;
+            break;
+        }
+    }
+    
+    // The outer print call closes its callee and one argument
+    ParseEvent* last_call = NULL;
+    for (size_t i = 0; ok && i < log.count; i++) {
+        if (log.events[i].node == AST_CALL_EXPR) last_call = &log.events[i];
+    }
+    ok = ok && last_call && last_call->arity == 2 && last_call->name_length == 5 &&
+         strncmp(last_call->name, "print", 5) == 0;
+    
+    parser_free(&parser);
+    string_interner_free(interner);
+    
+    // Errors match the tree parser's
+    const char* broken = "func f(a {\n    print(1 2)\n}\ny = [1, 2\n";
+    DiagBuffer tree_diags, event_diags;
+    diag_buffer_init(&tree_diags);
+    diag_buffer_init(&event_diags);
+    
+    lexer_init(&lexer, broken);
+    parser_init(&parser, &lexer);
+    parser_set_diagnostics(&parser, &tree_diags);
+    ast_free_node(parser_parse(&parser));
+    parser_free(&parser);
+    
+    lexer_init(&lexer, broken);
+    parser_init(&parser, &lexer);
+    parser_set_diagnostics(&parser, &event_diags);
+    log.count = 0;
+    ok = ok && !parser_parse_events(&parser, NULL, record_event, &log);
+    parser_free(&parser);
+    
+    ok = ok && tree_diags.count == 3 && event_diags.count == tree_diags.count;
+    for (size_t i = 0; ok && i < tree_diags.count; i++) {
+        ok = tree_diags.items[i].code == event_diags.items[i].code &&
+             tree_diags.items[i].offset == event_diags.items[i].offset;
+    }
+    diag_buffer_free(&tree_diags);
+    diag_buffer_free(&event_diags);
+    
+    // Imports are reported like any other declaration, named after the module
+    lexer_init(&lexer, "import math\nfunc main() {\n    x = 1\n}\n");
+    parser_init(&parser, &lexer);
+    log.count = 0;
+    ok = ok && parser_parse_events(&parser, NULL, record_event, &log);
+    parser_free(&parser);
+    ok = ok && log.count > 2 && log.events[1].kind == PARSE_EVENT_ENTER && log.events[1].node == AST_IMPORT_STMT &&
+         log.events[1].name_length == 4 && strncmp(log.events[1].name, "math", 4) == 0 &&
+         log.events[2].kind == PARSE_EVENT_EXIT && log.events[2].length == 11;
+    
+    if (!ok) {
+        printf("✗ Event-stream parser test failed\n");
+        exit(1);
+    }
+    printf("✓ Event-stream parser test passed\n");
+}
+
+/* Every constant key must find its own entry through the layout */
+static bool layout_finds_keys(AstNode* dict) {
+    DictLayout* layout = dict->as.dict.layout;
+    AstList* entries = dict->as.dict.entries;
+    if (!layout || layout->count != entries->count || layout->capacity < entries->count) return false;
+    
+    for (size_t i = 0; i < entries->count; i++) {
+        uint64_t hash;
+        if (!ast_dict_key_hash(((DictEntry*)entries->items[i])->key, &hash)) return false;
+        if (layout->slots[ast_dict_slot(layout, hash)] != i + 1) return false;
+    }
+    return true;
+}
+
+void test_dict_literals() {
+    printf("\n=== Testing Dictionary Literals ===\n");
+    
+    // A large literal with string and int keys, then a small mixed one
+    size_t size = 64 + 1000 * 24;
+    char* source = (char*)malloc(size);
+    size_t used = (size_t)snprintf(source, size, "big = {\n");
+    for (int i = 0; i < 1000; i++) {
+        used += (size_t)snprintf(source + used, size - used,
+                                 i % 2 ? "    \"k%d\": %d,\n" : "    %d: %d,\n", i, i);
+    }
+    snprintf(source + used, size - used, "}\nsmall = { name: 1, \"x\": 2 }\n");
+    
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    
+    bool ok = program && program->as.program.declarations->count == 2;
+    AstNode* big = ok ? ((AstNode*)program->as.program.declarations->items[0])->as.var_decl.initializer : NULL;
+    AstNode* small = ok ? ((AstNode*)program->as.program.declarations->items[1])->as.var_decl.initializer : NULL;
+    ok = ok && big->type == AST_DICT_EXPR && big->as.dict.entries->count == 1000 &&
+         big->as.dict.constant_keys && layout_finds_keys(big) &&
+         small->type == AST_DICT_EXPR && !small->as.dict.constant_keys && !small->as.dict.layout;
+    
+    ast_free_node(program);
+    free(source);
+    
+    // Repeated constant keys are an error pointing at the second one
+    const char* repeated = "d = { 1: \"a\", \"1\": \"b\", 1: \"c\" }\n";
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
+    lexer_init(&lexer, repeated);
+    parser_init(&parser, &lexer);
+    parser_set_diagnostics(&parser, &diags);
+    program = parser_parse(&parser);
+    
+    ok = ok && program == NULL && diags.count == 1 && diags.items[0].code == DIAG_DUPLICATE_KEY &&
+         diags.items[0].offset == 24;
+    diag_buffer_free(&diags);
+    
+    if (!ok) {
+        printf("✗ Dictionary literal test failed\n");
+        exit(1);
+    }
+    printf("✓ Dictionary literal test passed\n");
+}
+
+void test_class_layout() {
+    printf("\n=== Testing Class Layout ===\n");
+    
+    const char* source =
+        "class Particle {\n"
+        "    alive: bool\n"
+        "    name: string\n"
+        "    hot x: f32\n"
+        "    mass: float\n"
+        "    id: i16\n"
+        "    hot y: f32\n"
+        "    func move(dx) {\n"
+        "        this.x = this.x + dx\n"
+        "    }\n"
+        "}\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    
+    bool ok = program && program->as.program.declarations->count == 1;
+    AstNode* class_node = ok ? (AstNode*)program->as.program.declarations->items[0] : NULL;
+    ok = ok && class_node->type == AST_CLASS_DECL &&
+         class_node->as.class_decl.fields->count == 6 &&
+         class_node->as.class_decl.methods->count == 1;
+    
+    // Hot x and y lead, then the rest by alignment
+    static const uint32_t FIELDS[] = { 2, 5, 1, 3, 4, 0 };
+    static const uint32_t OFFSETS[] = { 0, 4, 8, 16, 24, 26 };
+    ClassLayout* layout = ok ? class_node->as.class_decl.layout : NULL;
+    ok = ok && layout && layout->count == 6 && layout->size == 32 && layout->align == 8 &&
+         layout->padding == 5 && layout->declared_size == 40 && layout->hot_end == 8;
+    for (uint32_t i = 0; ok && i < layout->count; i++) {
+        ok = layout->slots[i].field == FIELDS[i] && layout->slots[i].offset == OFFSETS[i];
+    }
+    
+    // this.x = ... is an assignment to a member of 'this'
+    if (ok) {
+        AstNode* method = (AstNode*)class_node->as.class_decl.methods->items[0];
+        AstNode* stmt = (AstNode*)method->as.function.body->as.block.statements->items[0];
+        AstNode* target = stmt->type == AST_ASSIGN_STMT ? stmt->as.assign.target : NULL;
+        ok = target && target->type == AST_MEMBER_EXPR &&
+             strcmp(target->as.member.member, "x") == 0 &&
+             target->as.member.object->type == AST_IDENTIFIER_EXPR &&
+             strcmp(target->as.member.object->as.identifier, "this") == 0;
+    }
+    
+    ast_free_node(program);
+    
+    if (!ok) {
+        printf("✗ Class layout test failed\n");
+        exit(1);
+    }
+    printf("✓ Class layout test passed\n");
+}
+
+void test_parse_stats() {
+    printf("\n=== Testing Parse Statistics ===\n");
+    
+    const char* source = "xs = [1, 2]\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    parse_stats_reset();
+    AstNode* program = parser_parse(&parser);
+    ParseStats stats;
+    parse_stats_snapshot(&stats);
+    ast_free_node(program);
+    
+    bool ok = program != NULL;
+    if (stats.enabled) {
+        // A top-level assignment declares xs
+        ok = ok && stats.tokens > 0 && stats.match_hits <= stats.match_calls &&
+             stats.nodes[AST_VAR_DECL] == 1 && stats.nodes[AST_LITERAL_EXPR] == 2 &&
+             stats.nodes[AST_ARRAY_EXPR] == 1 && stats.nodes[AST_PROGRAM] == 1 &&
+             stats.bytes[STATS_BYTES_NODES] == 5 * sizeof(AstNode) &&
+             stats.bytes[STATS_BYTES_STRINGS] == 3;
+    } else {
+        // Without LAMC_STATS the counters stay at zero
+        ok = ok && stats.tokens == 0 && stats.match_calls == 0 &&
+             stats.nodes[AST_IDENTIFIER_EXPR] == 0 && stats.bytes[STATS_BYTES_NODES] == 0;
+    }
+    
+    if (!ok) {
+        printf("✗ Parse statistics test failed\n");
+        exit(1);
+    }
+    printf("✓ Parse statistics test passed (%s)\n",
+           stats.enabled ? "counters enabled" : "counters compiled out");
+}
+
+/* Source text of a node's span */
+static bool span_is(const char* source, AstNode* node, const char* text) {
+    return node && node->length == strlen(text) &&
+           memcmp(source + node->offset, text, node->length) == 0;
+}
+
+void test_source_spans() {
+    printf("\n=== Testing Source Spans ===\n");
+    
+    const char* source =
+        "func area(w, h) {\n"
+        "    r = (w + 1) * h\n"
+        "    print(r, -w)\n"
+        "    return items[0].size\n"
+        "}\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    
+    bool ok = program && program->offset == 0 && program->length == strlen(source);
+    AstNode* func = ok ? (AstNode*)program->as.program.declarations->items[0] : NULL;
+    AstList* stmts = ok ? func->as.function.body->as.block.statements : NULL;
+    // The function runs up to its '}', without the final newline
+    ok = ok && stmts->count == 3 && func->offset == 0 && func->length == strlen(source) - 1;
+    
+    if (ok) {
+        AstNode* decl = (AstNode*)stmts->items[0];
+        AstNode* product = decl->as.var_decl.initializer;
+        ok = span_is(source, decl, "r = (w + 1) * h") &&
+             span_is(source, product, "(w + 1) * h") &&
+             span_is(source, product->as.binary.left, "w + 1");
+    }
+    
+    // The call's position is its '(' and its span runs from the callee
+    AstNode* call = NULL;
+    if (ok) {
+        AstNode* stmt = (AstNode*)stmts->items[1];
+        call = stmt->as.expr_stmt;
+        ok = span_is(source, stmt, "print(r, -w)") && span_is(source, call, "print(r, -w)") &&
+             span_is(source, (AstNode*)call->as.call.arguments->items[1], "-w");
+    }
+    
+    if (ok) {
+        AstNode* ret = (AstNode*)stmts->items[2];
+        AstNode* member = ret->as.return_stmt.value;
+        ok = span_is(source, ret, "return items[0].size") &&
+             span_is(source, member, "items[0].size") &&
+             span_is(source, member->as.member.object, "items[0]");
+    }
+    
+    // Line table lookups agree with the lexer's line of the call
+    LineTable lines;
+    ok = ok && line_table_build(&lines, source);
+    if (ok) {
+        int line, column;
+        line_table_locate(&lines, call->offset, &line, &column);
+        ok = lines.count == 6 && line == 3 && column == 5 && call->line == 3 &&
+             source[line_table_line_start(&lines, 3) + (size_t)column - 1] == 'p';
+        line_table_locate(&lines, strlen(source), &line, &column);
+        ok = ok && line == 6 && column == 1;
+        line_table_free(&lines);
+    }
+    
+    ast_free_node(program);
+    
+    if (!ok) {
+        printf("✗ Source span test failed\n");
+        exit(1);
+    }
+    printf("✓ Source span test passed\n");
+}
+
+/* Parse with the given nesting limit; returns the program (NULL on error)
+ * and the first diagnostic's code */
+static AstNode* parse_nested(const char* source, size_t limit, DiagCode* first) {
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
+    parser_init(&parser, &lexer);
+    parser_set_diagnostics(&parser, &diags);
+    parser_set_nesting_limit(&parser, limit);
+    AstNode* program = parser_parse(&parser);
+    *first = diags.count > 0 ? diags.items[0].code : DIAG_SYNTAX;
+    bool failed = parser.had_error;
+    parser_free(&parser);
+    diag_buffer_free(&diags);
+    if (failed && program) {
+        ast_free_node(program);
+        return NULL;
+    }
+    return program;
+}
+
+void test_deep_nesting() {
+    printf("\n=== Testing Deep Nesting ===\n");
+    
+    enum { ARMS = 10000, TERMS = 100000, PARENS = 100 };
+    char* source = malloc((size_t)ARMS * 32 + (size_t)TERMS * 4 + 64);
+    DiagCode code;
+    bool ok = true;
+    
+    // A 10k-arm else-if chain nests 10k ifs deep but parses in a loop
+    char* out = source;
+    for (int i = 0; i < ARMS; i++) {
+        out += sprintf(out, "%sif x == %d { y = %d }\n", i > 0 ? "else " : "", i, i);
+    }
+    sprintf(out, "else { y = 0 }\n");
+    AstNode* program = parse_nested(source, PARSER_DEFAULT_NESTING_LIMIT, &code);
+    size_t arms = 0;
+    if (program && program->as.program.declarations->count == 1) {
+        AstNode* node = (AstNode*)program->as.program.declarations->items[0];
+        for (; node && node->type == AST_IF_STMT; node = node->as.if_stmt.else_branch) arms++;
+    }
+    ok = ok && arms == ARMS;
+    ast_free_node(program);
+    
+    // So does a long left-associative operator chain
+    out = source;
+    out += sprintf(out, "z = 1");
+    for (int i = 1; i < TERMS; i++) out += sprintf(out, " + 1");
+    sprintf(out, "\n");
+    program = parse_nested(source, PARSER_DEFAULT_NESTING_LIMIT, &code);
+    ok = ok && program != NULL;
+    ast_free_node(program);
+    
+    // Parentheses count against the limit: fine within it, E0104 beyond
+    out = source;
+    out += sprintf(out, "z = ");
+    for (int i = 0; i < PARENS; i++) *out++ = '(';
+    *out++ = '1';
+    for (int i = 0; i < PARENS; i++) *out++ = ')';
+    sprintf(out, "\n");
+    program = parse_nested(source, PARSER_DEFAULT_NESTING_LIMIT, &code);
+    ok = ok && program != NULL;
+    ast_free_node(program);
+    program = parse_nested(source, PARENS / 2, &code);
+    ok = ok && program == NULL && code == DIAG_NESTING_LIMIT;
+    
+    // Statements too: blocks nested past the limit are an error, not a crash
+    out = source;
+    for (int i = 0; i < ARMS; i++) out += sprintf(out, "while x {");
+    for (int i = 0; i < ARMS; i++) *out++ = '}';
+    sprintf(out, "\n");
+    program = parse_nested(source, PARSER_DEFAULT_NESTING_LIMIT, &code);
+    ok = ok && program == NULL && code == DIAG_NESTING_LIMIT;
+    
+    free(source);
+    
+    if (!ok) {
+        printf("✗ Deep nesting test failed\n");
+        exit(1);
+    }
+    printf("✓ Deep nesting test passed\n");
+}
+
+void test_checkpoints() {
+    printf("\n=== Testing Parser Checkpoints ===\n");
+    
+    const char* source = "a + (b * c\nx + 1\n";
+    bool ok = true;
+    
+    // Streaming: a failed speculation leaves no trace, arena nodes included
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstArena* arena = ast_arena_create();
+    AstArena* previous = ast_use_arena(arena);
+    
+    ParserCheckpoint checkpoint = parser_checkpoint(&parser);
+    size_t bytes = arena->total_bytes;
+    parser_parse_expression(&parser);
+    ok = ok && parser.had_error && parser.diags->count == 1 && arena->total_bytes > bytes;
+    parser_rewind(&parser, &checkpoint);
+    ok = ok && !parser.had_error && !parser.panic_mode && parser.diags->count == 0 &&
+         arena->total_bytes == bytes && parser.current.start == source;
+    
+    // Reading again after the rewind sees the same tokens
+    parser_advance(&parser);
+    parser_advance(&parser);
+    ok = ok && parser.current.type == TOKEN_LEFT_PAREN;
+    
+    ast_use_arena(previous);
+    ast_arena_free(arena);
+    parser_free(&parser);
+    
+    // Buffered: the checkpoint is a token index
+    TokenBuffer buffer;
+    ok = ok && token_buffer_lex(&buffer, source);
+    parser_init_tokens(&parser, &buffer, 0);
+    parser_advance(&parser);
+    checkpoint = parser_checkpoint(&parser);
+    Token plus = parser.current;
+    parser_advance(&parser);
+    parser_advance(&parser);
+    parser_rewind(&parser, &checkpoint);
+    ok = ok && parser.current.start == plus.start && parser.position == checkpoint.position;
+    parser_free(&parser);
+    token_buffer_free(&buffer);
+    
+    // An identifier-led statement that is no declaration is a full expression
+    lexer_init(&lexer, "x + 1\nf(2) * 3\n");
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    ok = ok && program && program->as.program.declarations->count == 2;
+    for (size_t i = 0; ok && i < 2; i++) {
+        AstNode* stmt = (AstNode*)program->as.program.declarations->items[i];
+        ok = stmt->type == AST_EXPR_STMT && stmt->as.expr_stmt->type == AST_BINARY_EXPR;
+    }
+    ast_free_node(program);
+    parser_free(&parser);
+    
+    if (!ok) {
+        printf("✗ Parser checkpoint test failed\n");
+        exit(1);
+    }
+    printf("✓ Parser checkpoint test passed\n");
+}
+
+/* Emit node into memory and compare with expected */
+static bool emits(AstNode* node, AstEmitFormat format, int indent, const char* expected) {
+    AstEmitter out;
+    ast_emitter_init(&out, -1);
+    ast_emit(&out, node, format, indent);
+    bool ok = !out.failed && strcmp(out.data, expected) == 0;
+    if (!ok) printf("  got: %s\n", out.failed ? "(failed)" : out.data);
+    ast_emitter_free(&out);
+    return ok;
+}
+
+void test_emitters() {
+    printf("\n=== Testing AST Emitters ===\n");
+    
+    const char* source = "f(a, 2) + -x\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+    
+    bool ok = program != NULL;
+    ok = ok && emits(program, AST_EMIT_SEXPR, 0, "(program (expr (+ (call f a 2) (- x))))\n");
+    AstNode* call = ok ? ((AstNode*)program->as.program.declarations->items[0])->as.expr_stmt->as.binary.left : NULL;
+    ok = ok && emits(call, AST_EMIT_PRETTY, 1,
+                     "  CallExpr\n"
+                     "    callee:\n"
+                     "      Identifier (f)\n"
+                     "    arguments:\n"
+                     "      Identifier (a)\n"
+                     "      Literal (int: 2)\n");
+    // Columns are where the lexer left each token
+    ok = ok && emits(call, AST_EMIT_JSON, 0,
+                     "{\"type\":\"CallExpr\",\"line\":1,\"column\":3,\"offset\":0,\"length\":7,"
+                     "\"callee\":{\"type\":\"Identifier\",\"line\":1,\"column\":2,\"offset\":0,\"length\":1,\"name\":\"f\"},"
+                     "\"arguments\":[{\"type\":\"Identifier\",\"line\":1,\"column\":4,\"offset\":2,\"length\":1,\"name\":\"a\"},"
+                     "{\"type\":\"Literal\",\"line\":1,\"column\":7,\"offset\":5,\"length\":1,\"literal\":\"int\",\"value\":2}]}\n");
+    ast_free_node(program);
+    
+    // Strings are escaped; indentation deeper than the space buffer is fine
+    AstNode* text = ast_create_literal_string("a\"b\n", 1, 1);
+    ok = ok && emits(text, AST_EMIT_SEXPR, 0, "\"a\\\"b\\n\"\n");
+    char expected[512];
+    memset(expected, ' ', 400);
+    strcpy(expected + 400, "Literal (int: -7)\n");
+    AstNode* number = ast_create_literal_int(-7, 1, 1);
+    ok = ok && emits(number, AST_EMIT_PRETTY, 200, expected);
+    ast_free_node(text);
+    ast_free_node(number);
+    
+    if (!ok) {
+        printf("✗ AST emitter test failed\n");
+        exit(1);
+    }
+    printf("✓ AST emitter test passed\n");
+}
+
+void test_tree_index() {
+    printf("\n=== Testing Tree Index ===\n");
+    
+    const char* source =
+        "func f(n) {\n"
+        "    while n > 0 {\n"
+        "        if n == 3 { break }\n"
+        "        n = n - 1\n"
+        "    }\n"
+        "}\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+    
+    AstIndex index;
+    bool ok = program && ast_index_build(&index, program);
+    ok = ok && index.nodes[0] == program && index.size[0] == index.count &&
+         ast_index_parent(&index, 0) == NULL;
+    
+    // Ids map back to their nodes, and every node lies inside its parent
+    for (uint32_t id = 0; ok && id < index.count; id++) {
+        ok = ast_index_id(&index, index.nodes[id]) == id &&
+             (id == 0 || ast_index_is_ancestor(&index, index.parent[id], id));
+    }
+    
+    // Cursor on 'break': innermost node, its loop and its function
+    size_t offset = (size_t)(strstr(source, "break") - source);
+    uint32_t brk = ok ? ast_index_at_offset(&index, offset) : AST_INDEX_NONE;
+    ok = ok && brk != AST_INDEX_NONE && index.nodes[brk]->type == AST_BREAK_STMT;
+    if (ok) {
+        uint32_t loop = ast_index_enclosing(&index, brk, AST_TYPE_BIT(AST_WHILE_STMT) |
+                                            AST_TYPE_BIT(AST_FOR_STMT) | AST_TYPE_BIT(AST_LOOP_STMT));
+        uint32_t func = ast_index_enclosing(&index, brk, AST_TYPE_BIT(AST_FUNCTION_DECL));
+        ok = loop != AST_INDEX_NONE && index.nodes[loop]->type == AST_WHILE_STMT &&
+             func == 1 && ast_index_is_ancestor(&index, func, brk) &&
+             !ast_index_is_ancestor(&index, brk, func) &&
+             ast_index_parent(&index, brk)->type == AST_BLOCK_STMT;
+    }
+    
+    // The '3' is a literal inside the comparison; past the end is nothing
+    offset = (size_t)(strchr(source, '3') - source);
+    uint32_t three = ok ? ast_index_at_offset(&index, offset) : AST_INDEX_NONE;
+    ok = ok && three != AST_INDEX_NONE && index.nodes[three]->type == AST_LITERAL_EXPR &&
+         ast_index_parent(&index, three)->type == AST_BINARY_EXPR &&
+         ast_index_at_offset(&index, strlen(source) + 10) == AST_INDEX_NONE;
+    
+    if (program) ast_index_free(&index);
+    ast_free_node(program);
+    
+    if (!ok) {
+        printf("✗ Tree index test failed\n");
+        exit(1);
+    }
+    printf("✓ Tree index test passed\n");
+}
+
+void test_persistent_ast() {
+    printf("\n=== Testing Persistent AST ===\n");
+    
+    const char* source =
+        "func f(x) {\n"
+        "    y = x + 1\n"
+        "    return y\n"
+        "}\n"
+        "func g() { return 2 }\n";
+    const char* before =
+        "(program (func f (x) _ (block (var y _ (+ x 1)) (return y))) (func g () _ (block (return 2))))\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+    bool ok = program != NULL;
+    
+    // f, its body, 'y = ...', the sum, the literal 1
+    size_t path[] = { 0, 1, 0, 0, 1 };
+    AstNode* edited = ok ? ast_persist_replace(program, path, 5, ast_create_literal_int(5, 2, 13)) : NULL;
+    ok = ok && edited && emits(program, AST_EMIT_SEXPR, 0, before) &&
+         emits(edited, AST_EMIT_SEXPR, 0,
+               "(program (func f (x) _ (block (var y _ (+ x 5)) (return y))) (func g () _ (block (return 2))))\n");
+    
+    // Only the path was copied: g and 'return y' are shared
+    AstNode* body = ast_child_at(ast_child_at(program, 0), 1);
+    ok = ok && ast_child_at(edited, 0) != ast_child_at(program, 0) &&
+         ast_child_at(edited, 1) == ast_child_at(program, 1) && ast_child_at(program, 1)->refcount == 2 &&
+         ast_child_at(ast_child_at(ast_child_at(edited, 0), 1), 1) == ast_child_at(body, 1);
+    
+    // List edits and an invalid path
+    AstNode* inserted = ok ? ast_persist_insert(edited, path, 2, 2, ast_create_break(3, 5)) : NULL;
+    AstNode* removed = inserted ? ast_persist_remove(inserted, NULL, 0, 0) : NULL;
+    size_t outside[] = { 5 };
+    ok = ok && inserted && removed &&
+         emits(ast_child_at(inserted, 0), AST_EMIT_SEXPR, 0,
+               "(func f (x) _ (block (var y _ (+ x 5)) (return y) (break)))\n") &&
+         emits(removed, AST_EMIT_SEXPR, 0, "(program (func g () _ (block (return 2))))\n") &&
+         ast_persist_replace(program, outside, 1, NULL) == NULL;
+    
+    // A snapshot outlives the original owner and every later version
+    AstSnapshot snapshot = ast_snapshot(program);
+    ast_free_node(program);
+    ast_free_node(edited);
+    ast_free_node(removed);
+    ok = ok && snapshot.root == program && emits(snapshot.root, AST_EMIT_SEXPR, 0, before);
+    ast_snapshot_release(&snapshot);
+    ast_free_node(inserted);
+    
+    if (!ok) {
+        printf("✗ Persistent AST test failed\n");
+        exit(1);
+    }
+    printf("✓ Persistent AST test passed\n");
+}
+
 int main() {
     printf("====================================\n");
     printf("   LAMC AST Module Test Suite\n");
@@ -195,6 +1268,23 @@ int main() {
     test_control_flow();
     test_array();
     test_complete_program();
+    test_hashing();
+    test_hash_consing();
+    test_lazy_bodies();
+    test_parallel_parse();
+    test_incremental_reparse();
+    test_diagnostics();
+    test_constant_folding();
+    test_event_stream();
+    test_dict_literals();
+    test_class_layout();
+    test_parse_stats();
+    test_source_spans();
+    test_deep_nesting();
+    test_checkpoints();
+    test_emitters();
+    test_tree_index();
+    test_persistent_ast();
     
     printf("\n====================================\n");
     printf("✓ All AST tests passed successfully!\n");
@@ -5,18 +5,90 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "parser/parser.h"
+#include "parser/ast_emit.h"
+#include "parser/stats.h"
 #include "lexer/lexer.h"
 
+/* Print top-level function signatures without parsing any body */
+static int print_outline(const char* source) {
+    TokenBuffer tokens;
+    if (!token_buffer_lex(&tokens, source)) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return 1;
+    }
+    
+    Parser parser;
+    parser_init_tokens(&parser, &tokens, 0);
+    parser_enable_lazy_bodies(&parser, true);
+    AstNode* program = parser_parse(&parser);
+    
+    if (!program) {
+        printf("✗ Parsing failed with errors.\n");
+        token_buffer_free(&tokens);
+        return 1;
+    }
+    
+    AstList* decls = program->as.program.declarations;
+    for (size_t i = 0; i < decls->count; i++) {
+        AstNode* decl = (AstNode*)decls->items[i];
+        if (decl->type != AST_FUNCTION_DECL) continue;
+        
+        FunctionDecl* func = &decl->as.function;
+        printf("%d: func %s(", decl->line, func->name);
+        for (size_t j = 0; j < func->parameters->count; j++) {
+            Parameter* param = (Parameter*)func->parameters->items[j];
+            printf("%s%s", j > 0 ? ", " : "", param->name);
+            if (param->type_name) printf(": %s", param->type_name);
+        }
+        printf(")");
+        if (func->return_type) printf(" -> %s", func->return_type);
+        printf("\n");
+    }
+    
+    ast_free_node(program);
+    token_buffer_free(&tokens);
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     const char* source;
+    const char* path = NULL;
     bool from_file = false;
+    bool outline = false;
+    bool json_diagnostics = false;
+    bool fold = false;
+    bool stats = false;
+    bool stats_json = false;
+    AstEmitFormat format = AST_EMIT_PRETTY;
     
-    if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--outline") == 0) {
+            outline = true;
+        } else if (strcmp(argv[i], "--diagnostics=json") == 0) {
+            json_diagnostics = true;
+        } else if (strcmp(argv[i], "--fold") == 0) {
+            fold = true;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            stats_json = true;
+        } else if (strcmp(argv[i], "--format=json") == 0) {
+            format = AST_EMIT_JSON;
+        } else if (strcmp(argv[i], "--format=sexpr") == 0) {
+            format = AST_EMIT_SEXPR;
+        } else {
+            path = argv[i];
+        }
+    }
+    
+    if (path) {
         /* Read from file */
-        FILE* file = fopen(argv[1], "r");
+        FILE* file = fopen(path, "r");
         if (!file) {
-            fprintf(stderr, "Error: Could not open file '%s'\n", argv[1]);
+            fprintf(stderr, "Error: Could not open file '%s'\n", path);
             return 1;
         }
         
@@ -32,7 +104,7 @@ int main(int argc, char* argv[]) {
         source = file_source;
         from_file = true;
         
-        printf("Parsing: %s\n\n", argv[1]);
+        printf("Parsing: %s\n\n", path);
     } else {
         /* Use inline test */
         source = 
@@ -45,28 +117,63 @@ int main(int argc, char* argv[]) {
         printf("---\n%s---\n\n", source);
     }
     
+    if (outline) {
+        int status = print_outline(source);
+        if (from_file) free((void*)source);
+        return status;
+    }
+    
     /* Initialize lexer */
     Lexer lexer;
     lexer_init(&lexer, source);
     
-    /* Initialize parser */
+    /* Initialize parser; errors are collected and rendered afterwards */
     Parser parser;
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
     parser_init(&parser, &lexer);
+    parser_set_diagnostics(&parser, &diags);
+    parser_enable_constant_folding(&parser, fold);
     
     /* Parse */
     printf("Parsing...\n\n");
+    parse_stats_reset();
     AstNode* program = parser_parse(&parser);
+    ParseStats parse_stats;
+    parse_stats_snapshot(&parse_stats);
+    
+    if (json_diagnostics) {
+        diag_render_json(&diags, source, path, stdout);
+    } else if (diags.count > 0) {
+        fflush(stdout);
+        diag_render_text(&diags, source, path, stderr);
+        fprintf(stderr, "\n%zu error%s\n", diags.error_count, diags.error_count == 1 ? "" : "s");
+    }
+    diag_buffer_free(&diags);
     
-    if (program && !parser.had_error) {
+    bool ok = program && !parser.had_error;
+    if (ok) {
         printf("✓ Parsing successful!\n\n");
-        ast_print_program(program);
-        ast_free_node(program);
-        
-        if (from_file) free((void*)source);
-        return 0;
+        if (format == AST_EMIT_PRETTY) {
+            ast_print_program(program);
+        } else {
+            AstEmitter out;
+            fflush(stdout);
+            ast_emitter_init(&out, STDOUT_FILENO);
+            ast_emit_program(&out, program, format);
+            ast_emitter_free(&out);
+        }
     } else {
         printf("✗ Parsing failed with errors.\n");
-        if (from_file) free((void*)source);
-        return 1;
     }
+    ast_free_node(program);
+    
+    if (stats) {
+        printf("\n");
+        parse_stats_print(&parse_stats, stdout);
+    }
+    if (stats_json) parse_stats_print_json(&parse_stats, stdout);
+    
+    if (from_file) free((void*)source);
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,861 @@
+/* LAMC Compiler - Semantic Analysis Test Program
+ * Tests symbol tables, name resolution, type inference, specialization
+ * module compilation and incremental checking
+ * Copyright (c) 2025 Naveen Singh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "parser/incremental.h"
+#include "parser/intern.h"
+#include "parser/parser.h"
+#include "semantic/decl_graph.h"
+#include "semantic/infer.h"
+#include "semantic/modules.h"
+#include "semantic/resolve.h"
+#include "semantic/specialize.h"
+#include "semantic/symbol_table.h"
+
+void test_symbol_scopes() {
+    printf("\n=== Testing Symbol Scopes ===\n");
+
+    StringInterner* names = string_interner_create();
+    uint32_t x = string_intern(names, "x", 1);
+    uint32_t y = string_intern(names, "y", 1);
+    SymbolTable* table = symbol_table_create();
+
+    SymbolId global = symbol_table_declare(table, x, SYMBOL_VARIABLE, NULL);
+    bool ok = global != SYMBOL_NONE && symbol_table_depth(table) == 0 &&
+              symbol_table_lookup(table, x) == global && symbol_table_lookup(table, y) == SYMBOL_NONE;
+
+    // An inner x hides the global one until its scope closes
+    ok = ok && symbol_table_push_scope(table);
+    ok = ok && symbol_table_lookup(table, x) == global && symbol_table_lookup_local(table, x) == SYMBOL_NONE;
+    SymbolId inner = symbol_table_declare(table, x, SYMBOL_PARAMETER, NULL);
+    SymbolId local = symbol_table_declare(table, y, SYMBOL_VARIABLE, NULL);
+    ok = ok && symbol_table_lookup(table, x) == inner && symbol_table_lookup_local(table, x) == inner &&
+         symbol_table_lookup(table, y) == local && symbol_table_get(table, inner)->shadowed == global;
+    symbol_table_pop_scope(table);
+
+    ok = ok && symbol_table_depth(table) == 0 && symbol_table_lookup(table, x) == global &&
+         symbol_table_lookup(table, y) == SYMBOL_NONE;
+
+    // Closed scopes keep their symbols; popping scope 0 does nothing
+    const Symbol* closed = symbol_table_get(table, inner);
+    ok = ok && closed && closed->depth == 1 && closed->kind == SYMBOL_PARAMETER &&
+         symbol_table_count(table) == 3 && symbol_table_get(table, 3) == NULL;
+    symbol_table_pop_scope(table);
+    ok = ok && symbol_table_lookup(table, x) == global;
+
+    symbol_table_free(table);
+    string_interner_free(names);
+
+    if (!ok) {
+        printf("✗ Symbol scope test failed\n");
+        exit(1);
+    }
+    printf("✓ Symbol scope test passed\n");
+}
+
+void test_symbol_table_growth() {
+    printf("\n=== Testing Symbol Table Growth ===\n");
+
+    // 64 scopes of 100 names each, every name shadowing the scope above
+    // its own; unwinding must restore each outer binding in turn
+    enum { SCOPES = 64, NAMES = 100 };
+    SymbolTable* table = symbol_table_create();
+    static SymbolId ids[SCOPES][NAMES];
+    bool ok = true;
+
+    for (int scope = 0; ok && scope < SCOPES; scope++) {
+        ok = symbol_table_push_scope(table);
+        for (int n = 0; ok && n < NAMES; n++) {
+            ids[scope][n] = symbol_table_declare(table, (uint32_t)(n * 7919 + 1), SYMBOL_VARIABLE, NULL);
+            ok = ids[scope][n] != SYMBOL_NONE;
+        }
+    }
+    for (int scope = SCOPES - 1; ok && scope >= 0; scope--) {
+        for (int n = 0; ok && n < NAMES; n++) {
+            ok = symbol_table_lookup(table, (uint32_t)(n * 7919 + 1)) == ids[scope][n];
+        }
+        symbol_table_pop_scope(table);
+    }
+    ok = ok && symbol_table_lookup(table, 1) == SYMBOL_NONE && symbol_table_count(table) == SCOPES * NAMES;
+
+    symbol_table_free(table);
+
+    if (!ok) {
+        printf("✗ Symbol table growth test failed\n");
+        exit(1);
+    }
+    printf("✓ Symbol table growth test passed\n");
+}
+
+/* Resolution of the first identifier spelled name at or after offset */
+static const NameRef* use_of(const Resolution* res, const char* source, const char* name, const char* after) {
+    size_t offset = (size_t)(strstr(source, after) - source);
+    for (uint32_t id = 0; id < res->index.count; id++) {
+        AstNode* node = res->index.nodes[id];
+        if (node->type == AST_IDENTIFIER_EXPR && node->offset >= offset &&
+            strcmp(node->as.identifier, name) == 0) {
+            return resolution_name(res, id);
+        }
+    }
+    return NULL;
+}
+
+static uint32_t flags_of(const Resolution* res, const NameRef* ref) {
+    return ref && ref->symbol != SYMBOL_NONE ? res->variables[ref->symbol].flags : 0;
+}
+
+void test_name_resolution() {
+    printf("\n=== Testing Name Resolution ===\n");
+
+    const char* source =
+        "func area(w, h) {\n"
+        "    s = w * h + scale\n"
+        "    if s > 10 { big = s } else { small = [h] }\n"
+        "    for i, v in w { s = s + v * i }\n"
+        "    return s\n"
+        "}\n"
+        "scale = 2\n"
+        "print(area(3, 4), missing)\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
+    Resolution res;
+    bool resolved = program && resolve_program(&res, program, &diags);
+    bool ok = resolved;
+
+    // Parameters first, then locals; sibling branches share a slot
+    const NameRef* w = ok ? use_of(&res, source, "w", "s = w") : NULL;
+    const NameRef* h = ok ? use_of(&res, source, "h", "s = w") : NULL;
+    const NameRef* s = ok ? use_of(&res, source, "s", "return s") : NULL;
+    const NameRef* v = ok ? use_of(&res, source, "v", "s + v") : NULL;
+    const NameRef* i = ok ? use_of(&res, source, "i", "v * i") : NULL;
+    ok = ok && w && h && s && v && i &&
+         w->kind == NAME_LOCAL && w->slot == 0 && h->kind == NAME_LOCAL && h->slot == 1 &&
+         s->kind == NAME_LOCAL && s->slot == 2 && v->slot == 3 && i->slot == 4 &&
+         res.frame_count == 2 && res.frames[1].param_count == 2 && res.frames[1].slot_count == 5;
+
+    // The body sees a global declared after it; calls reach functions and builtins
+    const NameRef* scale = ok ? use_of(&res, source, "scale", "scale\n") : NULL;
+    const NameRef* area = ok ? use_of(&res, source, "area", "area(3") : NULL;
+    const NameRef* print = ok ? use_of(&res, source, "print", "print") : NULL;
+    ok = ok && scale && area && print &&
+         scale->kind == NAME_GLOBAL && area->kind == NAME_GLOBAL && print->kind == NAME_BUILTIN &&
+         print->slot == 0 && res.global_count == 2;
+
+    // Captured and escaping variables
+    ok = ok && (flags_of(&res, scale) & VAR_CAPTURED) && (flags_of(&res, s) & VAR_ESCAPES) &&
+         (flags_of(&res, h) & VAR_ESCAPES) && flags_of(&res, w) == 0 && flags_of(&res, v) == 0;
+
+    // One undefined name, reported with its span
+    ok = ok && res.unresolved == 1 && diags.count == 1 &&
+         diags.items[0].code == DIAG_UNDEFINED_NAME &&
+         strncmp(source + diags.items[0].offset, "missing", diags.items[0].length) == 0 &&
+         use_of(&res, source, "missing", "missing")->kind == NAME_UNRESOLVED;
+
+    if (resolved) resolution_free(&res);
+    diag_buffer_free(&diags);
+    ast_free_node(program);
+
+    if (!ok) {
+        printf("✗ Name resolution test failed\n");
+        exit(1);
+    }
+    printf("✓ Name resolution test passed\n");
+}
+
+/* Whether two resolutions of one program bind every name alike */
+static bool same_resolution(const Resolution* a, const Resolution* b) {
+    size_t count = symbol_table_count(a->symbols);
+    bool same = a->index.count == b->index.count && count == symbol_table_count(b->symbols) &&
+                a->frame_count == b->frame_count && a->global_count == b->global_count &&
+                a->unresolved == b->unresolved &&
+                string_interner_count(a->interner) == string_interner_count(b->interner);
+    for (uint32_t id = 0; same && id < a->index.count; id++) {
+        same = a->names[id].kind == b->names[id].kind && a->names[id].slot == b->names[id].slot &&
+               a->names[id].symbol == b->names[id].symbol;
+    }
+    for (SymbolId id = 0; same && id < count; id++) {
+        const Symbol* x = symbol_table_get(a->symbols, id);
+        const Symbol* y = symbol_table_get(b->symbols, id);
+        same = x->name == y->name && x->depth == y->depth && x->kind == y->kind && x->decl == y->decl &&
+               x->shadowed == y->shadowed && a->variables[id].frame == b->variables[id].frame &&
+               a->variables[id].slot == b->variables[id].slot && a->variables[id].flags == b->variables[id].flags;
+    }
+    for (size_t f = 0; same && f < a->frame_count; f++) {
+        same = a->frames[f].node == b->frames[f].node && a->frames[f].first_param == b->frames[f].first_param &&
+               a->frames[f].param_count == b->frames[f].param_count &&
+               a->frames[f].slot_count == b->frames[f].slot_count;
+    }
+    return same;
+}
+
+void test_parallel_resolution() {
+    printf("\n=== Testing Parallel Resolution ===\n");
+
+    /* Enough bodies for every worker to steal from the others: shadowed
+     * globals and builtins, methods, captures and errors in each */
+    size_t capacity = 64 * 1024;
+    char* source = (char*)malloc(capacity);
+    size_t length = (size_t)snprintf(source, capacity, "limit = 10\ncount = 0\n");
+    for (int f = 0; f < 120; f++) {
+        length += (size_t)snprintf(source + length, capacity - length,
+            "func f%d(a, b, a) {\n"
+            "    len = a + limit\n"
+            "    for i, v in b { count = count + v * i }\n"
+            "    if a > %d { x%d = [len] } else { return f%d(b, a, nowhere%d) }\n"
+            "    return len\n"
+            "}\n"
+            "class C%d {\n"
+            "    size = limit\n"
+            "    func grow(n) { this.size = this.size + n + f%d(n, n, n) }\n"
+            "}\n",
+            f, f, f, (f + 1) % 120, f % 3, f, f);
+    }
+    snprintf(source + length, capacity - length, "print(f0(1, [2], 3), C0())\n");
+
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
+    Resolution sequential;
+    bool resolved = program && resolve_program(&sequential, program, &diags);
+    bool ok = resolved && sequential.unresolved == 120 && diags.count == 240;
+
+    // Every thread count gives the sequential result, diagnostics included
+    for (int threads = 1; ok && threads <= 8; threads *= 2) {
+        DiagBuffer parallel_diags;
+        diag_buffer_init(&parallel_diags);
+        Resolution parallel;
+        ParallelResolveStats stats;
+        bool parallel_resolved = resolve_program_parallel(&parallel, program, &parallel_diags, threads, &stats);
+        ok = parallel_resolved && stats.bodies == 240 && stats.threads == threads && same_resolution(&sequential, &parallel);
+        ok = ok && parallel_diags.count == diags.count;
+        for (size_t d = 0; ok && d < diags.count; d++) {
+            ok = parallel_diags.items[d].code == diags.items[d].code &&
+                 parallel_diags.items[d].offset == diags.items[d].offset;
+        }
+        if (parallel_resolved) resolution_free(&parallel);
+        diag_buffer_free(&parallel_diags);
+    }
+
+    if (resolved) resolution_free(&sequential);
+    diag_buffer_free(&diags);
+    ast_free_node(program);
+    free(source);
+
+    if (!ok) {
+        printf("✗ Parallel resolution test failed\n");
+        exit(1);
+    }
+    printf("✓ Parallel resolution test passed\n");
+}
+
+/* Type of the first declaration of name (variable or function), formatted */
+static const char* type_of_decl(const TypeInference* types, const Resolution* res, const char* name, char* buffer) {
+    for (uint32_t id = 0; id < res->index.count; id++) {
+        AstNode* node = res->index.nodes[id];
+        if ((node->type == AST_VAR_DECL && strcmp(node->as.var_decl.name, name) == 0) ||
+            (node->type == AST_FUNCTION_DECL && strcmp(node->as.function.name, name) == 0)) {
+            return type_format(types->types, inference_type(types, id), buffer, 64);
+        }
+    }
+    return "";
+}
+
+void test_type_inference() {
+    printf("\n=== Testing Type Inference ===\n");
+
+    const char* source =
+        "func area(w, h) {\n"
+        "    return w * h\n"
+        "}\n"
+        "func greet(name) {\n"
+        "    return \"hi \" + name\n"
+        "}\n"
+        "func mean(values) {\n"
+        "    total = 0.5\n"
+        "    for i, v in values { total = total + v * values[i] }\n"
+        "    return total\n"
+        "}\n"
+        "big = area(3, 4) > 10\n"
+        "m = mean([1, 2.5])\n"
+        "s = greet(\"x\")\n"
+        "d = {\"a\": 1}\n"
+        "n = d[\"a\"]\n"
+        "z = 1\n"
+        "z = \"oops\"\n"
+        "area(1)\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
+    Resolution res;
+    TypeInference types;
+    bool resolved = program && resolve_program(&res, program, &diags);
+    bool inferred = resolved && infer_program(&types, &res, &diags);
+    bool ok = inferred;
+    char buffer[64];
+
+    // Integer literals default to int, and meet float literals as float
+    ok = ok && strcmp(type_of_decl(&types, &res, "area", buffer), "func(int, int) -> int") == 0;
+    ok = ok && strcmp(type_of_decl(&types, &res, "mean", buffer), "func(array[float]) -> float") == 0;
+    ok = ok && strcmp(type_of_decl(&types, &res, "greet", buffer), "func(string) -> string") == 0;
+    ok = ok && strcmp(type_of_decl(&types, &res, "big", buffer), "bool") == 0;
+    ok = ok && strcmp(type_of_decl(&types, &res, "m", buffer), "float") == 0;
+    ok = ok && strcmp(type_of_decl(&types, &res, "d", buffer), "dict[string, int]") == 0;
+    ok = ok && strcmp(type_of_decl(&types, &res, "n", buffer), "int") == 0;
+    ok = ok && types.defaulted > 0;
+
+    // Every expression has a type; equal types share an id
+    for (uint32_t id = 0; ok && id < res.index.count; id++) {
+        if (res.index.nodes[id]->type < AST_VAR_DECL) ok = inference_type(&types, id) != TYPE_NONE;
+    }
+    ok = ok && type_array(types.types, TYPE_FLOAT) == type_operand(types.types,
+         inference_type(&types, ast_index_id(&res.index, ((AstNode*)program->as.program.declarations->items[2]))), 1);
+
+    // z is given two types and falls back to dynamic; area(1) is short an argument
+    ok = ok && strcmp(type_of_decl(&types, &res, "z", buffer), "dynamic") == 0 && types.conflicts == 1;
+    ok = ok && diags.count == 2 && diags.items[0].code == DIAG_TYPE_CONFLICT &&
+         diags.items[0].severity == DIAG_WARNING && diags.items[1].code == DIAG_ARGUMENT_COUNT &&
+         strncmp(source + diags.items[1].offset, "area(1)", diags.items[1].length) == 0;
+
+    if (inferred) type_inference_free(&types);
+    if (resolved) resolution_free(&res);
+    diag_buffer_free(&diags);
+    ast_free_node(program);
+
+    // Annotations look class names up without adding any to the interner
+    const char* annotated =
+        "class Point {\n"
+        "    x = 0\n"
+        "}\n"
+        "p: Point = Point()\n"
+        "q: Widget = 1\n";
+    lexer_init(&lexer, annotated);
+    parser_init(&parser, &lexer);
+    program = parser_parse(&parser);
+    parser_free(&parser);
+    diag_buffer_init(&diags);
+    resolved = program && resolve_program(&res, program, &diags);
+    size_t names = resolved ? string_interner_count(res.interner) : 0;
+    inferred = resolved && infer_program(&types, &res, &diags);
+    ok = ok && inferred && string_interner_count(res.interner) == names;
+    ok = ok && strcmp(type_of_decl(&types, &res, "p", buffer), "Point") == 0;
+    ok = ok && strcmp(type_of_decl(&types, &res, "q", buffer), "dynamic") == 0;
+
+    if (inferred) type_inference_free(&types);
+    if (resolved) resolution_free(&res);
+    diag_buffer_free(&diags);
+    ast_free_node(program);
+
+    if (!ok) {
+        printf("✗ Type inference test failed\n");
+        exit(1);
+    }
+    printf("✓ Type inference test passed\n");
+}
+
+/* Preorder id of the call written as text in source */
+static uint32_t call_at(const Resolution* res, const char* source, const char* text) {
+    uint32_t offset = (uint32_t)(strstr(source, text) - source);
+    for (uint32_t id = 0; id < res->index.count; id++) {
+        if (res->index.nodes[id]->type == AST_CALL_EXPR && res->index.nodes[id]->offset == offset) return id;
+    }
+    return AST_INDEX_NONE;
+}
+
+static uint32_t function_named(const Resolution* res, const char* name) {
+    for (uint32_t id = 0; id < res->index.count; id++) {
+        AstNode* node = res->index.nodes[id];
+        if (node->type == AST_FUNCTION_DECL && strcmp(node->as.function.name, name) == 0) return id;
+    }
+    return AST_INDEX_NONE;
+}
+
+static const char* instance_signature(const SpecializationSet* set, const TypeInference* types, uint32_t instance,
+                                      char* buffer) {
+    if (instance == SPECIALIZATION_NONE) return "";
+    return type_format(types->types, set->items[instance].signature, buffer, 64);
+}
+
+void test_specialization() {
+    printf("\n=== Testing Specialization ===\n");
+
+    const char* source =
+        "func twice(x) {\n"
+        "    return x + x\n"
+        "}\n"
+        "func fib(n) {\n"
+        "    if n < 2 { return n }\n"
+        "    return fib(n - 1) + fib(n - 2)\n"
+        "}\n"
+        "func unused(y) {\n"
+        "    return y\n"
+        "}\n"
+        "func main() {\n"
+        "    a = twice(2)\n"
+        "    b = twice(1.5)\n"
+        "    c = twice(\"ab\")\n"
+        "    d = twice(3)\n"
+        "    z = 1\n"
+        "    z = \"oops\"\n"
+        "    e = twice(z)\n"
+        "    print(fib(20))\n"
+        "}\n"
+        "top = fib(5)\n";
+    Lexer lexer;
+    lexer_init(&lexer, source);
+    Parser parser;
+    parser_init(&parser, &lexer);
+    AstNode* program = parser_parse(&parser);
+    parser_free(&parser);
+
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
+    Resolution res;
+    TypeInference types;
+    SpecializationSet set;
+    bool resolved = program && resolve_program(&res, program, &diags);
+    bool inferred = resolved && infer_program(&types, &res, &diags);
+    bool specialized = inferred && specialize_program(&set, &res, &types);
+    bool ok = specialized;
+    char buffer[64];
+
+    // One shared signature cannot take int, float and string: it is boxed
+    ok = ok && strcmp(type_of_decl(&types, &res, "twice", buffer), "func(dynamic) -> dynamic") == 0;
+
+    // Instances: one per argument tuple, the dynamic z going to the boxed one
+    uint32_t twice = function_named(&res, "twice");
+    uint32_t fib = function_named(&res, "fib");
+    ok = ok && specialization_count(&set, twice) == 4 && specialization_count(&set, fib) == 1 && set.boxed == 1;
+    ok = ok && specialization_count(&set, function_named(&res, "unused")) == 0;
+    ok = ok && set.count == 6 && set.cache_hits >= 3;
+
+    // Calls in main go to the instance for their argument types
+    uint32_t main_instance = 0;
+    for (uint32_t i = 0; ok && i < set.count; i++) {
+        if (set.items[i].function == function_named(&res, "main")) main_instance = i;
+    }
+    ok = ok && strcmp(instance_signature(&set, &types, specialization_target(&set, main_instance,
+                      call_at(&res, source, "twice(1.5)")), buffer), "func(float) -> float") == 0;
+    ok = ok && strcmp(instance_signature(&set, &types, specialization_target(&set, main_instance,
+                      call_at(&res, source, "twice(\"ab\")")), buffer), "func(string) -> string") == 0;
+    ok = ok && specialization_target(&set, main_instance, call_at(&res, source, "twice(2)")) ==
+               specialization_target(&set, main_instance, call_at(&res, source, "twice(3)"));
+    ok = ok && set.items[specialization_target(&set, main_instance, call_at(&res, source, "twice(z)"))].boxed;
+
+    // Recursion reaches the instance being checked, and top-level code shares it
+    uint32_t fib_instance = ok ? specialization_target(&set, SPECIALIZATION_NONE, call_at(&res, source, "fib(5)")) : 0;
+    ok = ok && strcmp(instance_signature(&set, &types, fib_instance, buffer), "func(int) -> int") == 0;
+    ok = ok && specialization_target(&set, fib_instance, call_at(&res, source, "fib(n - 1)")) == fib_instance;
+    ok = ok && specialization_target(&set, main_instance, call_at(&res, source, "fib(20)")) == fib_instance;
+
+    // Node types of an instance: b is a float in main
+    if (ok) {
+        const Specialization* item = &set.items[main_instance];
+        uint32_t b = call_at(&res, source, "twice(1.5)") - 1;
+        ok = res.index.nodes[b]->type == AST_VAR_DECL && item->node_types[b - item->function] == TYPE_FLOAT;
+    }
+
+    if (ok) specialization_report(&set, &res, &types, stdout);
+    if (specialized) specialization_set_free(&set);
+    if (inferred) type_inference_free(&types);
+    if (resolved) resolution_free(&res);
+    diag_buffer_free(&diags);
+    ast_free_node(program);
+
+    if (!ok) {
+        printf("✗ Specialization test failed\n");
+        exit(1);
+    }
+    printf("✓ Specialization test passed\n");
+}
+
+/* An in-memory project: names[i] is the module with source sources[i] */
+typedef struct {
+    const char* names[8];
+    const char* sources[8];
+} Project;
+
+static char* read_project(void* context, const char* name, size_t* length) {
+    Project* project = (Project*)context;
+    for (size_t i = 0; i < 8 && project->names[i]; i++) {
+        if (strcmp(project->names[i], name) != 0) continue;
+        *length = strlen(project->sources[i]);
+        char* copy = (char*)malloc(*length + 1);
+        if (copy) memcpy(copy, project->sources[i], *length + 1);
+        return copy;
+    }
+    return NULL;
+}
+
+static ModuleState state_of(const ModuleGraph* graph, const char* name) {
+    const Module* module = module_graph_find(graph, name);
+    return module ? module->state : MODULE_PENDING;
+}
+
+static bool has_diag(const ModuleGraph* graph, const char* name, DiagCode code) {
+    const Module* module = module_graph_find(graph, name);
+    for (size_t i = 0; module && i < module->diags.count; i++) {
+        if (module->diags.items[i].code == code) return true;
+    }
+    return false;
+}
+
+void test_modules() {
+    printf("\n=== Testing Modules ===\n");
+
+    // A diamond: main imports shapes and text, both of which import base
+    Project project = {
+        { "main", "shapes", "text", "base", "ghost_user", NULL },
+        {
+            "import shapes\n"
+            "import text\n"
+            "func main() {\n"
+            "    print(shapes.area(2, 3))\n"
+            "    print(text.banner(\"hi\"))\n"
+            "    print(base.square(2))\n"
+            "}\n",
+            "import base\n"
+            "func area(w, h) {\n"
+            "    return base.square(w) * h\n"
+            "}\n"
+            "class Box {\n"
+            "    func init(w) { this.w = w }\n"
+            "}\n",
+            "import base\n"
+            "func banner(s) {\n"
+            "    return s + \"!\"\n"
+            "}\n"
+            "x = base.missing\n"
+            "y = base.square(1, 2)\n",
+            "func square(n) {\n"
+            "    return n * n\n"
+            "}\n"
+            "limit = 10\n",
+            "import ghost\n",
+        }
+    };
+
+    ModuleGraph graph;
+    ModuleBuildStats stats;
+    module_graph_init(&graph, read_project, &project);
+    bool ok = module_graph_build(&graph, "main", 4, &stats);
+
+    // base, then shapes and text side by side, then main
+    ok = ok && stats.modules == 4 && stats.waves == 3 && stats.widest_wave == 2 && stats.parsed == 4 &&
+         stats.analyzed == 4 && stats.reused == 0 && stats.cycles == 0;
+    ok = ok && module_graph_find(&graph, "base")->wave == 0 && module_graph_find(&graph, "shapes")->wave == 1 &&
+         module_graph_find(&graph, "text")->wave == 1 && module_graph_find(&graph, "main")->wave == 2;
+    ok = ok && state_of(&graph, "main") == MODULE_COMPILED && state_of(&graph, "base") == MODULE_COMPILED;
+
+    // Interfaces: sorted exports with their arity and signature
+    const ModuleInterface* base = ok ? &module_graph_find(&graph, "base")->interface : NULL;
+    const ModuleExport* square = base ? module_interface_find(base, "square") : NULL;
+    ok = ok && base->count == 2 && square && square->kind == SYMBOL_FUNCTION && square->param_count == 1 &&
+         strcmp(square->signature, "func(int) -> int") == 0;
+    ok = ok && module_interface_find(base, "limit") && module_interface_find(base, "limit")->kind == SYMBOL_VARIABLE;
+    const ModuleExport* box = ok ? module_interface_find(&module_graph_find(&graph, "shapes")->interface, "Box") : NULL;
+    ok = ok && box && box->kind == SYMBOL_CLASS && box->param_count == 1;
+
+    // Uses are checked against the interface; base is not imported by main
+    ok = ok && has_diag(&graph, "text", DIAG_UNDEFINED_NAME) && has_diag(&graph, "text", DIAG_ARGUMENT_COUNT);
+    ok = ok && module_graph_find(&graph, "text")->diags.count == 2 && module_graph_find(&graph, "shapes")->diags.count == 0;
+    ok = ok && has_diag(&graph, "main", DIAG_UNDEFINED_NAME) && !has_diag(&graph, "main", DIAG_ARGUMENT_COUNT);
+    ok = ok && module_graph_error_count(&graph) == 3;
+
+    // Nothing changed: every module is reused and none is parsed
+    ok = ok && module_graph_build(&graph, "main", 4, &stats);
+    ok = ok && stats.parsed == 0 && stats.analyzed == 0 && stats.reused == 4 && module_graph_error_count(&graph) == 3;
+
+    // A body edit keeping base's interface recompiles base alone
+    project.sources[3] = "func square(n) {\n    r = n * n\n    return r\n}\nlimit = 10\n";
+    ok = ok && module_graph_build(&graph, "main", 2, &stats);
+    ok = ok && stats.parsed == 1 && stats.analyzed == 1 && stats.reused == 3;
+
+    // A signature edit recompiles its importers, whose uses now fail
+    project.sources[3] = "func square(n, m) {\n    return n * m\n}\nlimit = 10\n";
+    ok = ok && module_graph_build(&graph, "main", 1, &stats);
+    ok = ok && stats.parsed == 3 && stats.analyzed == 3 && stats.reused == 1 && state_of(&graph, "main") == MODULE_REUSED;
+    ok = ok && has_diag(&graph, "shapes", DIAG_ARGUMENT_COUNT);
+
+    // A missing module is reported at its import statement
+    ok = ok && module_graph_build(&graph, "ghost_user", 2, &stats);
+    ok = ok && stats.modules == 2 && state_of(&graph, "ghost") == MODULE_MISSING &&
+         has_diag(&graph, "ghost_user", DIAG_UNDEFINED_NAME) && module_graph_error_count(&graph) == 1;
+    module_graph_render(&graph, stdout);
+    module_graph_free(&graph);
+
+    // A cycle is reported on both of its modules; the module above it is blocked
+    Project cyclic = {
+        { "app", "left", "right", "leaf", NULL },
+        { "import left\nimport leaf\n", "import right\n", "import left\nimport leaf\n", "z = 1\n" }
+    };
+    module_graph_init(&graph, read_project, &cyclic);
+    ok = ok && module_graph_build(&graph, "app", 4, &stats);
+    ok = ok && stats.modules == 4 && stats.cycles == 1 && stats.waves == 1 && stats.analyzed == 1;
+    ok = ok && state_of(&graph, "left") == MODULE_IN_CYCLE && state_of(&graph, "right") == MODULE_IN_CYCLE &&
+         state_of(&graph, "app") == MODULE_BLOCKED && state_of(&graph, "leaf") == MODULE_COMPILED;
+    ok = ok && has_diag(&graph, "left", DIAG_IMPORT_CYCLE) && has_diag(&graph, "right", DIAG_IMPORT_CYCLE) &&
+         module_graph_error_count(&graph) == 2;
+
+    // Breaking the cycle compiles everything
+    cyclic.sources[2] = "import leaf\n";
+    ok = ok && module_graph_build(&graph, "app", 4, &stats);
+    ok = ok && stats.cycles == 0 && stats.waves == 4 && module_graph_error_count(&graph) == 0 &&
+         state_of(&graph, "app") == MODULE_COMPILED && state_of(&graph, "leaf") == MODULE_REUSED;
+
+    // A source that no longer parses drops the imports of the one before
+    cyclic.sources[0] = "import left\nfunc (\n";
+    module_graph_build(&graph, "app", 4, &stats);
+    ok = ok && stats.modules == 1 && state_of(&graph, "app") == MODULE_PARSE_FAILED &&
+         module_graph_find(&graph, "app")->import_count == 0;
+    module_graph_free(&graph);
+
+    if (!ok) {
+        printf("✗ Modules test failed\n");
+        exit(1);
+    }
+    printf("✓ Modules test passed\n");
+}
+
+static const char* signature_of(const DeclGraph* graph, const char* name, char* buffer) {
+    return type_format(decl_graph_types(graph), decl_graph_signature(graph, name), buffer, 64);
+}
+
+/* Name a top-level function, class or variable declaration gives a type */
+static const char* top_level_name(const AstNode* node) {
+    return node->type == AST_FUNCTION_DECL ? node->as.function.name
+         : node->type == AST_CLASS_DECL    ? node->as.class_decl.name
+         : node->type == AST_VAR_DECL      ? node->as.var_decl.name
+                                           : NULL;
+}
+
+/* Diagnostics by position, then code: passes report in their own order */
+static int compare_diags(const void* a, const void* b) {
+    const Diagnostic* x = (const Diagnostic*)a;
+    const Diagnostic* y = (const Diagnostic*)b;
+    if (x->offset != y->offset) return x->offset < y->offset ? -1 : 1;
+    if (x->line != y->line) return x->line < y->line ? -1 : 1;
+    if (x->column != y->column) return x->column < y->column ? -1 : 1;
+    return (int)x->code - (int)y->code;
+}
+
+/* The graph agrees with resolving and inferring the whole program: the
+ * same type for the last declaration of every top-level name and the
+ * same diagnostics, in the same places */
+static bool same_as_whole(const DeclGraph* graph, AstNode* program) {
+    DiagBuffer a, b;
+    Resolution res;
+    TypeInference types;
+    diag_buffer_init(&a);
+    diag_buffer_init(&b);
+    bool resolved = resolve_program(&res, program, &b);
+    bool inferred = resolved && infer_program(&types, &res, &b);
+    bool ok = inferred && decl_graph_diagnostics(graph, &a) && a.count == b.count &&
+              decl_graph_error_count(graph) == b.error_count;
+    if (ok) {
+        qsort(a.items, a.count, sizeof(Diagnostic), compare_diags);
+        qsort(b.items, b.count, sizeof(Diagnostic), compare_diags);
+    }
+    for (size_t i = 0; ok && i < a.count; i++) {
+        ok = a.items[i].code == b.items[i].code && a.items[i].severity == b.items[i].severity &&
+             a.items[i].offset == b.items[i].offset && a.items[i].length == b.items[i].length &&
+             a.items[i].line == b.items[i].line && a.items[i].column == b.items[i].column;
+    }
+
+    const AstIndex* index = inferred ? &res.index : NULL;
+    for (uint32_t id = 1; ok && id < index->count; id += index->size[id]) {
+        const char* name = top_level_name(index->nodes[id]);
+        bool last = name != NULL;
+        for (uint32_t later = id + index->size[id]; last && later < index->count; later += index->size[later]) {
+            const char* other = top_level_name(index->nodes[later]);
+            last = !other || strcmp(other, name) != 0;
+        }
+        char x[64], y[64];
+        ok = !last || strcmp(signature_of(graph, name, x), type_format(types.types, inference_type(&types, id), y, 64)) == 0;
+    }
+
+    if (inferred) type_inference_free(&types);
+    if (resolved) resolution_free(&res);
+    diag_buffer_free(&a);
+    diag_buffer_free(&b);
+    return ok;
+}
+
+/* Replaces the first occurrence of from with to, reparsing the program */
+static AstNode* edit_source(AstNode* program, TokenBuffer* tokens, char** source, const char* from, const char* to) {
+    char* at = strstr(*source, from);
+    if (!program || !at) return NULL;
+    size_t start = (size_t)(at - *source);
+    size_t length = strlen(*source) - strlen(from) + strlen(to);
+    char* edited = (char*)malloc(length + 1);
+    if (!edited) return NULL;
+    memcpy(edited, *source, start);
+    strcpy(edited + start, to);
+    strcat(edited, at + strlen(from));
+    SourceEdit edit = { start, strlen(from), strlen(to) };
+    program = parser_reparse(program, tokens, edited, edit, NULL);
+    free(*source);
+    *source = edited;
+    return program;
+}
+
+void test_decl_graph() {
+    printf("\n=== Testing Declaration Graph ===\n");
+
+    const char* text =
+        "func sq(x) {\n"
+        "    return x * x\n"
+        "}\n"
+        "func use() {\n"
+        "    return sq(2.5)\n"
+        "}\n"
+        "func twice(n) {\n"
+        "    return sq(n) + 1\n"
+        "}\n"
+        "class Point {\n"
+        "    func init(x) { this.x = x + 1 }\n"
+        "}\n"
+        "func origin() {\n"
+        "    return Point(0)\n"
+        "}\n"
+        "p = Point(1, 2)\n"
+        "total = twice(3)\n"
+        "label = \"n\" + total\n"
+        "func broken() {\n"
+        "    return sq(1, 2)\n"
+        "}\n";
+    char* source = (char*)malloc(strlen(text) + 1);
+    strcpy(source, text);
+    TokenBuffer tokens;
+    Parser parser;
+    bool ok = token_buffer_lex(&tokens, source);
+    AstNode* program = NULL;
+    if (ok) {
+        parser_init_tokens(&parser, &tokens, 0);
+        program = parser_parse(&parser);
+    }
+
+    DeclGraph* graph = decl_graph_create();
+    DeclCheckStats stats;
+    char buffer[64];
+    ok = ok && program && graph && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.declarations == 9 && stats.components == 2 && stats.rechecked == 9 && stats.reused == 0;
+
+    // Types flow through calls both ways: use's float reaches twice
+    ok = ok && strcmp(signature_of(graph, "sq", buffer), "func(float) -> float") == 0;
+    ok = ok && strcmp(signature_of(graph, "twice", buffer), "func(float) -> float") == 0;
+    ok = ok && strcmp(signature_of(graph, "origin", buffer), "func() -> Point") == 0;
+    ok = ok && strcmp(signature_of(graph, "total", buffer), "float") == 0;
+    ok = ok && strcmp(signature_of(graph, "label", buffer), "string") == 0;
+    ok = ok && decl_graph_signature(graph, "missing") == TYPE_NONE;
+
+    // Both calls with too many arguments are errors
+    DiagBuffer diags;
+    diag_buffer_init(&diags);
+    ok = ok && decl_graph_diagnostics(graph, &diags) && diags.count == 2 && decl_graph_error_count(graph) == 2;
+    ok = ok && diags.items[0].line == 16 && diags.items[0].length == 11 && diags.items[1].line == 20;
+    diag_buffer_free(&diags);
+    ok = ok && same_as_whole(graph, program);
+
+    // Nothing changed: every result is kept
+    ok = ok && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.rechecked == 0 && stats.reused == 9 && stats.cutoffs == 0;
+
+    // A literal of the same kind is cut off; its diagnostic follows the call
+    program = edit_source(program, &tokens, &source, "Point(1, 2)", "Point(1, 22)");
+    ok = ok && program && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.rechecked == 0 && stats.cutoffs == 1;
+    diag_buffer_init(&diags);
+    ok = ok && decl_graph_diagnostics(graph, &diags) && diags.count == 2 && diags.items[0].length == 12;
+    diag_buffer_free(&diags);
+    ok = ok && same_as_whole(graph, program);
+
+    // Lines added above move the declarations below without rechecking
+    // them; the two reparsed around the edit have the same shape
+    program = edit_source(program, &tokens, &source, "func use", "// note\n\nfunc use");
+    ok = ok && program && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.rechecked == 0 && stats.reused == 9 && stats.cutoffs == 2 && same_as_whole(graph, program);
+
+    // A literal of another kind rechecks its component, and no other
+    program = edit_source(program, &tokens, &source, "twice(3)", "twice(3.5)");
+    ok = ok && program && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.rechecked == 6 && stats.reused == 3 && same_as_whole(graph, program);
+
+    // A new local leaves what use passes on as it was: inference stops
+    // after its body, and the rest of the component keeps its results
+    program = edit_source(program, &tokens, &source, "return sq(2.5)", "scale = 2\n    return sq(2.5)");
+    ok = ok && program && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.rechecked == 2 && stats.reused == 7 && stats.cutoffs == 1 && same_as_whole(graph, program);
+
+    // Passing sq another type changes it: the component is inferred again
+    program = edit_source(program, &tokens, &source, "return sq(2.5)", "return sq(\"s\")");
+    ok = ok && program && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.rechecked == 6 && stats.cutoffs == 0 && same_as_whole(graph, program);
+
+    // Renaming a function leaves its callers undefined and splits them up
+    program = edit_source(program, &tokens, &source, "func sq(", "func square(");
+    ok = ok && program && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.components == 5 && stats.rechecked == 6 && decl_graph_error_count(graph) == 4;
+    ok = ok && same_as_whole(graph, program);
+
+    // A duplicate joins the components of both names; the later one is bound
+    program = edit_source(program, &tokens, &source, "func broken", "func origin");
+    ok = ok && program && decl_graph_check(graph, program, &stats);
+    ok = ok && stats.components == 4 && stats.rechecked == 4 && stats.reused == 5;
+    ok = ok && strcmp(signature_of(graph, "origin", buffer), "func() -> dynamic") == 0 && same_as_whole(graph, program);
+
+    decl_graph_free(graph);
+    ast_free_node(program);
+    token_buffer_free(&tokens);
+    free(source);
+
+    if (!ok) {
+        printf("✗ Declaration graph test failed\n");
+        exit(1);
+    }
+    printf("✓ Declaration graph test passed\n");
+}
+
+int main() {
+    printf("====================================\n");
+    printf("   LAMC Semantic Test Suite\n");
+    printf("====================================\n");
+
+    test_symbol_scopes();
+    test_symbol_table_growth();
+    test_name_resolution();
+    test_parallel_resolution();
+    test_type_inference();
+    test_specialization();
+    test_modules();
+    test_decl_graph();
+
+    printf("\n====================================\n");
+    printf("✓ All semantic tests passed successfully!\n");
+    printf("====================================\n");
+
+    return 0;
+}